@@ -123,6 +123,12 @@ protected:
     return m_debugLevel;
   }
 
+  //! Returns the seed the random number generator was initialized with
+  int getSeed() const
+  {
+    return m_seed;
+  }
+
  private:
 
   static const char* const s_optionHelp;
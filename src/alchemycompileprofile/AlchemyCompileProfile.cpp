@@ -0,0 +1,238 @@
+#include "alchemycompileprofile/AlchemyCompileProfile.h"
+
+#include "stocknnet/ProfileIO.h"
+#include "stocknnet/ProfileCompiler.h"
+
+#include <fstream>
+#include <cctype>
+
+namespace alch {
+
+  const char* const AlchemyCompileProfile::s_optionProfile = "profile";
+  const char* const AlchemyCompileProfile::s_optionOutput = "output";
+  const char* const AlchemyCompileProfile::s_optionIdentifier = "identifier";
+
+  AlchemyCompileProfile::AlchemyCompileProfile()
+    : Framework()
+    , m_profileName("")
+    , m_outputFile("")
+    , m_identifier("")
+    , m_profile()
+  {
+    ;
+  }
+
+
+  AlchemyCompileProfile::~AlchemyCompileProfile()
+  {
+    ;
+  }
+
+  std::string AlchemyCompileProfile::getApplicationDescription() const
+  {
+    return
+      "Compiles a trained prediction profile into a C++ header holding its\n"
+      "weights and a predict() function for its exact layer sizes. Add an\n"
+      "#include of the header to alchemyprofile/CompiledProfiles.cpp and\n"
+      "rebuild alchemyprofile to score the profile with it. The compiled\n"
+      "evaluator is only used while the profile is unchanged; retrain and\n"
+      "the profile falls back to the generic network until recompiled.\n"
+      ;
+  }
+
+  bool AlchemyCompileProfile::initialize()
+  {
+    return Framework::initialize();
+  }
+
+  bool AlchemyCompileProfile::finalize()
+  {
+    return Framework::finalize();
+  }
+
+  Framework::OptionsReturnCode AlchemyCompileProfile::processOptions(
+    int argc, char** argv)
+  {
+    getOptions().getGenericOptions().add_options()
+      (s_optionProfile,
+       boost::program_options::value<std::string>(),
+       "Base name of prediction profile to compile")
+      (s_optionOutput,
+       boost::program_options::value<std::string>(),
+       "Name of C++ header file to write")
+      (s_optionIdentifier,
+       boost::program_options::value<std::string>(),
+       "Namespace to put the compiled profile in (default is made from the "
+       "profile base name)")
+      ;
+
+    return Framework::processOptions(argc, argv);
+  }
+
+
+  bool AlchemyCompileProfile::processApplication()
+  {
+    // process parameters passed in by user
+    if (!loadParams())
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Application failed while loading parameters"
+                   << Context::endl;
+      return false;
+    }
+    printParams();
+
+    if (!loadProfile())
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Application failed while loading prediction profile"
+                   << Context::endl;
+      return false;
+    }
+
+    if (!writeHeader())
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Application failed while writing compiled profile"
+                   << Context::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool AlchemyCompileProfile::loadParams()
+  {
+    FrameworkOptions& options(getOptions());
+    FrameworkOptions::VariablesMap& vm = options.getVariablesMap();
+
+    // get profile name
+    if (vm.count(s_optionProfile))
+    {
+      m_profileName = vm[s_optionProfile].as<std::string>();
+    }
+    else
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Profile name not specified"
+                   << Context::endl;
+      return false;
+    }
+
+    // get output file name
+    if (vm.count(s_optionOutput))
+    {
+      m_outputFile = vm[s_optionOutput].as<std::string>();
+    }
+    else
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Output file not specified"
+                   << Context::endl;
+      return false;
+    }
+
+    // get identifier
+    if (vm.count(s_optionIdentifier))
+    {
+      m_identifier = vm[s_optionIdentifier].as<std::string>();
+
+      bool valid = (!m_identifier.empty()
+                    && !::isdigit((unsigned char) m_identifier[0]));
+      for (std::string::size_type i = 0; i < m_identifier.length(); ++i)
+      {
+        unsigned char c = m_identifier[i];
+        valid = (valid && (::isalnum(c) || (c == '_')));
+      }
+
+      if (!valid)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Identifier '" << m_identifier
+                     << "' is not a valid C++ identifier"
+                     << Context::endl;
+        return false;
+      }
+    }
+    else
+    {
+      m_identifier = ProfileCompiler::getIdentifier(m_profileName);
+    }
+
+    return true;
+  }
+
+
+  void AlchemyCompileProfile::printParams()
+  {
+    getContext() << Context::PRIORITY_info
+                 << "Profile name: " << m_profileName
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Output file: " << m_outputFile
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Identifier: " << m_identifier
+                 << Context::endl;
+  }
+
+
+  bool AlchemyCompileProfile::loadProfile()
+  {
+    if (!ProfileIO::exists(m_profileName.c_str()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Profile name '" << m_profileName
+                   << "' does not exist"
+                   << Context::endl;
+      return false;
+    }
+
+    if (!ProfileIO::read(m_profileName.c_str(), m_profile, getContext()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to read profile from '" << m_profileName
+                   << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Loaded profile from '" << m_profileName << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyCompileProfile::writeHeader()
+  {
+    std::ofstream ofs(m_outputFile.c_str());
+    if (!ofs)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to open file '" << m_outputFile
+                   << "' for writing"
+                   << Context::endl;
+      return false;
+    }
+
+    if (!ProfileCompiler::write(ofs, m_profile, m_identifier, getContext()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to write compiled profile to '"
+                   << m_outputFile << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Wrote compiled profile to '" << m_outputFile << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+} // namespace alch
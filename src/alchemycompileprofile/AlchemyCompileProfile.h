@@ -0,0 +1,67 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_alchemycompileprofile_AlchemyCompileProfile_h
+#define INCLUDED_alchemycompileprofile_AlchemyCompileProfile_h
+
+#include "afwk/Framework.h"
+#include "stocknnet/PredictionProfile.h"
+
+namespace alch {
+
+/*!
+  \brief Compiles a trained prediction profile into a C++ header
+  \ingroup alchemycompileprofile
+*/
+class AlchemyCompileProfile : public Framework
+{
+ public:
+
+  /*!
+    \brief Constructor
+  */
+  AlchemyCompileProfile();
+
+  virtual ~AlchemyCompileProfile();
+
+protected:
+
+  std::string getApplicationName() const
+  {
+    return "alchemycompileprofile";
+  }
+
+  std::string getApplicationDescription() const;
+
+  std::string getApplicationVersion() const
+  {
+    return VERSIONSTRING;
+  }
+
+  virtual bool initialize();
+
+  virtual bool finalize();
+
+  virtual Framework::OptionsReturnCode processOptions(int argc, char** argv);
+
+  virtual bool processApplication();
+
+ private:
+
+  static const char* const s_optionProfile;
+  static const char* const s_optionOutput;
+  static const char* const s_optionIdentifier;
+
+  std::string m_profileName;
+  std::string m_outputFile;
+  std::string m_identifier;
+  PredictionProfile m_profile;
+
+  bool loadParams();
+  void printParams();
+  bool loadProfile();
+  bool writeHeader();
+};
+
+} // namespace alch
+
+#endif
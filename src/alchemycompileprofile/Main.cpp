@@ -0,0 +1,8 @@
+
+#include "alchemycompileprofile/AlchemyCompileProfile.h"
+
+int main(int argc, char** argv)
+{
+  alch::AlchemyCompileProfile app;
+  return app.run(argc, argv);
+}
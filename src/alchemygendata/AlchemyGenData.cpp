@@ -6,6 +6,7 @@
 
 #include "nnet/NNetDataset.h"
 #include "nnet/NNetDataStream.h"
+#include "nnet/NNetDataFile.h"
 #include "stocknnet/DatasetGeneratorBasic.h"
 
 #include <sstream>
@@ -23,6 +24,7 @@ namespace alch {
   const char* const AlchemyGenData::s_optionSymbol = "symbol";
   const char* const AlchemyGenData::s_optionRandomize = "randomize";
   const char* const AlchemyGenData::s_optionSample = "sample";
+  const char* const AlchemyGenData::s_optionBinary = "binary";
 
   AlchemyGenData::AlchemyGenData()
     : Framework()
@@ -32,6 +34,7 @@ namespace alch {
     , m_daysAdvance(1)
     , m_trainRatio(0.80)
     , m_sampleRatio(1.00)
+    , m_binary(false)
     , m_data()
   {
     ;
@@ -92,6 +95,8 @@ namespace alch {
        boost::program_options::value<double>(),
        "Percentage of data to sample (default 100%)")
       (s_optionRandomize, "Whether to randomize order of output data")
+      (s_optionBinary, "Write the data files in binary format, which "
+       "alchemytrain can map without parsing")
       ;
 
     return Framework::processOptions(argc, argv);
@@ -245,6 +250,8 @@ namespace alch {
       return false;
     }
 
+    m_binary = (vm.count(s_optionBinary) > 0);
+
     return true;
   }
 
@@ -275,6 +282,10 @@ namespace alch {
     getContext() << Context::PRIORITY_info
                  << "Data sampling ratio: " << m_sampleRatio
                  << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Output format: " << (m_binary ? "binary" : "text")
+                 << Context::endl;
   }
 
 
@@ -420,7 +431,7 @@ namespace alch {
 
         if (idx1 != idx2)
         {
-          std::swap(dataset[idx1], dataset[idx2]);
+          dataset.swapPoints(idx1, idx2);
         }
       }
     }
@@ -431,7 +442,13 @@ namespace alch {
 
   bool AlchemyGenData::outputDataset(const NNetDataset& dataset)
   {
-    std::ofstream testFile(m_testFile.c_str(), std::ios::trunc);
+    std::ios::openmode mode = (std::ios::out | std::ios::trunc);
+    if (m_binary)
+    {
+      mode |= std::ios::binary;
+    }
+
+    std::ofstream testFile(m_testFile.c_str(), mode);
     if (!testFile)
     {
       getContext() << Context::PRIORITY_error
@@ -440,7 +457,7 @@ namespace alch {
       return false;
     }
 
-    std::ofstream trainFile(m_trainFile.c_str(), std::ios::trunc);
+    std::ofstream trainFile(m_trainFile.c_str(), mode);
     if (!trainFile)
     {
       getContext() << Context::PRIORITY_error
@@ -454,9 +471,13 @@ namespace alch {
     int numTest = 0;
     int total = 0;
 
-    NNetDataset::const_iterator end = dataset.end();
-    NNetDataset::const_iterator iter;
-    for (iter = dataset.begin(); iter != end; ++iter)
+    // binary files hold all points of a matrix together, so they are
+    // collected and written at the end
+    NNetDataset trainData;
+    NNetDataset testData;
+
+    int datasetSize = int(dataset.size());
+    for (int i = 0; i < datasetSize; ++i)
     {
       ++total;
 
@@ -471,7 +492,12 @@ namespace alch {
       {
         ++numTest;
 
-        if (!NNetDataStream::writeDatapoint(testFile, *iter, getContext()))
+        if (m_binary)
+        {
+          testData.push_back(dataset[i]);
+        }
+        else if (!NNetDataStream::writeDatapoint(testFile, dataset[i],
+                                                 getContext()))
         {
           getContext() << Context::PRIORITY_error
                        << "Failed to write datapoint to test file "
@@ -484,7 +510,12 @@ namespace alch {
       {
         ++numTrain;
 
-        if (!NNetDataStream::writeDatapoint(trainFile, *iter, getContext()))
+        if (m_binary)
+        {
+          trainData.push_back(dataset[i]);
+        }
+        else if (!NNetDataStream::writeDatapoint(trainFile, dataset[i],
+                                                 getContext()))
         {
           getContext() << Context::PRIORITY_error
                        << "Failed to write datapoint to train file "
@@ -494,6 +525,25 @@ namespace alch {
       }
     }
 
+    if (m_binary)
+    {
+      if (!NNetDataFile::write(testFile, testData, getContext()))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed to write test file " << m_testFile
+                     << Context::endl;
+        return false;
+      }
+
+      if (!NNetDataFile::write(trainFile, trainData, getContext()))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed to write train file " << m_trainFile
+                     << Context::endl;
+        return false;
+      }
+    }
+
     // print out some simple statistics on number of points
     {
       getContext() << Context::PRIORITY_info
@@ -55,6 +55,7 @@ protected:
   static const char* const s_optionSymbol;
   static const char* const s_optionRandomize;
   static const char* const s_optionSample;
+  static const char* const s_optionBinary;
 
 
   std::string m_symbol;
@@ -63,6 +64,7 @@ protected:
   int m_daysAdvance;
   double m_trainRatio;
   double m_sampleRatio;
+  bool m_binary;
   RangeDataPtr m_data;
 
   bool loadParams();
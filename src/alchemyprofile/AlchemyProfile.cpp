@@ -1,32 +1,156 @@
 #include "alchemyprofile/AlchemyProfile.h"
 
 #include "afwk/PathRegistry.h"
+#include "autil/UnixSocket.h"
 #include "stocknnet/DatasetGeneratorBasic.h"
 #include "stocknnet/PredictionProfile.h"
 #include "stocknnet/ProfileIO.h"
+#include "stocknnet/ProfileLibrary.h"
 #include "stockdata/StockDataRetriever.h"
+#include "stockdata/FileStockDataSource.h"
 #include "stockdata/YahooStockDataSource.h"
 #include "stockdata/StockTimeUtil.h"
 #include "nnet/NeuralNetAlg.h"
-#include "nnet/Statistics.h"
+#include "nnet/RunningStatistics.h"
 
 #include "boost/tokenizer.hpp"
 #include "boost/filesystem/operations.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/bind.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 namespace alch {
 
   const char* const AlchemyProfile::s_optionSymbol = "symbol";
   const char* const AlchemyProfile::s_optionOutput = "output";
   const char* const AlchemyProfile::s_optionProfile = "profile";
+  const char* const AlchemyProfile::s_optionFastTanh = "fasttanh";
+  const char* const AlchemyProfile::s_optionLibrary = "library";
+  const char* const AlchemyProfile::s_optionJobs = "jobs";
+  const char* const AlchemyProfile::s_optionCache = "cache";
+  const char* const AlchemyProfile::s_optionServe = "serve";
+
+  namespace
+  {
+    //! Seconds a server keeps updates to the prediction cache before
+    //! writing them
+    const int cacheWriteInterval = 60;
+
+    //! Returns the modification time of a file, or 0 if it doesn't exist
+    std::time_t getModificationTime(const std::string& file)
+    {
+      struct stat st;
+      if (::stat(file.c_str(), &st) == -1)
+      {
+        return 0;
+      }
+      return st.st_mtime;
+    }
+  }
+
+
+  /*!
+    \brief State each thread keeps for scoring symbols
+
+    The profiles are shared between the threads and only read; everything
+    that is written while scoring a symbol lives here.
+  */
+  class AlchemyProfile::Worker
+  {
+   public:
+    //! Creates a worker logging with the same filter as ctx
+    explicit Worker(const Context& ctx)
+      : context()
+      , generator(context)
+      , workspace()
+      , floatWorkspace()
+      , fastWorkspace()
+      , stats()
+      , firstIdx()
+      , predictions()
+      , evaluatorOutput()
+      , cacheUpdates()
+    {
+      // messages are handed to the application context in symbol order
+      context.setPriorityFilter(ctx.getPriorityFilter());
+      context.setFlushFrequency(-1);
+    }
+
+    //! Messages logged for the symbol being processed
+    Context context;
+
+    //! Generates the dataset of each symbol
+    DatasetGeneratorBasic generator;
+
+    //! Propagation buffers for each network type
+    NeuralNetGroup<NeuralNet>::Workspace workspace;
+    NeuralNetGroup<FloatNeuralNet>::Workspace floatWorkspace;
+    NeuralNetGroup<FastTanhNeuralNet>::Workspace fastWorkspace;
+
+    //! Statistics of each profile cached by earlier runs
+    std::vector<RunningStatistics> stats;
+
+    //! Index of the first dataset point each profile must score
+    std::vector<int> firstIdx;
+
+    //! Predictions of the symbol being processed, one row per dataset
+    //! point and one column per profile
+    std::vector<double> predictions;
+
+    //! Outputs of a compiled evaluator for one dataset point
+    std::vector<double> evaluatorOutput;
+
+    //! Entries for the prediction cache from the symbol being processed
+    std::vector<std::pair<std::string, PredictionCache::Entry> >
+      cacheUpdates;
+  };
+
 
   AlchemyProfile::AlchemyProfile()
     : Framework()
     , m_outputFile("")
+    , m_fastTanh(false)
+    , m_numJobs(1)
+    , m_cacheFile("")
+    , m_socketFile("")
+    , m_libraryFile("")
+    , m_profileList("")
+    , m_profileTime(0)
+    , m_cache()
+    , m_numCacheUpdates(0)
+    , m_cacheWriteTime(0)
     , m_profiles()
+    , m_profileNames()
+    , m_profileSelected()
+    , m_evaluators()
+    , m_neuralNets()
+    , m_floatNeuralNets()
+    , m_fastNeuralNets()
+    , m_cacheKeys()
+    , m_symbolMutex()
+    , m_nextSymbol(0)
+    , m_nextOutput(0)
+    , m_symbolResults()
+    , m_workers()
+    , m_threads()
+    , m_startCondition()
+    , m_doneCondition()
+    , m_numRequests(0)
+    , m_numRunning(0)
+    , m_stopThreads(false)
+    , m_requestSymbols(0)
+    , m_requestOutput(0)
+    , m_symbolData()
   {
     ;
   }
@@ -34,7 +158,7 @@ namespace alch {
 
   AlchemyProfile::~AlchemyProfile()
   {
-    ;
+    stopThreads();
   }
 
 
@@ -47,6 +171,22 @@ namespace alch {
       "\nexists then only those symbols will be profiled. Otherwise, all\n"
       "symbols will be profiled. Profiling output is saved to the specified\n"
       "output file in CSV format.\n"
+      "\n"
+      "With --serve the profiles and the data of each symbol scored are\n"
+      "kept in memory, and requests are answered on a Unix domain socket\n"
+      "instead. Each request and reply is a 4 byte length in network byte\n"
+      "order followed by that many bytes of text. Requests are:\n"
+      "  score SYMBOL[,SYMBOL...] [PROFILE[,PROFILE...]]\n"
+      "  reload\n"
+      "  stop\n"
+      "Profiles are named as they were given to --profile, or by their name\n"
+      "in the --library; all profiles are used if none are named. reload\n"
+      "reads the profiles again if their files changed, and the data of\n"
+      "symbols whose data files changed. Replies start with 'ok' or\n"
+      "'error' on a line of their own; a score reply continues with the\n"
+      "CSV output for the symbols. Updates to the --cache file are written\n"
+      "after the reply to a score request, at most once a minute, and when\n"
+      "the server stops.\n"
       ;
 
     return ss.str();
@@ -75,9 +215,28 @@ namespace alch {
       (s_optionProfile,
        boost::program_options::value<std::string>(),
        "Specifies profiles to use (comma-separated)")
+      (s_optionLibrary,
+       boost::program_options::value<std::string>(),
+       "Reads profiles from the specified profile library instead of from "
+       "profile files; uses every profile in it unless --profile is given")
       (s_optionOutput,
        boost::program_options::value<std::string>(),
        "Specifies output file name")
+      (s_optionFastTanh,
+       "Scores double precision profiles with an approximate tanh that is "
+       "faster but may change predictions by up to about 1e-6")
+      (s_optionJobs,
+       boost::program_options::value<int>(),
+       "Number of symbols to process at once (default is the number of "
+       "processors)")
+      (s_optionCache,
+       boost::program_options::value<std::string>(),
+       "Keeps the error and correlation of each symbol and profile in the "
+       "specified file, so that later runs only score the days added since")
+      (s_optionServe,
+       boost::program_options::value<std::string>(),
+       "Keeps the profiles and symbol data in memory and answers scoring "
+       "requests on the specified Unix domain socket")
       ;
 
     return Framework::processOptions(argc, argv);
@@ -89,21 +248,58 @@ namespace alch {
     FrameworkOptions& options(getOptions());
     FrameworkOptions::VariablesMap& vm = options.getVariablesMap();
 
-    if (!vm.count(s_optionProfile))
+    // the profiles are converted for scoring as they are loaded
+    m_fastTanh = (vm.count(s_optionFastTanh) > 0);
+
+    if (vm.count(s_optionJobs))
+    {
+      m_numJobs = vm[s_optionJobs].as<int>();
+      if (m_numJobs < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Number of jobs must be at least 1"
+                     << Context::endl;
+        return false;
+      }
+    }
+    else
+    {
+      m_numJobs = std::max(1, int(::sysconf(_SC_NPROCESSORS_ONLN)));
+    }
+
+    if (vm.count(s_optionLibrary))
+    {
+      m_libraryFile = vm[s_optionLibrary].as<std::string>();
+    }
+
+    if (vm.count(s_optionProfile))
+    {
+      m_profileList = vm[s_optionProfile].as<std::string>();
+    }
+    else if (m_libraryFile.empty())
     {
       getContext() << Context::PRIORITY_error
                    << "Option not specified: -" << s_optionProfile
                    << Context::endl;
       return false;
     }
-    else if (!initializeProfiles(vm[s_optionProfile].as<std::string>()))
+
+    if (!loadProfiles())
     {
-      getContext() << Context::PRIORITY_error
-                   << "Failed to process profile list"
-                   << Context::endl;
       return false;
     }
 
+    if (vm.count(s_optionCache))
+    {
+      m_cacheFile = vm[s_optionCache].as<std::string>();
+    }
+
+    if (vm.count(s_optionServe))
+    {
+      m_socketFile = vm[s_optionServe].as<std::string>();
+      return serve();
+    }
+
 
     if (!vm.count(s_optionOutput))
     {
@@ -289,86 +485,629 @@ namespace alch {
       return false;
     }
 
-    VecStockID::const_iterator end = symbolList.end();
-    VecStockID::const_iterator iter;
-    for (iter = symbolList.begin(); iter != end; ++iter)
+    if (!m_cacheFile.empty() && !readCache())
     {
-      if (!processSymbol(*iter, ofs))
+      return false;
+    }
+
+    scoreSymbols(symbolList, ofs);
+
+    if (!m_cacheFile.empty() && !writeCache())
+    {
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void AlchemyProfile::scoreSymbols(const VecStockID& symbolList,
+                                    std::ostream& os)
+  {
+    // the workers, their buffers and their threads are kept for the next
+    // request, so a server doesn't start threads for each one
+    if (m_workers.empty())
+    {
+      for (int job = 0; job < m_numJobs; ++job)
       {
-        getContext() << Context::PRIORITY_error
-                     << "Failed to process symbol '" << *iter
-                     << "'. Continuing execution."
-                     << Context::endl;
-        continue;
+        m_workers.push_back(
+          boost::shared_ptr<Worker>(new Worker(getContext())));
+      }
+
+      for (int job = 1; job < m_numJobs; ++job)
+      {
+        m_threads.create_thread(
+          boost::bind(&AlchemyProfile::runThread, this, job));
       }
     }
 
-    return true;
+    // each job takes symbols until none are left, and this thread runs
+    // the first job
+    {
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      m_nextSymbol = 0;
+      m_nextOutput = 0;
+      m_symbolResults.assign(symbolList.size(), SymbolResult());
+      m_requestSymbols = &symbolList;
+      m_requestOutput = &os;
+      m_numRunning = m_numJobs - 1;
+      ++m_numRequests;
+      m_startCondition.notify_all();
+    }
+
+    processSymbols(symbolList, *m_workers[0], os);
+
+    boost::mutex::scoped_lock lock(m_symbolMutex);
+    while (m_numRunning)
+    {
+      m_doneCondition.wait(lock);
+    }
+
+    assert(m_nextOutput == int(symbolList.size()));
+    m_symbolResults.clear();
+    m_requestSymbols = 0;
+    m_requestOutput = 0;
   }
 
 
-  bool AlchemyProfile::printHeader(std::ostream& os)
+  void AlchemyProfile::runThread(int job)
   {
-    os << "Symbol,Price,Profile,NumberDays,Ratio,FuturePrice,OverallError,"
-       << "Correlation\n";
-    return os;
+    int numRequests = 0;
+    for (;;)
+    {
+      {
+        boost::mutex::scoped_lock lock(m_symbolMutex);
+        while (!m_stopThreads && (m_numRequests == numRequests))
+        {
+          m_startCondition.wait(lock);
+        }
+
+        if (m_stopThreads)
+        {
+          return;
+        }
+
+        numRequests = m_numRequests;
+      }
+
+      processSymbols(*m_requestSymbols, *m_workers[job], *m_requestOutput);
+
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      if (!--m_numRunning)
+      {
+        m_doneCondition.notify_all();
+      }
+    }
   }
 
 
-  bool AlchemyProfile::processSymbol(const StockID& symbol,
-                                     std::ostream& os)
+  void AlchemyProfile::stopThreads()
+  {
+    {
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      m_stopThreads = true;
+      m_startCondition.notify_all();
+    }
+
+    m_threads.join_all();
+  }
+
+
+  void AlchemyProfile::processSymbols(const VecStockID& symbolList,
+                                      Worker& worker,
+                                      std::ostream& os)
+  {
+    for (;;)
+    {
+      int index = 0;
+      {
+        boost::mutex::scoped_lock lock(m_symbolMutex);
+        index = m_nextSymbol++;
+      }
+
+      if (index >= int(symbolList.size()))
+      {
+        return;
+      }
+
+      const StockID& symbol = symbolList[index];
+      std::ostringstream oss;
+      if (!processSymbol(symbol, worker, oss))
+      {
+        worker.context << Context::PRIORITY_error
+                       << "Failed to process symbol '" << symbol
+                       << "'. Continuing execution."
+                       << Context::endl;
+      }
+
+      finishSymbol(index, oss.str(), worker, os);
+    }
+  }
+
+
+  void AlchemyProfile::finishSymbol(int index,
+                                    const std::string& text,
+                                    Worker& worker,
+                                    std::ostream& os)
+  {
+    boost::mutex::scoped_lock lock(m_symbolMutex);
+
+    SymbolResult& result = m_symbolResults[index];
+    result.done = true;
+    result.text = text;
+    result.messages = worker.context.getMessages();
+    worker.context.clear();
+
+    for (int i = 0; i < int(worker.cacheUpdates.size()); ++i)
+    {
+      m_cache.set(worker.cacheUpdates[i].first,
+                  worker.cacheUpdates[i].second);
+    }
+    m_numCacheUpdates += int(worker.cacheUpdates.size());
+    worker.cacheUpdates.clear();
+
+    // write everything that no longer waits on an earlier symbol
+    while ((m_nextOutput < int(m_symbolResults.size()))
+           && m_symbolResults[m_nextOutput].done)
+    {
+      SymbolResult& next = m_symbolResults[m_nextOutput];
+      for (int i = 0; i < int(next.messages.size()); ++i)
+      {
+        getContext() << next.messages[i];
+      }
+
+      os << next.text;
+
+      // release the memory of results that are written
+      std::string().swap(next.text);
+      Context::MessageVec().swap(next.messages);
+      ++m_nextOutput;
+    }
+  }
+
+
+  bool AlchemyProfile::serve()
   {
+    if (!m_cacheFile.empty() && !readCache())
+    {
+      return false;
+    }
+    m_cacheWriteTime = ::time(0);
+
+    UnixSocket server;
+    if (!server.listen(m_socketFile, getContext()))
+    {
+      return false;
+    }
+
     getContext() << Context::PRIORITY_info
-                 << "Processing " << symbol << "..."
+                 << "Serving " << m_profiles.size() << " profile(s) on '"
+                 << m_socketFile << "'"
                  << Context::endl;
 
-    RangeDataPtr stockData;
+    // one client is served at a time; each request already uses every
+    // worker, and a client may send any number of requests
+    bool ok = true;
+    bool stop = false;
+    while (!stop)
+    {
+      UnixSocket connection;
+      if (!server.accept(connection, getContext()))
+      {
+        // a client that gave up is no reason to stop serving, and neither
+        // is running out of descriptors or memory for a moment; those are
+        // given a second to be released
+        int acceptErrno = errno;
+        if ((acceptErrno == ECONNABORTED) || (acceptErrno == EPROTO))
+        {
+          continue;
+        }
+        else if ((acceptErrno == EMFILE) || (acceptErrno == ENFILE)
+                 || (acceptErrno == ENOBUFS) || (acceptErrno == ENOMEM))
+        {
+          ::sleep(1);
+          continue;
+        }
+
+        ok = false;
+        break;
+      }
+
+      std::string request;
+      std::string reply;
+      while (!stop && connection.readMessage(request, getContext()))
+      {
+        processRequest(request, reply, stop);
+
+        // the client would only see the connection fail
+        if (reply.size() > UnixSocket::s_maxMessageSize)
+        {
+          std::ostringstream oss;
+          oss << "error Reply of " << reply.size() << " bytes is larger "
+              << "than the limit of " << UnixSocket::s_maxMessageSize
+              << "; score fewer symbols or profiles\n";
+          reply = oss.str();
+        }
+
+        bool sent = connection.writeMessage(reply, getContext());
+
+        // the client doesn't wait for the cache
+        writeCacheIfDue();
+
+        if (!sent)
+        {
+          break;
+        }
+      }
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Stopped serving on '" << m_socketFile << "'"
+                 << Context::endl;
 
-    if (!retrieveData(symbol, stockData))
+    // the updates of this session are kept however serving ended
+    if (!m_cacheFile.empty() && !writeCache())
+    {
+      return false;
+    }
+
+    return ok;
+  }
+
+
+  void AlchemyProfile::processRequest(const std::string& request,
+                                      std::string& reply,
+                                      bool& stop)
+  {
+    typedef boost::tokenizer<boost::escaped_list_separator<char> > tokenizer;
+
+    getContext() << Context::PRIORITY_debug1
+                 << "Request: " << request
+                 << Context::endl;
+
+    std::istringstream iss(request);
+    std::string command;
+    iss >> command;
+
+    std::ostringstream oss;
+    if (command == "score")
+    {
+      std::string symbols;
+      std::string profiles;
+      iss >> symbols >> profiles;
+
+      VecStockID symbolList;
+      tokenizer symbolTok(symbols);
+      tokenizer::iterator iter;
+      for (iter = symbolTok.begin(); iter != symbolTok.end(); ++iter)
+      {
+        if (!iter->empty())
+        {
+          symbolList.push_back(StockID(*iter));
+        }
+      }
+
+      if (symbolList.empty())
+      {
+        reply = "error No symbols to score\n";
+        return;
+      }
+
+      // all profiles are used unless some are named
+      m_profileSelected.assign(m_profiles.size(), profiles.empty());
+      tokenizer profileTok(profiles);
+      for (iter = profileTok.begin(); iter != profileTok.end(); ++iter)
+      {
+        std::vector<std::string>::const_iterator name =
+          std::find(m_profileNames.begin(), m_profileNames.end(), *iter);
+        if (name == m_profileNames.end())
+        {
+          reply = "error Unknown profile '" + *iter + "'\n";
+          return;
+        }
+
+        m_profileSelected[name - m_profileNames.begin()] = true;
+      }
+
+      oss << "ok\n";
+      printHeader(oss);
+      scoreSymbols(symbolList, oss);
+    }
+    else if (command == "reload")
+    {
+      int numProfiles = 0;
+      int numSymbols = 0;
+      if (reload(numProfiles, numSymbols))
+      {
+        oss << "ok\n"
+            << "Reloaded " << numProfiles << " profile(s); dropped "
+            << numSymbols << " symbol(s)\n";
+      }
+      else
+      {
+        oss << "error Failed to reload profiles; the old ones are kept\n";
+      }
+    }
+    else if (command == "stop")
+    {
+      oss << "ok\n";
+      stop = true;
+    }
+    else
+    {
+      oss << "error Unknown command '" << command << "'\n";
+    }
+
+    reply = oss.str();
+  }
+
+
+  bool AlchemyProfile::reload(int& numProfiles, int& numSymbols)
+  {
+    numProfiles = 0;
+    numSymbols = 0;
+
+    // symbols whose data changed are read again when they are next scored
+    std::string dataDir(PathRegistry::getDataDir());
+    std::map<std::string, SymbolDataPtr>::iterator iter =
+      m_symbolData.begin();
+    while (iter != m_symbolData.end())
+    {
+      std::string file(FileStockDataSource::getSymbolFile(dataDir,
+                                                          iter->first));
+      if (getModificationTime(file) != iter->second->modified)
+      {
+        m_symbolData.erase(iter++);
+        ++numSymbols;
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+
+    if (getProfileTime() == m_profileTime)
+    {
+      return true;
+    }
+
+    // keep the profiles in use until the new ones are all loaded
+    ProfileState saved;
+    swapProfiles(saved);
+    std::time_t profileTime = m_profileTime;
+    if (!loadProfiles())
+    {
+      swapProfiles(saved);
+      m_profileSelected.assign(m_profiles.size(), true);
+      m_profileTime = profileTime;
+      return false;
+    }
+
+    numProfiles = m_profiles.size();
+
+    getContext() << Context::PRIORITY_info
+                 << "Reloaded " << numProfiles << " profile(s)"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  std::time_t AlchemyProfile::getProfileTime() const
+  {
+    if (!m_libraryFile.empty())
+    {
+      return getModificationTime(m_libraryFile);
+    }
+
+    typedef boost::tokenizer<boost::escaped_list_separator<char> > tokenizer;
+    tokenizer tok(m_profileList);
+
+    std::time_t newest = 0;
+    tokenizer::iterator end = tok.end();
+    tokenizer::iterator iter;
+    for (iter = tok.begin(); iter != end; ++iter)
+    {
+      newest = std::max(newest, getModificationTime(
+                          ProfileIO::getNeuralNetFileName(iter->c_str())));
+      newest = std::max(newest, getModificationTime(
+                          ProfileIO::getMetaDataFileName(iter->c_str())));
+    }
+
+    return newest;
+  }
+
+
+  bool AlchemyProfile::loadProfiles()
+  {
+    // the time is taken first so that a change while loading is picked up
+    // by the next reload
+    m_profileTime = getProfileTime();
+
+    if (!m_libraryFile.empty())
+    {
+      if (!initializeLibraryProfiles(m_libraryFile, m_profileList))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed to process profile library"
+                     << Context::endl;
+        return false;
+      }
+    }
+    else if (!initializeProfiles(m_profileList))
     {
       getContext() << Context::PRIORITY_error
-                   << "Data retrieval failed for symbol '" << symbol << "'"
+                   << "Failed to process profile list"
                    << Context::endl;
       return false;
     }
 
-    assert(stockData.get());
-    assert(stockData->size());
+    m_profileSelected.assign(m_profiles.size(), true);
+    return true;
+  }
 
-    // switch to using adjusted data
-    stockData->useAdjusted();
 
-    // calculate neural net dataset
-    DatasetGeneratorBasic generator(getContext());
-    NNetDataset dataset;
-    if (!generator.generateInputs(stockData, dataset))
+  void AlchemyProfile::swapProfiles(ProfileState& state)
+  {
+    m_profiles.swap(state.profiles);
+    m_profileNames.swap(state.names);
+    m_evaluators.swap(state.evaluators);
+    std::swap(m_neuralNets, state.neuralNets);
+    std::swap(m_floatNeuralNets, state.floatNeuralNets);
+    std::swap(m_fastNeuralNets, state.fastNeuralNets);
+    m_cacheKeys.swap(state.cacheKeys);
+  }
+
+
+  bool AlchemyProfile::readCache()
+  {
+    std::ifstream ifs(m_cacheFile.c_str());
+    if (!ifs)
+    {
+      getContext() << Context::PRIORITY_info
+                   << "No prediction cache in '" << m_cacheFile
+                   << "'; scoring all days"
+                   << Context::endl;
+      return true;
+    }
+
+    if (!m_cache.read(ifs, getContext()))
     {
       getContext() << Context::PRIORITY_error
-                   << "Failed to generate neural network dataset for '"
-                   << symbol << "'"
+                   << "Failed to read prediction cache '" << m_cacheFile
+                   << "'"
                    << Context::endl;
       return false;
     }
-    else if (!dataset.size())
+
+    getContext() << Context::PRIORITY_info
+                 << "Read " << m_cache.size() << " entries from prediction "
+                 << "cache '" << m_cacheFile << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyProfile::writeCache()
+  {
+    // write a new file and rename it over the old one, so that a failed
+    // run leaves the old cache intact
+    std::string tempName(m_cacheFile + ".tmp");
+    bool ok;
+    {
+      std::ofstream ofs(tempName.c_str());
+      ok = (ofs && m_cache.write(ofs));
+      ofs.close();
+      ok = (ok && ofs);
+    }
+
+    if (!ok || (::rename(tempName.c_str(), m_cacheFile.c_str()) == -1))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to write prediction cache '" << m_cacheFile
+                   << "': " << strerror(errno)
+                   << Context::endl;
+      ::remove(tempName.c_str());
+      return false;
+    }
+
+    m_numCacheUpdates = 0;
+    m_cacheWriteTime = ::time(0);
+    return true;
+  }
+
+
+  void AlchemyProfile::writeCacheIfDue()
+  {
+    // the whole file is rewritten each time, so updates are collected for
+    // a while; a server that is killed loses no more than that
+    if (m_cacheFile.empty() || !m_numCacheUpdates
+        || (::time(0) - m_cacheWriteTime < cacheWriteInterval))
+    {
+      return;
+    }
+
+    if (!writeCache())
     {
       getContext() << Context::PRIORITY_warning
-                   << "Empty neural network dataset for '"
-                   << symbol << "'"
+                   << "Failed to write prediction cache; continuing"
+                   << Context::endl;
+    }
+  }
+
+
+  bool AlchemyProfile::printHeader(std::ostream& os)
+  {
+    os << "Symbol,Price,Profile,NumberDays,Ratio,FuturePrice,OverallError,"
+       << "Correlation\n";
+    return os;
+  }
+
+
+  bool AlchemyProfile::processSymbol(const StockID& symbol,
+                                     Worker& worker,
+                                     std::ostream& os)
+  {
+    worker.context << Context::PRIORITY_info
+                   << "Processing " << symbol << "..."
                    << Context::endl;
+
+    SymbolDataPtr data;
+    if (!getSymbolData(symbol, worker, data))
+    {
+      return false;
+    }
+
+    RangeDataPtr stockData(data->stockData);
+    const NNetDataset& dataset(data->dataset);
+    if (!dataset.size())
+    {
+      worker.context << Context::PRIORITY_warning
+                     << "Empty neural network dataset for '"
+                     << symbol << "'"
+                     << Context::endl;
       return true;
     }
 
+    // every profile is scored from the first point any of them needs, so
+    // that all of them can be run over the same rows of the dataset
+    int numProfiles = int(m_profiles.size());
+    int datasetSize = int(dataset.size());
+    int firstIdx = datasetSize - 1;
+    worker.stats.resize(numProfiles);
+    worker.firstIdx.resize(numProfiles);
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      if (!m_profileSelected[i])
+      {
+        continue;
+      }
+
+      worker.firstIdx[i] = findCachedStatistics(symbol, stockData,
+                                                datasetSize, i, worker,
+                                                worker.stats[i]);
+      firstIdx = std::min(firstIdx, worker.firstIdx[i]);
+    }
+
+    predictProfiles(dataset, firstIdx, worker);
+
     // for each profile we must add to this CSV line
-    std::vector<PredictionProfile>::const_iterator end = m_profiles.end();
-    std::vector<PredictionProfile>::const_iterator iter;
-    for (iter = m_profiles.begin(); iter != end; ++iter)
+    for (int i = 0; i < numProfiles; ++i)
     {
-      if (!processSymbolProfile(symbol, stockData, dataset, *iter, os))
+      if (!m_profileSelected[i])
       {
-        getContext() << Context::PRIORITY_error
-                     << "Failed to process profile '" << iter->getName()
-                     << "' for symbol '" << symbol << "'"
-                     << Context::endl;
+        continue;
+      }
+
+      if (!processSymbolProfile(symbol, stockData, datasetSize, i, firstIdx,
+                                worker, os))
+      {
+        worker.context << Context::PRIORITY_error
+                       << "Failed to process profile '"
+                       << m_profiles[i].getName()
+                       << "' for symbol '" << symbol << "'"
+                       << Context::endl;
         return false;
       }
     }
@@ -409,14 +1148,220 @@ namespace alch {
         return false;
       }
 
+      if (!addProfile(*iter, profile))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  bool AlchemyProfile::initializeLibraryProfiles(
+    const std::string& libraryFile,
+    const std::string& profileList)
+  {
+    // the library is only mapped while the profiles are copied out of it;
+    // nothing but the index is read for profiles that aren't used
+    ProfileLibrary library;
+    if (!library.open(libraryFile, getContext()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to open profile library '" << libraryFile << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    std::vector<int> indexes;
+    if (profileList.empty())
+    {
+      for (int i = 0; i < library.size(); ++i)
+      {
+        indexes.push_back(i);
+      }
+    }
+    else
+    {
+      typedef boost::tokenizer<boost::escaped_list_separator<char> >
+        tokenizer;
+      tokenizer tok(profileList);
+
+      tokenizer::iterator end = tok.end();
+      tokenizer::iterator iter;
+      for (iter = tok.begin(); iter != end; ++iter)
+      {
+        int index = library.find(*iter);
+        if (index < 0)
+        {
+          getContext() << Context::PRIORITY_error
+                       << "Prediction profile '" << *iter
+                       << "' is not in profile library '" << libraryFile
+                       << "'"
+                       << Context::endl;
+          return false;
+        }
+
+        indexes.push_back(index);
+      }
+    }
+
+    for (int i = 0; i < int(indexes.size()); ++i)
+    {
       getContext() << Context::PRIORITY_debug1
-                   << "-- Name: " << profile.getName()
+                   << "Loading prediction profile '"
+                   << library.getName(indexes[i]) << "' from library"
                    << Context::endl;
+
+      PredictionProfile profile;
+      library.read(indexes[i], profile);
+      if (!addProfile(library.getName(indexes[i]), profile))
+      {
+        return false;
+      }
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Using " << indexes.size() << " profile(s) from '"
+                 << libraryFile << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyProfile::addProfile(const std::string& name,
+                                  const PredictionProfile& profile)
+  {
+    // the profiles are all run over the same dataset
+    const NeuralNet& neuralNet = profile.getNeuralNet();
+    int numInputs = neuralNet.getNumInputUnits();
+    if (!m_profiles.empty()
+        && (numInputs != m_profiles.front().getNeuralNet().getNumInputUnits()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Prediction profile '" << profile.getName()
+                   << "' has " << numInputs << " inputs, unlike the "
+                   << "profiles before it"
+                   << Context::endl;
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_debug1
+                 << "-- Name: " << profile.getName()
+                 << Context::endl;
+    getContext() << Context::PRIORITY_debug1
+                 << "-- Number of Days: " << profile.getNumberDays()
+                 << Context::endl;
+
+    const CompiledProfile::Evaluator* evaluator =
+      CompiledProfile::find(profile);
+    if (evaluator)
+    {
       getContext() << Context::PRIORITY_debug1
-                   << "-- Number of Days: " << profile.getNumberDays()
+                   << "-- Using compiled evaluator"
                    << Context::endl;
+    }
+
+    if (m_profiles.empty())
+    {
+      m_neuralNets = NeuralNetGroup<NeuralNet>(numInputs);
+      m_floatNeuralNets = NeuralNetGroup<FloatNeuralNet>(numInputs);
+      m_fastNeuralNets = NeuralNetGroup<FastTanhNeuralNet>(numInputs);
+    }
+
+    // networks of the other types are converted once here and then
+    // shared by the threads
+    int column = m_profiles.size();
+    char type = 'c';
+    if (!evaluator)
+    {
+      if (profile.getPrecision() == PredictionProfile::PRECISION_float)
+      {
+        m_floatNeuralNets.add(FloatNeuralNet(neuralNet), column);
+        type = 'f';
+      }
+      else if (m_fastTanh)
+      {
+        m_fastNeuralNets.add(FastTanhNeuralNet(neuralNet), column);
+        type = 't';
+      }
+      else
+      {
+        m_neuralNets.add(neuralNet, column);
+        type = 'd';
+      }
+    }
+
+    // the cache key changes whenever the predictions would: the 64-bit
+    // digest covers the network and precision, and the last letter says
+    // which of the network types above scores the profile
+    std::ostringstream cacheKey;
+    cacheKey << std::hex << CompiledProfile::digest(profile) << std::dec
+             << ':' << profile.getNumberDays()
+             << ':' << type;
+
+    m_profiles.push_back(profile);
+    m_profileNames.push_back(name);
+    m_evaluators.push_back(evaluator);
+    m_cacheKeys.push_back(cacheKey.str());
+    return true;
+  }
+
+
+  bool AlchemyProfile::getSymbolData(const StockID& symbol,
+                                     Worker& worker,
+                                     SymbolDataPtr& data)
+  {
+    if (!m_socketFile.empty())
+    {
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      std::map<std::string, SymbolDataPtr>::const_iterator iter =
+        m_symbolData.find(symbol.getSymbol());
+      if (iter != m_symbolData.end())
+      {
+        data = iter->second;
+        return true;
+      }
+    }
+
+    // the time is taken first so that a change while reading is picked
+    // up by the next reload
+    boost::shared_ptr<SymbolData> newData(new SymbolData);
+    newData->modified = getModificationTime(
+      FileStockDataSource::getSymbolFile(PathRegistry::getDataDir(),
+                                         symbol.getSymbol()));
+
+    if (!retrieveData(symbol, newData->stockData, worker.context))
+    {
+      worker.context << Context::PRIORITY_error
+                     << "Data retrieval failed for symbol '" << symbol << "'"
+                     << Context::endl;
+      return false;
+    }
+
+    assert(newData->stockData.get());
+    assert(newData->stockData->size());
+
+    // switch to using adjusted data
+    newData->stockData->useAdjusted();
 
-      m_profiles.push_back(profile);
+    // calculate neural net dataset
+    if (!worker.generator.generateInputs(newData->stockData,
+                                         newData->dataset))
+    {
+      worker.context << Context::PRIORITY_error
+                     << "Failed to generate neural network dataset for '"
+                     << symbol << "'"
+                     << Context::endl;
+      return false;
+    }
+
+    data = newData;
+    if (!m_socketFile.empty())
+    {
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      m_symbolData[symbol.getSymbol()] = data;
     }
 
     return true;
@@ -424,9 +1369,10 @@ namespace alch {
 
 
   bool AlchemyProfile::retrieveData(const StockID& symbol,
-                                    RangeDataPtr& stockData)
+                                    RangeDataPtr& stockData,
+                                    Context& ctx)
   {
-    StockDataRetriever retriever(PathRegistry::getDataDir(), getContext());
+    StockDataRetriever retriever(PathRegistry::getDataDir(), ctx);
     stockData = RangeDataPtr(new RangeData);
 
     // we want to retrieve *all* data for this stock so that we can compute
@@ -437,59 +1383,174 @@ namespace alch {
 
     if (!retriever.retrieve(symbol, dataStartTime, dataEndTime, *stockData))
     {
-      getContext() << Context::PRIORITY_error
-                   << "Failed to retrieve data for " << symbol
-                   << Context::endl;
+      ctx << Context::PRIORITY_error
+          << "Failed to retrieve data for " << symbol
+          << Context::endl;
       return false;
     }
     else if (!stockData->size())
     {
-      getContext() << Context::PRIORITY_error
-                   << "No data returned for " << symbol
-                   << Context::endl;
+      ctx << Context::PRIORITY_error
+          << "No data returned for " << symbol
+          << Context::endl;
       return false;
     }
 
-    getContext() << Context::PRIORITY_debug1
-                 << "Retrieved " << stockData->size() << " data records"
-                 << Context::endl;
+    ctx << Context::PRIORITY_debug1
+        << "Retrieved " << stockData->size() << " data records"
+        << Context::endl;
 
     return true;
   }
 
 
+  int AlchemyProfile::findCachedStatistics(const StockID& symbol,
+                                           RangeDataPtr rangeData,
+                                           int datasetSize,
+                                           int profileIdx,
+                                           Worker& worker,
+                                           RunningStatistics& stats)
+  {
+    stats = RunningStatistics();
+    if (m_cacheFile.empty())
+    {
+      return 0;
+    }
+
+    const PredictionProfile& profile = m_profiles[profileIdx];
+    int numRangeDataPoints = int(rangeData->size());
+    int startIdx = (numRangeDataPoints
+                    - datasetSize
+                    + profile.getNumberDays());
+
+    // number of dataset points whose future close is known
+    int numDays = numRangeDataPoints - startIdx;
+
+    std::string cacheKey(symbol.getSymbol() + ':' + m_cacheKeys[profileIdx]);
+
+    PredictionCache::Entry entry;
+    bool found = false;
+    {
+      boost::mutex::scoped_lock lock(m_symbolMutex);
+      found = m_cache.find(cacheKey, entry);
+    }
+
+    // pick up the statistics of the days scored by earlier runs, unless
+    // the history has changed since, e.g. by a split adjusting the closes
+    int lastIdx = entry.stats.size() - 1;
+    if (found && (lastIdx >= 0) && (lastIdx < numDays)
+        && (rangeData->get(startIdx + lastIdx).tradeTime == entry.lastTime)
+        && (rangeData->get(startIdx + lastIdx).close == entry.lastClose))
+    {
+      stats = entry.stats;
+      return (lastIdx + 1);
+    }
+    else if (found)
+    {
+      worker.context << Context::PRIORITY_debug1
+                     << "History of '" << symbol << "' changed since it "
+                     << "was cached; scoring all days of profile '"
+                     << profile.getName() << "'"
+                     << Context::endl;
+    }
+
+    return 0;
+  }
+
+
+  void AlchemyProfile::predictProfiles(const NNetDataset& nnetDataset,
+                                       int firstIdx,
+                                       Worker& worker)
+  {
+    int numProfiles = int(m_profiles.size());
+    int numPoints = int(nnetDataset.size()) - firstIdx;
+    int numInputs = nnetDataset.getNumInputs();
+    assert(numPoints >= 1);
+    if (!numProfiles)
+    {
+      return;
+    }
+
+    // every profile reads the inputs straight from the dataset and writes
+    // its predictions to its own column
+    const double* inputs = nnetDataset.getInput(firstIdx);
+    worker.predictions.resize(std::size_t(numPoints) * numProfiles);
+    double* predictions = &worker.predictions[0];
+
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const CompiledProfile::Evaluator* evaluator = m_evaluators[i];
+      if (!evaluator)
+      {
+        continue;
+      }
+
+      assert(numInputs == evaluator->numInputUnits);
+      worker.evaluatorOutput.resize(evaluator->numOutputUnits);
+      for (int idx = 0; idx < numPoints; ++idx)
+      {
+        evaluator->predict(inputs + std::size_t(idx) * numInputs,
+                           &worker.evaluatorOutput[0]);
+        predictions[std::size_t(idx) * numProfiles + i] =
+          worker.evaluatorOutput[0];
+      }
+    }
+
+    // the networks of each type are run together, so that networks with
+    // the same layers share one pass over the inputs of each batch.
+    // Profiles trained in float are scored in float too so the
+    // predictions match those seen while training.
+    if (m_neuralNets.size())
+    {
+      m_neuralNets.propagate(inputs, numPoints, numInputs, worker.workspace,
+                             predictions, numProfiles);
+    }
+    if (m_floatNeuralNets.size())
+    {
+      m_floatNeuralNets.propagate(inputs, numPoints, numInputs,
+                                  worker.floatWorkspace,
+                                  predictions, numProfiles);
+    }
+    if (m_fastNeuralNets.size())
+    {
+      m_fastNeuralNets.propagate(inputs, numPoints, numInputs,
+                                 worker.fastWorkspace,
+                                 predictions, numProfiles);
+    }
+  }
+
+
   bool AlchemyProfile::processSymbolProfile(const StockID& symbol,
                                             RangeDataPtr rangeData,
-                                            const NNetDataset& nnetDataset,
-                                            const PredictionProfile& profile,
+                                            int datasetSize,
+                                            int profileIdx,
+                                            int firstIdx,
+                                            Worker& worker,
                                             std::ostream& os)
   {
-    NNetDataset dataset = nnetDataset;
-    int datasetSize = int(dataset.size());
+    const PredictionProfile& profile = m_profiles[profileIdx];
     assert(datasetSize >= 1);
-    NeuralNet neuralNet = profile.getNeuralNet();
     int numRangeDataPoints = int(rangeData->size());
     int startIdx = (numRangeDataPoints
                     - datasetSize
                     + profile.getNumberDays());
 
-    // propagate all the inputs for the dataset we have.. this gives us
-    // the predictions for rangeData.
-    NeuralNetAlg::calculateOutputs(neuralNet, dataset);
+    // number of dataset points whose future close is known
+    int numDays = numRangeDataPoints - startIdx;
 
-    std::vector<double> predictions;
-    std::vector<double> actuals;
+    // predictions of this profile from firstIdx on
+    int numProfiles = int(m_profiles.size());
+    const double* predictions = &worker.predictions[profileIdx];
 
-    predictions.reserve(dataset.size());
-    actuals.reserve(dataset.size());
+    RunningStatistics& stats = worker.stats[profileIdx];
 
-    // fill in predictions and actuals arrays
-    for (int idx = 0; idx + startIdx < numRangeDataPoints; ++idx)
+    // add the new predictions and actuals to the statistics
+    for (int idx = worker.firstIdx[profileIdx]; idx < numDays; ++idx)
     {
+      assert(idx >= firstIdx);
       assert(idx < datasetSize);
-      assert(dataset[idx].output.size());
 
-      double ratio = dataset[idx].output[0];
+      double ratio = predictions[std::size_t(idx - firstIdx) * numProfiles];
 
       int rangeIdx = startIdx + idx;
 
@@ -504,36 +1565,48 @@ namespace alch {
       double actualClose = futurePoint.close;
         
       
-      getContext() << Context::PRIORITY_debug2
-                   << "Current: "
-                   << boost::posix_time::to_simple_string(
-                     referencePoint.tradeTime)
-                   << "  Close: " << referenceClose
-                   << Context::endl;
+      worker.context << Context::PRIORITY_debug2
+                     << "Current: "
+                     << boost::posix_time::to_simple_string(
+                       referencePoint.tradeTime)
+                     << "  Close: " << referenceClose
+                     << Context::endl;
       
-      getContext() << Context::PRIORITY_debug2
-                   << "Future: "
-                   << boost::posix_time::to_simple_string(
-                     futurePoint.tradeTime)
-                   << "  Ratio: " << ratio
-                   << "  Predict: " << predictedClose
-                   << "  Actual: " << actualClose
-                   << Context::endl;
+      worker.context << Context::PRIORITY_debug2
+                     << "Future: "
+                     << boost::posix_time::to_simple_string(
+                       futurePoint.tradeTime)
+                     << "  Ratio: " << ratio
+                     << "  Predict: " << predictedClose
+                     << "  Actual: " << actualClose
+                     << Context::endl;
 
 
-      predictions.push_back(predictedClose);
-      actuals.push_back(actualClose);
+      stats.add(predictedClose, actualClose);
     }
 
-    assert(predictions.size() == actuals.size());
-    assert(int(predictions.size()) == (datasetSize - profile.getNumberDays()));
-    double error = NeuralNetAlg::squaredError(&predictions[0], &actuals[0],
-                                              int(predictions.size()));
-    double correl = Statistics::correlation(&predictions[0], &actuals[0],
-                                            int(predictions.size()));
+    assert(stats.size() == (datasetSize - profile.getNumberDays()));
+    double error = stats.getSquaredError();
+    double correl = stats.getCorrelation();
+
+    if (!m_cacheFile.empty() && (numDays > 0))
+    {
+      std::string cacheKey(symbol.getSymbol() + ':'
+                           + m_cacheKeys[profileIdx]);
+
+      const RangeData::Point& lastPoint(
+        rangeData->get(numRangeDataPoints - 1));
+
+      PredictionCache::Entry entry;
+      entry.lastTime = lastPoint.tradeTime;
+      entry.lastClose = lastPoint.close;
+      entry.stats = stats;
+      worker.cacheUpdates.push_back(std::make_pair(cacheKey, entry));
+    }
 
     double currValue = rangeData->get(numRangeDataPoints - 1).close;
-    double predictRatio = dataset[datasetSize - 1].output[0];
+    double predictRatio =
+      predictions[std::size_t(datasetSize - 1 - firstIdx) * numProfiles];
     double predictValue = currValue * (1.0 + predictRatio);
 
 
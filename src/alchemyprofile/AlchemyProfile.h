@@ -7,11 +7,22 @@
 #include "stockdata/StockID.h"
 #include "stockdata/RangeData.h"
 #include "stocknnet/PredictionProfile.h"
+#include "stocknnet/CompiledProfile.h"
+#include "stocknnet/PredictionCache.h"
 #include "nnet/NNetDataset.h"
+#include "nnet/NeuralNet.h"
+#include "nnet/NeuralNetGroup.h"
+
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/shared_ptr.hpp"
 
 #include <vector>
+#include <map>
 #include <string>
 #include <ostream>
+#include <ctime>
 
 namespace alch {
 
@@ -60,10 +71,169 @@ namespace alch {
     static const char* const s_optionSymbol;
     static const char* const s_optionOutput;
     static const char* const s_optionProfile;
+    static const char* const s_optionFastTanh;
+    static const char* const s_optionLibrary;
+    static const char* const s_optionJobs;
+    static const char* const s_optionCache;
+    static const char* const s_optionServe;
+
+    //! Per-thread state for scoring symbols; defined in AlchemyProfile.cpp
+    class Worker;
+
+    //! Output of one symbol, held until the symbols before it are written
+    struct SymbolResult
+    {
+      SymbolResult()
+        : done(false)
+        , text()
+        , messages()
+      {
+        ;
+      }
+
+      //! Whether the symbol has been processed
+      bool done;
+
+      //! CSV lines for the symbol
+      std::string text;
+
+      //! Messages logged while processing the symbol
+      Context::MessageVec messages;
+    };
+
+    //! Market data of a symbol, kept between requests when serving
+    struct SymbolData
+    {
+      SymbolData()
+        : stockData()
+        , dataset()
+        , modified(0)
+      {
+        ;
+      }
+
+      //! The adjusted history of the symbol
+      RangeDataPtr stockData;
+
+      //! Neural network dataset generated from stockData
+      NNetDataset dataset;
+
+      //! Modification time of the data file when it was read
+      std::time_t modified;
+    };
+
+    //! Shared pointer to SymbolData; the data isn't changed once loaded
+    typedef boost::shared_ptr<const SymbolData> SymbolDataPtr;
+
+    //! The profiles in use and everything derived from them
+    struct ProfileState
+    {
+      std::vector<PredictionProfile> profiles;
+      std::vector<std::string> names;
+      std::vector<const CompiledProfile::Evaluator*> evaluators;
+      NeuralNetGroup<NeuralNet> neuralNets;
+      NeuralNetGroup<FloatNeuralNet> floatNeuralNets;
+      NeuralNetGroup<FastTanhNeuralNet> fastNeuralNets;
+      std::vector<std::string> cacheKeys;
+    };
 
     std::string m_outputFile;
+    bool m_fastTanh;
+    int m_numJobs;
+
+    //! File the prediction cache is kept in, or empty if none
+    std::string m_cacheFile;
+
+    //! Socket to serve requests on, or empty to score the symbol list
+    //! once and exit
+    std::string m_socketFile;
+
+    //! Profile library and profile list the profiles are loaded from
+    std::string m_libraryFile;
+    std::string m_profileList;
+
+    //! Newest modification time of the profile files when they were loaded
+    std::time_t m_profileTime;
+
+    //! Statistics of earlier runs; guarded by m_symbolMutex while scoring
+    PredictionCache m_cache;
+
+    //! Entries set in m_cache since it was last written; guarded by
+    //! m_symbolMutex while scoring
+    int m_numCacheUpdates;
+
+    //! When m_cacheFile was last written or read
+    std::time_t m_cacheWriteTime;
     std::vector<PredictionProfile> m_profiles;
 
+    //! Name each profile in m_profiles was loaded under: its base name or
+    //! its name in the profile library
+    std::vector<std::string> m_profileNames;
+
+    //! Whether each profile in m_profiles is written to the output of the
+    //! symbols being scored
+    std::vector<bool> m_profileSelected;
+
+    //! Compiled evaluator for each profile in m_profiles, or 0 if none
+    std::vector<const CompiledProfile::Evaluator*> m_evaluators;
+
+    //! The networks of the profiles in m_profiles without an evaluator,
+    //! by the type they are scored with: single precision for float
+    //! profiles, fast tanh for double profiles with --fasttanh. Each
+    //! network writes to the column of its profile in
+    //! Worker::predictions.
+    NeuralNetGroup<NeuralNet> m_neuralNets;
+    NeuralNetGroup<FloatNeuralNet> m_floatNeuralNets;
+    NeuralNetGroup<FastTanhNeuralNet> m_fastNeuralNets;
+
+    //! Identifies each profile in m_profiles and how it is scored, for
+    //! the keys of m_cache
+    std::vector<std::string> m_cacheKeys;
+
+    //! Guards the symbol queue, m_symbolResults and the main context
+    boost::mutex m_symbolMutex;
+
+    //! Index of the next symbol for a worker to take
+    int m_nextSymbol;
+
+    //! Index of the next symbol to write to the output file
+    int m_nextOutput;
+
+    //! Results of symbols that can't be written yet, indexed by symbol
+    std::vector<SymbolResult> m_symbolResults;
+
+    //! State of each scoring thread, kept between requests
+    std::vector<boost::shared_ptr<Worker> > m_workers;
+
+    //! Threads running m_workers[1..m_numJobs - 1]; started by the first
+    //! scoreSymbols() and kept until stopThreads()
+    boost::thread_group m_threads;
+
+    //! Signaled, with m_symbolMutex, when the threads get a new symbol
+    //! list or are asked to stop
+    boost::condition m_startCondition;
+
+    //! Signaled, with m_symbolMutex, when the last thread finishes its
+    //! symbols
+    boost::condition m_doneCondition;
+
+    //! Number of symbol lists handed to the threads so far
+    int m_numRequests;
+
+    //! Number of threads still processing the current symbol list
+    int m_numRunning;
+
+    //! Whether the threads should exit
+    bool m_stopThreads;
+
+    //! Symbol list and output of the current scoreSymbols() call
+    const VecStockID* m_requestSymbols;
+    std::ostream* m_requestOutput;
+
+    //! Data of the symbols scored so far, by symbol, when serving;
+    //! guarded by m_symbolMutex
+    std::map<std::string, SymbolDataPtr> m_symbolData;
+
 
     /*!
       \brief Reads in specified list file
@@ -109,6 +279,125 @@ namespace alch {
   bool processSymbolList(const VecStockID& symbolList);
 
 
+  /*!
+    \brief Scores symbols with the selected profiles using every worker
+    \param symbolList The symbols to score
+    \param os Output stream for the CSV lines
+  */
+  void scoreSymbols(const VecStockID& symbolList, std::ostream& os);
+
+  /*!
+    \brief Runs a scoring thread until stopThreads()
+    \param job Index of the thread's worker in m_workers
+
+    Processes each symbol list scoreSymbols() hands out with the
+    worker.
+  */
+  void runThread(int job);
+
+  //! Stops and joins the scoring threads
+  void stopThreads();
+
+
+  /*!
+    \brief Processes symbols from symbolList until none are left
+    \param symbolList The symbols to process
+    \param worker State of the calling thread
+    \param os Output stream for the CSV lines
+
+    Run by each worker thread. Results are written in symbolList order
+    whichever thread finishes them, so the output matches that of a
+    single thread.
+  */
+  void processSymbols(const VecStockID& symbolList,
+                      Worker& worker,
+                      std::ostream& os);
+
+  /*!
+    \brief Stores the result of a symbol and writes every result that is
+    next in order
+    \param index Index of the symbol in the symbol list
+    \param text CSV lines for the symbol
+    \param worker The worker that processed the symbol; its messages and
+    cache updates are taken over
+    \param os Output stream for the CSV lines
+  */
+  void finishSymbol(int index,
+                    const std::string& text,
+                    Worker& worker,
+                    std::ostream& os);
+
+  /*!
+    \brief Answers requests on m_socketFile until asked to stop
+    \retval true Success
+    \retval false Error
+  */
+  bool serve();
+
+
+  /*!
+    \brief Answers a single request
+    \param request The request message
+    \param reply [out] The reply message
+    \param stop [out] Set to true if the server should stop
+  */
+  void processRequest(const std::string& request,
+                      std::string& reply,
+                      bool& stop);
+
+
+  /*!
+    \brief Reloads the profiles if their files changed since they were
+    loaded, and drops the data of symbols whose data files changed
+    \param numProfiles [out] Number of profiles reloaded
+    \param numSymbols [out] Number of symbols dropped
+    \retval true Success
+    \retval false Error; the profiles in use are kept
+  */
+  bool reload(int& numProfiles, int& numSymbols);
+
+
+  //! Returns the newest modification time of the profile files
+  std::time_t getProfileTime() const;
+
+
+  /*!
+    \brief Loads the profiles named by m_libraryFile and m_profileList
+    \retval true Success
+    \retval false Error
+  */
+  bool loadProfiles();
+
+
+  /*!
+    \brief Exchanges the profiles in use with those in state
+    \param state The profiles to use
+  */
+  void swapProfiles(ProfileState& state);
+
+
+  /*!
+    \brief Reads m_cache from m_cacheFile, if it exists
+    \retval true Success
+    \retval false Error
+  */
+  bool readCache();
+
+  /*!
+    \brief Writes m_cache to m_cacheFile
+    \retval true Success
+    \retval false Error
+  */
+  bool writeCache();
+
+  /*!
+    \brief Writes m_cache to m_cacheFile if it has changed and was last
+    written long enough ago
+
+    A failure is only logged as a warning; the next call tries again.
+  */
+  void writeCacheIfDue();
+
   /*!
     \brief Prints CSV header to output stream
     \retval true Success
@@ -116,14 +405,29 @@ namespace alch {
   */
   bool printHeader(std::ostream& os);
 
+  /*!
+    \brief Returns the data of a symbol, from memory if it was loaded
+    before while serving
+    \param symbol The symbol
+    \param worker State of the calling thread
+    \param data [out] The data of the symbol
+    \retval true Success
+    \retval false Error
+  */
+  bool getSymbolData(const StockID& symbol,
+                     Worker& worker,
+                     SymbolDataPtr& data);
+
+
   /*!
     \brief Downloads data for the specified symbol
     \param symbol The symbol for which data will be downloaded
+    \param worker State of the calling thread
     \param os Output stream to write symbol data to
     \retval true Success
     \retval false Error
   */
-  bool processSymbol(const StockID& symbol, std::ostream& os);
+  bool processSymbol(const StockID& symbol, Worker& worker, std::ostream& os);
 
 
   /*!
@@ -133,34 +437,96 @@ namespace alch {
     \retval false Error
    */
   bool initializeProfiles(const std::string& profileList);
+
+
+  /*!
+    \brief Initializes the m_profiles data member from a profile library
+    \param libraryFile Name of the ProfileLibrary file
+    \param profileList List of profile names in the library (comma-separated);
+    empty to use every profile in the library
+    \retval true Success
+    \retval false Error
+   */
+  bool initializeLibraryProfiles(const std::string& libraryFile,
+                                 const std::string& profileList);
+
+
+  /*!
+    \brief Appends a loaded profile to m_profiles along with its evaluator
+    \param name Name the profile was loaded under
+    \param profile The profile to add
+    \retval true Success
+    \retval false Error; the profile has another number of inputs than
+    the profiles before it
+   */
+  bool addProfile(const std::string& name, const PredictionProfile& profile);
   
 
   /*!
     \brief Retrieves stock data for specified symbol
     \param symbol Symbol to retrieve data for
     \param stockData [out] Stock data to populate
+    \param ctx Context for this operation
     \retval true Success
     \retval false Error
    */
-  bool retrieveData(const StockID& symbol, RangeDataPtr& stockData);
+  bool retrieveData(const StockID& symbol,
+                    RangeDataPtr& stockData,
+                    Context& ctx);
+
+
+
+  /*!
+    \brief Looks up the statistics of a profile that earlier runs cached
+    \param symbol Symbol we're analyzing
+    \param rangeData Data associated with that symbol
+    \param datasetSize Number of points in the dataset of rangeData
+    \param profileIdx Index of the prediction profile in m_profiles
+    \param worker State of the calling thread
+    \param stats [out] Statistics of the points scored by earlier runs;
+    empty if there are none
+    \return Index of the first dataset point that must be scored
+   */
+  int findCachedStatistics(const StockID& symbol,
+                           RangeDataPtr rangeData,
+                           int datasetSize,
+                           int profileIdx,
+                           Worker& worker,
+                           RunningStatistics& stats);
 
 
+  /*!
+    \brief Predicts with every profile in m_profiles
+    \param nnetDataset The neural network dataset of the symbol
+    \param firstIdx Index of the first dataset point to predict
+    \param worker [in/out] State of the calling thread; receives the
+    predictions of the points from firstIdx on in Worker::predictions
+   */
+  void predictProfiles(const NNetDataset& nnetDataset,
+                       int firstIdx,
+                       Worker& worker);
+
 
   /*!
     \brief Processes profile for specified symbol
     \param symbol Symbol we're analyzing
     \param rangeData Data associated with that symbol
-    \param nnetdataset The neural network dataset that came from the specified
-    rangeData
-    \param profile Prediction profile to use
+    \param datasetSize Number of points in the dataset of rangeData
+    \param profileIdx Index of the prediction profile in m_profiles
+    \param firstIdx Index of the dataset point in the first row of
+    Worker::predictions
+    \param worker State of the calling thread; holds the predictions and
+    the cached statistics of the profile
     \param os [out] Output stream to write data to
     \retval true Success
     \retval false Error
    */
   bool processSymbolProfile(const StockID& symbol,
                             RangeDataPtr rangeData,
-                            const NNetDataset& nnetDataset,
-                            const PredictionProfile& profile,
+                            int datasetSize,
+                            int profileIdx,
+                            int firstIdx,
+                            Worker& worker,
                             std::ostream& os);
 };
 
@@ -0,0 +1,15 @@
+
+/*
+  Prediction profiles compiled into alchemyprofile.
+
+  Headers written by alchemycompileprofile register their evaluator when
+  included here, and alchemyprofile then scores the matching profile with
+  it instead of the generic network, e.g.
+
+    #include "alchemyprofile/compiled/profile_5day.h"
+
+  A profile that has been retrained since it was compiled no longer
+  matches and is scored with its network as usual.
+*/
+
+#include "stocknnet/CompiledProfile.h"
@@ -0,0 +1,382 @@
+#include "alchemyprofilelib/AlchemyProfileLib.h"
+
+#include "stocknnet/ProfileIO.h"
+#include "stocknnet/ProfileLibrary.h"
+
+#include "boost/filesystem/path.hpp"
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/convenience.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+
+namespace alch {
+
+  const char* const AlchemyProfileLib::s_optionLibrary = "library";
+  const char* const AlchemyProfileLib::s_optionPack = "pack";
+  const char* const AlchemyProfileLib::s_optionUnpack = "unpack";
+  const char* const AlchemyProfileLib::s_optionList = "list";
+
+  AlchemyProfileLib::AlchemyProfileLib()
+    : Framework()
+    , m_libraryFile("")
+    , m_directory("")
+    , m_mode(MODE_list)
+  {
+    ;
+  }
+
+
+  AlchemyProfileLib::~AlchemyProfileLib()
+  {
+    ;
+  }
+
+  std::string AlchemyProfileLib::getApplicationDescription() const
+  {
+    return
+      "Packs the prediction profiles in a directory into a single profile\n"
+      "library file, unpacks a library back into profile files, or lists\n"
+      "the profiles in a library. Each profile is packed under its base\n"
+      "name; pass the library to alchemyprofile with --library to score\n"
+      "with the profiles in it without reading hundreds of profile files.\n"
+      ;
+  }
+
+  bool AlchemyProfileLib::initialize()
+  {
+    return Framework::initialize();
+  }
+
+  bool AlchemyProfileLib::finalize()
+  {
+    return Framework::finalize();
+  }
+
+  Framework::OptionsReturnCode AlchemyProfileLib::processOptions(
+    int argc, char** argv)
+  {
+    getOptions().getGenericOptions().add_options()
+      (s_optionLibrary,
+       boost::program_options::value<std::string>(),
+       "Name of profile library file")
+      (s_optionPack,
+       boost::program_options::value<std::string>(),
+       "Packs the profiles in the specified directory into the library, "
+       "replacing it")
+      (s_optionUnpack,
+       boost::program_options::value<std::string>(),
+       "Writes the profiles in the library to the specified directory")
+      (s_optionList,
+       "Lists the profiles in the library")
+      ;
+
+    return Framework::processOptions(argc, argv);
+  }
+
+
+  bool AlchemyProfileLib::processApplication()
+  {
+    // process parameters passed in by user
+    if (!loadParams())
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Application failed while loading parameters"
+                   << Context::endl;
+      return false;
+    }
+    printParams();
+
+    bool ok = false;
+    switch (m_mode)
+    {
+    case MODE_pack:
+      ok = pack();
+      break;
+
+    case MODE_unpack:
+      ok = unpack();
+      break;
+
+    case MODE_list:
+      ok = list();
+      break;
+    }
+
+    if (!ok)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Application failed while processing profile library"
+                   << Context::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool AlchemyProfileLib::loadParams()
+  {
+    FrameworkOptions& options(getOptions());
+    FrameworkOptions::VariablesMap& vm = options.getVariablesMap();
+
+    // get library file name
+    if (vm.count(s_optionLibrary))
+    {
+      m_libraryFile = vm[s_optionLibrary].as<std::string>();
+    }
+    else
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Library file not specified"
+                   << Context::endl;
+      return false;
+    }
+
+    // get mode
+    int numModes = (int(vm.count(s_optionPack)) + int(vm.count(s_optionUnpack))
+                    + int(vm.count(s_optionList)));
+    if (numModes != 1)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Specify exactly one of --" << s_optionPack
+                   << ", --" << s_optionUnpack << " and --" << s_optionList
+                   << Context::endl;
+      return false;
+    }
+
+    if (vm.count(s_optionPack))
+    {
+      m_mode = MODE_pack;
+      m_directory = vm[s_optionPack].as<std::string>();
+    }
+    else if (vm.count(s_optionUnpack))
+    {
+      m_mode = MODE_unpack;
+      m_directory = vm[s_optionUnpack].as<std::string>();
+    }
+    else
+    {
+      m_mode = MODE_list;
+    }
+
+    return true;
+  }
+
+
+  void AlchemyProfileLib::printParams()
+  {
+    getContext() << Context::PRIORITY_info
+                 << "Library file: " << m_libraryFile
+                 << Context::endl;
+
+    if (m_mode != MODE_list)
+    {
+      getContext() << Context::PRIORITY_info
+                   << "Profile directory: " << m_directory
+                   << Context::endl;
+    }
+  }
+
+
+  bool AlchemyProfileLib::getProfileNames(std::vector<std::string>& names)
+  {
+    boost::filesystem::path dirPath(m_directory, boost::filesystem::native);
+
+    if (!boost::filesystem::is_directory(dirPath))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Invalid profile directory '" << dirPath.string() << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    try
+    {
+      // a profile is a .meta file with a matching .nnet file
+      boost::filesystem::directory_iterator end;
+      boost::filesystem::directory_iterator iter(dirPath);
+      for ( ; iter != end; ++iter)
+      {
+        if (!boost::filesystem::is_directory(*iter)
+            && (boost::filesystem::extension(*iter) == ".meta"))
+        {
+          std::string name(boost::filesystem::basename(iter->leaf()));
+          std::string baseName((dirPath / name).native_file_string());
+          if (ProfileIO::exists(baseName.c_str()))
+          {
+            names.push_back(name);
+          }
+        }
+      }
+    }
+    catch (boost::filesystem::filesystem_error err)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Unable to retrieve profile list from '"
+                   << dirPath.string()
+                   << "'" << Context::endl;
+      return false;
+    }
+
+    std::sort(names.begin(), names.end());
+    return true;
+  }
+
+
+  bool AlchemyProfileLib::pack()
+  {
+    std::vector<std::string> names;
+    if (!getProfileNames(names))
+    {
+      return false;
+    }
+
+    boost::filesystem::path dirPath(m_directory, boost::filesystem::native);
+    std::vector<PredictionProfile> profiles(names.size());
+    for (int i = 0; i < int(names.size()); ++i)
+    {
+      std::string baseName((dirPath / names[i]).native_file_string());
+      if (!ProfileIO::read(baseName.c_str(), profiles[i], getContext()))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed to read profile from '" << baseName << "'"
+                     << Context::endl;
+        return false;
+      }
+
+      getContext() << Context::PRIORITY_debug1
+                   << "Read profile '" << names[i] << "'"
+                   << Context::endl;
+    }
+
+    // write a new file and rename it over the old one, so that programs
+    // still mapping the old library keep a consistent copy
+    std::string tempName(m_libraryFile + ".tmp");
+    bool ok;
+    {
+      std::ofstream ofs(tempName.c_str(),
+                        std::ios::out | std::ios::binary | std::ios::trunc);
+      ok = (ofs && ProfileLibrary::write(ofs, names, profiles, getContext()));
+      ofs.close();
+      ok = (ok && ofs);
+    }
+
+    if (!ok || (::rename(tempName.c_str(), m_libraryFile.c_str()) == -1))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to write profile library '" << m_libraryFile
+                   << "': " << strerror(errno)
+                   << Context::endl;
+      ::remove(tempName.c_str());
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Packed " << names.size() << " profile(s) into '"
+                 << m_libraryFile << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyProfileLib::unpack()
+  {
+    boost::filesystem::path dirPath(m_directory, boost::filesystem::native);
+    if (!boost::filesystem::is_directory(dirPath))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Invalid profile directory '" << dirPath.string() << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    ProfileLibrary library;
+    if (!library.open(m_libraryFile, getContext()))
+    {
+      return false;
+    }
+
+    // the names become file names in the directory; refuse any that would
+    // put a file elsewhere before writing anything
+    for (int i = 0; i < library.size(); ++i)
+    {
+      std::string name(library.getName(i));
+      if (name.empty() || (name == ".") || (name == "..")
+          || (name.find('/') != std::string::npos)
+          || (name.find('\0') != std::string::npos))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Profile library '" << m_libraryFile
+                     << "' has invalid profile name '" << name << "'"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    for (int i = 0; i < library.size(); ++i)
+    {
+      PredictionProfile profile;
+      library.read(i, profile);
+
+      std::string baseName((dirPath / library.getName(i))
+                           .native_file_string());
+      if (!ProfileIO::write(baseName.c_str(), profile, getContext()))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed to write profile to '" << baseName << "'"
+                     << Context::endl;
+        return false;
+      }
+
+      getContext() << Context::PRIORITY_debug1
+                   << "Wrote profile '" << baseName << "'"
+                   << Context::endl;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Unpacked " << library.size() << " profile(s) into '"
+                 << m_directory << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyProfileLib::list()
+  {
+    ProfileLibrary library;
+    if (!library.open(m_libraryFile, getContext()))
+    {
+      return false;
+    }
+
+    // only the metadata is read; the weights are never touched
+    std::vector<int> layerSizes;
+    for (int i = 0; i < library.size(); ++i)
+    {
+      PredictionProfile profile;
+      library.readMetaData(i, profile);
+      library.getLayerSizes(i, layerSizes);
+
+      std::cout << library.getName(i) << "\t" << profile.getNumberDays()
+                << "\t" << layerSizes[0];
+      for (int layer = 1; layer < int(layerSizes.size()); ++layer)
+      {
+        std::cout << "-" << layerSizes[layer];
+      }
+      std::cout << "\t"
+                << ((profile.getPrecision()
+                     == PredictionProfile::PRECISION_float)
+                    ? "float" : "double")
+                << "\t" << profile.getName() << "\n";
+    }
+
+    return true;
+  }
+
+} // namespace alch
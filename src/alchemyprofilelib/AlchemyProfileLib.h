@@ -0,0 +1,92 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_alchemyprofilelib_AlchemyProfileLib_h
+#define INCLUDED_alchemyprofilelib_AlchemyProfileLib_h
+
+#include "afwk/Framework.h"
+
+#include <string>
+#include <vector>
+
+namespace alch {
+
+/*!
+  \brief Packs prediction profiles into a profile library and back
+  \ingroup alchemyprofilelib
+*/
+class AlchemyProfileLib : public Framework
+{
+ public:
+
+  /*!
+    \brief Constructor
+  */
+  AlchemyProfileLib();
+
+  virtual ~AlchemyProfileLib();
+
+protected:
+
+  std::string getApplicationName() const
+  {
+    return "alchemyprofilelib";
+  }
+
+  std::string getApplicationDescription() const;
+
+  std::string getApplicationVersion() const
+  {
+    return VERSIONSTRING;
+  }
+
+  virtual bool initialize();
+
+  virtual bool finalize();
+
+  virtual Framework::OptionsReturnCode processOptions(int argc, char** argv);
+
+  virtual bool processApplication();
+
+ private:
+
+  //! What the application does with the library
+  enum Mode
+  {
+    MODE_pack,
+    MODE_unpack,
+    MODE_list
+  };
+
+  static const char* const s_optionLibrary;
+  static const char* const s_optionPack;
+  static const char* const s_optionUnpack;
+  static const char* const s_optionList;
+
+  std::string m_libraryFile;
+  std::string m_directory;
+  Mode m_mode;
+
+  bool loadParams();
+  void printParams();
+
+  /*!
+    \brief Finds the prediction profiles in m_directory
+    \param names [out] Base name of each profile, without the directory
+    \retval true Success
+    \retval false Error
+  */
+  bool getProfileNames(std::vector<std::string>& names);
+
+  //! Writes the profiles in m_directory to m_libraryFile
+  bool pack();
+
+  //! Writes the profiles in m_libraryFile to m_directory
+  bool unpack();
+
+  //! Prints the profiles in m_libraryFile
+  bool list();
+};
+
+} // namespace alch
+
+#endif
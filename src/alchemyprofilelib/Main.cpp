@@ -0,0 +1,8 @@
+
+#include "alchemyprofilelib/AlchemyProfileLib.h"
+
+int main(int argc, char** argv)
+{
+  alch::AlchemyProfileLib app;
+  return app.run(argc, argv);
+}
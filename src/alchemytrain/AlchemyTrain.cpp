@@ -4,17 +4,215 @@
 
 #include "stocknnet/ProfileIO.h"
 #include "nnet/NNetDataStream.h"
+#include "nnet/NNetDataFile.h"
+#include "nnet/NNetDataReader.h"
 #include "nnet/NeuralNetAlg.h"
+#include "nnet/AdamGradDescent.h"
 #include "nnet/GradDescent.h"
+#include "nnet/MiniBatchGradDescent.h"
 #include "nnet/MomentumGradDescent.h"
+#include "nnet/RMSPropGradDescent.h"
+#include "nnet/StateIO.h"
 #include "autil/TempFile.h"
 
+#include "boost/bind.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/thread.hpp"
+
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace alch {
 
+namespace
+{
+
+  // column widths and precision of the training progress table
+  const int colWidth1 = 8;
+  const int colWidth2 = 15;
+  const int prec = 8;
+
+  // "ANNC" when read in little endian byte order
+  const boost::uint32_t checkpointMagic = 0x434e4e41;
+  const boost::uint32_t checkpointVersion = 1;
+
+
+  //! Writes the layer sizes and weights of a network in StateIO format
+  template <class TNeuralNet>
+  void writeNetwork(std::ostream& os, const TNeuralNet& network)
+  {
+    int numLayers = network.getNumLayers();
+    StateIO::write(os, numLayers);
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      StateIO::write(os, network.getNumUnits(layer));
+    }
+
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      StateIO::write(os, network.getLayerWeight(layer));
+    }
+  }
+
+
+  //! Reads weights written by writeNetwork() into a network of the same
+  //! layer sizes
+  template <class TNeuralNet>
+  bool readNetwork(std::istream& is, TNeuralNet& network)
+  {
+    int numLayers = 0;
+    if (!StateIO::read(is, numLayers)
+        || (numLayers != network.getNumLayers()))
+    {
+      return false;
+    }
+
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      int numUnits = 0;
+      if (!StateIO::read(is, numUnits)
+          || (numUnits != network.getNumUnits(layer)))
+      {
+        return false;
+      }
+    }
+
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      typename TNeuralNet::LayerWeight weight;
+      if (!StateIO::read(is, weight)
+          || (weight.size() != network.getLayerWeight(layer).size()))
+      {
+        return false;
+      }
+
+      network.getLayerWeight(layer).swap(weight);
+    }
+
+    return true;
+  }
+
+
+  /*!
+    \brief Measures the errors of a snapshot of a network in a background
+    thread, while training goes on changing the network
+  */
+  template <class TNeuralNet>
+  class ErrorEvaluation
+  {
+   public:
+
+    //! Type of the datasets the errors are measured on
+    typedef NNetDatasetTemplate<typename TNeuralNet::Scalar> Dataset;
+
+    ErrorEvaluation(const Dataset& trainData, const Dataset& testData)
+      : m_trainData(trainData)
+      , m_testData(testData)
+      , m_network()
+      , m_step(0)
+      , m_measureTrainError(false)
+      , m_trainError(0.00)
+      , m_testError(0.00)
+      , m_thread()
+    {
+      ;
+    }
+
+    ~ErrorEvaluation()
+    {
+      join();
+    }
+
+    /*!
+      \brief Starts measuring the errors of a copy of network
+      \param network The network after step
+      \param step The training step
+      \param measureTrainError Whether to measure the training error too
+      \param trainError The training error to report if it isn't measured
+    */
+    void start(const TNeuralNet& network,
+               int step,
+               bool measureTrainError,
+               double trainError)
+    {
+      assert(!m_thread);
+
+      m_network = network;
+      m_step = step;
+      m_measureTrainError = measureTrainError;
+      m_trainError = trainError;
+      m_thread.reset(new boost::thread(
+                       boost::bind(&ErrorEvaluation::run, this)));
+    }
+
+    /*!
+      \brief Waits for the errors
+      \retval true The errors of the last start() are ready
+      \retval false Nothing was started since the last call
+    */
+    bool join()
+    {
+      if (!m_thread)
+      {
+        return false;
+      }
+
+      m_thread->join();
+      m_thread.reset();
+      return true;
+    }
+
+    //! The network the errors were measured for
+    const TNeuralNet& getNetwork() const
+    {
+      return m_network;
+    }
+
+    int getStep() const
+    {
+      return m_step;
+    }
+
+    double getTrainError() const
+    {
+      return m_trainError;
+    }
+
+    double getTestError() const
+    {
+      return m_testError;
+    }
+
+   private:
+
+    void run()
+    {
+      m_testError = NeuralNetAlg::calculateError(m_network, m_testData);
+      if (m_measureTrainError)
+      {
+        m_trainError = NeuralNetAlg::calculateError(m_network, m_trainData);
+      }
+    }
+
+    const Dataset& m_trainData;
+    const Dataset& m_testData;
+    TNeuralNet m_network;
+    int m_step;
+    bool m_measureTrainError;
+    double m_trainError;
+    double m_testError;
+    boost::scoped_ptr<boost::thread> m_thread;
+  };
+
+} // anonymous namespace
+
   const char* const AlchemyTrain::s_optionTrain = "train";
   const char* const AlchemyTrain::s_optionTest = "test";
   const char* const AlchemyTrain::s_optionProfile = "profile";
@@ -24,19 +222,60 @@ namespace alch {
   const char* const AlchemyTrain::s_optionBeta = "beta";
   const char* const AlchemyTrain::s_optionSteps = "steps";
   const char* const AlchemyTrain::s_optionMomentum = "momentum";
+  const char* const AlchemyTrain::s_optionBatch = "batch";
+  const char* const AlchemyTrain::s_optionTrainer = "trainer";
   const char* const AlchemyTrain::s_optionAutoStop = "autostop";
+  const char* const AlchemyTrain::s_optionThreads = "threads";
+  const char* const AlchemyTrain::s_optionPrecision = "precision";
+  const char* const AlchemyTrain::s_optionBlock = "block";
+  const char* const AlchemyTrain::s_optionRestarts = "restarts";
+  const char* const AlchemyTrain::s_optionJobs = "jobs";
+  const char* const AlchemyTrain::s_optionSearchEta = "searcheta";
+  const char* const AlchemyTrain::s_optionSearchAlpha = "searchalpha";
+  const char* const AlchemyTrain::s_optionSearchBeta = "searchbeta";
+  const char* const AlchemyTrain::s_optionSearchSteps = "searchsteps";
+  const char* const AlchemyTrain::s_optionSearchHidden = "searchhidden";
+  const char* const AlchemyTrain::s_optionTrials = "trials";
+  const char* const AlchemyTrain::s_optionRung = "rung";
+  const char* const AlchemyTrain::s_optionLeaderboard = "leaderboard";
+  const char* const AlchemyTrain::s_optionCheckpoint = "checkpoint";
+  const char* const AlchemyTrain::s_optionCheckpointInterval =
+    "checkpointinterval";
+  const char* const AlchemyTrain::s_optionResume = "resume";
 
   AlchemyTrain::AlchemyTrain()
     : Framework()
     , m_trainFile("")
     , m_testFile("")
     , m_profileName("")
-    , m_useMomentum(false)
+    , m_trainer(TRAINER_gradient)
+    , m_batchSize(0)
     , m_eta(0.001)
     , m_alpha(1.10)
     , m_beta(0.50)
     , m_numSteps(100)
     , m_autoStopSteps(25)
+    , m_numThreads(1)
+    , m_blockSize(0)
+    , m_numRestarts(1)
+    , m_numJobs(1)
+    , m_search(false)
+    , m_searchEta()
+    , m_searchAlpha()
+    , m_searchBeta()
+    , m_searchSteps()
+    , m_searchHidden()
+    , m_numTrials(16)
+    , m_rungSteps(10)
+    , m_leaderboardFile("")
+    , m_checkpointFile("")
+    , m_checkpointInterval(300)
+    , m_resume(false)
+    , m_trialStates()
+    , m_lastCheckpoint(0)
+    , m_numCheckpoints(0)
+    , m_writtenCheckpoint(0)
+    , m_precision(PredictionProfile::PRECISION_double)
     , m_profile()
     , m_trainData()
     , m_testData()
@@ -75,15 +314,25 @@ namespace alch {
     getOptions().getGenericOptions().add_options()
       (s_optionTrain,
        boost::program_options::value<std::string>(),
-       "Name of input file for training data")
+       "Name of input file for training data, in text or binary format")
       (s_optionTest,
        boost::program_options::value<std::string>(),
-       "Name of input file for testing data")
+       "Name of input file for testing data, in text or binary format")
       (s_optionProfile,
        boost::program_options::value<std::string>(),
        "Name of file for neural network profile")
       (s_optionPlot, "Flag to produce a plot of train/test error")
-      (s_optionMomentum, "Specifies to use momentum for training")
+      (s_optionTrainer,
+       boost::program_options::value<std::string>(),
+       "Training algorithm: gradient, momentum, minibatch, adam or rmsprop "
+       "(default gradient)")
+      (s_optionMomentum, "Specifies to use momentum for training; same as "
+       "--trainer momentum")
+      (s_optionBatch,
+       boost::program_options::value<int>(),
+       "Number of data points per weight update for the minibatch, adam "
+       "and rmsprop trainers; implies --trainer minibatch if no trainer is "
+       "given. adam and rmsprop default to the whole training set.")
       (s_optionSteps,
        boost::program_options::value<int>(),
        "Number of training steps to perform")
@@ -102,6 +351,68 @@ namespace alch {
        boost::program_options::value<double>(),
        "Value of beta (momentum decrease multiplier) for neural network "
        "training")
+      (s_optionThreads,
+       boost::program_options::value<int>(),
+       "Number of threads used to compute each training step")
+      (s_optionPrecision,
+       boost::program_options::value<std::string>(),
+       "Precision to train in: float or double (default is the precision "
+       "the profile was last trained in)")
+      (s_optionBlock,
+       boost::program_options::value<int>(),
+       "Stream the training data in shuffled blocks of this many points "
+       "instead of reading it all into memory; the training file must be "
+       "binary. Each step trains on the blocks one at a time, and the "
+       "training error shown is measured before each block's update.")
+      (s_optionRestarts,
+       boost::program_options::value<int>(),
+       "Number of copies of the network to train, keeping the one with the "
+       "lowest testing error. The first continues from the profile's "
+       "weights and the others start from random weights (default 1)")
+      (s_optionJobs,
+       boost::program_options::value<int>(),
+       "Number of restarts or search trials to train at once (default is "
+       "the number of processors)")
+      (s_optionSearchEta,
+       boost::program_options::value<std::string>(),
+       "Searches eta instead of training the profile: comma separated "
+       "values to try, or min:max to draw values at random")
+      (s_optionSearchAlpha,
+       boost::program_options::value<std::string>(),
+       "Searches alpha; see --searcheta")
+      (s_optionSearchBeta,
+       boost::program_options::value<std::string>(),
+       "Searches beta; see --searcheta")
+      (s_optionSearchSteps,
+       boost::program_options::value<std::string>(),
+       "Searches the number of training steps; see --searcheta")
+      (s_optionSearchHidden,
+       boost::program_options::value<std::string>(),
+       "Searches the number of units in each hidden layer, keeping the "
+       "profile's number of hidden layers; see --searcheta")
+      (s_optionTrials,
+       boost::program_options::value<int>(),
+       "Number of configurations to draw when a search has a random range "
+       "(default 16); grids alone are searched exhaustively")
+      (s_optionRung,
+       boost::program_options::value<int>(),
+       "Steps after which a search first prunes the worse half of its "
+       "trials; the rest are pruned again each time their steps double "
+       "(default 10)")
+      (s_optionLeaderboard,
+       boost::program_options::value<std::string>(),
+       "Name of CSV file to write search results to; the profile is not "
+       "changed by a search")
+      (s_optionCheckpoint,
+       boost::program_options::value<std::string>(),
+       "Name of file to save the training state to periodically, so that "
+       "training can be resumed with --resume")
+      (s_optionCheckpointInterval,
+       boost::program_options::value<int>(),
+       "Seconds between checkpoints (default 300)")
+      (s_optionResume, "Resumes training from the checkpoint file, which "
+       "must come from a run with the same options; starts from the "
+       "profile if there is no checkpoint yet")
       ;
 
     return Framework::processOptions(argc, argv);
@@ -120,19 +431,23 @@ namespace alch {
     }
     printParams();
 
-    if (!readData(m_trainFile, m_trainData, "training data"))
-    {
-      getContext() << Context::PRIORITY_error
-                   << "Application failed while reading training data"
-                   << Context::endl;
-      return false;
-    }
-    else if (!m_trainData.size())
+    // streamed training data is read while training
+    if (!m_blockSize)
     {
-      getContext() << Context::PRIORITY_error
-                   << "No training data was read; aborting execution"
-                   << Context::endl;
-      return false;
+      if (!readData(m_trainFile, m_trainData, "training data"))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Application failed while reading training data"
+                     << Context::endl;
+        return false;
+      }
+      else if (!m_trainData.size())
+      {
+        getContext() << Context::PRIORITY_error
+                     << "No training data was read; aborting execution"
+                     << Context::endl;
+        return false;
+      }
     }
 
     if (!readData(m_testFile, m_testData, "testing data"))
@@ -166,7 +481,8 @@ namespace alch {
       return false;
     }
 
-    if (!writeProfile())
+    // a search only reports its results
+    if (!m_search && !writeProfile())
     {
       getContext() << Context::PRIORITY_error
                    << "Application failed while writing prediction profile"
@@ -269,296 +585,1685 @@ namespace alch {
       m_beta = vm[s_optionBeta].as<double>();
     }
 
-    if (vm.count(s_optionMomentum))
+    // get training algorithm
+    if (vm.count(s_optionTrainer))
     {
-      m_useMomentum = true;
+      std::string trainer = vm[s_optionTrainer].as<std::string>();
+      if (trainer == "gradient")
+      {
+        m_trainer = TRAINER_gradient;
+      }
+      else if (trainer == "momentum")
+      {
+        m_trainer = TRAINER_momentum;
+      }
+      else if (trainer == "minibatch")
+      {
+        m_trainer = TRAINER_minibatch;
+      }
+      else if (trainer == "adam")
+      {
+        m_trainer = TRAINER_adam;
+      }
+      else if (trainer == "rmsprop")
+      {
+        m_trainer = TRAINER_rmsprop;
+      }
+      else
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Unknown trainer '" << trainer << "'"
+                     << Context::endl;
+        return false;
+      }
     }
 
-    return true;
-  }
-
-
-  void AlchemyTrain::printParams()
-  {
-    getContext() << Context::PRIORITY_info
-                 << "Training input file: " << m_trainFile
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "Testing input file: " << m_testFile
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "Profile name: " << m_profileName
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "Number of training steps: " << m_numSteps
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "Auto-stop after these steps: " << m_autoStopSteps
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "eta: " << m_eta
-                 << Context::endl;
-
-    getContext() << Context::PRIORITY_info
-                 << "alpha: " << m_alpha
-                 << Context::endl;
+    if (vm.count(s_optionMomentum))
+    {
+      if (vm.count(s_optionTrainer) && (m_trainer != TRAINER_momentum))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "--" << s_optionMomentum << " conflicts with --"
+                     << s_optionTrainer
+                     << Context::endl;
+        return false;
+      }
+      m_trainer = TRAINER_momentum;
+    }
 
-    getContext() << Context::PRIORITY_info
-                 << "beta: " << m_beta
-                 << Context::endl;
-  }
+    // get mini-batch size
+    if (vm.count(s_optionBatch))
+    {
+      m_batchSize = vm[s_optionBatch].as<int>();
+      if (!vm.count(s_optionTrainer) && !vm.count(s_optionMomentum))
+      {
+        m_trainer = TRAINER_minibatch;
+      }
 
+      if (m_batchSize < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Batch size must be at least 1"
+                     << Context::endl;
+        return false;
+      }
+      else if ((m_trainer == TRAINER_gradient)
+               || (m_trainer == TRAINER_momentum))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Batch size does not apply to the selected trainer"
+                     << Context::endl;
+        return false;
+      }
+    }
 
-  bool AlchemyTrain::readData(const std::string& filename,
-                              NNetDataset& dataset,
-                              const char* name)
-  {
-    std::ifstream ifs(filename.c_str());
-    if (!ifs)
+    // get number of training threads
+    if (vm.count(s_optionThreads))
     {
-      getContext() << Context::PRIORITY_error
-                   << "Failed to open file '" << filename << "' to read "
-                   << name
-                   << Context::endl;
-      return false;
+      m_numThreads = vm[s_optionThreads].as<int>();
+      if (m_numThreads < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Number of threads must be at least 1"
+                     << Context::endl;
+        return false;
+      }
     }
 
-    if (!NNetDataStream::readDataset(ifs, dataset, getContext()))
+    // get block size for streaming the training data
+    if (vm.count(s_optionBlock))
     {
-      getContext() << Context::PRIORITY_error
-                   << "Failed while reading " << name << " from file '"
-                   << filename << "'"
-                   << Context::endl;
-      return false;
+      m_blockSize = vm[s_optionBlock].as<int>();
+      if (m_blockSize < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Block size must be at least 1"
+                     << Context::endl;
+        return false;
+      }
+      else if (m_trainer == TRAINER_momentum)
+      {
+        // it would compare the errors of different blocks
+        getContext() << Context::PRIORITY_error
+                     << "--" << s_optionBlock << " does not apply to the "
+                     << "momentum trainer"
+                     << Context::endl;
+        return false;
+      }
+      else if (!NNetDataFile::isDataFile(m_trainFile))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Training file '" << m_trainFile << "' must be in "
+                     << "binary format to be streamed"
+                     << Context::endl;
+        return false;
+      }
     }
 
-    getContext() << Context::PRIORITY_info
-                 << "Read " << dataset.size() << " data points from file '"
-                 << filename << "'"
-                 << Context::endl;
-
-    return true;
-  }
-
-
-  bool AlchemyTrain::loadProfile()
-  {
-    if (!ProfileIO::exists(m_profileName.c_str()))
+    // get number of restarts and how many to train at once
+    if (vm.count(s_optionRestarts))
     {
-      getContext() << Context::PRIORITY_error
-                   << "Profile name '" << m_profileName
-                   << "' does not exist"
-                   << Context::endl;
-      return false;
+      m_numRestarts = vm[s_optionRestarts].as<int>();
+      if (m_numRestarts < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Number of restarts must be at least 1"
+                     << Context::endl;
+        return false;
+      }
     }
 
-    if (!ProfileIO::read(m_profileName.c_str(), m_profile, getContext()))
+    if (vm.count(s_optionJobs))
     {
-      getContext() << Context::PRIORITY_error
-                   << "Failed to read profile from '" << m_profileName
-                   << "'"
-                   << Context::endl;
-      return false;
+      m_numJobs = vm[s_optionJobs].as<int>();
+      if (m_numJobs < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Number of jobs must be at least 1"
+                     << Context::endl;
+        return false;
+      }
     }
-
-    getContext() << Context::PRIORITY_info
+    else
+    {
+      m_numJobs = std::max(1, int(::sysconf(_SC_NPROCESSORS_ONLN)));
+    }
+
+    // get hyperparameter search; parameters that aren't searched keep
+    // their single value
+    m_search = false;
+    const char* const searchOptions[] = {
+      s_optionSearchEta, s_optionSearchAlpha, s_optionSearchBeta,
+      s_optionSearchSteps, s_optionSearchHidden
+    };
+    SearchRange* const searchRanges[] = {
+      &m_searchEta, &m_searchAlpha, &m_searchBeta,
+      &m_searchSteps, &m_searchHidden
+    };
+    const double searchDefaults[] = {
+      m_eta, m_alpha, m_beta, static_cast<double>(m_numSteps), 0
+    };
+    const double searchMinValues[] = { 0, 0, 0, 1, 1 };
+
+    for (int i = 0; i < 5; ++i)
+    {
+      SearchRange& range = *searchRanges[i];
+      if (vm.count(searchOptions[i]))
+      {
+        m_search = true;
+        if (!parseSearchRange(vm[searchOptions[i]].as<std::string>(),
+                              searchMinValues[i],
+                              range))
+        {
+          getContext() << Context::PRIORITY_error
+                       << "Invalid values for --" << searchOptions[i]
+                       << Context::endl;
+          return false;
+        }
+      }
+      else
+      {
+        range.values.assign(1, searchDefaults[i]);
+      }
+    }
+
+    if (vm.count(s_optionTrials))
+    {
+      m_numTrials = vm[s_optionTrials].as<int>();
+      if (m_numTrials < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Number of trials must be at least 1"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    if (vm.count(s_optionRung))
+    {
+      m_rungSteps = vm[s_optionRung].as<int>();
+      if (m_rungSteps < 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Rung steps must be at least 1"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    if (m_search)
+    {
+      if (vm.count(s_optionLeaderboard))
+      {
+        m_leaderboardFile = vm[s_optionLeaderboard].as<std::string>();
+      }
+      else
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Leaderboard file not specified for search"
+                     << Context::endl;
+        return false;
+      }
+
+      if (m_numRestarts > 1)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "--" << s_optionRestarts << " does not apply to a "
+                     << "search"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    // get checkpointing
+    if (vm.count(s_optionCheckpoint))
+    {
+      m_checkpointFile = vm[s_optionCheckpoint].as<std::string>();
+      if (m_search)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "--" << s_optionCheckpoint << " does not apply to "
+                     << "a search"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    if (vm.count(s_optionCheckpointInterval))
+    {
+      m_checkpointInterval = vm[s_optionCheckpointInterval].as<int>();
+      if (m_checkpointInterval < 0)
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Checkpoint interval must not be negative"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    m_resume = (vm.count(s_optionResume) != 0);
+    if (m_resume && m_checkpointFile.empty())
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Checkpoint file not specified for --"
+                   << s_optionResume
+                   << Context::endl;
+      return false;
+    }
+
+    // get training precision
+    if (vm.count(s_optionPrecision))
+    {
+      std::string precision = vm[s_optionPrecision].as<std::string>();
+      if (precision == "double")
+      {
+        m_precision = PredictionProfile::PRECISION_double;
+      }
+      else if (precision == "float")
+      {
+        m_precision = PredictionProfile::PRECISION_float;
+      }
+      else
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Unknown precision '" << precision << "'"
+                     << Context::endl;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  void AlchemyTrain::printParams()
+  {
+    getContext() << Context::PRIORITY_info
+                 << "Training input file: " << m_trainFile
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Testing input file: " << m_testFile
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Profile name: " << m_profileName
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Number of training steps: " << m_numSteps
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Auto-stop after these steps: " << m_autoStopSteps
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "eta: " << m_eta
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "alpha: " << m_alpha
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "beta: " << m_beta
+                 << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << "Training threads: " << m_numThreads
+                 << Context::endl;
+
+    if (m_blockSize)
+    {
+      getContext() << Context::PRIORITY_info
+                   << "Training data block size: " << m_blockSize
+                   << Context::endl;
+    }
+
+    if (m_search)
+    {
+      getContext() << Context::PRIORITY_info
+                   << "Search leaderboard file: " << m_leaderboardFile
+                   << Context::endl;
+
+      getContext() << Context::PRIORITY_info
+                   << "Search jobs: " << m_numJobs
+                   << " / first rung: " << m_rungSteps << " steps"
+                   << Context::endl;
+    }
+    else
+    {
+      getContext() << Context::PRIORITY_info
+                   << "Restarts: " << m_numRestarts
+                   << " (" << std::min(m_numJobs, m_numRestarts)
+                   << " at once)"
+                   << Context::endl;
+    }
+
+    if (!m_checkpointFile.empty())
+    {
+      getContext() << Context::PRIORITY_info
+                   << "Checkpoint file: " << m_checkpointFile
+                   << " (every " << m_checkpointInterval << " s"
+                   << (m_resume ? ", resuming" : "") << ")"
+                   << Context::endl;
+    }
+  }
+
+
+  bool AlchemyTrain::parseSearchRange(const std::string& spec,
+                                      double minValue,
+                                      SearchRange& range)
+  {
+    range.values.clear();
+    range.min = 0.00;
+    range.max = 0.00;
+
+    std::string::size_type colon = spec.find(':');
+    if (colon != std::string::npos)
+    {
+      std::istringstream minStream(spec.substr(0, colon));
+      std::istringstream maxStream(spec.substr(colon + 1));
+      return ((minStream >> range.min) && (minStream >> std::ws).eof()
+              && (maxStream >> range.max) && (maxStream >> std::ws).eof()
+              && (range.min >= minValue) && (range.min <= range.max));
+    }
+
+    std::istringstream iss(spec);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+      std::istringstream itemStream(item);
+      double value = 0.00;
+      if (!(itemStream >> value) || !(itemStream >> std::ws).eof()
+          || (value < minValue))
+      {
+        return false;
+      }
+
+      range.values.push_back(value);
+    }
+
+    return !range.values.empty();
+  }
+
+
+  void AlchemyTrain::makeSearchConfigs(std::vector<TrialConfig>& configs)
+  {
+    const SearchRange* const ranges[] = {
+      &m_searchEta, &m_searchAlpha, &m_searchBeta,
+      &m_searchSteps, &m_searchHidden
+    };
+    const int numRanges = 5;
+
+    bool random = false;
+    int numGrid = 1;
+    for (int i = 0; i < numRanges; ++i)
+    {
+      random = (random || ranges[i]->values.empty());
+      numGrid *= std::max(1, int(ranges[i]->values.size()));
+    }
+
+    configs.clear();
+
+    // a generator of our own, seeded like srand48(), so that the configs
+    // don't depend on or disturb other users of drand48()
+    long seed = getSeed();
+    unsigned short randState[3];
+    randState[0] = 0x330E;
+    randState[1] = static_cast<unsigned short>(seed & 0xFFFF);
+    randState[2] = static_cast<unsigned short>((seed >> 16) & 0xFFFF);
+
+    int numConfigs = (random ? m_numTrials : numGrid);
+    for (int index = 0; index < numConfigs; ++index)
+    {
+      // grids are walked like the digits of index; random ranges and
+      // grids in a random search are drawn
+      double value[numRanges];
+      int digits = index;
+      for (int i = 0; i < numRanges; ++i)
+      {
+        const SearchRange& range = *ranges[i];
+        int size = int(range.values.size());
+        if (!size)
+        {
+          value[i] = (range.min
+                      + ::erand48(randState) * (range.max - range.min));
+        }
+        else if (random)
+        {
+          value[i] = range.values[std::min(size - 1,
+                                           int(::erand48(randState)
+                                               * size))];
+        }
+        else
+        {
+          value[i] = range.values[digits % size];
+          digits /= size;
+        }
+      }
+
+      TrialConfig config;
+      config.eta = value[0];
+      config.alpha = value[1];
+      config.beta = value[2];
+      config.numSteps = int(value[3] + 0.5);
+      config.numHiddenUnits = int(value[4] + 0.5);
+      configs.push_back(config);
+    }
+  }
+
+
+  bool AlchemyTrain::readData(const std::string& filename,
+                              NNetDataset& dataset,
+                              const char* name)
+  {
+    // binary files are mapped and copied without parsing
+    if (NNetDataFile::isDataFile(filename))
+    {
+      NNetDataFile file;
+      if (!file.open(filename, getContext()))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Failed while reading " << name << " from file '"
+                     << filename << "'"
+                     << Context::endl;
+        return false;
+      }
+
+      file.copyTo(dataset);
+
+      getContext() << Context::PRIORITY_info
+                   << "Read " << dataset.size()
+                   << " data points from binary file '" << filename << "'"
+                   << Context::endl;
+
+      return true;
+    }
+
+    std::ifstream ifs(filename.c_str());
+    if (!ifs)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to open file '" << filename << "' to read "
+                   << name
+                   << Context::endl;
+      return false;
+    }
+
+    if (!NNetDataStream::readDataset(ifs, dataset, getContext()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed while reading " << name << " from file '"
+                   << filename << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Read " << dataset.size() << " data points from file '"
+                 << filename << "'"
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyTrain::loadProfile()
+  {
+    if (!ProfileIO::exists(m_profileName.c_str()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Profile name '" << m_profileName
+                   << "' does not exist"
+                   << Context::endl;
+      return false;
+    }
+
+    if (!ProfileIO::read(m_profileName.c_str(), m_profile, getContext()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to read profile from '" << m_profileName
+                   << "'"
+                   << Context::endl;
+      return false;
+    }
+
+    getContext() << Context::PRIORITY_info
                  << "Loaded profile from '" << m_profileName << "'"
                  << Context::endl;
 
-    NeuralNetPtr neuralNet(m_profile.getNeuralNetPtr());
+    NeuralNetPtr neuralNet(m_profile.getNeuralNetPtr());
+
+    getContext() << Context::PRIORITY_debug1
+                 << "Number layers: " << neuralNet->getNumLayers()
+                 << Context::endl;
+    
+    for (int layer = 0; layer <  neuralNet->getNumLayers(); ++layer)
+    {
+      getContext() << Context::PRIORITY_debug1
+                   << "Units on layer " << layer << ": "
+                   << neuralNet->getNumUnits(layer)
+                   << Context::endl;
+    }
+    
+    getContext() << Context::PRIORITY_debug1
+                 << "Number input units: "
+                 << neuralNet->getNumInputUnits()
+                 << Context::endl;
+    
+    getContext() << Context::PRIORITY_debug1
+                 << "Number output units: "
+                 << neuralNet->getNumOutputUnits()
+                 << Context::endl;
+
+    // keep training in the profile's precision unless told otherwise
+    if (getOptions().getVariablesMap().count(s_optionPrecision))
+    {
+      m_profile.setPrecision(m_precision);
+    }
+    else
+    {
+      m_precision = m_profile.getPrecision();
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << "Training precision: "
+                 << ((m_precision == PredictionProfile::PRECISION_float)
+                     ? "float" : "double")
+                 << Context::endl;
+
+    return true;
+  }
+
+
+  bool AlchemyTrain::trainNeuralNet()
+  {
+    if (m_precision == PredictionProfile::PRECISION_float)
+    {
+      // datasets are always read in double precision
+      FloatNNetDataset trainData(m_trainData);
+      FloatNNetDataset testData(m_testData);
+      return trainNeuralNet<FloatNeuralNet>(trainData, testData);
+    }
+    else
+    {
+      return trainNeuralNet<NeuralNet>(m_trainData, m_testData);
+    }
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::trainNeuralNet(
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    typedef Trial<TNeuralNet> TrainTrial;
+    typedef boost::shared_ptr<TrainTrial> TrainTrialPtr;
+
+    if (m_search)
+    {
+      return searchNeuralNet<TNeuralNet>(trainData, testData);
+    }
+
+    NeuralNetPtr neuralNet(m_profile.getNeuralNetPtr());
+    assert(neuralNet.get());
+
+    TNeuralNet startNeuralNet(*neuralNet);
+    double profileTestErr = NeuralNetAlg::calculateError(startNeuralNet,
+                                                         testData);
+
+    TrialConfig config;
+    config.eta = m_eta;
+    config.alpha = m_alpha;
+    config.beta = m_beta;
+    config.numSteps = m_numSteps;
+    config.numHiddenUnits = 0;
+
+    // the first restart continues from the profile's weights; the others
+    // start from random weights like a new profile
+    std::vector<TrainTrialPtr> restarts;
+    for (int index = 0; index < m_numRestarts; ++index)
+    {
+      TrainTrialPtr restart(new TrainTrial(index, config, startNeuralNet));
+      if (index)
+      {
+        srand48(getSeed() + index);
+        NeuralNetAlg::randomizeWeights(*restart->network, -1.00, 1.00);
+      }
+
+      restarts.push_back(restart);
+    }
+
+    if (!m_checkpointFile.empty())
+    {
+      m_trialStates.assign(m_numRestarts, std::string());
+      m_lastCheckpoint = ::time(0);
+    }
+
+    if (m_resume
+        && !resumeTrials<TNeuralNet>(restarts, trainData, testData))
+    {
+      return false;
+    }
+
+    printErrorHeader();
+
+    if (!runTrials<TNeuralNet>(restarts, m_numSteps, trainData, testData))
+    {
+      return false;
+    }
+
+    // keep the restart with the lowest testing error
+    TrainTrialPtr bestRestart;
+    for (int index = 0; index < m_numRestarts; ++index)
+    {
+      const TrainTrial& restart = *restarts[index];
+      if (m_numRestarts > 1)
+      {
+        std::stringstream ss;
+        ss << "Restart " << index << ": minimum testing error was at step "
+           << restart.minTestErrIdx << ": "
+           << std::setprecision(prec) << restart.minTestErr;
+
+        getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+      }
+
+      if (!bestRestart || (restart.minTestErr < bestRestart->minTestErr))
+      {
+        bestRestart = restarts[index];
+      }
+    }
+
+    assert(bestRestart.get());
+
+    // the profile keeps the best network in double precision; leave it
+    // untouched if training never improved on it
+    if (bestRestart->minTestErr < profileTestErr)
+    {
+      *neuralNet = NeuralNet(bestRestart->best);
+    }
+
+    {
+      std::stringstream ss;
+      ss  << "Minimum testing error was at step "
+          << bestRestart->minTestErrIdx;
+
+      if (m_numRestarts > 1)
+      {
+        ss << " of restart " << bestRestart->index;
+      }
+
+      ss << ": " << std::setprecision(prec) << bestRestart->minTestErr;
+
+      getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+    }
+
+    // plot the train and test error if requested
+    if (getOptions().getVariablesMap().count(s_optionPlot)
+        && !plotError(bestRestart->trainError, bestRestart->testError))
+    {
+      getContext() << Context::PRIORITY_warning
+                   << "Failed to plot train and test error; continuing"
+                   << Context::endl;
+    }
+
+    return true;
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::searchNeuralNet(
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    typedef Trial<TNeuralNet> TrainTrial;
+    typedef boost::shared_ptr<TrainTrial> TrainTrialPtr;
+
+    NeuralNetPtr neuralNet(m_profile.getNeuralNetPtr());
+    assert(neuralNet.get());
+
+    std::vector<TrialConfig> configs;
+    makeSearchConfigs(configs);
+
+    getContext() << Context::PRIORITY_info
+                 << "Searching " << configs.size() << " configurations"
+                 << Context::endl;
+
+    // every trial starts from random weights, since the hidden layers may
+    // differ from the profile's; searched hidden units replace those of
+    // the profile's hidden layers, keeping their number
+    int numHiddenLayers = neuralNet->getNumLayers() - 2;
+    if (getOptions().getVariablesMap().count(s_optionSearchHidden)
+        && (numHiddenLayers < 1))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Can't search hidden units; the profile's network "
+                   << "has no hidden layers"
+                   << Context::endl;
+      return false;
+    }
+
+    int profileHiddenUnits = ((neuralNet->getNumLayers() > 2)
+                              ? (neuralNet->getNumUnits(1) - 1) : 0);
+    std::vector<TrainTrialPtr> trials;
+    for (int index = 0; index < int(configs.size()); ++index)
+    {
+      const TrialConfig& config = configs[index];
+      TNeuralNet startNeuralNet(*neuralNet);
+      if (config.numHiddenUnits)
+      {
+        startNeuralNet = TNeuralNet(neuralNet->getNumInputUnits(),
+                                    neuralNet->getNumOutputUnits() - 1,
+                                    numHiddenLayers,
+                                    config.numHiddenUnits);
+      }
+
+      srand48(getSeed() + index);
+      NeuralNetAlg::randomizeWeights(startNeuralNet, -1.00, 1.00);
+
+      trials.push_back(TrainTrialPtr(new TrainTrial(index, config,
+                                                    startNeuralNet)));
+    }
+
+    printErrorHeader();
+
+    // successive halving: each rung doubles the steps of the better half
+    // of the trials still training
+    std::vector<TrainTrialPtr> active(trials);
+    for (int rung = m_rungSteps; !active.empty(); rung *= 2)
+    {
+      if (!runTrials<TNeuralNet>(active, rung, trainData, testData))
+      {
+        return false;
+      }
+
+      std::vector<TrainTrialPtr> training;
+      for (int i = 0; i < int(active.size()); ++i)
+      {
+        if (!active[i]->done)
+        {
+          training.push_back(active[i]);
+        }
+      }
+
+      // the trials still training have all run the rung's steps, so they
+      // are compared at the same step
+      std::stable_sort(training.begin(), training.end(),
+                       boost::bind(&AlchemyTrain::isBetterAtStep<TNeuralNet>,
+                                   _1, _2, rung));
+
+      int numKept = (int(training.size()) + 1) / 2;
+      for (int i = numKept; i < int(training.size()); ++i)
+      {
+        TrainTrial& trial = *training[i];
+        trial.prunedStep = int(trial.testError.size());
+
+        std::stringstream ss;
+        ss << "Pruning trial " << trial.index << " at step "
+           << trial.prunedStep << " (testing error "
+           << std::setprecision(prec) << trial.testError[rung - 1] << ")";
+
+        getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+      }
+
+      training.resize(numKept);
+      active.swap(training);
+    }
+
+    std::stable_sort(trials.begin(), trials.end(),
+                     &AlchemyTrain::isBetterTrial<TNeuralNet>);
+
+    if (!writeLeaderboard<TNeuralNet>(trials, profileHiddenUnits))
+    {
+      return false;
+    }
+
+    const TrainTrial& best = *trials[0];
+    {
+      std::stringstream ss;
+      ss << "Best trial " << best.index << ": eta " << best.config.eta
+         << ", alpha " << best.config.alpha
+         << ", beta " << best.config.beta
+         << ", steps " << best.config.numSteps
+         << ", hidden units "
+         << (best.config.numHiddenUnits ? best.config.numHiddenUnits
+             : profileHiddenUnits)
+         << "; minimum testing error was at step " << best.minTestErrIdx
+         << ": " << std::setprecision(prec) << best.minTestErr;
+
+      getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+    }
+
+    // plot the train and test error if requested
+    if (getOptions().getVariablesMap().count(s_optionPlot)
+        && !plotError(best.trainError, best.testError))
+    {
+      getContext() << Context::PRIORITY_warning
+                   << "Failed to plot train and test error; continuing"
+                   << Context::endl;
+    }
+
+    return true;
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::runTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    // the trials share the datasets; each job trains trials until none
+    // are left, and this thread runs the first job
+    int numJobs = std::min(m_numJobs, int(trials.size()));
+    int nextTrial = 0;
+    boost::thread_group threads;
+    for (int job = 1; job < numJobs; ++job)
+    {
+      threads.create_thread(
+        boost::bind(&AlchemyTrain::trainTrials<TNeuralNet>,
+                    this,
+                    boost::ref(trials),
+                    boost::ref(nextTrial),
+                    lastStep,
+                    boost::cref(trainData),
+                    boost::cref(testData)));
+    }
+
+    trainTrials<TNeuralNet>(trials, nextTrial, lastStep, trainData, testData);
+    threads.join_all();
+
+    for (int i = 0; i < int(trials.size()); ++i)
+    {
+      if (!trials[i]->ok)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  template <class TNeuralNet>
+  void AlchemyTrain::trainTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int& nextTrial,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    for (;;)
+    {
+      int index = 0;
+      {
+        boost::mutex::scoped_lock lock(m_trainMutex);
+        index = nextTrial++;
+      }
+
+      if (index >= int(trials.size()))
+      {
+        return;
+      }
+
+      Trial<TNeuralNet>& trial = *trials[index];
+      if (!trial.done)
+      {
+        trial.ok = trainTrial(trial, lastStep, trainData, testData);
+      }
+    }
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::startTrial(
+    Trial<TNeuralNet>& trial,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    typedef boost::shared_ptr<GradDescentTemplate<TNeuralNet> > TrainerPtr;
+    typedef NNetDataReaderTemplate<typename TNeuralNet::Scalar> Reader;
+
+    boost::shared_ptr<TNeuralNet> trainNeuralNet(trial.network);
+    assert(trainNeuralNet.get());
+
+    // each trial shuffles with its own seed
+    long seed = getSeed() + trial.index;
+
+    // with a block size the training data is streamed from the file
+    // instead of being in trainData
+    if (m_blockSize)
+    {
+      trial.reader.reset(new Reader(m_blockSize, seed));
+      trial.reader->setShuffle(true);
+
+      bool opened = false;
+      {
+        boost::mutex::scoped_lock lock(m_trainMutex);
+        opened = trial.reader->open(m_trainFile, getContext());
+      }
+
+      if (!opened)
+      {
+        std::stringstream ss;
+        ss << "Failed to open training data file '" << m_trainFile
+           << "' for streaming";
+        logMessage(Context::PRIORITY_error, ss.str());
+        return false;
+      }
+      else if (!trial.reader->size())
+      {
+        std::stringstream ss;
+        ss << "No training data in file '" << m_trainFile << "'";
+        logMessage(Context::PRIORITY_error, ss.str());
+        return false;
+      }
+
+      std::stringstream ss;
+      ss << "Streaming " << trial.reader->size() << " data points in "
+         << trial.reader->getNumBlocks() << " blocks from binary file '"
+         << m_trainFile << "'";
+      logMessage(Context::PRIORITY_info, ss.str());
+    }
+    else if (!trainData.size())
+    {
+      // the batch size defaults to the number of points, and no trainer
+      // can update from an empty batch
+      std::stringstream ss;
+      ss << "No training data in '" << m_trainFile << "'";
+      logMessage(Context::PRIORITY_error, ss.str());
+      return false;
+    }
+
+    TrainerPtr grad;
+    double eta = trial.config.eta;
+
+    // adaptive trainers default to full-batch updates, or to one update
+    // per block when streaming
+    int batchSize = m_batchSize;
+    if (!batchSize)
+    {
+      batchSize = (m_blockSize ? m_blockSize : int(trainData.size()));
+    }
+
+    std::stringstream trainerDesc;
+    switch (m_trainer)
+    {
+      case TRAINER_momentum:
+        trainerDesc << "Using momentum trainer (alpha = "
+                    << trial.config.alpha << " / beta = "
+                    << trial.config.beta << ")";
+
+        grad = TrainerPtr(
+          new MomentumGradDescentTemplate<TNeuralNet>(trainNeuralNet, eta,
+                                                      trial.config.alpha,
+                                                      trial.config.beta));
+        break;
+
+      case TRAINER_minibatch:
+        trainerDesc << "Using mini-batch gradient descent (eta = " << eta
+                    << " / batch size = " << batchSize << ")";
+
+        grad = TrainerPtr(
+          new MiniBatchGradDescentTemplate<TNeuralNet>(trainNeuralNet, eta,
+                                                       batchSize, seed));
+        break;
+
+      case TRAINER_adam:
+        trainerDesc << "Using Adam trainer (eta = " << eta
+                    << " / batch size = " << batchSize << ")";
+
+        grad = TrainerPtr(
+          new AdamGradDescentTemplate<TNeuralNet>(trainNeuralNet, eta,
+                                                  batchSize, seed));
+        break;
+
+      case TRAINER_rmsprop:
+        trainerDesc << "Using RMSProp trainer (eta = " << eta
+                    << " / batch size = " << batchSize << ")";
+
+        grad = TrainerPtr(
+          new RMSPropGradDescentTemplate<TNeuralNet>(trainNeuralNet, eta,
+                                                     batchSize, seed));
+        break;
+
+      case TRAINER_gradient:
+      default:
+        trainerDesc << "Using gradient descent (eta = " << eta << ")";
+
+        grad = TrainerPtr(
+          new GradDescentTemplate<TNeuralNet>(trainNeuralNet, eta));
+        break;
+    }
+
+    logMessage(Context::PRIORITY_debug1, trainerDesc.str());
 
-    getContext() << Context::PRIORITY_debug1
-                 << "Number layers: " << neuralNet->getNumLayers()
-                 << Context::endl;
-    
-    for (int layer = 0; layer <  neuralNet->getNumLayers(); ++layer)
-    {
-      getContext() << Context::PRIORITY_debug1
-                   << "Units on layer " << layer << ": "
-                   << neuralNet->getNumUnits(layer)
-                   << Context::endl;
-    }
-    
-    getContext() << Context::PRIORITY_debug1
-                 << "Number input units: "
-                 << neuralNet->getNumInputUnits()
-                 << Context::endl;
-    
-    getContext() << Context::PRIORITY_debug1
-                 << "Number output units: "
-                 << neuralNet->getNumOutputUnits()
-                 << Context::endl;
+    grad->setNumThreads(m_numThreads);
+    trial.trainer = grad;
+
+    trial.best = *trainNeuralNet;
+    trial.minTestErrIdx = 0;
+    trial.minTestErr = NeuralNetAlg::calculateError(*trainNeuralNet,
+                                                    testData);
+
+    trial.trainError.reserve(trial.config.numSteps);
+    trial.testError.reserve(trial.config.numSteps);
+    trial.savedTime = ::time(0);
 
     return true;
   }
 
 
-  bool AlchemyTrain::trainNeuralNet()
+  template <class TNeuralNet>
+  bool AlchemyTrain::trainTrial(
+    Trial<TNeuralNet>& trial,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
   {
-    NeuralNetPtr neuralNet(m_profile.getNeuralNetPtr());
-    assert(neuralNet.get());
+    if (!trial.trainer && !startTrial(trial, trainData, testData))
+    {
+      return false;
+    }
 
-    NeuralNetPtr trainNeuralNet(new NeuralNet());
-    *trainNeuralNet = *neuralNet;
+    TNeuralNet& trainNeuralNet = *trial.network;
+    GradDescentTemplate<TNeuralNet>& grad = *trial.trainer;
 
-    GradDescentPtr grad;
+    // the errors of each step are measured on a snapshot of its weights
+    // while the next step trains, so they arrive one step late
+    ErrorEvaluation<TNeuralNet> evaluation(trainData, testData);
 
-    if (m_useMomentum)
+    // a trial resumed from a checkpoint may have its last step's errors
+    // still to measure
+    if (trial.stepsRun > int(trial.testError.size()))
     {
-      getContext() << Context::PRIORITY_debug1
-                   << "Using momentum trainer (alpha = " << m_alpha
-                   << " / beta = " << m_beta << ")"
-                   << Context::endl;
+      evaluation.start(trainNeuralNet, trial.stepsRun, !trial.reader,
+                       trial.lastStepTrainError);
+    }
+
+    // a full-batch step starts with a gradient pass over the weights the
+    // last step left, which gives the training error of its snapshot
+    bool errorFromRun = (!trial.reader
+                         && ((m_trainer == TRAINER_gradient)
+                             || (m_trainer == TRAINER_momentum)));
+
+    bool stopped = false;
+    int stepIdx = trial.stepsRun + 1;
+    lastStep = std::min(lastStep, trial.config.numSteps);
+    for ( ; stepIdx <= lastStep; ++stepIdx)
+    {
+      // run this step
+      double trainError = 0.00;
+      if (trial.reader)
+      {
+        // another pass just to measure the error would double the reading
+        trainError = grad.run(*trial.reader);
+        if (trial.reader->failed())
+        {
+          std::stringstream ss;
+          ss << "Failed while reading training data from file '"
+             << m_trainFile << "'";
+          logMessage(Context::PRIORITY_error, ss.str());
+          return false;
+        }
+      }
+      else
+      {
+        trainError = grad.run(trainData);
+
+        // the last step's snapshot may be the result of training
+        if (stepIdx == lastStep)
+        {
+          grad.finish(trainData);
+        }
+      }
+
+      // a stop decided by the last step discards this one
+      if (evaluation.join()
+          && !recordStep(trial, evaluation.getStep(),
+                         (errorFromRun ? trainError
+                          : evaluation.getTrainError()),
+                         evaluation.getTestError(),
+                         evaluation.getNetwork()))
+      {
+        stopped = true;
+        break;
+      }
+
+      trial.stepsRun = stepIdx;
+      trial.lastStepTrainError = trainError;
+
+      if (!m_checkpointFile.empty()
+          && (::time(0) - trial.savedTime >= m_checkpointInterval))
+      {
+        saveTrial(trial);
+      }
 
-     grad = GradDescentPtr(
-        new MomentumGradDescent(trainNeuralNet, m_eta, m_alpha, m_beta));
+      // with no later step to measure it, the last snapshot's training
+      // error is measured with its testing error
+      bool measureTrainError = (!trial.reader
+                                && (!errorFromRun || (stepIdx == lastStep)));
+      evaluation.start(trainNeuralNet, stepIdx, measureTrainError,
+                       trainError);
     }
-    else
+
+    if (!stopped
+        && evaluation.join()
+        && !recordStep(trial, evaluation.getStep(),
+                       evaluation.getTrainError(),
+                       evaluation.getTestError(),
+                       evaluation.getNetwork()))
     {
-      getContext() << Context::PRIORITY_debug1
-                   << "Using gradient descent (eta = " << m_eta << ")"
-                   << Context::endl;
+      stopped = true;
+    }
+
+    trial.done = (stopped || (stepIdx > trial.config.numSteps));
 
-      grad = GradDescentPtr(
-        new GradDescent(trainNeuralNet, m_eta));
+    // a finished restart isn't trained again on resume
+    if (trial.done && !m_checkpointFile.empty())
+    {
+      saveTrial(trial);
     }
 
+    return true;
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::recordStep(Trial<TNeuralNet>& trial,
+                                int stepIdx,
+                                double trainError,
+                                double testError,
+                                const TNeuralNet& network)
+  {
     const int reportFreq = 1;
-    const int colWidth1 = 8;
-    const int colWidth2 = 15;
-    const int totalWidth = colWidth1 + colWidth2 * 2 + 5;
-    const int prec = 8;
-    
+    bool showIndex = (m_search || (m_numRestarts > 1));
+    assert(stepIdx == int(trial.testError.size()) + 1);
+
+    ++trial.stepsSinceImprovement;
+
+    // save these error rates
+    trial.trainError.push_back(trainError);
+    trial.testError.push_back(testError);
+
+    bool doReport = false;
+
+    // if this error is better than our known best...
+    if (testError < trial.minTestErr)
     {
+      // we got a better error -- report this
+      doReport = true;
 
-      getContext() << Context::PRIORITY_info
-                   << std::setfill('-')
-                   << std::setw(totalWidth) << ""
-                   << Context::endl;
+      // update known best error
+      trial.minTestErr = testError;
+      trial.minTestErrIdx = stepIdx;
+
+      // save the network
+      trial.best = network;
 
+      // note that we improved
+      trial.stepsSinceImprovement = 0;
+    }
+    else if ((m_autoStopSteps >= 0)
+             && (trial.stepsSinceImprovement >= m_autoStopSteps))
+    {
       std::stringstream ss;
-      ss << std::left << std::setw(colWidth1) << "Step"
-         << std::left << std::setw(colWidth2) << "TrainErr"
-         << std::left << std::setw(colWidth2) << "TestErr";
+      if (showIndex)
+      {
+        ss << (m_search ? "Trial " : "Restart ") << trial.index << ": ";
+      }
 
-      getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+      ss << "Stopping early at step " << stepIdx << " after "
+         << trial.stepsSinceImprovement << " steps without improvement";
+      logMessage(Context::PRIORITY_info, ss.str());
 
-      getContext() << Context::PRIORITY_info
-                   << std::setfill('-') << std::setw(totalWidth) << ""
-                   << Context::endl;
+      return false;
+    }
+
+    // report at least every reportFreq steps
+    if (!(stepIdx % reportFreq))
+    {
+      doReport = true;
+    }
+
+    // print progress messages
+    if (doReport)
+    {
+      std::stringstream ss;
+      if (showIndex)
+      {
+        ss << std::left << std::setw(colWidth1) << trial.index;
+      }
+
+      ss << std::left << std::setw(colWidth1) << stepIdx
+         << std::left << std::setw(colWidth2)
+         << std::setprecision(prec) << trainError
+         << std::left << std::setw(colWidth2)
+         << std::setprecision(prec) << testError;
+
+      // if this was a new low then we print a pretty little flag
+      if (testError == trial.minTestErr)
+      {
+        ss << " <";
+      }
+
+      logMessage(Context::PRIORITY_info, ss.str());
     }
 
-    int minTestErrIdx = 0;
-    double minTestErr = NeuralNetAlg::calculateError(*trainNeuralNet,
-                                                     m_testData);
+    return true;
+  }
 
-    std::vector<double> trainErrorVec;
-    trainErrorVec.reserve(m_numSteps);
 
-    std::vector<double> testErrorVec;
-    testErrorVec.reserve(m_numSteps);
+  template <class TNeuralNet>
+  void AlchemyTrain::saveTrial(Trial<TNeuralNet>& trial)
+  {
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    writeTrialState(os, trial);
+    std::string state(os.str());
+    trial.savedTime = ::time(0);
+
+    // the checkpoint is made under the lock but written outside it, so
+    // the other trials aren't held up by the disk
+    int number = 0;
+    std::string data;
+    {
+      boost::mutex::scoped_lock lock(m_trainMutex);
+      m_trialStates[trial.index].swap(state);
 
-    int stepsSinceImprovement = 0;
+      if (trial.savedTime - m_lastCheckpoint >= m_checkpointInterval)
+      {
+        number = makeCheckpoint(sizeof(typename TNeuralNet::Scalar), data);
+        m_lastCheckpoint = trial.savedTime;
+      }
+    }
 
-    for (int stepIdx = 1; stepIdx <= m_numSteps; ++stepIdx)
+    // a failed checkpoint only puts more training at risk
+    if (number && !writeCheckpoint(number, data))
     {
-      // run this step
-      assert(grad.get());
-      grad->run(m_trainData);
+      logMessage(Context::PRIORITY_warning,
+                 "Failed to write checkpoint; continuing");
+    }
+  }
 
-      ++stepsSinceImprovement;
 
-      // calculate what the new error is for the neural net
-      double testError = NeuralNetAlg::calculateError(*trainNeuralNet,
-                                                      m_testData);
-      double trainError = NeuralNetAlg::calculateError(*trainNeuralNet,
-                                                       m_trainData);
+  template <class TNeuralNet>
+  void AlchemyTrain::writeTrialState(std::ostream& os,
+                                     const Trial<TNeuralNet>& trial)
+  {
+    bool stoppedEarly = (trial.done
+                         && (trial.stepsRun < trial.config.numSteps));
+
+    StateIO::write(os, trial.stepsRun);
+    StateIO::write(os, trial.lastStepTrainError);
+    StateIO::write(os, stoppedEarly);
+    StateIO::write(os, trial.minTestErr);
+    StateIO::write(os, trial.minTestErrIdx);
+    StateIO::write(os, trial.stepsSinceImprovement);
+    StateIO::write(os, trial.trainError);
+    StateIO::write(os, trial.testError);
+    writeNetwork(os, *trial.network);
+    writeNetwork(os, trial.best);
+    trial.trainer->writeState(os);
+
+    StateIO::write(os, bool(trial.reader));
+    if (trial.reader)
+    {
+      trial.reader->writeState(os);
+    }
+  }
+
 
-      // save these error rates
-      trainErrorVec.push_back(trainError);
-      testErrorVec.push_back(testError);
+  template <class TNeuralNet>
+  bool AlchemyTrain::readTrialState(std::istream& is,
+                                    Trial<TNeuralNet>& trial)
+  {
+    assert(trial.trainer.get());
+
+    bool stoppedEarly = false;
+    bool haveReader = false;
+    if (!StateIO::read(is, trial.stepsRun)
+        || !StateIO::read(is, trial.lastStepTrainError)
+        || !StateIO::read(is, stoppedEarly)
+        || !StateIO::read(is, trial.minTestErr)
+        || !StateIO::read(is, trial.minTestErrIdx)
+        || !StateIO::read(is, trial.stepsSinceImprovement)
+        || !StateIO::read(is, trial.trainError)
+        || !StateIO::read(is, trial.testError)
+        || !readNetwork(is, *trial.network)
+        || !readNetwork(is, trial.best)
+        || !trial.trainer->readState(is)
+        || !StateIO::read(is, haveReader)
+        || (haveReader != bool(trial.reader))
+        || (haveReader && !trial.reader->readState(is)))
+    {
+      return false;
+    }
 
-      bool doReport = false;
+    // the errors of the last step may not have been measured yet
+    int numRecorded = int(trial.testError.size());
+    if ((int(trial.trainError.size()) != numRecorded)
+        || (trial.stepsRun < numRecorded)
+        || (trial.stepsRun > numRecorded + 1))
+    {
+      return false;
+    }
 
-      // if this error is better than our known best...
-      if (testError < minTestErr)
-      {
-        // we got a better error -- report this
-        doReport = true;
+    // more steps than before continue a trial that ran out of steps
+    trial.done = (stoppedEarly
+                  || ((trial.stepsRun >= trial.config.numSteps)
+                      && (trial.stepsRun == numRecorded)));
+    return true;
+  }
 
-        // update known best error
-        minTestErr = testError;
-        minTestErrIdx = stepIdx;
-        
-        // save the network
-        *neuralNet = *trainNeuralNet;
 
-        // note that we improved
-        stepsSinceImprovement = 0;
-      }
-      else if ((m_autoStopSteps >= 0)
-               && (stepsSinceImprovement >= m_autoStopSteps))
+  template <class TNeuralNet>
+  bool AlchemyTrain::resumeTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData)
+  {
+    std::ifstream ifs(m_checkpointFile.c_str(),
+                      std::ios::in | std::ios::binary);
+    if (!ifs)
+    {
+      getContext() << Context::PRIORITY_info
+                   << "No checkpoint file '" << m_checkpointFile
+                   << "' to resume from; starting from the profile"
+                   << Context::endl;
+      return true;
+    }
+
+    boost::uint32_t magic = 0;
+    boost::uint32_t version = 0;
+    boost::uint32_t trainer = 0;
+    boost::uint32_t scalarSize = 0;
+    boost::uint32_t numTrials = 0;
+    if (!StateIO::read(ifs, magic) || (magic != checkpointMagic))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "File '" << m_checkpointFile
+                   << "' is not a checkpoint file"
+                   << Context::endl;
+      return false;
+    }
+
+    if (!StateIO::read(ifs, version) || (version != checkpointVersion))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Checkpoint file '" << m_checkpointFile
+                   << "' has unsupported version " << version
+                   << Context::endl;
+      return false;
+    }
+
+    if (!StateIO::read(ifs, trainer)
+        || !StateIO::read(ifs, scalarSize)
+        || !StateIO::read(ifs, numTrials)
+        || (trainer != boost::uint32_t(m_trainer))
+        || (scalarSize != sizeof(typename TNeuralNet::Scalar))
+        || (numTrials != trials.size()))
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Checkpoint file '" << m_checkpointFile
+                   << "' is from a run with another trainer, precision "
+                   << "or number of restarts"
+                   << Context::endl;
+      return false;
+    }
+
+    for (int index = 0; index < int(trials.size()); ++index)
+    {
+      std::string state;
+      if (!StateIO::read(ifs, state))
       {
-        getContext() << Context::PRIORITY_info
-                     << "Stopping early at step " << stepIdx << " after "
-                     << stepsSinceImprovement << " steps without improvement"
+        getContext() << Context::PRIORITY_error
+                     << "Checkpoint file '" << m_checkpointFile
+                     << "' is truncated"
                      << Context::endl;
-        break;
+        return false;
       }
 
-      // report at least every reportFreq steps
-      if (!(stepIdx % reportFreq))
+      // restarts that hadn't started start over
+      if (state.empty())
       {
-        doReport = true;
+        continue;
       }
 
-      // print progress messages
-      if (doReport)
+      Trial<TNeuralNet>& trial = *trials[index];
+      if (!startTrial(trial, trainData, testData))
       {
-        std::stringstream ss;
-        ss << std::left << std::setw(colWidth1) << stepIdx
-           << std::left << std::setw(colWidth2)
-           << std::setprecision(prec) << trainError
-           << std::left << std::setw(colWidth2)
-           << std::setprecision(prec) << testError;
-
-        // if this was a new low then we print a pretty little flag
-        if (testError == minTestErr)
-        {
-          ss << " <";
-        }
+        return false;
+      }
 
-        getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+      std::istringstream is(state, std::ios::in | std::ios::binary);
+      if (!readTrialState(is, trial))
+      {
+        getContext() << Context::PRIORITY_error
+                     << "Checkpoint file '" << m_checkpointFile
+                     << "' has invalid state for restart " << index
+                     << Context::endl;
+        return false;
       }
+
+      getContext() << Context::PRIORITY_info
+                   << "Resuming restart " << index << " after step "
+                   << trial.stepsRun << (trial.done ? " (done)" : "")
+                   << Context::endl;
+
+      m_trialStates[index].swap(state);
+    }
+
+    return true;
+  }
+
+
+  int AlchemyTrain::makeCheckpoint(int scalarSize, std::string& data)
+  {
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    StateIO::write(os, checkpointMagic);
+    StateIO::write(os, checkpointVersion);
+    StateIO::write(os, boost::uint32_t(m_trainer));
+    StateIO::write(os, boost::uint32_t(scalarSize));
+    StateIO::write(os, boost::uint32_t(m_trialStates.size()));
+    for (int index = 0; index < int(m_trialStates.size()); ++index)
+    {
+      StateIO::write(os, m_trialStates[index]);
+    }
+
+    data = os.str();
+    return ++m_numCheckpoints;
+  }
+
+
+  bool AlchemyTrain::writeCheckpoint(int number, const std::string& data)
+  {
+    boost::mutex::scoped_lock lock(m_checkpointMutex);
+
+    // trials that made their checkpoints in one order may get here in the
+    // other; the later checkpoint holds everything the earlier one does
+    if (number < m_writtenCheckpoint)
+    {
+      return true;
     }
 
+    // write a new file and rename it over the old one, so that a crash
+    // leaves one or the other intact
+    std::string tempName(m_checkpointFile + ".tmp");
+    int fd = ::open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
     {
       std::stringstream ss;
-      ss  << "Minimum testing error was at step "
-          << minTestErrIdx << ": "
-          << std::setprecision(prec) << minTestErr;
+      ss << "Failed to open '" << tempName << "': " << strerror(errno);
+      logMessage(Context::PRIORITY_error, ss.str());
+      return false;
+    }
 
-      getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+    const char* p = data.data();
+    std::size_t length = data.size();
+    bool ok = true;
+    while (ok && length)
+    {
+      ssize_t count = ::write(fd, p, length);
+      if (count > 0)
+      {
+        p += count;
+        length -= count;
+      }
+      else if ((count == 0) || (errno != EINTR))
+      {
+        ok = false;
+      }
     }
 
-    // plot the train and test error if requested
-    if (getOptions().getVariablesMap().count(s_optionPlot)
-        && !plotError(trainErrorVec, testErrorVec))
+    ok = (ok && (::fsync(fd) == 0));
+    ok = ((::close(fd) == 0) && ok);
+    if (!ok || (::rename(tempName.c_str(), m_checkpointFile.c_str()) == -1))
     {
-      getContext() << Context::PRIORITY_warning
-                   << "Failed to plot train and test error; continuing"
+      std::stringstream ss;
+      ss << "Failed to write checkpoint file '" << m_checkpointFile
+         << "': " << strerror(errno);
+      logMessage(Context::PRIORITY_error, ss.str());
+      ::unlink(tempName.c_str());
+      return false;
+    }
+
+    m_writtenCheckpoint = number;
+
+    // the rename is only durable once the directory is synced
+    std::string::size_type slash = m_checkpointFile.rfind('/');
+    std::string dirName((slash == std::string::npos) ? std::string(".")
+                        : m_checkpointFile.substr(0, slash + 1));
+    int dirFd = ::open(dirName.c_str(), O_RDONLY);
+    ok = ((dirFd != -1) && (::fsync(dirFd) == 0));
+    int syncErrno = errno;
+    if (dirFd != -1)
+    {
+      ::close(dirFd);
+    }
+
+    if (!ok)
+    {
+      std::stringstream ss;
+      ss << "Failed to sync directory '" << dirName << "' of checkpoint "
+         << "file '" << m_checkpointFile << "': " << strerror(syncErrno);
+      logMessage(Context::PRIORITY_error, ss.str());
+      return false;
+    }
+
+    return true;
+  }
+
+
+  template <class TNeuralNet>
+  bool AlchemyTrain::writeLeaderboard(
+    const std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int profileHiddenUnits)
+  {
+    std::ofstream ofs(m_leaderboardFile.c_str());
+    if (!ofs)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to open file '" << m_leaderboardFile
+                   << "' for writing"
+                   << Context::endl;
+      return false;
+    }
+
+    ofs << "rank,trial,eta,alpha,beta,steps,hidden,min_test_error,"
+        << "best_step,steps_run,status\n";
+
+    for (int rank = 0; rank < int(trials.size()); ++rank)
+    {
+      const Trial<TNeuralNet>& trial = *trials[rank];
+      int stepsRun = int(trial.testError.size());
+
+      const char* status = "completed";
+      if (trial.prunedStep)
+      {
+        status = "pruned";
+      }
+      else if (stepsRun < trial.config.numSteps)
+      {
+        status = "stopped";
+      }
+
+      ofs << (rank + 1) << ','
+          << trial.index << ','
+          << std::setprecision(prec) << trial.config.eta << ','
+          << std::setprecision(prec) << trial.config.alpha << ','
+          << std::setprecision(prec) << trial.config.beta << ','
+          << trial.config.numSteps << ','
+          << (trial.config.numHiddenUnits ? trial.config.numHiddenUnits
+              : profileHiddenUnits) << ','
+          << std::setprecision(prec) << trial.minTestErr << ','
+          << trial.minTestErrIdx << ','
+          << stepsRun << ','
+          << status << '\n';
+    }
+
+    ofs.close();
+    if (!ofs)
+    {
+      getContext() << Context::PRIORITY_error
+                   << "Failed to write leaderboard to '" << m_leaderboardFile
+                   << "'"
                    << Context::endl;
+      return false;
     }
 
+    getContext() << Context::PRIORITY_info
+                 << "Wrote " << trials.size() << " trials to leaderboard '"
+                 << m_leaderboardFile << "'"
+                 << Context::endl;
+
     return true;
   }
 
 
+  void AlchemyTrain::printErrorHeader()
+  {
+    bool showIndex = (m_search || (m_numRestarts > 1));
+    int totalWidth = colWidth1 + colWidth2 * 2 + 5;
+    if (showIndex)
+    {
+      totalWidth += colWidth1;
+    }
+
+    getContext() << Context::PRIORITY_info
+                 << std::setfill('-')
+                 << std::setw(totalWidth) << ""
+                 << Context::endl;
+
+    std::stringstream ss;
+    if (showIndex)
+    {
+      ss << std::left << std::setw(colWidth1)
+         << (m_search ? "Trial" : "Restart");
+    }
+
+    ss << std::left << std::setw(colWidth1) << "Step"
+       << std::left << std::setw(colWidth2) << "TrainErr"
+       << std::left << std::setw(colWidth2) << "TestErr";
+
+    getContext() << Context::PRIORITY_info << ss.str() << Context::endl;
+
+    getContext() << Context::PRIORITY_info
+                 << std::setfill('-') << std::setw(totalWidth) << ""
+                 << Context::endl;
+  }
+
+
+  void AlchemyTrain::logMessage(Context::Priority priority,
+                                const std::string& text)
+  {
+    boost::mutex::scoped_lock lock(m_trainMutex);
+    getContext() << priority << text << Context::endl;
+  }
+
+
   bool AlchemyTrain::writeProfile()
   {
     if (!ProfileIO::write(m_profileName.c_str(), m_profile, getContext()))
@@ -6,6 +6,17 @@
 #include "afwk/Framework.h"
 #include "stocknnet/PredictionProfile.h"
 #include "nnet/NNetDataset.h"
+#include "nnet/NNetDataReader.h"
+#include "nnet/GradDescent.h"
+
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include <cassert>
+#include <time.h>
 
 namespace alch {
 
@@ -48,6 +59,16 @@ protected:
 
  private:
 
+  //! Training algorithms that can be selected with --trainer
+  enum Trainer
+  {
+    TRAINER_gradient,
+    TRAINER_momentum,
+    TRAINER_minibatch,
+    TRAINER_adam,
+    TRAINER_rmsprop
+  };
+
   static const char* const s_optionTrain;
   static const char* const s_optionTest;
   static const char* const s_optionProfile;
@@ -57,29 +78,438 @@ protected:
   static const char* const s_optionBeta;
   static const char* const s_optionSteps;
   static const char* const s_optionMomentum;
+  static const char* const s_optionBatch;
+  static const char* const s_optionTrainer;
   static const char* const s_optionAutoStop;
- 
+  static const char* const s_optionThreads;
+  static const char* const s_optionPrecision;
+  static const char* const s_optionBlock;
+  static const char* const s_optionRestarts;
+  static const char* const s_optionJobs;
+  static const char* const s_optionSearchEta;
+  static const char* const s_optionSearchAlpha;
+  static const char* const s_optionSearchBeta;
+  static const char* const s_optionSearchSteps;
+  static const char* const s_optionSearchHidden;
+  static const char* const s_optionTrials;
+  static const char* const s_optionRung;
+  static const char* const s_optionLeaderboard;
+  static const char* const s_optionCheckpoint;
+  static const char* const s_optionCheckpointInterval;
+  static const char* const s_optionResume;
+
+  //! Values to search for one hyperparameter
+  struct SearchRange
+  {
+    //! Values of a grid, or empty for a random range
+    std::vector<double> values;
+
+    //! Lower bound of a random range
+    double min;
+
+    //! Upper bound of a random range
+    double max;
+  };
+
+  //! Hyperparameters of one trial
+  struct TrialConfig
+  {
+    double eta;
+    double alpha;
+    double beta;
+    int numSteps;
+
+    //! Units in each hidden layer, or 0 to keep the profile's layers
+    int numHiddenUnits;
+  };
+
+  //! One copy of the network being trained and the outcome; a restart or
+  //! a search trial
+  template <class TNeuralNet>
+  struct Trial
+  {
+    Trial(int trialIndex,
+          const TrialConfig& trialConfig,
+          const TNeuralNet& startNeuralNet)
+      : index(trialIndex)
+      , config(trialConfig)
+      , network(new TNeuralNet(startNeuralNet))
+      , trainer()
+      , reader()
+      , best(startNeuralNet)
+      , minTestErr(0.00)
+      , minTestErrIdx(0)
+      , stepsSinceImprovement(0)
+      , trainError()
+      , testError()
+      , stepsRun(0)
+      , lastStepTrainError(0.00)
+      , prunedStep(0)
+      , done(false)
+      , ok(true)
+      , savedTime(0)
+    {
+      ;
+    }
+
+    //! Index of the trial; seeds its random number generators
+    int index;
+
+    //! Hyperparameters to train with
+    TrialConfig config;
+
+    //! Network being trained
+    boost::shared_ptr<TNeuralNet> network;
+
+    //! Trainer of network; created by the first step
+    boost::shared_ptr<GradDescentTemplate<TNeuralNet> > trainer;
+
+    //! Reader of the training data when it is streamed
+    boost::shared_ptr<NNetDataReaderTemplate<typename TNeuralNet::Scalar> >
+    reader;
+
+    //! Network with the lowest testing error so far
+    TNeuralNet best;
+
+    //! Testing error of best
+    double minTestErr;
+
+    //! Step after which network was best, or 0 if it never improved
+    int minTestErrIdx;
+
+    //! Steps since the testing error last improved
+    int stepsSinceImprovement;
+
+    //! Training error after each step
+    std::vector<double> trainError;
+
+    //! Testing error after each step
+    std::vector<double> testError;
+
+    //! Steps trained; one more than recorded while the errors of the
+    //! last step are being measured
+    int stepsRun;
+
+    //! Training error returned by the trainer for the last step
+    double lastStepTrainError;
+
+    //! Step at which the search pruned the trial, or 0
+    int prunedStep;
+
+    //! Whether all steps have run or training stopped early
+    bool done;
+
+    //! Whether training succeeded
+    bool ok;
+
+    //! When the trial's state was last saved for a checkpoint
+    time_t savedTime;
+  };
 
   std::string m_trainFile;
   std::string m_testFile;
   std::string m_profileName;
-  bool m_useMomentum;
+  Trainer m_trainer;
+  int m_batchSize;
   double m_eta;
   double m_alpha;
   double m_beta;
   int m_numSteps;
   int m_autoStopSteps;
+  int m_numThreads;
+
+  //! Number of points per block when streaming the training data, or 0
+  //! to read it all into m_trainData
+  int m_blockSize;
+
+  //! Number of copies of the network to train
+  int m_numRestarts;
+
+  //! Number of restarts or trials trained at once
+  int m_numJobs;
+
+  //! Whether to search hyperparameters instead of training the profile
+  bool m_search;
+  SearchRange m_searchEta;
+  SearchRange m_searchAlpha;
+  SearchRange m_searchBeta;
+  SearchRange m_searchSteps;
+  SearchRange m_searchHidden;
+
+  //! Number of trials drawn when a hyperparameter has a random range
+  int m_numTrials;
+
+  //! Steps to the first successive halving rung
+  int m_rungSteps;
+
+  //! Name of CSV file to write the search results to
+  std::string m_leaderboardFile;
+
+  //! Name of file to save training state to, or empty for none
+  std::string m_checkpointFile;
+
+  //! Seconds between checkpoints
+  int m_checkpointInterval;
+
+  //! Whether to resume training from m_checkpointFile
+  bool m_resume;
+
+  //! Saved state of each restart, or empty if it hasn't started; guarded
+  //! by m_trainMutex
+  std::vector<std::string> m_trialStates;
+
+  //! When m_checkpointFile was last written; guarded by m_trainMutex
+  time_t m_lastCheckpoint;
+
+  //! Number of checkpoints made by makeCheckpoint(); guarded by
+  //! m_trainMutex
+  int m_numCheckpoints;
+
+  //! Number of the checkpoint in m_checkpointFile; guarded by
+  //! m_checkpointMutex
+  int m_writtenCheckpoint;
+
+  PredictionProfile::Precision m_precision;
   PredictionProfile m_profile;
   NNetDataset m_trainData;
   NNetDataset m_testData;
 
+  //! Guards the context and the next trial while trials train
+  boost::mutex m_trainMutex;
+
+  //! Serializes writing m_checkpointFile, which is done without
+  //! m_trainMutex so that the other trials keep training
+  boost::mutex m_checkpointMutex;
+
   bool loadParams();
   void printParams();
+
+  /*!
+    \brief Parses the values to search for a hyperparameter
+    \param spec Comma separated grid values, or min:max for a random range
+    \param minValue Smallest value allowed
+    \param range [out] The values
+    \retval true Success
+    \retval false Error
+  */
+  static bool parseSearchRange(const std::string& spec,
+                               double minValue,
+                               SearchRange& range);
+
+  /*!
+    \brief Makes the hyperparameters of each search trial
+    \param configs [out] The hyperparameters
+
+    Grids are searched exhaustively unless some hyperparameter has a
+    random range, in which case m_numTrials configurations are drawn.
+  */
+  void makeSearchConfigs(std::vector<TrialConfig>& configs);
+
   bool readData(const std::string& filename,
                 NNetDataset& dataset,
                 const char* name);
   bool loadProfile();
   bool trainNeuralNet();
+  template <class TNeuralNet>
+  bool trainNeuralNet(const NNetDatasetTemplate<typename TNeuralNet::Scalar>&
+                      trainData,
+                      const NNetDatasetTemplate<typename TNeuralNet::Scalar>&
+                      testData);
+
+  /*!
+    \brief Trains search trials with successive halving
+    \retval true Success
+    \retval false Error
+
+    All trials run to m_rungSteps steps; then the worse half of those
+    still training is pruned, and the rest run to twice as many steps,
+    until every trial is done or pruned. Writes the leaderboard; the
+    profile is not changed.
+  */
+  template <class TNeuralNet>
+  bool searchNeuralNet(const NNetDatasetTemplate<typename TNeuralNet::Scalar>&
+                       trainData,
+                       const NNetDatasetTemplate<typename TNeuralNet::Scalar>&
+                       testData);
+
+  /*!
+    \brief Trains trials up to a step, m_numJobs at a time
+    \param trials The trials; any that are done are skipped
+    \param lastStep Step to stop each trial after
+    \param trainData Training data, unless it is streamed
+    \param testData Testing data
+    \retval true Success
+    \retval false Error in some trial
+  */
+  template <class TNeuralNet>
+  bool runTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData);
+
+  /*!
+    \brief Trains trials until none are left; run by each job
+    \param nextTrial [in/out] Index of the next trial to train; shared by
+    the jobs and guarded by m_trainMutex
+  */
+  template <class TNeuralNet>
+  void trainTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int& nextTrial,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData);
+
+  /*!
+    \brief Trains one trial up to a step, logging its error after each step
+    \retval true Success
+    \retval false Error
+
+    The errors of each step are measured in a background thread while
+    the next step trains; see recordStep().
+  */
+  template <class TNeuralNet>
+  bool trainTrial(
+    Trial<TNeuralNet>& trial,
+    int lastStep,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData);
+
+  /*!
+    \brief Records the errors measured after a step of a trial
+    \param trial The trial
+    \param stepIdx The step; the one after the last recorded
+    \param trainError Training error after the step
+    \param testError Testing error after the step
+    \param network Snapshot of the network after the step
+    \retval true Training goes on
+    \retval false Training should stop early
+  */
+  template <class TNeuralNet>
+  bool recordStep(Trial<TNeuralNet>& trial,
+                  int stepIdx,
+                  double trainError,
+                  double testError,
+                  const TNeuralNet& network);
+
+  //! Creates the trainer and reader of a trial before its first step
+  template <class TNeuralNet>
+  bool startTrial(
+    Trial<TNeuralNet>& trial,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData);
+
+  /*!
+    \brief Saves the state of a trial for the checkpoint, and writes the
+    checkpoint file if it is due
+    \param trial The trial; its errors must be recorded up to the step
+    before the last one trained
+
+    Each trial saves its own state between steps, so the checkpoint file
+    holds the latest state of every trial without stopping the others.
+  */
+  template <class TNeuralNet>
+  void saveTrial(Trial<TNeuralNet>& trial);
+
+  /*!
+    \brief Writes the state needed to resume a trial
+    \param os The output stream; should be opened in binary mode
+    \param trial The trial
+
+    Holds the weights, the trainer's and reader's state and the progress
+    so far; see GradDescentTemplate::writeState().
+  */
+  template <class TNeuralNet>
+  static void writeTrialState(std::ostream& os,
+                              const Trial<TNeuralNet>& trial);
+
+  /*!
+    \brief Reads the state written by writeTrialState()
+    \param is The input stream; should be opened in binary mode
+    \param trial [in/out] The trial, after startTrial()
+    \retval true Success
+    \retval false Error; the state is corrupt or doesn't fit the trial
+  */
+  template <class TNeuralNet>
+  bool readTrialState(std::istream& is, Trial<TNeuralNet>& trial);
+
+  /*!
+    \brief Resumes restarts from the checkpoint file
+    \param trials [in/out] The restarts, before training
+    \retval true Success, or no checkpoint file yet
+    \retval false Error; the file is corrupt or from other options
+  */
+  template <class TNeuralNet>
+  bool resumeTrials(
+    std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& trainData,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& testData);
+
+  /*!
+    \brief Serializes m_trialStates for the checkpoint file
+    \param scalarSize Size of the scalar type of the networks
+    \param data [out] The contents of the checkpoint file
+    \return Number of the checkpoint, for writeCheckpoint()
+
+    Call with m_trainMutex held.
+  */
+  int makeCheckpoint(int scalarSize, std::string& data);
+
+  /*!
+    \brief Writes a checkpoint made by makeCheckpoint() to the checkpoint
+    file
+    \param number Number of the checkpoint
+    \param data The contents of the checkpoint file
+    \retval true Success, or a later checkpoint has already been written
+    \retval false Error; the last checkpoint file is left in place
+
+    Writes a temporary file and renames it over the checkpoint, so the
+    checkpoint is never left half written, then syncs the directory so
+    the rename survives a crash. Call without m_trainMutex held.
+  */
+  bool writeCheckpoint(int number, const std::string& data);
+
+  //! Orders trials by their minimum testing error
+  template <class TNeuralNet>
+  static bool isBetterTrial(const boost::shared_ptr<Trial<TNeuralNet> >& a,
+                            const boost::shared_ptr<Trial<TNeuralNet> >& b)
+  {
+    return (a->minTestErr < b->minTestErr);
+  }
+
+  //! Orders trials by their testing error after step; both must have
+  //! run at least that many steps
+  template <class TNeuralNet>
+  static bool isBetterAtStep(const boost::shared_ptr<Trial<TNeuralNet> >& a,
+                             const boost::shared_ptr<Trial<TNeuralNet> >& b,
+                             int step)
+  {
+    assert(step >= 1);
+    assert(step <= int(a->testError.size()));
+    assert(step <= int(b->testError.size()));
+    return (a->testError[step - 1] < b->testError[step - 1]);
+  }
+
+  /*!
+    \brief Writes the search results
+    \param trials The trials, best first
+    \param profileHiddenUnits Units in the profile's first hidden layer,
+    reported for trials that keep the profile's layers
+    \retval true Success
+    \retval false Error
+  */
+  template <class TNeuralNet>
+  bool writeLeaderboard(
+    const std::vector<boost::shared_ptr<Trial<TNeuralNet> > >& trials,
+    int profileHiddenUnits);
+
+  //! Logs the header of the table of training progress
+  void printErrorHeader();
+
+  //! Logs a message; safe to call while trials train
+  void logMessage(Context::Priority priority, const std::string& text);
+
   bool writeProfile();
   bool plotError(const std::vector<double>& trainError,
                  const std::vector<double>& testError);
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "TestCSVDataStream.h"
+#include "TestUnixSocket.h"
 
 int main(int argc, char** argv)
 {
@@ -11,6 +12,7 @@ int main(int argc, char** argv)
   CppUnit::TextUi::TestRunner runner;
 
   runner.addTest(TestCSVDataStream::suite());
+  runner.addTest(TestUnixSocket::suite());
 
   return !runner.run();
 }
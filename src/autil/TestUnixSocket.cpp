@@ -0,0 +1,130 @@
+#include "TestUnixSocket.h"
+
+#include <sstream>
+#include <iostream>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+namespace alch
+{
+
+void TestUnixSocket::setUp() 
+{
+  std::ostringstream oss;
+  oss << "/tmp/alchemy-test-" << ::getpid() << ".sock";
+  m_path = oss.str();
+}
+
+void TestUnixSocket::tearDown()
+{
+  m_ctx.dump(std::cerr);
+}
+
+void TestUnixSocket::test1()
+{
+  UnixSocket server;
+  CPPUNIT_ASSERT(server.listen(m_path, m_ctx));
+
+  // the connection is queued until it's accepted
+  UnixSocket client;
+  CPPUNIT_ASSERT(client.connect(m_path, m_ctx));
+
+  UnixSocket connection;
+  CPPUNIT_ASSERT(server.accept(connection, m_ctx));
+  CPPUNIT_ASSERT(connection.isOpen());
+
+  // empty, binary and large messages
+  std::string binary("a\0b\n", 4);
+  std::string large(300000, 'x');
+  for (int i = 0; i < int(large.size()); i += 7)
+  {
+    large[i] = char(i);
+  }
+
+  CPPUNIT_ASSERT(client.writeMessage("score IBM", m_ctx));
+  CPPUNIT_ASSERT(client.writeMessage("", m_ctx));
+  CPPUNIT_ASSERT(client.writeMessage(binary, m_ctx));
+
+  std::string message;
+  CPPUNIT_ASSERT(connection.readMessage(message, m_ctx));
+  CPPUNIT_ASSERT_EQUAL(std::string("score IBM"), message);
+  CPPUNIT_ASSERT(connection.readMessage(message, m_ctx));
+  CPPUNIT_ASSERT_EQUAL(std::string(), message);
+  CPPUNIT_ASSERT(connection.readMessage(message, m_ctx));
+  CPPUNIT_ASSERT(binary == message);
+
+  // larger than the socket buffer, so the reader has to take it in parts;
+  // the writer blocks until then, so it writes from its own process
+  pid_t pid = ::fork();
+  CPPUNIT_ASSERT(pid != -1);
+  if (pid == 0)
+  {
+    connection.writeMessage(large, m_ctx);
+    ::_exit(0);
+  }
+
+  CPPUNIT_ASSERT(client.readMessage(message, m_ctx));
+  CPPUNIT_ASSERT(large == message);
+  ::waitpid(pid, 0, 0);
+
+  // the socket file goes away with the listening socket
+  server.close();
+  struct stat st;
+  CPPUNIT_ASSERT(::stat(m_path.c_str(), &st) == -1);
+}
+
+void TestUnixSocket::test2()
+{
+  // keep the messages to check them
+  m_ctx.setFlushFrequency(-1);
+  std::string message;
+
+  // a socket file left behind by a server that is gone is replaced
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  CPPUNIT_ASSERT(fd != -1);
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, m_path.c_str(), sizeof(address.sun_path) - 1);
+  CPPUNIT_ASSERT(::bind(fd, reinterpret_cast<sockaddr*>(&address),
+                        sizeof(address)) == 0);
+  ::close(fd);
+
+  UnixSocket server;
+  CPPUNIT_ASSERT(server.listen(m_path, m_ctx));
+  CPPUNIT_ASSERT(m_ctx.getMessages().empty());
+
+  // a second server doesn't take the path from a running one
+  UnixSocket other;
+  CPPUNIT_ASSERT(!other.listen(m_path, m_ctx));
+  CPPUNIT_ASSERT(!other.isOpen());
+  CPPUNIT_ASSERT(!m_ctx.getMessages().empty());
+  m_ctx.clear();
+
+  // it found out by connecting, and closed without sending anything
+  UnixSocket connection;
+  CPPUNIT_ASSERT(server.accept(connection, m_ctx));
+  CPPUNIT_ASSERT(!connection.readMessage(message, m_ctx));
+
+  UnixSocket client;
+  CPPUNIT_ASSERT(client.connect(m_path, m_ctx));
+  CPPUNIT_ASSERT(server.accept(connection, m_ctx));
+
+  // closing between messages isn't an error
+  client.close();
+  CPPUNIT_ASSERT(!connection.readMessage(message, m_ctx));
+  CPPUNIT_ASSERT(m_ctx.getMessages().empty());
+
+  // nothing listens once the server is closed
+  server.close();
+  CPPUNIT_ASSERT(!client.connect(m_path, m_ctx));
+  CPPUNIT_ASSERT(!client.isOpen());
+  CPPUNIT_ASSERT(!m_ctx.getMessages().empty());
+  m_ctx.clear();
+}
+
+} // namespace alch
@@ -0,0 +1,50 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_autil_TestUnixSocket_h
+#define INCLUDED_autil_TestUnixSocket_h
+
+#include "autil/UnixSocket.h"
+#include "autil/Context.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestUnixSocket : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestUnixSocket);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Passes messages both ways over a connection
+  void test1();
+
+  //! Checks closing connections and servers
+  void test2();
+
+
+private:
+  Context m_ctx;
+
+  //! Path of the socket file for the test
+  std::string m_path;
+
+};
+
+} // namespace alch
+
+#endif
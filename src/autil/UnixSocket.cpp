@@ -0,0 +1,301 @@
+#include "autil/UnixSocket.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace alch
+{
+
+const unsigned int UnixSocket::s_maxMessageSize = 64 * 1024 * 1024;
+
+namespace
+{
+  // fills in the address of the socket file at path
+  bool makeAddress(const std::string& path,
+                   sockaddr_un& address,
+                   Context& ctx)
+  {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (path.empty() || (path.size() >= sizeof(address.sun_path)))
+    {
+      ctx << Context::PRIORITY_error
+          << "Invalid socket path '" << path << "'"
+          << Context::endl;
+      return false;
+    }
+
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+  }
+}
+
+
+UnixSocket::UnixSocket()
+  : m_fd(-1)
+  , m_path()
+{
+  ;
+}
+
+UnixSocket::~UnixSocket()
+{
+  close();
+}
+
+bool UnixSocket::listen(const std::string& path, Context& ctx)
+{
+  close();
+
+  sockaddr_un address;
+  if (!makeAddress(path, address, ctx))
+  {
+    return false;
+  }
+
+  // a socket file left behind by an earlier server would make bind()
+  // fail, but one a running server listens on must be left alone
+  struct stat st;
+  if ((::stat(path.c_str(), &st) == 0) && S_ISSOCK(st.st_mode))
+  {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to listen on '" << path << "': " << strerror(errno)
+          << Context::endl;
+      return false;
+    }
+
+    int result;
+    do
+    {
+      result = ::connect(fd, reinterpret_cast<sockaddr*>(&address),
+                         sizeof(address));
+    } while ((result == -1) && (errno == EINTR));
+    int connectErrno = errno;
+    ::close(fd);
+
+    if (result == 0)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to listen on '" << path << "': a server is already "
+          << "listening there"
+          << Context::endl;
+      return false;
+    }
+
+    if (connectErrno == ECONNREFUSED)
+    {
+      ::unlink(path.c_str());
+    }
+  }
+
+  m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((m_fd == -1)
+      || (::bind(m_fd, reinterpret_cast<sockaddr*>(&address),
+                 sizeof(address)) == -1)
+      || (::listen(m_fd, SOMAXCONN) == -1))
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to listen on '" << path << "': " << strerror(errno)
+        << Context::endl;
+    close();
+    return false;
+  }
+
+  m_path = path;
+  return true;
+}
+
+bool UnixSocket::accept(UnixSocket& connection, Context& ctx)
+{
+  connection.close();
+
+  int fd;
+  do
+  {
+    fd = ::accept(m_fd, 0, 0);
+  } while ((fd == -1) && (errno == EINTR));
+
+  if (fd == -1)
+  {
+    int acceptErrno = errno;
+    ctx << Context::PRIORITY_error
+        << "Failed to accept connection on '" << m_path << "': "
+        << strerror(acceptErrno)
+        << Context::endl;
+    errno = acceptErrno;
+    return false;
+  }
+
+  connection.m_fd = fd;
+  return true;
+}
+
+bool UnixSocket::connect(const std::string& path, Context& ctx)
+{
+  close();
+
+  sockaddr_un address;
+  if (!makeAddress(path, address, ctx))
+  {
+    return false;
+  }
+
+  m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((m_fd == -1)
+      || (::connect(m_fd, reinterpret_cast<sockaddr*>(&address),
+                    sizeof(address)) == -1))
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to connect to '" << path << "': " << strerror(errno)
+        << Context::endl;
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+bool UnixSocket::readMessage(std::string& message, Context& ctx)
+{
+  unsigned char header[4];
+  std::size_t numRead = 0;
+  if (!readFully(reinterpret_cast<char*>(header), sizeof(header), numRead))
+  {
+    // the other end closing between messages is how a connection ends
+    if (numRead || errno)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to read message length: "
+          << (errno ? strerror(errno) : "connection closed")
+          << Context::endl;
+    }
+    return false;
+  }
+
+  unsigned int length = ((static_cast<unsigned int>(header[0]) << 24)
+                         | (static_cast<unsigned int>(header[1]) << 16)
+                         | (static_cast<unsigned int>(header[2]) << 8)
+                         | static_cast<unsigned int>(header[3]));
+  if (length > s_maxMessageSize)
+  {
+    ctx << Context::PRIORITY_error
+        << "Message of " << length << " bytes is larger than the limit of "
+        << s_maxMessageSize
+        << Context::endl;
+    return false;
+  }
+
+  message.resize(length);
+  if (length && !readFully(&message[0], length, numRead))
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to read message of " << length << " bytes: "
+        << (errno ? strerror(errno) : "connection closed")
+        << Context::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool UnixSocket::writeMessage(const std::string& message, Context& ctx)
+{
+  if (message.size() > s_maxMessageSize)
+  {
+    ctx << Context::PRIORITY_error
+        << "Message of " << message.size() << " bytes is larger than the "
+        << "limit of " << s_maxMessageSize
+        << Context::endl;
+    return false;
+  }
+
+  unsigned int length = message.size();
+  unsigned char header[4];
+  header[0] = (length >> 24) & 0xff;
+  header[1] = (length >> 16) & 0xff;
+  header[2] = (length >> 8) & 0xff;
+  header[3] = length & 0xff;
+
+  if (!writeFully(reinterpret_cast<const char*>(header), sizeof(header))
+      || !writeFully(message.data(), message.size()))
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to write message of " << length << " bytes: "
+        << strerror(errno)
+        << Context::endl;
+    return false;
+  }
+
+  return true;
+}
+
+void UnixSocket::close()
+{
+  if (m_fd != -1)
+  {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+
+  if (!m_path.empty())
+  {
+    ::unlink(m_path.c_str());
+    m_path.clear();
+  }
+}
+
+bool UnixSocket::readFully(char* buf, std::size_t n, std::size_t& numRead)
+{
+  numRead = 0;
+  while (numRead < n)
+  {
+    ssize_t count = ::read(m_fd, buf + numRead, n - numRead);
+    if (count > 0)
+    {
+      numRead += count;
+    }
+    else if (count == 0)
+    {
+      errno = 0;
+      return false;
+    }
+    else if (errno != EINTR)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool UnixSocket::writeFully(const char* buf, std::size_t n)
+{
+  std::size_t numWritten = 0;
+  while (numWritten < n)
+  {
+    // a client that went away must not kill the server with SIGPIPE
+    ssize_t count = ::send(m_fd, buf + numWritten, n - numWritten,
+                           MSG_NOSIGNAL);
+    if (count >= 0)
+    {
+      numWritten += count;
+    }
+    else if (errno != EINTR)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace alch
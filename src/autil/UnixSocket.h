@@ -0,0 +1,131 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_autil_UnixSocket_h
+#define INCLUDED_autil_UnixSocket_h
+
+#include "autil/Context.h"
+
+#include <string>
+
+namespace alch
+{
+
+/*!
+  \brief Stream socket in the Unix domain carrying length-prefixed
+  messages
+  \ingroup autil
+
+  A socket either listens for connections on a path in the filesystem or
+  is one end of a connection. Each message on a connection is a 4 byte
+  length in network byte order followed by that many bytes. Messages may
+  hold any bytes; they are passed around as std::string.
+
+  Calls block until they are complete. The socket is closed when the
+  object is destroyed.
+*/
+class UnixSocket
+{
+public:
+  //! Largest message readMessage() accepts, so that a corrupt length
+  //! can't make it allocate without bound
+  static const unsigned int s_maxMessageSize;
+
+  /*!
+    \brief Constructor; the socket isn't open until listen(), accept() or
+    connect() is called
+  */
+  UnixSocket();
+
+  /*!
+    \brief Destructor; closes the socket
+  */
+  ~UnixSocket();
+
+  /*!
+    \brief Listens for connections on the specified path
+    \param path Path of the socket file; a socket file left there by a
+    server that is gone is replaced, but if a server answers on it this
+    fails
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error
+  */
+  bool listen(const std::string& path, Context& ctx);
+
+  /*!
+    \brief Waits for the next connection to a listening socket
+    \param connection [out] Receives the new connection
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error; errno tells which, so that a server can tell
+    errors of a single connection from those of the socket
+  */
+  bool accept(UnixSocket& connection, Context& ctx);
+
+  /*!
+    \brief Connects to a socket listening on the specified path
+    \param path Path of the socket file
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error
+  */
+  bool connect(const std::string& path, Context& ctx);
+
+  /*!
+    \brief Reads the next message from a connection
+    \param message [out] The message
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error, or the other end closed the connection; the
+    latter is not logged if it happens between messages
+  */
+  bool readMessage(std::string& message, Context& ctx);
+
+  /*!
+    \brief Writes a message to a connection
+    \param message The message
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error
+  */
+  bool writeMessage(const std::string& message, Context& ctx);
+
+  /*!
+    \brief Closes the socket
+
+    A listening socket also removes its socket file.
+  */
+  void close();
+
+  //! Whether the socket is open
+  bool isOpen() const
+  {
+    return (m_fd != -1);
+  }
+
+private:
+  // not implemented; the descriptor can't be shared
+  UnixSocket(const UnixSocket&);
+  UnixSocket& operator=(const UnixSocket&);
+
+  /*!
+    \brief Reads exactly n bytes
+    \retval true Success
+    \retval false Error or end of file; numRead holds the bytes read and
+    errno is 0 at end of file
+  */
+  bool readFully(char* buf, std::size_t n, std::size_t& numRead);
+
+  //! Writes exactly n bytes
+  bool writeFully(const char* buf, std::size_t n);
+
+  //! The socket descriptor, or -1
+  int m_fd;
+
+  //! Path of the socket file if this socket is listening, otherwise empty
+  std::string m_path;
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,121 @@
+
+#include "nnet/AdamGradDescent.h"
+#include "nnet/StateIO.h"
+
+#include <cmath>
+
+namespace alch {
+
+template <class TNeuralNet>
+AdamGradDescentTemplate<TNeuralNet>::AdamGradDescentTemplate(
+  NetworkPtr network,
+  double eta,
+  int batchSize,
+  long seed,
+  double beta1,
+  double beta2,
+  double epsilon)
+  : MiniBatchGradDescentTemplate<TNeuralNet>(network, eta, batchSize, seed)
+  , m_beta1(beta1)
+  , m_beta2(beta2)
+  , m_epsilon(epsilon)
+  , m_numUpdates(0)
+  , m_moment1()
+  , m_moment2()
+{
+  assert((m_beta1 >= 0.00) && (m_beta1 < 1.00));
+  assert((m_beta2 >= 0.00) && (m_beta2 < 1.00));
+  assert(m_epsilon > 0.00);
+
+  // moments start at zero, matching the network's weight blocks
+  int numLayers = network->getNumLayers();
+  m_moment1.resize(numLayers);
+  m_moment2.resize(numLayers);
+  for (int layer = 1; layer < numLayers; ++layer)
+  {
+    int numWeights = int(network->getLayerWeight(layer).size());
+    m_moment1[layer].resize(numWeights, 0.00);
+    m_moment2[layer].resize(numWeights, 0.00);
+  }
+}
+
+
+template <class TNeuralNet>
+void AdamGradDescentTemplate<TNeuralNet>::writeState(std::ostream& os) const
+{
+  MiniBatchGradDescentTemplate<TNeuralNet>::writeState(os);
+
+  StateIO::write(os, m_numUpdates);
+  StateIO::write(os, m_moment1);
+  StateIO::write(os, m_moment2);
+}
+
+
+template <class TNeuralNet>
+bool AdamGradDescentTemplate<TNeuralNet>::readState(std::istream& is)
+{
+  std::vector<LayerWeight> moment1;
+  std::vector<LayerWeight> moment2;
+  if (!MiniBatchGradDescentTemplate<TNeuralNet>::readState(is)
+      || !StateIO::read(is, m_numUpdates)
+      || !StateIO::read(is, moment1)
+      || !StateIO::read(is, moment2)
+      || !StateIO::sameShape(moment1, m_moment1)
+      || !StateIO::sameShape(moment2, m_moment2))
+  {
+    return false;
+  }
+
+  m_moment1.swap(moment1);
+  m_moment2.swap(moment2);
+  return true;
+}
+
+
+template <class TNeuralNet>
+double AdamGradDescentTemplate<TNeuralNet>::updateWeights(double eta)
+{
+  ++m_numUpdates;
+
+  // fold the bias corrections of both averages into the step size
+  double correction1 = 1.00 - ::pow(m_beta1, m_numUpdates);
+  double correction2 = 1.00 - ::pow(m_beta2, m_numUpdates);
+  double step = eta * ::sqrt(correction2) / correction1;
+  double epsilon = m_epsilon * ::sqrt(correction2);
+
+  // The constant unit rows and the row padding of the weight deltas are
+  // always zero, so the moments there stay zero and so do the updates.
+  double change = 0.00;
+  TNeuralNet& net = *this->getNetwork();
+  int numLayers = net.getNumLayers();
+  for (int layer = 1; layer < numLayers; ++layer)
+  {
+    Scalar* weight = &net.getLayerWeight(layer)[0];
+    const Scalar* weightDelta = &this->getWeightDelta(layer)[0];
+    Scalar* moment1 = &m_moment1[layer][0];
+    Scalar* moment2 = &m_moment2[layer][0];
+    int numWeights = int(m_moment1[layer].size());
+
+    assert(static_cast<int>(net.getLayerWeight(layer).size()) == numWeights);
+
+    for (int i = 0; i < numWeights; ++i)
+    {
+      double d = weightDelta[i];
+      moment1[i] = m_beta1 * moment1[i] + (1.00 - m_beta1) * d;
+      moment2[i] = m_beta2 * moment2[i] + (1.00 - m_beta2) * d * d;
+      double diff = step * moment1[i] / (::sqrt(moment2[i]) + epsilon);
+      weight[i] -= diff;
+      change -= d * diff;
+    }
+  }
+
+  return change;
+}
+
+// the network types we train
+template class AdamGradDescentTemplate<TanhNeuralNet>;
+template class AdamGradDescentTemplate<LinearNeuralNet>;
+template class AdamGradDescentTemplate<FloatTanhNeuralNet>;
+template class AdamGradDescentTemplate<FloatLinearNeuralNet>;
+
+} // namespace alch
@@ -0,0 +1,116 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_AdamGradDescent_h
+#define INCLUDED_nnet_AdamGradDescent_h
+
+#include <vector>
+#include <cassert>
+#include "nnet/NNetDataset.h"
+#include "nnet/NeuralNet.h"
+#include "nnet/MiniBatchGradDescent.h"
+
+namespace alch {
+
+/*!
+  \brief Class that trains a neural network with the Adam optimizer.
+
+  Keeps running averages of each weight's delta (first moment) and squared
+  delta (second moment), and moves each weight by
+
+    eta * m / (sqrt(v) + epsilon)
+
+  where m and v are the bias-corrected averages. This gives every weight
+  its own effective step size. The weights are updated once per mini-batch;
+  use a batch size of at least the dataset size for full-batch updates.
+*/
+template <class TNeuralNet>
+class AdamGradDescentTemplate : public MiniBatchGradDescentTemplate<TNeuralNet>
+{
+ public:
+
+  //! Shared pointer to the neural network being trained
+  typedef typename GradDescentTemplate<TNeuralNet>::NetworkPtr NetworkPtr;
+
+  //! Type of the weights and unit values
+  typedef typename GradDescentTemplate<TNeuralNet>::Scalar Scalar;
+
+  //! Type of dataset the network is trained on
+  typedef typename GradDescentTemplate<TNeuralNet>::Dataset Dataset;
+
+  //! The weights of a single layer
+  typedef typename GradDescentTemplate<TNeuralNet>::LayerWeight LayerWeight;
+
+  /*!
+    \brief Constructor
+    \param network The neural network on which we're performing gradient
+    descent.
+    \param eta The learning rate parameter
+    \param batchSize Number of data points per weight update
+    \param seed Seed for the random number generator used for shuffling
+    \param beta1 Decay rate of the first moment average
+    \param beta2 Decay rate of the second moment average
+    \param epsilon Added to the denominator to avoid dividing by zero
+  */
+  AdamGradDescentTemplate(NetworkPtr network,
+                          double eta = 0.001,
+                          int batchSize = 32,
+                          long seed = 0,
+                          double beta1 = 0.9,
+                          double beta2 = 0.999,
+                          double epsilon = 1e-8);
+
+
+  /*!
+    \brief Destructor
+  */
+  ~AdamGradDescentTemplate()
+  {
+  }
+
+
+  //! Also writes the moment averages; see GradDescentTemplate::writeState()
+  virtual void writeState(std::ostream& os) const;
+
+
+  //! Reads state written by writeState()
+  virtual bool readState(std::istream& is);
+
+
+ protected:
+
+  //! Updates all weights using the Adam rule
+  virtual double updateWeights(double eta);
+
+
+ private:
+
+  //! Decay rate of the first moment average
+  double m_beta1;
+
+  //! Decay rate of the second moment average
+  double m_beta2;
+
+  //! Added to the denominator to avoid dividing by zero
+  double m_epsilon;
+
+  //! Number of updates performed so far
+  int m_numUpdates;
+
+  //! Running average of the weight deltas. Same layout as
+  //! NeuralNet::getLayerWeight().
+  std::vector<LayerWeight> m_moment1;
+
+  //! Running average of the squared weight deltas. Same layout as
+  //! NeuralNet::getLayerWeight().
+  std::vector<LayerWeight> m_moment2;
+};
+
+//! AdamGradDescent for the default neural network type
+typedef AdamGradDescentTemplate<NeuralNet> AdamGradDescent;
+
+//! AdamGradDescent for the single precision neural network type
+typedef AdamGradDescentTemplate<FloatNeuralNet> FloatAdamGradDescent;
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,124 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_AlignedAllocator_h
+#define INCLUDED_nnet_AlignedAllocator_h
+
+#include <new>
+#include <cstddef>
+#include <stdlib.h>
+
+namespace alch {
+
+//! Alignment in bytes of all neural network buffers; wide enough for AVX
+const int c_nnetAlignment = 32;
+
+
+/*!
+  \brief STL allocator that returns memory aligned to c_nnetAlignment bytes
+  \ingroup nnet
+
+  Used for the neural network weight and activation buffers so that the
+  inner loops can use aligned SIMD loads.
+*/
+template <typename T>
+class AlignedAllocator
+{
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  //! Allows containers to allocate their internal node types
+  template <typename U>
+  struct rebind
+  {
+    typedef AlignedAllocator<U> other;
+  };
+
+  AlignedAllocator()
+  {
+    ;
+  }
+
+  AlignedAllocator(const AlignedAllocator&)
+  {
+    ;
+  }
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&)
+  {
+    ;
+  }
+
+  ~AlignedAllocator()
+  {
+    ;
+  }
+
+  pointer address(reference val) const
+  {
+    return &val;
+  }
+
+  const_pointer address(const_reference val) const
+  {
+    return &val;
+  }
+
+  //! Allocates space for n objects; throws std::bad_alloc on failure
+  pointer allocate(size_type n, const void* = 0)
+  {
+    if (!n)
+    {
+      return 0;
+    }
+
+    void* p = 0;
+    if (::posix_memalign(&p, c_nnetAlignment, n * sizeof(T)))
+    {
+      throw std::bad_alloc();
+    }
+    return static_cast<pointer>(p);
+  }
+
+  void deallocate(pointer p, size_type)
+  {
+    ::free(p);
+  }
+
+  size_type max_size() const
+  {
+    return (size_type(-1) / sizeof(T));
+  }
+
+  void construct(pointer p, const T& val)
+  {
+    new (static_cast<void*>(p)) T(val);
+  }
+
+  void destroy(pointer p)
+  {
+    p->~T();
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&)
+{
+  return false;
+}
+
+} // namespace alch
+
+#endif
@@ -1,8 +1,13 @@
 
 #include "nnet/GradDescent.h"
 #include "nnet/NeuralNet.h"
+#include "nnet/StateIO.h"
+
+#include "boost/bind.hpp"
+#include "boost/thread/thread.hpp"
 
 #include <cmath>
+#include <algorithm>
 
 #ifndef NDEBUG
 #include <iomanip>
@@ -12,292 +17,541 @@ namespace alch {
 
 //#define DEBUG_GRADDESCENT
 
-namespace {
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::setNumThreads(int val)
+{
+  assert(val >= 1);
+
+  // the threads are started again for the new workers when needed
+  stopThreads();
+  m_numThreads = val;
+  resize();
+}
+
+
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::run(const Dataset& data)
+{
+#ifdef DEBUG_GRADDESCENT
+  std::cerr << "*** GradDescent::run() ***\n";
+#endif
+
+  return runSubset(data, 0, int(data.size()));
+}
+
+
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::run(const Dataset& data,
+                                            double eta)
+{
+  setEta(eta);
+  return run(data);
+}
+
 
-  // derivative of activation function
-  double derivActivation(double d)
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::run(Reader& reader)
+{
+  double error = 0.00;
+  int numPoints = 0;
+  for (const Dataset* block = reader.next(); block; block = reader.next())
   {
-    d = ::tanh(d);
-    return (1.00 - (d * d));
+    error += run(*block) * block->size();
+    numPoints += int(block->size());
   }
-} // anonymous namespace
 
+  return (numPoints ? (error / numPoints) : 0.00);
+}
 
-void GradDescent::run(const NNetDataset& data)
+
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::writeState(std::ostream& os) const
+{
+  StateIO::write(os, m_eta);
+  StateIO::write(os, m_estimatedError);
+}
+
+
+template <class TNeuralNet>
+bool GradDescentTemplate<TNeuralNet>::readState(std::istream& is)
+{
+  return (StateIO::read(is, m_eta) && StateIO::read(is, m_estimatedError));
+}
+
+
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::runSubset(const Dataset& data,
+                                                  const int* order,
+                                                  int numPoints)
+{
+  double error = computeWeightDelta(data, order, numPoints);
+  double change = updateWeights(getEta());
+  setEstimatedError(estimateError(error, change, numPoints));
+  return error;
+}
+
+
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::computeWeightDelta(
+  const Dataset& data,
+  const int* order,
+  int numPoints)
 {
   assert(m_network.get());
+  assert(static_cast<int>(m_worker.size()) == m_numThreads);
+  assert(numPoints >= 0);
 
-  clearWeightDelta();
+  // no point starting threads that would have no data points
+  int numWorkers = std::max(1, std::min(m_numThreads, numPoints));
 
-#ifdef DEBUG_GRADDESCENT
-  std::cerr << "*** GradDescent::run() ***\n";
-#endif
+  // the threads are kept for the following updates, so a trainer that
+  // updates once per mini-batch or block doesn't start threads each time
+  if ((numWorkers > 1) && !m_threads)
+  {
+    m_threads.reset(new boost::thread_group);
+    for (int index = 1; index < m_numThreads; ++index)
+    {
+      m_threads->create_thread(
+        boost::bind(&GradDescentTemplate::runThread, this, index));
+    }
+  }
 
-  NNetDataset::const_iterator end = data.end();
-  NNetDataset::const_iterator iter;
-  for (iter = data.begin(); iter != end; ++iter)
   {
-#ifdef DEBUG_GRADDESCENT
-    std::cerr << "Datapoint: ";
-    iter->dump(std::cerr);
-#endif
+    boost::mutex::scoped_lock lock(m_threadMutex);
+    if (!m_barrier || (numWorkers != m_requestNumWorkers))
+    {
+      m_barrier.reset(new boost::barrier(numWorkers));
+    }
 
-    clearDelta();
-    
-    m_network->propagateInput(iter->input);
+    m_requestData = &data;
+    m_requestOrder = order;
+    m_requestNumPoints = numPoints;
+    m_requestNumWorkers = numWorkers;
+    if (numWorkers > 1)
+    {
+      m_numRunning = numWorkers - 1;
+      ++m_numRequests;
+      m_startCondition.notify_all();
+    }
+  }
 
-#ifdef DEBUG_GRADDESCENT
-    m_network->dump(std::cerr);
-#endif
+  // worker 0 runs on this thread
+  runWorker(0, numWorkers, data, order, numPoints, *m_barrier);
 
-    computeOutputDelta(iter->output);
+  {
+    boost::mutex::scoped_lock lock(m_threadMutex);
+    while (m_numRunning)
+    {
+      m_doneCondition.wait(lock);
+    }
 
-    computeDelta();
+    m_requestData = 0;
+    m_requestOrder = 0;
+  }
 
-    addDeltaToTotal();
+  // .25 times the mean squared error, as NeuralNetAlg::calculateError()
+  int totalPoints = numPoints * (m_network->getNumOutputUnits() - 1);
+  if (totalPoints <= 0)
+  {
+    return 0.00;
   }
 
-  updateWeights(getEta());
+  return 0.25 * m_worker[0].error / (double) totalPoints;
 }
 
 
-void GradDescent::run(const NNetDataset& data, double eta)
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::estimateError(double error,
+                                                      double change,
+                                                      int numPoints) const
 {
-  setEta(eta);
-  run(data);
+  // The weight deltas are the gradient of half the sum of squared errors;
+  // the error is a quarter of its mean, so its gradient is half the
+  // weight deltas over the number of outputs summed.
+  int totalPoints = numPoints * (m_network->getNumOutputUnits() - 1);
+  if (totalPoints <= 0)
+  {
+    return error;
+  }
+
+  return error + 0.5 * change / (double) totalPoints;
 }
 
 
-void GradDescent::clearDelta()
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::runWorker(int index,
+                                                int numWorkers,
+                                                const Dataset& data,
+                                                const int* order,
+                                                int numPoints,
+                                                boost::barrier& barrier)
 {
-  int numLayers = m_network->getNumLayers();
+  assert(index >= 0);
+  assert(index < numWorkers);
+  assert(numWorkers <= m_numThreads);
 
-  assert(static_cast<int>(m_delta.size()) == numLayers);
+  Worker& worker = m_worker[index];
+  clearWeightDelta(worker);
+  worker.error = 0.00;
 
-  for (int layer = 0; layer < numLayers; ++layer)
+  // contiguous slice of the points; depends only on the number of workers
+  // so that results are repeatable
+  assert(!numPoints
+         || (data.getNumOutputs() + 1 == m_network->getNumOutputUnits()));
+
+  int begin = int((long long)numPoints * index / numWorkers);
+  int end = int((long long)numPoints * (index + 1) / numWorkers);
+
+  for (int pos = begin; pos < end; ++pos)
+  {
+    int idx = (order ? order[pos] : pos);
+    assert(idx >= 0);
+    assert(idx < static_cast<int>(data.size()));
+
+#ifdef DEBUG_GRADDESCENT
+    std::cerr << "Datapoint: ";
+    data[idx].dump(std::cerr);
+#endif
+
+    clearDelta(worker);
+    
+    m_network->propagateInput(data.getInput(idx), worker.workspace);
+
+#ifdef DEBUG_GRADDESCENT
+    worker.workspace.dump(std::cerr);
+#endif
+
+    computeOutputDelta(worker, data.getOutput(idx));
+
+    computeDelta(worker);
+
+    addDeltaToTotal(worker);
+  }
+
+  // tree reduction: in each round worker i adds in worker i + step, once
+  // both have finished the previous round
+  for (int step = 1; step < numWorkers; step *= 2)
   {
-    int numUnits = m_network->getNumUnits(layer);
+    barrier.wait();
 
-    assert(static_cast<int>(m_delta[layer].size()) == numUnits);
+    int other = index + step;
+    if ((index % (2 * step)) || (other >= numWorkers))
+    {
+      continue;
+    }
 
-    for (int unit = 0; unit < numUnits; ++unit)
+    worker.error += m_worker[other].error;
+
+    int numLayers = m_network->getNumLayers();
+    for (int layer = 1; layer < numLayers; ++layer)
     {
-      m_delta[layer][unit] = 0.00;
+      Scalar* total = &worker.weightDelta[layer][0];
+      const Scalar* part = &m_worker[other].weightDelta[layer][0];
+      int numWeights = int(worker.weightDelta[layer].size());
+
+      for (int i = 0; i < numWeights; ++i)
+      {
+        total[i] += part[i];
+      }
     }
   }
 }
 
 
-void GradDescent::clearWeightDelta()
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::runThread(int index)
 {
-  int numLayers = m_network->getNumLayers();
-
-  assert(static_cast<int>(m_weightDelta.size()) == numLayers);
-
-  for (int layer = 1; layer < numLayers; ++layer)
+  int numRequests = 0;
+  for (;;)
   {
-    // number of units in prev layer
-    int numUnitsPrevLayer = m_network->getNumUnits(layer - 1);
-    assert(static_cast<int>(m_weightDelta[layer].size()) == numUnitsPrevLayer);
-
-    for (int prevUnit = 0; prevUnit < numUnitsPrevLayer; ++prevUnit)
+    const Dataset* data;
+    const int* order;
+    int numPoints;
+    int numWorkers;
+    boost::barrier* barrier;
     {
-      // number of units in this layer
-      int numUnitsThisLayer = m_network->getNumUnits(layer);
-      assert(static_cast<int>(m_weightDelta[layer][prevUnit].size())
-             == numUnitsThisLayer);
+      boost::mutex::scoped_lock lock(m_threadMutex);
+      while (!m_stopThreads && (m_numRequests == numRequests))
+      {
+        m_startCondition.wait(lock);
+      }
 
-      for (int unit = 0; unit < numUnitsThisLayer; ++unit)
+      if (m_stopThreads)
       {
-        m_weightDelta[layer][prevUnit][unit] = 0.00;
+        return;
       }
+
+      numRequests = m_numRequests;
+      data = m_requestData;
+      order = m_requestOrder;
+      numPoints = m_requestNumPoints;
+      numWorkers = m_requestNumWorkers;
+      barrier = m_barrier.get();
+    }
+
+    // updates with fewer points than threads leave the last threads idle
+    if (index >= numWorkers)
+    {
+      continue;
+    }
+
+    runWorker(index, numWorkers, *data, order, numPoints, *barrier);
+
+    boost::mutex::scoped_lock lock(m_threadMutex);
+    if (!--m_numRunning)
+    {
+      m_doneCondition.notify_all();
     }
   }
 }
 
 
-void GradDescent::resize()
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::stopThreads()
 {
-  // size the deltas
-  m_delta.clear();
+  if (!m_threads)
+  {
+    return;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(m_threadMutex);
+    m_stopThreads = true;
+    m_startCondition.notify_all();
+  }
+
+  m_threads->join_all();
+  m_threads.reset();
+  m_barrier.reset();
+  m_stopThreads = false;
+}
+
 
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::clearDelta(Worker& worker)
+{
   int numLayers = m_network->getNumLayers();
-  m_delta.resize(numLayers);
+
+  assert(static_cast<int>(worker.delta.size()) == numLayers);
 
   for (int layer = 0; layer < numLayers; ++layer)
   {
-    int numUnits = m_network->getNumUnits(layer);
-    m_delta[layer].resize(numUnits, 0.00);
+    assert(static_cast<int>(worker.delta[layer].size())
+           == m_network->getStride(layer));
+
+    std::fill(worker.delta[layer].begin(), worker.delta[layer].end(), 0.00);
   }
+}
+
+
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::clearWeightDelta(Worker& worker)
+{
+  int numLayers = m_network->getNumLayers();
+
+  assert(static_cast<int>(worker.weightDelta.size()) == numLayers);
 
-  // size the weight deltas
-  m_weightDelta.clear();
-  m_weightDelta.resize(numLayers);
   for (int layer = 1; layer < numLayers; ++layer)
   {
-    // number of units in prev layer
-    int numUnits = m_network->getNumUnits(layer - 1);
+    assert(worker.weightDelta[layer].size()
+           == m_network->getLayerWeight(layer).size());
 
-    m_weightDelta[layer].resize(numUnits);
+    std::fill(worker.weightDelta[layer].begin(),
+              worker.weightDelta[layer].end(),
+              0.00);
+  }
+}
+
+
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::resize()
+{
+  int numLayers = m_network->getNumLayers();
+
+  m_worker.clear();
+  m_worker.resize(m_numThreads);
+
+  for (int index = 0; index < m_numThreads; ++index)
+  {
+    Worker& worker = m_worker[index];
+    worker.workspace.resize(*m_network);
+
+    // size the deltas
+    worker.delta.resize(numLayers);
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      worker.delta[layer].resize(m_network->getStride(layer), 0.00);
+    }
 
-    for (int prevUnit = 0; prevUnit < numUnits; ++prevUnit)
+    // size the weight deltas to match the network's weight blocks
+    worker.weightDelta.resize(numLayers);
+    for (int layer = 1; layer < numLayers; ++layer)
     {
-      // number of units in this layer
-      m_weightDelta[layer][prevUnit].resize(m_network->getNumUnits(layer),
-                                            0.00);
+      worker.weightDelta[layer].resize(
+        m_network->getLayerWeight(layer).size(), 0.00);
     }
   }
 }
 
 
-void GradDescent::updateWeights(double eta)
+template <class TNeuralNet>
+double GradDescentTemplate<TNeuralNet>::updateWeights(double eta)
 {
+  // The constant unit rows and the row padding of the weight deltas are
+  // always zero, so we can stream through each weight block in one pass.
+  double sumSquares = 0.00;
   int numLayers = m_network->getNumLayers();
   for (int layer = 1; layer < numLayers; ++layer)
   {
-    int prevLayer = layer - 1;
-    int numUnitsPrevLayer = m_network->getNumUnits(prevLayer);
-    int numUnitsThisLayer = m_network->getNumUnits(layer);
+    LayerWeight& weight = m_network->getLayerWeight(layer);
+    const LayerWeight& weightDelta = getWeightDelta(layer);
+    int numWeights = int(weight.size());
 
-    for (int prevUnit = 0; prevUnit < numUnitsPrevLayer; ++prevUnit)
-    {
-      // don't need to update weight for constant unit 0
-      for (int unit = 1; unit < numUnitsThisLayer; ++unit)
-      {
-        // get a reference to existing weight
-        double& weight = m_network->getWeight(layer, prevUnit, unit);
+    assert(weightDelta.size() == weight.size());
 
+    for (int i = 0; i < numWeights; ++i)
+    {
 #ifdef DEBUG_GRADDESCENT
-        std::cerr << "Begin: weight[" << layer << "][" << prevUnit
-                  << "][" << unit << "] = " << weight << "\n";
-        std::cerr << "eta(" << eta
-                  << ") * weightDelta(" << m_weightDelta[layer][prevUnit][unit]
-                  << ") = " << (eta * m_weightDelta[layer][prevUnit][unit])
-                  << "\n";
+      std::cerr << "weight[" << layer << "][" << i << "] = " << weight[i]
+                << " - eta(" << eta << ") * weightDelta(" << weightDelta[i]
+                << ")\n";
 #endif
 
-        // update the weight
-        weight -= (eta * m_weightDelta[layer][prevUnit][unit]);
-
-
-#ifdef DEBUG_GRADDESCENT
-        std::cerr << "Updated weight: "
-                  << m_network->getWeight(layer, prevUnit, unit)
-                  << " or "
-                  << weight
-                  << std::endl;
-#endif
-      }
+      // update the weight
+      weight[i] -= (eta * weightDelta[i]);
+      sumSquares += (weightDelta[i] * weightDelta[i]);
     }
   }
+
+  return -eta * sumSquares;
 }
 
 
-void GradDescent::computeOutputDelta(const std::vector<double>& target)
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::computeOutputDelta(
+  Worker& worker,
+  const Scalar* target)
 {
   int numLayers = m_network->getNumLayers();
-  assert(static_cast<int>(m_delta.size()) == numLayers);
+  assert(static_cast<int>(worker.delta.size()) == numLayers);
 
   int outputLayer = numLayers - 1;
-  const std::vector<double>& output = m_network->getOutput();
+  const LayerValue& output = worker.workspace.getOutput();
   
   int numUnits = m_network->getNumUnits(outputLayer);
 
-  assert(static_cast<int>(m_delta[outputLayer].size()) == numUnits);
+  assert(static_cast<int>(worker.delta[outputLayer].size()) == numUnits);
   assert(static_cast<int>(output.size()) == numUnits);
-  assert(output.size() == target.size() + 1);
 
   for (int unit = 1; unit < numUnits; ++unit)
   {
 #ifdef DEBUG_GRADDESCENT
-    std::cerr << "m_delta[" << outputLayer << "][" << unit << "] = "
-              << "output[unit](" << output[unit] << ") - target[unit]("
-              << target[unit - 1] << ")\n";
+    std::cerr << "worker.delta[" << outputLayer << "][" << unit << "] = "
+              << "(output[unit](" << output[unit] << ") - target[unit]("
+              << target[unit - 1] << ")) * derivative\n";
 #endif
-    m_delta[outputLayer][unit] = (output[unit] - target[unit - 1]);
+    double diff = output[unit] - target[unit - 1];
+    worker.delta[outputLayer][unit]
+      = diff * Network::OutputActivation::derivative(output[unit]);
+    worker.error += (diff * diff);
   }
 }
 
 
-void GradDescent::computeDelta()
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::computeDelta(Worker& worker)
 {
-  int numLayers = m_network->getNumLayers();
-  assert(static_cast<int>(m_delta.size()) == numLayers);
+  const Network& net = *m_network;
+  int numLayers = net.getNumLayers();
+  assert(static_cast<int>(worker.delta.size()) == numLayers);
 
   // start at second to last layer
   for (int layer = numLayers - 2; layer >= 1; --layer)
   {
     int nextLayer = layer + 1;
-    int numUnitsNextLayer = m_network->getNumUnits(nextLayer);
-    int numUnitsThisLayer = m_network->getNumUnits(layer);
+    int numUnitsNextLayer = net.getNumUnits(nextLayer);
+    int numUnitsThisLayer = net.getNumUnits(layer);
+    int stride = net.getStride(layer);
 
-    assert(static_cast<int>(m_delta[layer].size()) == numUnitsThisLayer);
+    assert(static_cast<int>(worker.delta[layer].size()) == stride);
 
-    // calculate all deltas except for constant unit
-    for (int unit = 1; unit < numUnitsThisLayer; ++unit)
+    // Sum delta*weight for the layer above. Rather than walking a column
+    // of the next layer's weights per unit, we add each next unit's weight
+    // row scaled by its delta, so the weights are read in memory order.
+    Scalar* sumDeltas = &worker.delta[layer][0];
+    const Scalar* nextDelta = &worker.delta[nextLayer][0];
+    const Scalar* row = &net.getLayerWeight(nextLayer)[0];
+
+    std::fill(sumDeltas, sumDeltas + stride, 0.00);
+
+    for (int nextUnit = 1; nextUnit < numUnitsNextLayer; ++nextUnit)
     {
-      // sum all delta*weights for above layer
-      double sumDeltas = 0.00;
-      for (int nextUnit = 1; nextUnit < numUnitsNextLayer; ++nextUnit)
+      row += stride;
+      double d = nextDelta[nextUnit];
+
+      for (int unit = 0; unit < stride; ++unit)
       {
-        sumDeltas += (m_network->getWeight(nextLayer, unit, nextUnit)
-                      * m_delta[nextLayer][nextUnit]);
+        sumDeltas[unit] += (row[unit] * d);
       }
-      m_delta[layer][unit]
-        = (derivActivation(m_network->getUnitInput(layer, unit))
-           * sumDeltas);
+    }
+
+    // calculate all deltas except for constant unit; the derivative is
+    // taken from the unit outputs of the forward pass
+    const Scalar* output = &worker.workspace.getLayerOutput(layer)[0];
+    sumDeltas[0] = 0.00;
+    for (int unit = 1; unit < numUnitsThisLayer; ++unit)
+    {
+      sumDeltas[unit] *= Network::Activation::derivative(output[unit]);
     }
   }
 
 }
 
-void GradDescent::addDeltaToTotal()
+template <class TNeuralNet>
+void GradDescentTemplate<TNeuralNet>::addDeltaToTotal(Worker& worker)
 {
-  int numLayers = m_network->getNumLayers();
-  assert(static_cast<int>(m_delta.size()) == numLayers);
-  assert(static_cast<int>(m_weightDelta.size()) == numLayers);
+  const Network& net = *m_network;
+  int numLayers = net.getNumLayers();
+  assert(static_cast<int>(worker.delta.size()) == numLayers);
+  assert(static_cast<int>(worker.weightDelta.size()) == numLayers);
 
   for (int layer = 1; layer < numLayers; ++layer)
   {
     int prevLayer = layer - 1;
-    int numUnitsPrevLayer = m_network->getNumUnits(prevLayer);
-    int numUnitsThisLayer = m_network->getNumUnits(layer);
+    int prevStride = net.getStride(prevLayer);
+    int numUnitsThisLayer = net.getNumUnits(layer);
+
+    assert(static_cast<int>(worker.weightDelta[layer].size())
+           == numUnitsThisLayer * prevStride);
 
-    assert(static_cast<int>(m_delta[layer].size()) == numUnitsThisLayer);
-    assert(static_cast<int>(m_weightDelta[layer].size()) == numUnitsPrevLayer);
+    const Scalar* prevOutput = &worker.workspace.getLayerOutput(prevLayer)[0];
+    Scalar* row = &worker.weightDelta[layer][0];
 
-    for (int prevUnit = 0; prevUnit < numUnitsPrevLayer; ++prevUnit)
+    // don't need to update weight for constant unit 0; the padded tail of
+    // prevOutput is zero so each row is updated over its full stride
+    for (int unit = 1; unit < numUnitsThisLayer; ++unit)
     {
-      assert(static_cast<int>(m_weightDelta[layer][prevUnit].size())
-             == numUnitsThisLayer);
+      row += prevStride;
+      double d = worker.delta[layer][unit];
 
-      // don't need to update weight for constant unit 0
-      for (int unit = 1; unit < numUnitsThisLayer; ++unit)
-      {
 #ifdef DEBUG_GRADDESCENT
-        std::cerr << "Begin: m_weightDelta[" << layer << "][" << prevUnit
-                  << "][" << unit << "] = "
-                  << m_weightDelta[layer][prevUnit][unit] << "\n";
-        std::cerr << "m_delta[layer][unit](" << m_delta[layer][unit]
-                  << ") * m_network->getUnitOutput(prevLayer, prevUnit)("
-                  << m_network->getUnitOutput(prevLayer, prevUnit)
-                  << ") = "
-                  << (m_delta[layer][unit]
-                      * m_network->getUnitOutput(prevLayer, prevUnit))
-                  << "\n";
+      std::cerr << "worker.delta[" << layer << "][" << unit << "] = " << d
+                << "\n";
 #endif
-        // update the weight
-        m_weightDelta[layer][prevUnit][unit] += 
-          m_delta[layer][unit] * m_network->getUnitOutput(prevLayer, prevUnit);
 
-#ifdef DEBUG_GRADDESCENT
-        std::cerr << "Updated weightDelta: " 
-                  << m_weightDelta[layer][prevUnit][unit] << "\n";
-#endif
+      for (int prevUnit = 0; prevUnit < prevStride; ++prevUnit)
+      {
+        row[prevUnit] += d * prevOutput[prevUnit];
       }
     }
   }
 }
 
+// the network types we train
+template class GradDescentTemplate<TanhNeuralNet>;
+template class GradDescentTemplate<LinearNeuralNet>;
+template class GradDescentTemplate<FloatTanhNeuralNet>;
+template class GradDescentTemplate<FloatLinearNeuralNet>;
+
 } // namespace alch
 
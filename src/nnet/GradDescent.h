@@ -4,31 +4,79 @@
 #define INCLUDED_nnet_GradDescent_h
 
 #include "nnet/NNetDataset.h"
+#include "nnet/NNetDataReader.h"
 #include "nnet/NeuralNet.h"
 
 #include "boost/shared_ptr.hpp"
+#include "boost/thread/barrier.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
 
 #include <vector>
+#include <iosfwd>
 #include <cassert>
 
 namespace alch {
 
 /*!
   \brief Class that performs gradient descent to train a neural network.
+
+  TNeuralNet is the NeuralNetTemplate instantiation being trained; the
+  deltas are computed with the derivatives of its activation functors.
+  Instantiated for TanhNeuralNet and LinearNeuralNet and their float
+  versions. Float networks accumulate the weight deltas in float; the
+  reported errors are summed in double.
 */
-class GradDescent
+template <class TNeuralNet>
+class GradDescentTemplate
 {
  public:
+
+  //! Type of neural network being trained
+  typedef TNeuralNet Network;
+
+  //! Shared pointer to the neural network being trained
+  typedef boost::shared_ptr<Network> NetworkPtr;
+
+  //! Type of the weights and unit values
+  typedef typename Network::Scalar Scalar;
+
+  //! Type of dataset the network is trained on
+  typedef NNetDatasetTemplate<Scalar> Dataset;
+
+  //! Type of reader the network can be trained from in blocks
+  typedef NNetDataReaderTemplate<Scalar> Reader;
+
+  //! The weights or weight deltas of a single layer
+  typedef typename Network::LayerWeight LayerWeight;
+
+  //! The values of all units in a single layer
+  typedef typename Network::LayerValue LayerValue;
+
   /*!
     \brief Constructor
     \param network The neural network on which we're performing gradient
     descent.
   */
-  GradDescent(NeuralNetPtr network, double eta = 0.001)
+  GradDescentTemplate(NetworkPtr network, double eta = 0.001)
     : m_network(network)
-    , m_delta()
-    , m_weightDelta()
+    , m_worker()
+    , m_numThreads(1)
     , m_eta(eta)
+    , m_estimatedError(0.00)
+    , m_threads()
+    , m_threadMutex()
+    , m_startCondition()
+    , m_doneCondition()
+    , m_numRequests(0)
+    , m_numRunning(0)
+    , m_stopThreads(false)
+    , m_barrier()
+    , m_requestData(0)
+    , m_requestOrder(0)
+    , m_requestNumPoints(0)
+    , m_requestNumWorkers(0)
   {
     assert(m_network.get());
     resize();
@@ -36,10 +84,11 @@ class GradDescent
 
 
   /*!
-    \brief Destructor
+    \brief Destructor; stops the worker threads
   */
-  virtual ~GradDescent()
+  virtual ~GradDescentTemplate()
   {
+    stopThreads();
   }
 
 
@@ -57,88 +106,364 @@ class GradDescent
   }
 
 
+  //! Returns number of threads used to compute the weight deltas
+  int getNumThreads() const
+  {
+    return m_numThreads;
+  }
+
+
+  /*!
+    \brief Sets number of threads used to compute the weight deltas
+    \param val Number of threads; must be at least 1
+
+    The data points of each update are split into val contiguous slices,
+    one per thread, and the per-thread totals are summed pairwise. Updates
+    with fewer points than threads use one thread per point. For a given
+    number of threads the result is always the same; a different number of
+    threads sums in a different order, so the trained weights may differ
+    in the last bits.
+
+    The threads are started by the first update and kept until the number
+    of threads changes or the trainer is destroyed.
+  */
+  void setNumThreads(int val);
+
+
   /*!
     \brief Runs a single iteration for given dataset
     \param data The dataset to run against
+    \return The training error of the weights before the update
 
     This method will train the network over one iteration for the given
-    dataset.
+    dataset. The error is measured like NeuralNetAlg::calculateError()
+    from the outputs the gradient pass computes anyway, so it costs no
+    extra propagation.
   */
-  virtual void run(const NNetDataset& data);
+  virtual double run(const Dataset& data);
 
 
   /*!
     \brief Runs a single iteration for given dataset
     \param data The dataset to run against
     \param eta The multiplier to use for training the weights
+    \return The training error of the weights before the update
+  */
+  double run(const Dataset& data, double eta);
 
-    This method will train the network over one iteration for the given
-    dataset.
+
+  /*!
+    \brief Runs a single iteration streaming the dataset from a reader
+    \param reader Reader over the dataset to run against
+    \return Mean over all points of the error of each block before its
+    update
+
+    Calls run() on each block of the rest of the reader's current pass, so
+    each block is trained on as a dataset of its own and the whole dataset
+    is never in memory. A full-batch trainer becomes a block-batch one;
+    with a block size of at least the dataset size, the result is the same
+    as calling run() on the whole dataset. Stops early if the reader fails;
+    check reader.failed() afterwards.
+  */
+  double run(Reader& reader);
+
+
+  /*!
+    \brief Settles any step run() has taken but not yet checked
+    \param data The dataset the steps were taken on
+
+    A trainer that checks each step with the gradient pass of the next
+    call leaves the network holding an unchecked step after run(). This
+    checks it, so that the network holds weights training keeps; call it
+    before taking the network as the result of training. Later calls to
+    run() take the same steps whether or not it was called. Does nothing
+    for trainers that don't check their steps.
+  */
+  virtual void finish(const Dataset& data)
+  {
+  }
+
+
+  /*!
+    \brief Writes the state needed to continue training later
+    \param os The output stream; should be opened in binary mode
+
+    The state includes eta and whatever the trainer has adapted or
+    accumulated, such as momentum averages and random number generators,
+    but not the network's weights or the trainer's fixed parameters. A
+    trainer made with the same parameters for a network holding the same
+    weights continues exactly where this one left off after readState().
+    The format is that of StateIO.
+  */
+  virtual void writeState(std::ostream& os) const;
+
+
+  /*!
+    \brief Reads state written by writeState()
+    \param is The input stream; should be opened in binary mode
+    \retval true Success
+    \retval false The stream failed or the state doesn't fit the network;
+    the trainer is left in an unspecified state
+  */
+  virtual bool readState(std::istream& is);
+
+
+  /*!
+    \brief Returns an estimate of the training error after the last update
+
+    The error before the update plus the first-order change predicted by
+    the gradient, over the points of the last update. It is cheap to
+    compute but only accurate for small steps; use
+    NeuralNetAlg::calculateError() when the exact error is needed.
   */
-  void run(const NNetDataset& data, double eta);
+  double getEstimatedError() const
+  {
+    return m_estimatedError;
+  }
 
 
 protected:
 
+  /*!
+    \brief Updates the weights once from a subset of a dataset
+    \param data The dataset
+    \param order Indices into data of the points to use, or 0 to use the
+    first numPoints points in order
+    \param numPoints Number of points to use
+    \return The error over the points before the update
+
+    Calls computeWeightDelta() and then updateWeights(), and sets the
+    estimated error.
+  */
+  double runSubset(const Dataset& data, const int* order, int numPoints);
+
+  /*!
+    \brief Sums the weight deltas over a subset of a dataset
+    \param data The dataset
+    \param order The points to use; see runSubset()
+    \param numPoints Number of points to use
+    \return The error over the points, measured like
+    NeuralNetAlg::calculateError()
+
+    The points are split across the threads as described for
+    setNumThreads(); worker 0 runs on the calling thread. The weights are
+    not changed.
+  */
+  double computeWeightDelta(const Dataset& data,
+                            const int* order,
+                            int numPoints);
+
+  /*!
+    \brief Updates all weights from the weight deltas of the last update
+    \param eta multiplier to use when updating the weights
+    \return Sum over all weights of the weight delta times the change in
+    the weight
+
+    Moves each weight by -eta times its weight delta. Subclasses override
+    this to use a different update rule; getWeightDelta() returns the
+    summed deltas.
+  */
+  virtual double updateWeights(double eta);
+
+  /*!
+    \brief Returns the first-order estimate of the error after an update
+    \param error The error before the update
+    \param change The value returned by updateWeights()
+    \param numPoints Number of points the weight deltas were summed over
+  */
+  double estimateError(double error, double change, int numPoints) const;
+
+  //! Sets the value returned by getEstimatedError()
+  void setEstimatedError(double val)
+  {
+    m_estimatedError = val;
+  }
+
+  /*!
+    \brief Returns the weight deltas summed over the points of an update
+    \param toLayer The layer [1..getNumLayers() - 1]
+
+    Uses the same row-major layout as NeuralNet::getLayerWeight(). The
+    constant unit row and the row padding are always zero.
+  */
+  const LayerWeight& getWeightDelta(int toLayer) const
+  {
+    assert(toLayer >= 1);
+    assert(toLayer < static_cast<int>(m_worker[0].weightDelta.size()));
+    return m_worker[0].weightDelta[toLayer];
+  }
+
+  /*!
+    \brief Exchanges the summed weight deltas with other
+    \param other Buffers in the layout returned by getWeightDelta(), e.g.
+    the deltas of an earlier update; receives the current ones
+
+    Only the buffers are exchanged, nothing is copied.
+  */
+  void swapWeightDelta(std::vector<LayerWeight>& other)
+  {
+    assert(other.size() == m_worker[0].weightDelta.size());
+    m_worker[0].weightDelta.swap(other);
+  }
+
   //! Returns neural network we're operating on
-  NeuralNetPtr getNetwork()
+  NetworkPtr getNetwork()
   {
     return m_network;
   }
 
   //! Sets neural network we're operating on
-  void setNetwork(NeuralNetPtr val)
+  void setNetwork(NetworkPtr val)
   {
     m_network = val;
   }
 
 
 private:
-  //! Resets values in m_delta to 0.00
-  void clearDelta();
+  // not implemented; a trainer owns its threads
+  GradDescentTemplate(const GradDescentTemplate&);
+  GradDescentTemplate& operator=(const GradDescentTemplate&);
+
+  //! State used by one thread to accumulate weight deltas over its slice
+  //! of the dataset
+  struct Worker
+  {
+    //! Unit values from propagating this worker's data points through
+    //! the shared network
+    typename Network::Workspace workspace;
+
+    //! Value of delta for each of unit. delta[layer][unit], padded to the
+    //! network's stride for each layer.
+    std::vector<LayerValue> delta;
+
+    //! Total adjustment to weight summed over the worker's data points.
+    //! Uses the same row-major layout as NeuralNet::getLayerWeight().
+    std::vector<LayerWeight> weightDelta;
 
-  //! Resets values in m_weightDelta to 0.00
-  void clearWeightDelta();
+    //! Sum of the squared output errors over the worker's data points
+    double error;
+  };
 
-  //! Resizes internal data for m_network
+  //! Resets values in worker.delta to 0.00
+  void clearDelta(Worker& worker);
+
+  //! Resets values in worker.weightDelta to 0.00
+  void clearWeightDelta(Worker& worker);
+
+  //! Resizes internal data for m_network and m_numThreads
   void resize();
 
   /*!
-    \brief Updates all weights with values from m_weightDelta
-    \param eta multiplier to use when updating the weights
+    \brief Accumulates weight deltas for one slice and reduces the totals
+    \param index The worker [0..numWorkers - 1]
+    \param numWorkers Number of workers taking part in this update
+    \param data The dataset being trained on
+    \param order The points to use; see runSubset()
+    \param numPoints Number of points to use
+    \param barrier Barrier for numWorkers threads, shared by all of the
+    workers in this update
+
+    Worker index handles the points in
+    [index * numPoints / numWorkers, (index + 1) * numPoints / numWorkers).
+    Afterwards the workers sum their totals pairwise in log2(numWorkers)
+    rounds so that m_worker[0].weightDelta and m_worker[0].error hold the
+    grand totals.
   */
-  void updateWeights(double eta);
+  void runWorker(int index,
+                 int numWorkers,
+                 const Dataset& data,
+                 const int* order,
+                 int numPoints,
+                 boost::barrier& barrier);
 
   /*!
     \brief Computes delta for the output layer only
-    \param target The target outputs
+    \param worker The worker whose outputs and deltas to use
+    \param target The getNumOutputUnits() - 1 target outputs
 
-    Uses current outputs of network.
+    Also adds the squared errors of the outputs to worker.error.
   */
-  void computeOutputDelta(const std::vector<double>& target);
+  void computeOutputDelta(Worker& worker, const Scalar* target);
 
-  //! Computes full m_delta array based on m_network
-  void computeDelta();
+  /*!
+    \brief Runs a worker thread until stopThreads()
+    \param index The thread's worker in m_worker [1..m_numThreads - 1]
+
+    Runs the worker for each update computeWeightDelta() hands out that
+    has enough points for it.
+  */
+  void runThread(int index);
 
-  //! Adds full m_delta array to m_weightDelta
-  void addDeltaToTotal();
+  //! Stops and joins the worker threads
+  void stopThreads();
+
+  //! Computes full worker.delta array based on the worker's workspace
+  void computeDelta(Worker& worker);
+
+  //! Adds full worker.delta array to worker.weightDelta
+  void addDeltaToTotal(Worker& worker);
 
   //! The neural network on which we're performing gradient
-  NeuralNetPtr m_network;
+  NetworkPtr m_network;
 
-  //! Value of delta for each of unit. m_delta[layer][unit]
-  std::vector<std::vector<double> > m_delta;
+  //! Per-thread state; m_worker[thread]
+  std::vector<Worker> m_worker;
 
-  //! Total adjustment to weight summed over all data points for each unit.
-  std::vector<NeuralNet::LayerWeight> m_weightDelta;
+  //! Number of threads used to compute the weight deltas
+  int m_numThreads;
 
   //! "eta" value that controls how fast we converge
   double m_eta;
+
+  //! Estimated error after the last update
+  double m_estimatedError;
+
+  //! Threads running m_worker[1..m_numThreads - 1]; started by the first
+  //! update that uses them and kept until stopThreads()
+  boost::shared_ptr<boost::thread_group> m_threads;
+
+  //! Guards the members below that are shared with the threads
+  boost::mutex m_threadMutex;
+
+  //! Signaled, with m_threadMutex, when the threads get a new update or
+  //! are asked to stop
+  boost::condition m_startCondition;
+
+  //! Signaled, with m_threadMutex, when the last thread finishes its slice
+  boost::condition m_doneCondition;
+
+  //! Number of updates handed to the threads so far
+  int m_numRequests;
+
+  //! Number of threads still working on the current update
+  int m_numRunning;
+
+  //! Whether the threads should exit
+  bool m_stopThreads;
+
+  //! Barrier of the last update; only replaced when an update has a
+  //! different number of workers
+  boost::shared_ptr<boost::barrier> m_barrier;
+
+  //! Arguments of the current update
+  const Dataset* m_requestData;
+  const int* m_requestOrder;
+  int m_requestNumPoints;
+  int m_requestNumWorkers;
 };
 
+//! Gradient descent for the default neural network type
+typedef GradDescentTemplate<NeuralNet> GradDescent;
+
 //! Shared pointer to GradDescent
 typedef boost::shared_ptr<GradDescent> GradDescentPtr;
 
+//! Gradient descent for the single precision neural network type
+typedef GradDescentTemplate<FloatNeuralNet> FloatGradDescent;
+
+//! Shared pointer to FloatGradDescent
+typedef boost::shared_ptr<FloatGradDescent> FloatGradDescentPtr;
+
 } // namespace alch
 
 #endif
@@ -0,0 +1,99 @@
+
+#include "nnet/MiniBatchGradDescent.h"
+#include "nnet/StateIO.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace alch {
+
+template <class TNeuralNet>
+void MiniBatchGradDescentTemplate<TNeuralNet>::setSeed(long val)
+{
+  // same state srand48() sets up
+  m_randState[0] = 0x330E;
+  m_randState[1] = static_cast<unsigned short>(val & 0xFFFF);
+  m_randState[2] = static_cast<unsigned short>((val >> 16) & 0xFFFF);
+}
+
+
+template <class TNeuralNet>
+double MiniBatchGradDescentTemplate<TNeuralNet>::run(const Dataset& data)
+{
+  int dataSize = int(data.size());
+  shuffle(dataSize);
+
+  // each batch's error is measured before its own update
+  double error = 0.00;
+  for (int first = 0; first < dataSize; first += m_batchSize)
+  {
+    int numPoints = std::min(m_batchSize, dataSize - first);
+    error += this->runSubset(data, &m_order[first], numPoints) * numPoints;
+  }
+
+  return (dataSize ? (error / dataSize) : 0.00);
+}
+
+
+template <class TNeuralNet>
+void MiniBatchGradDescentTemplate<TNeuralNet>::writeState(
+  std::ostream& os) const
+{
+  GradDescentTemplate<TNeuralNet>::writeState(os);
+
+  // each shuffle starts from the last order, so it is part of the state
+  for (int i = 0; i < 3; ++i)
+  {
+    StateIO::write(os, m_randState[i]);
+  }
+  StateIO::write(os, m_order);
+}
+
+
+template <class TNeuralNet>
+bool MiniBatchGradDescentTemplate<TNeuralNet>::readState(std::istream& is)
+{
+  if (!GradDescentTemplate<TNeuralNet>::readState(is))
+  {
+    return false;
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (!StateIO::read(is, m_randState[i]))
+    {
+      return false;
+    }
+  }
+
+  return StateIO::read(is, m_order);
+}
+
+
+template <class TNeuralNet>
+void MiniBatchGradDescentTemplate<TNeuralNet>::shuffle(int dataSize)
+{
+  if (static_cast<int>(m_order.size()) != dataSize)
+  {
+    m_order.resize(dataSize);
+    for (int i = 0; i < dataSize; ++i)
+    {
+      m_order[i] = i;
+    }
+  }
+
+  // Fisher-Yates
+  for (int i = dataSize - 1; i > 0; --i)
+  {
+    int j = std::min(i, int(::erand48(m_randState) * (i + 1)));
+    std::swap(m_order[i], m_order[j]);
+  }
+}
+
+// the network types we train
+template class MiniBatchGradDescentTemplate<TanhNeuralNet>;
+template class MiniBatchGradDescentTemplate<LinearNeuralNet>;
+template class MiniBatchGradDescentTemplate<FloatTanhNeuralNet>;
+template class MiniBatchGradDescentTemplate<FloatLinearNeuralNet>;
+
+} // namespace alch
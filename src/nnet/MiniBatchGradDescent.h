@@ -0,0 +1,136 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_MiniBatchGradDescent_h
+#define INCLUDED_nnet_MiniBatchGradDescent_h
+
+#include <vector>
+#include <cassert>
+#include "nnet/NNetDataset.h"
+#include "nnet/NeuralNet.h"
+#include "nnet/GradDescent.h"
+
+namespace alch {
+
+/*!
+  \brief Class that performs mini-batch stochastic gradient descent to train
+  a neural network.
+
+  Each call to run() is one pass over the dataset in a freshly shuffled
+  order, updating the weights after every batchSize data points instead of
+  once per pass. The shuffling uses a private random number generator so
+  that a given seed always produces the same sequence of batches.
+*/
+template <class TNeuralNet>
+class MiniBatchGradDescentTemplate : public GradDescentTemplate<TNeuralNet>
+{
+ public:
+
+  //! Shared pointer to the neural network being trained
+  typedef typename GradDescentTemplate<TNeuralNet>::NetworkPtr NetworkPtr;
+
+  //! Type of dataset the network is trained on
+  typedef typename GradDescentTemplate<TNeuralNet>::Dataset Dataset;
+
+  // keep the other run() overloads visible
+  using GradDescentTemplate<TNeuralNet>::run;
+
+  /*!
+    \brief Constructor
+    \param network The neural network on which we're performing gradient
+    descent.
+    \param eta The learning rate parameter
+    \param batchSize Number of data points per weight update
+    \param seed Seed for the random number generator used for shuffling
+  */
+  MiniBatchGradDescentTemplate(NetworkPtr network,
+                               double eta = 0.001,
+                               int batchSize = 32,
+                               long seed = 0)
+    : GradDescentTemplate<TNeuralNet>(network, eta)
+    , m_batchSize(batchSize)
+    , m_order()
+  {
+    assert(m_batchSize >= 1);
+    setSeed(seed);
+  }
+
+
+  /*!
+    \brief Destructor
+  */
+  ~MiniBatchGradDescentTemplate()
+  {
+  }
+
+
+  //! Returns number of data points per weight update
+  int getBatchSize() const
+  {
+    return m_batchSize;
+  }
+
+
+  //! Sets number of data points per weight update
+  void setBatchSize(int val)
+  {
+    assert(val >= 1);
+    m_batchSize = val;
+  }
+
+
+  /*!
+    \brief Reseeds the random number generator used for shuffling
+    \param val The seed
+
+    Seeding works the same way as srand48(), so the same seed always gives
+    the same shuffles.
+  */
+  void setSeed(long val);
+
+
+  /*!
+    \brief Runs a single iteration for given dataset
+    \param data The dataset to run against
+    \return Mean over all points of the error of each batch before its
+    update
+
+    Shuffles the dataset and then updates the weights once for each batch
+    of getBatchSize() points; the last batch may be smaller. Each update
+    moves the weights by eta times the weight deltas summed over its batch.
+    getEstimatedError() refers to the last batch.
+  */
+  virtual double run(const Dataset& data);
+
+
+  //! Also writes the shuffling state; see GradDescentTemplate::writeState()
+  virtual void writeState(std::ostream& os) const;
+
+
+  //! Reads state written by writeState()
+  virtual bool readState(std::istream& is);
+
+
+ private:
+
+  //! Number of data points per weight update
+  int m_batchSize;
+
+  //! Order in which the data points are visited; reshuffled on each run
+  std::vector<int> m_order;
+
+  //! State of the random number generator used by erand48()
+  unsigned short m_randState[3];
+
+  //! Shuffles m_order, first resetting it if the dataset size changed
+  void shuffle(int dataSize);
+};
+
+//! MiniBatchGradDescent for the default neural network type
+typedef MiniBatchGradDescentTemplate<NeuralNet> MiniBatchGradDescent;
+
+//! MiniBatchGradDescent for the single precision neural network type
+typedef MiniBatchGradDescentTemplate<FloatNeuralNet> FloatMiniBatchGradDescent;
+
+} // namespace alch
+
+#endif
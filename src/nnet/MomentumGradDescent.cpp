@@ -2,6 +2,7 @@
 #include "nnet/MomentumGradDescent.h"
 #include "nnet/NeuralNetAlg.h"
 #include "nnet/NeuralNet.h"
+#include "nnet/StateIO.h"
 
 //#define DEBUG_MOMENDUMGRADDESCENT
 #ifdef DEBUG_MOMENDUMGRADDESCENT
@@ -10,18 +11,67 @@
 
 namespace alch {
 
-void MomentumGradDescent::run(const NNetDataset& data)
+template <class TNeuralNet>
+double MomentumGradDescentTemplate<TNeuralNet>::run(const Dataset& data)
 {
-  // save the net so we can revert
-  assert(getNetwork().get());
-  NeuralNetPtr savedNeuralNet(new NeuralNet());
-  *savedNeuralNet = *getNetwork();
+  assert(this->getNetwork().get());
+  int numPoints = int(data.size());
 
-  // run gradient descent on the network
-  GradDescent::run(data);
+  // the gradient pass also gives us the training error of the weights
+  // the last step produced
+  double trainError = this->computeWeightDelta(data, 0, numPoints);
+  bool reject = (m_havePendingStep && !checkStep(trainError));
 
-  // calculate our training error
-  double trainError = NeuralNetAlg::calculateError(*getNetwork(), data);
+  double baseError = trainError;
+  if (reject)
+  {
+    // revert to the weights the last step started from and retake it
+    // with the weight deltas computed for them
+    this->getNetwork()->swapWeights(m_spareWeight);
+    this->swapWeightDelta(m_spareWeightDelta);
+    baseError = m_pendingStepError;
+  }
+
+  double change = updateWeights(this->getEta());
+  this->setEstimatedError(this->estimateError(baseError, change, numPoints));
+
+  // keep the weight deltas of this step in case it gets rejected
+  this->swapWeightDelta(m_spareWeightDelta);
+  m_pendingStepError = baseError;
+  m_havePendingStep = true;
+
+  return trainError;
+}
+
+
+template <class TNeuralNet>
+void MomentumGradDescentTemplate<TNeuralNet>::finish(const Dataset& data)
+{
+  if (!m_havePendingStep)
+  {
+    return;
+  }
+
+  // the one extra pass; run() gets this error from its gradient pass
+  TNeuralNet& net = *this->getNetwork();
+  double trainError = NeuralNetAlg::calculateError(net, data);
+  if (checkStep(trainError))
+  {
+    this->setEstimatedError(trainError);
+  }
+  else
+  {
+    net.swapWeights(m_spareWeight);
+    this->setEstimatedError(m_pendingStepError);
+  }
+
+  m_havePendingStep = false;
+}
+
+
+template <class TNeuralNet>
+bool MomentumGradDescentTemplate<TNeuralNet>::checkStep(double trainError)
+{
 
 #ifdef DEBUG_MOMENDUMGRADDESCENT
   std::cerr << "-- trainError(" << trainError << ") <=> lastTrainError("
@@ -32,31 +82,102 @@ void MomentumGradDescent::run(const NNetDataset& data)
   {
 
 #ifdef DEBUG_MOMENDUMGRADDESCENT
-    std::cerr << "-- getEta()(" << getEta() << ") *= m_alpha(" << m_alpha
-              << ") ==> " << (getEta() * m_alpha) << "\n";
+    std::cerr << "-- getEta()(" << this->getEta() << ") *= m_alpha("
+              << m_alpha << ") ==> " << (this->getEta() * m_alpha) << "\n";
 #endif
 
-
     // we're improving.. increase momentum!
-    setEta(getEta() * m_alpha);
+    this->setEta(this->getEta() * m_alpha);
 
     // update last train error
     m_lastTrainError = trainError;
+    return true;
   }
-  else
-  {
 
 #ifdef DEBUG_MOMENDUMGRADDESCENT
-    std::cerr << "-- getEta()(" << getEta() << ") *= m_beta(" << m_beta
-              << ") ==> " << (getEta() * m_beta) << "\n";
-    std::cerr << "-- reverting neural net...\n";
+  std::cerr << "-- getEta()(" << this->getEta() << ") *= m_beta("
+            << m_beta << ") ==> " << (this->getEta() * m_beta) << "\n";
+  std::cerr << "-- reverting neural net...\n";
 #endif
 
-    // error got worse.. revert weights and slow down learning
-    setEta(getEta() * m_beta);
-    *getNetwork() = *savedNeuralNet;
+  // error got worse.. slow down learning
+  this->setEta(this->getEta() * m_beta);
+  return false;
+}
+
+
+template <class TNeuralNet>
+void MomentumGradDescentTemplate<TNeuralNet>::writeState(
+  std::ostream& os) const
+{
+  GradDescentTemplate<TNeuralNet>::writeState(os);
+
+  StateIO::write(os, m_lastTrainError);
+  StateIO::write(os, m_havePendingStep);
+  StateIO::write(os, m_pendingStepError);
+  StateIO::write(os, m_spareWeight);
+  StateIO::write(os, m_spareWeightDelta);
+}
+
+
+template <class TNeuralNet>
+bool MomentumGradDescentTemplate<TNeuralNet>::readState(std::istream& is)
+{
+  std::vector<LayerWeight> spareWeight;
+  std::vector<LayerWeight> spareWeightDelta;
+  if (!GradDescentTemplate<TNeuralNet>::readState(is)
+      || !StateIO::read(is, m_lastTrainError)
+      || !StateIO::read(is, m_havePendingStep)
+      || !StateIO::read(is, m_pendingStepError)
+      || !StateIO::read(is, spareWeight)
+      || !StateIO::read(is, spareWeightDelta)
+      || !StateIO::sameShape(spareWeight, m_spareWeight)
+      || !StateIO::sameShape(spareWeightDelta, m_spareWeightDelta))
+  {
+    return false;
   }
+
+  m_spareWeight.swap(spareWeight);
+  m_spareWeightDelta.swap(spareWeightDelta);
+  return true;
 }
 
-} // namespace alch
 
+template <class TNeuralNet>
+double MomentumGradDescentTemplate<TNeuralNet>::updateWeights(double eta)
+{
+  // The constant unit rows and the row padding of the weight deltas are
+  // always zero, so the new weights keep them zero as well.
+  double sumSquares = 0.00;
+  TNeuralNet& net = *this->getNetwork();
+  int numLayers = net.getNumLayers();
+  assert(static_cast<int>(m_spareWeight.size()) == numLayers);
+
+  for (int layer = 1; layer < numLayers; ++layer)
+  {
+    const Scalar* weight = &net.getLayerWeight(layer)[0];
+    const Scalar* weightDelta = &this->getWeightDelta(layer)[0];
+    Scalar* newWeight = &m_spareWeight[layer][0];
+    int numWeights = int(m_spareWeight[layer].size());
+
+    assert(static_cast<int>(net.getLayerWeight(layer).size()) == numWeights);
+
+    for (int i = 0; i < numWeights; ++i)
+    {
+      newWeight[i] = weight[i] - (eta * weightDelta[i]);
+      sumSquares += (weightDelta[i] * weightDelta[i]);
+    }
+  }
+
+  net.swapWeights(m_spareWeight);
+
+  return -eta * sumSquares;
+}
+
+// the network types we train
+template class MomentumGradDescentTemplate<TanhNeuralNet>;
+template class MomentumGradDescentTemplate<LinearNeuralNet>;
+template class MomentumGradDescentTemplate<FloatTanhNeuralNet>;
+template class MomentumGradDescentTemplate<FloatLinearNeuralNet>;
+
+} // namespace alch
@@ -14,10 +14,38 @@ namespace alch {
 /*!
   \brief Class that performs gradient descent with momentum to train a neural 
   network.
+
+  Each step is kept only if it lowers the training error. The error of a
+  step's weights is not known until the gradient pass of the next call to
+  run() measures it, so each step is accepted or rejected one call later:
+  run() first decides on the step of the previous call and then takes
+  the next one. This keeps each iteration to a single pass over the data.
+  finish() checks the last step with a pass of its own, before the
+  network is taken as the result of training.
+
+  The trainer owns a second set of weight buffers: an update writes the
+  new weights into the spare buffers and swaps them into the network,
+  leaving the old weights in the spare. Rejecting a step swaps them back
+  and takes the next step from there with the weight deltas saved from
+  that update, so neither saving nor reverting copies anything.
 */
-class MomentumGradDescent : public GradDescent
+template <class TNeuralNet>
+class MomentumGradDescentTemplate : public GradDescentTemplate<TNeuralNet>
 {
  public:
+
+  //! Shared pointer to the neural network being trained
+  typedef typename GradDescentTemplate<TNeuralNet>::NetworkPtr NetworkPtr;
+
+  //! Type of the weights and unit values
+  typedef typename GradDescentTemplate<TNeuralNet>::Scalar Scalar;
+
+  //! Type of dataset the network is trained on
+  typedef typename GradDescentTemplate<TNeuralNet>::Dataset Dataset;
+
+  //! The weights of a single layer
+  typedef typename GradDescentTemplate<TNeuralNet>::LayerWeight LayerWeight;
+
   /*!
     \brief Constructor
     \param network The neural network on which we're performing gradient
@@ -26,23 +54,36 @@ class MomentumGradDescent : public GradDescent
     \param alpha The multiplier when error rate is decreasing
     \param beta the multiplier when error rate is increasing
   */
-  MomentumGradDescent(NeuralNetPtr network, 
-                      double eta = 0.001,
-                      double alpha = 1.10, 
-                      double beta = 0.50)
-    : GradDescent(network, eta)
+  MomentumGradDescentTemplate(NetworkPtr network,
+                              double eta = 0.001,
+                              double alpha = 1.10, 
+                              double beta = 0.50)
+    : GradDescentTemplate<TNeuralNet>(network, eta)
     , m_alpha(alpha)
     , m_beta(beta)
     , m_lastTrainError(99999.9)
+    , m_havePendingStep(false)
+    , m_pendingStepError(0.00)
+    , m_spareWeight()
+    , m_spareWeightDelta()
   {
-    ;
+    // one buffer per weight block, in the network's layout
+    int numLayers = network->getNumLayers();
+    m_spareWeight.resize(numLayers);
+    m_spareWeightDelta.resize(numLayers);
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      int numWeights = int(network->getLayerWeight(layer).size());
+      m_spareWeight[layer].resize(numWeights, 0.00);
+      m_spareWeightDelta[layer].resize(numWeights, 0.00);
+    }
   }
 
 
   /*!
     \brief Destructor
   */
-  ~MomentumGradDescent()
+  ~MomentumGradDescentTemplate()
   {
   }
 
@@ -50,25 +91,89 @@ class MomentumGradDescent : public GradDescent
   /*!
     \brief Runs a single iteration for given dataset
     \param data The dataset to run against
+    \return The training error of the weights before this call, i.e.
+    of the step taken by the previous call
+
+    Accepts or rejects the previous step, adjusting eta, and then takes
+    the next step. After the last call the network holds a step that has
+    not been checked yet; see finish().
+  */
+  virtual double run(const Dataset& data);
+
+
+  /*!
+    \brief Accepts or rejects the step taken by the last call to run()
+    \param data The dataset the step was taken on
+
+    Measures the training error of the step with a forward pass, which
+    run() would otherwise get from its next gradient pass. A rejected step
+    is reverted; the next run() then takes the step run() would have
+    retaken.
+  */
+  virtual void finish(const Dataset& data);
+
+
+  //! Also writes the step awaiting acceptance and the last accepted
+  //! error; see GradDescentTemplate::writeState()
+  virtual void writeState(std::ostream& os) const;
 
-    This method will train the network over one iteration for the given
-    dataset.
+
+  //! Reads state written by writeState()
+  virtual bool readState(std::istream& is);
+
+
+ protected:
+
+  /*!
+    \brief Writes the updated weights into the spare buffers and swaps
+    them into the network
+    \param eta multiplier to use when updating the weights
+
+    Afterwards m_spareWeight holds the weights from before the update.
   */
-  virtual void run(const NNetDataset& data);
+  virtual double updateWeights(double eta);
 
 
  private:
 
+  /*!
+    \brief Decides on the pending step and adjusts eta
+    \param trainError The training error of the pending step's weights
+    \retval true The step is accepted
+    \retval false The step is rejected; the caller reverts it
+  */
+  bool checkStep(double trainError);
+
   //! "alpha" value we use to adjust m_eta when error rate is decreasing
   double m_alpha;
 
   //! "beta" value we use to adjust m_eta when error rate is increasing
   double m_beta;
 
-  //! The last training error we encountered
+  //! The training error of the last accepted step
   double m_lastTrainError;
+
+  //! Whether the network holds a step not yet accepted or rejected
+  bool m_havePendingStep;
+
+  //! The training error of the weights the pending step started from
+  double m_pendingStepError;
+
+  //! The weights not currently in the network; after an update, the
+  //! weights it replaced. Same layout as the network's weight blocks.
+  std::vector<LayerWeight> m_spareWeight;
+
+  //! The weight deltas the pending step was taken with, or the current
+  //! weight deltas while a rejected step is retaken
+  std::vector<LayerWeight> m_spareWeightDelta;
 };
 
+//! MomentumGradDescent for the default neural network type
+typedef MomentumGradDescentTemplate<NeuralNet> MomentumGradDescent;
+
+//! MomentumGradDescent for the single precision neural network type
+typedef MomentumGradDescentTemplate<FloatNeuralNet> FloatMomentumGradDescent;
+
 } // namespace alch
 
 #endif
@@ -0,0 +1,287 @@
+
+#include "nnet/NNetDataFile.h"
+
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace alch {
+
+  // "ANND" when read in little endian byte order
+  const boost::uint32_t NNetDataFile::c_magic = 0x444e4e41;
+  const boost::uint32_t NNetDataFile::c_version = 1;
+
+  NNetDataFile::NNetDataFile()
+    : m_map(0)
+    , m_mapLength(0)
+    , m_inputs(0)
+    , m_outputs(0)
+    , m_numPoints(0)
+    , m_numInputs(0)
+    , m_numOutputs(0)
+    , m_dataType(DATATYPE_double)
+  {
+    ;
+  }
+
+
+  NNetDataFile::~NNetDataFile()
+  {
+    close();
+  }
+
+
+  bool NNetDataFile::open(const std::string& filename, Context& ctx)
+  {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to open '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to stat '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      ::close(fd);
+      return false;
+    }
+
+    std::size_t length = std::size_t(st.st_size);
+    if (length < sizeof(Header))
+    {
+      ctx << Context::PRIORITY_error
+          << "File '" << filename << "' is too short to be a dataset file"
+          << Context::endl;
+      ::close(fd);
+      return false;
+    }
+
+    void* map = ::mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to map '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      return false;
+    }
+
+    // the matrices are read front to back
+    ::madvise(map, length, MADV_SEQUENTIAL);
+
+    m_map = map;
+    m_mapLength = length;
+
+    Header header;
+    memcpy(&header, map, sizeof(header));
+
+    if (!checkHeader(header, length, filename, ctx))
+    {
+      close();
+      return false;
+    }
+
+    m_numPoints = int(header.numPoints);
+    m_numInputs = int(header.numInputs);
+    m_numOutputs = int(header.numOutputs);
+    m_dataType = DataType(header.dataType);
+    m_inputs = static_cast<const char*>(map) + sizeof(Header);
+    m_outputs = m_inputs + (std::size_t(m_numPoints) * m_numInputs
+                            * getScalarSize(m_dataType));
+
+    return true;
+  }
+
+
+  void NNetDataFile::close()
+  {
+    if (m_map)
+    {
+      ::munmap(m_map, m_mapLength);
+    }
+
+    m_map = 0;
+    m_mapLength = 0;
+    m_inputs = 0;
+    m_outputs = 0;
+    m_numPoints = 0;
+    m_numInputs = 0;
+    m_numOutputs = 0;
+    m_dataType = DATATYPE_double;
+  }
+
+
+  bool NNetDataFile::checkHeader(const Header& header,
+                                 std::size_t length,
+                                 const std::string& filename,
+                                 Context& ctx)
+  {
+    if (header.magic != c_magic)
+    {
+      ctx << Context::PRIORITY_error
+          << "File '" << filename << "' is not a dataset file"
+          << Context::endl;
+      return false;
+    }
+
+    if (header.version != c_version)
+    {
+      ctx << Context::PRIORITY_error
+          << "Dataset file '" << filename << "' has unsupported version "
+          << header.version
+          << Context::endl;
+      return false;
+    }
+
+    if ((header.dataType != DATATYPE_double)
+        && (header.dataType != DATATYPE_float))
+    {
+      ctx << Context::PRIORITY_error
+          << "Dataset file '" << filename << "' has unknown data type "
+          << header.dataType
+          << Context::endl;
+      return false;
+    }
+
+    // the product of the header fields can overflow, so the data size is
+    // divided down instead, and every division must be exact
+    assert(length >= sizeof(Header));
+    boost::uint64_t scalarSize = getScalarSize(DataType(header.dataType));
+    boost::uint64_t dataSize = length - sizeof(Header);
+    boost::uint64_t numValues = (boost::uint64_t(header.numInputs)
+                                 + header.numOutputs);
+    const boost::uint64_t maxInt = std::numeric_limits<int>::max();
+    bool sizeMatches = false;
+    if ((header.numPoints <= maxInt) && (header.numInputs <= maxInt)
+        && (header.numOutputs <= maxInt) && !(dataSize % scalarSize))
+    {
+      boost::uint64_t numScalars = dataSize / scalarSize;
+      sizeMatches = (numValues
+                     ? (!(numScalars % numValues)
+                        && (numScalars / numValues == header.numPoints))
+                     : !numScalars);
+    }
+
+    if (!sizeMatches)
+    {
+      ctx << Context::PRIORITY_error
+          << "Dataset file '" << filename << "' has " << length
+          << " bytes, which doesn't match its header"
+          << Context::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+
+  template <typename TScalar>
+  void NNetDataFile::copyTo(NNetDatasetTemplate<TScalar>& dataset) const
+  {
+    if (getDataType() == DATATYPE_float)
+    {
+      copyTo(dataset, (const float*) 0);
+    }
+    else
+    {
+      copyTo(dataset, (const double*) 0);
+    }
+  }
+
+
+  template <typename TScalar, typename TFileScalar>
+  void NNetDataFile::copyTo(NNetDatasetTemplate<TScalar>& dataset,
+                            const TFileScalar*) const
+  {
+    const TFileScalar* inputs = getInputs<TFileScalar>();
+    const TFileScalar* outputs = getOutputs<TFileScalar>();
+
+    // the dataset holds the same matrices as the file
+    NNetDatasetTemplate<TScalar> copy(m_numPoints, m_numInputs,
+                                      m_numOutputs);
+    std::copy(inputs, inputs + std::size_t(m_numPoints) * m_numInputs,
+              copy.getInputs());
+    std::copy(outputs, outputs + std::size_t(m_numPoints) * m_numOutputs,
+              copy.getOutputs());
+    dataset.swap(copy);
+  }
+
+
+  bool NNetDataFile::isDataFile(const std::string& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+
+    boost::uint32_t magic = 0;
+    ifs.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+
+    return (ifs && (magic == c_magic));
+  }
+
+
+  template <typename TScalar>
+  bool NNetDataFile::write(std::ostream& os,
+                           const NNetDatasetTemplate<TScalar>& dataset,
+                           Context& ctx)
+  {
+    std::size_t numPoints = dataset.size();
+    int numInputs = dataset.getNumInputs();
+    int numOutputs = dataset.getNumOutputs();
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = c_magic;
+    header.version = c_version;
+    header.dataType = getDataTypeOf((TScalar*) 0);
+    header.numInputs = numInputs;
+    header.numOutputs = numOutputs;
+    header.numPoints = numPoints;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // the dataset already holds the matrices in file order
+    if (numPoints && numInputs)
+    {
+      os.write(reinterpret_cast<const char*>(dataset.getInputs()),
+               numPoints * numInputs * sizeof(TScalar));
+    }
+
+    if (numPoints && numOutputs)
+    {
+      os.write(reinterpret_cast<const char*>(dataset.getOutputs()),
+               numPoints * numOutputs * sizeof(TScalar));
+    }
+
+    if (!os)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to write dataset of " << numPoints << " points"
+          << Context::endl;
+    }
+
+    return os;
+  }
+
+
+  template void NNetDataFile::copyTo(NNetDataset&) const;
+  template void NNetDataFile::copyTo(FloatNNetDataset&) const;
+
+  template bool NNetDataFile::write(std::ostream&, const NNetDataset&,
+                                    Context&);
+  template bool NNetDataFile::write(std::ostream&, const FloatNNetDataset&,
+                                    Context&);
+
+} // namespace alch
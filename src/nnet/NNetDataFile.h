@@ -0,0 +1,242 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_NNetDataFile_h
+#define INCLUDED_nnet_NNetDataFile_h
+
+#include "autil/Context.h"
+#include "nnet/NNetDataset.h"
+
+#include "boost/cstdint.hpp"
+
+#include <string>
+#include <iosfwd>
+#include <cassert>
+
+namespace alch {
+
+/*!
+  \brief Binary neural network dataset file, read through a memory map
+  \ingroup nnet
+
+  The file is a fixed 32 byte header followed by the input values of every
+  point as one dense row-major matrix and then the output values as a
+  second one. Values are stored as doubles or floats in the byte order of
+  the machine that wrote them; a file from a machine of the other byte
+  order fails the magic number check.
+
+  open() maps the file read-only, so the matrices are used in place
+  without parsing. NNetDataset holds the same two matrices, so copyTo()
+  and write() each move them as two blocks.
+*/
+class NNetDataFile
+{
+ public:
+
+  //! Type of the values stored in the file
+  enum DataType
+  {
+    DATATYPE_double = 1,
+    DATATYPE_float = 2
+  };
+
+  /*!
+    \brief Constructor; the file is not opened until open() is called
+  */
+  NNetDataFile();
+
+  /*!
+    \brief Destructor; unmaps the file
+  */
+  ~NNetDataFile();
+
+  /*!
+    \brief Maps the named file
+    \param filename Name of the file to map
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error; the file is not a valid dataset file
+  */
+  bool open(const std::string& filename, Context& ctx);
+
+  //! Unmaps the file, if any
+  void close();
+
+  //! Whether a file is mapped
+  bool isOpen() const
+  {
+    return (m_map != 0);
+  }
+
+  //! Number of data points in the file
+  int size() const
+  {
+    return m_numPoints;
+  }
+
+  //! Number of inputs of each data point
+  int getNumInputs() const
+  {
+    return m_numInputs;
+  }
+
+  //! Number of outputs of each data point
+  int getNumOutputs() const
+  {
+    return m_numOutputs;
+  }
+
+  //! Type of the values stored in the file
+  DataType getDataType() const
+  {
+    return m_dataType;
+  }
+
+  /*!
+    \brief Returns the input matrix
+    \return size() rows of getNumInputs() values
+
+    TScalar must match getDataType().
+  */
+  template <typename TScalar>
+  const TScalar* getInputs() const
+  {
+    assert(getDataType() == getDataTypeOf((TScalar*) 0));
+    return reinterpret_cast<const TScalar*>(m_inputs);
+  }
+
+  /*!
+    \brief Returns the output matrix
+    \return size() rows of getNumOutputs() values
+
+    TScalar must match getDataType().
+  */
+  template <typename TScalar>
+  const TScalar* getOutputs() const
+  {
+    assert(getDataType() == getDataTypeOf((TScalar*) 0));
+    return reinterpret_cast<const TScalar*>(m_outputs);
+  }
+
+  /*!
+    \brief Copies the mapped data points into a dataset
+    \param dataset [out] Dataset to populate; any points in it are removed
+
+    The values are converted if TScalar does not match getDataType().
+  */
+  template <typename TScalar>
+  void copyTo(NNetDatasetTemplate<TScalar>& dataset) const;
+
+  /*!
+    \brief Checks whether the named file starts with the magic number
+    \param filename Name of the file to check
+    \retval true The file looks like a dataset file
+    \retval false The file can't be read or is in another format
+  */
+  static bool isDataFile(const std::string& filename);
+
+  /*!
+    \brief Writes a dataset in binary format
+    \param os The output stream; should be opened in binary mode
+    \param dataset The dataset to output
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error writing to the stream
+
+    The values are written as TScalar.
+  */
+  template <typename TScalar>
+  static bool write(std::ostream& os,
+                    const NNetDatasetTemplate<TScalar>& dataset,
+                    Context& ctx);
+
+ private:
+
+  //! Fixed size header at the start of the file
+  struct Header
+  {
+    //! Identifies the file type and byte order; c_magic
+    boost::uint32_t magic;
+
+    //! Format version; c_version
+    boost::uint32_t version;
+
+    //! DataType of the values
+    boost::uint32_t dataType;
+
+    //! Number of inputs of each point
+    boost::uint32_t numInputs;
+
+    //! Number of outputs of each point
+    boost::uint32_t numOutputs;
+
+    //! Unused; zero
+    boost::uint32_t reserved;
+
+    //! Number of data points
+    boost::uint64_t numPoints;
+  };
+
+  static const boost::uint32_t c_magic;
+  static const boost::uint32_t c_version;
+
+  // reads the same header and matrices in blocks
+  template <typename TScalar> friend class NNetDataReaderTemplate;
+
+  // not implemented; a mapping can't be shared
+  NNetDataFile(const NNetDataFile&);
+  NNetDataFile& operator=(const NNetDataFile&);
+
+  static DataType getDataTypeOf(const double*)
+  {
+    return DATATYPE_double;
+  }
+
+  static DataType getDataTypeOf(const float*)
+  {
+    return DATATYPE_float;
+  }
+
+  static std::size_t getScalarSize(DataType dataType)
+  {
+    return ((dataType == DATATYPE_float) ? sizeof(float) : sizeof(double));
+  }
+
+  /*!
+    \brief Checks a header read from the start of a file
+    \param header The header
+    \param length Length of the file in bytes
+    \param filename Name of the file (for messages)
+    \param ctx Context for this operation
+    \retval true The header is valid and matches the file length
+    \retval false Error
+  */
+  static bool checkHeader(const Header& header,
+                          std::size_t length,
+                          const std::string& filename,
+                          Context& ctx);
+
+  template <typename TScalar, typename TFileScalar>
+  void copyTo(NNetDatasetTemplate<TScalar>& dataset,
+              const TFileScalar* dummy) const;
+
+  //! Start of the mapping, or 0 if no file is mapped
+  void* m_map;
+
+  //! Length of the mapping in bytes
+  std::size_t m_mapLength;
+
+  //! Start of the input matrix in the mapping
+  const char* m_inputs;
+
+  //! Start of the output matrix in the mapping
+  const char* m_outputs;
+
+  int m_numPoints;
+  int m_numInputs;
+  int m_numOutputs;
+  DataType m_dataType;
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,471 @@
+
+#include "nnet/NNetDataReader.h"
+#include "nnet/StateIO.h"
+
+#include "boost/bind.hpp"
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace alch {
+
+template <typename TScalar>
+NNetDataReaderTemplate<TScalar>::NNetDataReaderTemplate(int blockSize,
+                                                        long seed)
+  : m_fd(-1)
+  , m_blockSize(blockSize)
+  , m_numPoints(0)
+  , m_numInputs(0)
+  , m_numOutputs(0)
+  , m_dataType(NNetDataFile::DATATYPE_double)
+  , m_inputOffset(0)
+  , m_outputOffset(0)
+  , m_shuffle(false)
+  , m_order()
+  , m_nextBlock(0)
+  , m_current()
+  , m_spare()
+  , m_buffer()
+  , m_thread()
+  , m_readMutex()
+  , m_readCondition()
+  , m_readBlock(-1)
+  , m_stopThread(false)
+  , m_readFailed(false)
+  , m_failed(false)
+{
+  assert(m_blockSize >= 1);
+  setSeed(seed);
+  std::copy(m_orderRandState, m_orderRandState + 3, m_passOrderRandState);
+  std::copy(m_pointRandState, m_pointRandState + 3, m_passPointRandState);
+}
+
+
+template <typename TScalar>
+NNetDataReaderTemplate<TScalar>::~NNetDataReaderTemplate()
+{
+  close();
+  stopThread();
+}
+
+
+template <typename TScalar>
+bool NNetDataReaderTemplate<TScalar>::open(const std::string& filename,
+                                           Context& ctx)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to open '" << filename << "': " << strerror(errno)
+        << Context::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1)
+  {
+    ctx << Context::PRIORITY_error
+        << "Failed to stat '" << filename << "': " << strerror(errno)
+        << Context::endl;
+    ::close(fd);
+    return false;
+  }
+
+  m_fd = fd;
+
+  NNetDataFile::Header header;
+  std::size_t length = std::size_t(st.st_size);
+  if ((length < sizeof(header)) || !readBytes(&header, sizeof(header), 0))
+  {
+    ctx << Context::PRIORITY_error
+        << "File '" << filename << "' is too short to be a dataset file"
+        << Context::endl;
+    close();
+    return false;
+  }
+
+  if (!NNetDataFile::checkHeader(header, length, filename, ctx))
+  {
+    close();
+    return false;
+  }
+
+  m_numPoints = int(header.numPoints);
+  m_numInputs = int(header.numInputs);
+  m_numOutputs = int(header.numOutputs);
+  m_dataType = NNetDataFile::DataType(header.dataType);
+  m_inputOffset = sizeof(header);
+  m_outputOffset = (m_inputOffset
+                    + boost::uint64_t(m_numPoints) * m_numInputs
+                    * NNetDataFile::getScalarSize(m_dataType));
+
+  int numBlocks = (m_numPoints + m_blockSize - 1) / m_blockSize;
+  m_order.resize(numBlocks);
+  startPass();
+
+  return true;
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::close()
+{
+  finishRead();
+
+  if (m_fd != -1)
+  {
+    ::close(m_fd);
+  }
+
+  m_fd = -1;
+  m_numPoints = 0;
+  m_numInputs = 0;
+  m_numOutputs = 0;
+  m_dataType = NNetDataFile::DATATYPE_double;
+  m_inputOffset = 0;
+  m_outputOffset = 0;
+  m_order.clear();
+  m_nextBlock = 0;
+  Dataset().swap(m_current);
+  Dataset().swap(m_spare);
+  std::vector<char>().swap(m_buffer);
+  m_readFailed = false;
+  m_failed = false;
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::setSeed(long val)
+{
+  // same state srand48() sets up; the points use the complement of the
+  // seed so that the two sequences differ
+  m_orderRandState[0] = 0x330E;
+  m_orderRandState[1] = static_cast<unsigned short>(val & 0xFFFF);
+  m_orderRandState[2] = static_cast<unsigned short>((val >> 16) & 0xFFFF);
+
+  m_pointRandState[0] = 0x330E;
+  m_pointRandState[1] = static_cast<unsigned short>(~val & 0xFFFF);
+  m_pointRandState[2] = static_cast<unsigned short>((~val >> 16) & 0xFFFF);
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::rewind()
+{
+  finishRead();
+
+  if (isOpen() && !m_failed)
+  {
+    startPass();
+  }
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::writeState(std::ostream& os) const
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    StateIO::write(os, m_passOrderRandState[i]);
+    StateIO::write(os, m_passPointRandState[i]);
+  }
+}
+
+
+template <typename TScalar>
+bool NNetDataReaderTemplate<TScalar>::readState(std::istream& is)
+{
+  finishRead();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (!StateIO::read(is, m_orderRandState[i])
+        || !StateIO::read(is, m_pointRandState[i]))
+    {
+      return false;
+    }
+  }
+
+  if (isOpen() && !m_failed)
+  {
+    startPass();
+  }
+
+  return true;
+}
+
+
+template <typename TScalar>
+const typename NNetDataReaderTemplate<TScalar>::Dataset*
+NNetDataReaderTemplate<TScalar>::next()
+{
+  if (!isOpen() || m_failed || m_order.empty())
+  {
+    return 0;
+  }
+
+  // end of the pass; start reading the next one
+  if (m_nextBlock >= getNumBlocks())
+  {
+    startPass();
+    return 0;
+  }
+
+  finishRead();
+  if (m_readFailed)
+  {
+    m_failed = true;
+    return 0;
+  }
+
+  m_current.swap(m_spare);
+
+  ++m_nextBlock;
+  if (m_nextBlock < getNumBlocks())
+  {
+    startRead();
+  }
+
+  return &m_current;
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::startPass()
+{
+  std::copy(m_orderRandState, m_orderRandState + 3, m_passOrderRandState);
+  std::copy(m_pointRandState, m_pointRandState + 3, m_passPointRandState);
+
+  int numBlocks = getNumBlocks();
+  for (int i = 0; i < numBlocks; ++i)
+  {
+    m_order[i] = i;
+  }
+
+  if (m_shuffle)
+  {
+    // Fisher-Yates
+    for (int i = numBlocks - 1; i > 0; --i)
+    {
+      int j = std::min(i, int(::erand48(m_orderRandState) * (i + 1)));
+      std::swap(m_order[i], m_order[j]);
+    }
+  }
+
+  m_nextBlock = 0;
+  if (numBlocks)
+  {
+    startRead();
+  }
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::startRead()
+{
+  assert(m_nextBlock < getNumBlocks());
+
+  // one thread reads every block, rather than a thread per block
+  if (!m_thread)
+  {
+    m_thread.reset(new boost::thread(
+                     boost::bind(&NNetDataReaderTemplate::runThread, this)));
+  }
+
+  boost::mutex::scoped_lock lock(m_readMutex);
+  assert(m_readBlock == -1);
+  m_readFailed = false;
+  m_readBlock = m_order[m_nextBlock];
+  m_readCondition.notify_all();
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::finishRead()
+{
+  boost::mutex::scoped_lock lock(m_readMutex);
+  while (m_readBlock != -1)
+  {
+    m_readCondition.wait(lock);
+  }
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::runThread()
+{
+  for (;;)
+  {
+    int block;
+    {
+      boost::mutex::scoped_lock lock(m_readMutex);
+      while (!m_stopThread && (m_readBlock == -1))
+      {
+        m_readCondition.wait(lock);
+      }
+
+      if (m_stopThread)
+      {
+        return;
+      }
+
+      block = m_readBlock;
+    }
+
+    readBlock(block);
+
+    boost::mutex::scoped_lock lock(m_readMutex);
+    m_readBlock = -1;
+    m_readCondition.notify_all();
+  }
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::stopThread()
+{
+  if (!m_thread)
+  {
+    return;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(m_readMutex);
+    m_stopThread = true;
+    m_readCondition.notify_all();
+  }
+
+  m_thread->join();
+  m_thread.reset();
+  m_stopThread = false;
+}
+
+
+template <typename TScalar>
+void NNetDataReaderTemplate<TScalar>::readBlock(int block)
+{
+  int first = block * m_blockSize;
+  int numPoints = std::min(m_blockSize, m_numPoints - first);
+  assert(numPoints > 0);
+
+  // keep the buffer from the last block when the shape allows
+  if ((m_spare.getNumInputs() == m_numInputs)
+      && (m_spare.getNumOutputs() == m_numOutputs))
+  {
+    m_spare.resize(numPoints);
+  }
+  else
+  {
+    Dataset(numPoints, m_numInputs, m_numOutputs).swap(m_spare);
+  }
+
+  std::size_t numInputValues = std::size_t(numPoints) * m_numInputs;
+  std::size_t numOutputValues = std::size_t(numPoints) * m_numOutputs;
+  std::size_t scalarSize = NNetDataFile::getScalarSize(m_dataType);
+  boost::uint64_t inputOffset =
+    m_inputOffset + boost::uint64_t(first) * m_numInputs * scalarSize;
+  boost::uint64_t outputOffset =
+    m_outputOffset + boost::uint64_t(first) * m_numOutputs * scalarSize;
+
+  bool ok = false;
+  if (m_dataType == NNetDataFile::DATATYPE_float)
+  {
+    ok = (readValues(m_spare.getInputs(), numInputValues, inputOffset,
+                     (const float*) 0)
+          && readValues(m_spare.getOutputs(), numOutputValues, outputOffset,
+                        (const float*) 0));
+  }
+  else
+  {
+    ok = (readValues(m_spare.getInputs(), numInputValues, inputOffset,
+                     (const double*) 0)
+          && readValues(m_spare.getOutputs(), numOutputValues, outputOffset,
+                        (const double*) 0));
+  }
+
+  if (!ok)
+  {
+    m_readFailed = true;
+    return;
+  }
+
+  if (m_shuffle)
+  {
+    // Fisher-Yates
+    for (int i = numPoints - 1; i > 0; --i)
+    {
+      int j = std::min(i, int(::erand48(m_pointRandState) * (i + 1)));
+      m_spare.swapPoints(i, j);
+    }
+  }
+}
+
+
+template <typename TScalar>
+template <typename TFileScalar>
+bool NNetDataReaderTemplate<TScalar>::readValues(TScalar* dest,
+                                                 std::size_t numValues,
+                                                 boost::uint64_t offset,
+                                                 const TFileScalar*)
+{
+  if (!numValues)
+  {
+    return true;
+  }
+
+  // the file holds the values in the type we want
+  if (sizeof(TFileScalar) == sizeof(TScalar))
+  {
+    return readBytes(dest, numValues * sizeof(TScalar), offset);
+  }
+
+  m_buffer.resize(numValues * sizeof(TFileScalar));
+  if (!readBytes(&m_buffer[0], m_buffer.size(), offset))
+  {
+    return false;
+  }
+
+  const TFileScalar* src = reinterpret_cast<const TFileScalar*>(&m_buffer[0]);
+  std::copy(src, src + numValues, dest);
+
+  return true;
+}
+
+
+template <typename TScalar>
+bool NNetDataReaderTemplate<TScalar>::readBytes(void* dest,
+                                                std::size_t length,
+                                                boost::uint64_t offset)
+{
+  char* p = static_cast<char*>(dest);
+  while (length)
+  {
+    ssize_t count = ::pread(m_fd, p, length, off_t(offset));
+    if (count > 0)
+    {
+      p += count;
+      length -= count;
+      offset += count;
+    }
+    else if (!count || (errno != EINTR))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+template class NNetDataReaderTemplate<double>;
+template class NNetDataReaderTemplate<float>;
+
+} // namespace alch
@@ -0,0 +1,297 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_NNetDataReader_h
+#define INCLUDED_nnet_NNetDataReader_h
+
+#include "autil/Context.h"
+#include "nnet/NNetDataset.h"
+#include "nnet/NNetDataFile.h"
+
+#include "boost/cstdint.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+namespace alch {
+
+/*!
+  \brief Reads a binary dataset file in blocks, for datasets larger than
+  memory
+  \ingroup nnet
+
+  Reads files written by NNetDataFile::write(). The points are returned as
+  consecutive blocks of getBlockSize() points; the last block of the file
+  may be smaller. Only two blocks are held in memory: while the caller
+  works on the block returned by next(), a background thread reads the
+  following one into the other buffer. The thread is started by the first
+  read and kept until the reader is destroyed.
+
+  Each pass over the file visits every point once. With shuffling on, each
+  pass visits the blocks in a new random order and the points of each
+  block are shuffled after reading; the shuffles use private random number
+  generators, so a given seed always produces the same sequence of passes.
+*/
+template <typename TScalar>
+class NNetDataReaderTemplate
+{
+ public:
+
+  //! Type of the blocks returned by next()
+  typedef NNetDatasetTemplate<TScalar> Dataset;
+
+  /*!
+    \brief Constructor; the file is not opened until open() is called
+    \param blockSize Number of points per block
+    \param seed Seed for the random number generators used for shuffling
+  */
+  explicit NNetDataReaderTemplate(int blockSize = 65536, long seed = 0);
+
+  /*!
+    \brief Destructor; waits for any read in progress, closes the file and
+    stops the read thread
+  */
+  ~NNetDataReaderTemplate();
+
+  /*!
+    \brief Opens the named file and starts reading its first block
+    \param filename Name of the file to read
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error; the file is not a valid dataset file
+  */
+  bool open(const std::string& filename, Context& ctx);
+
+  //! Closes the file, if any
+  void close();
+
+  //! Whether a file is open
+  bool isOpen() const
+  {
+    return (m_fd != -1);
+  }
+
+  //! Number of data points in the file
+  int size() const
+  {
+    return m_numPoints;
+  }
+
+  //! Number of inputs of each data point
+  int getNumInputs() const
+  {
+    return m_numInputs;
+  }
+
+  //! Number of outputs of each data point
+  int getNumOutputs() const
+  {
+    return m_numOutputs;
+  }
+
+  //! Number of points per block
+  int getBlockSize() const
+  {
+    return m_blockSize;
+  }
+
+  //! Number of blocks in each pass
+  int getNumBlocks() const
+  {
+    return int(m_order.size());
+  }
+
+  //! Whether the blocks and the points in them are shuffled
+  bool getShuffle() const
+  {
+    return m_shuffle;
+  }
+
+  /*!
+    \brief Turns shuffling on or off
+    \param val Whether to shuffle
+
+    Takes effect from the next pass; see rewind().
+  */
+  void setShuffle(bool val)
+  {
+    m_shuffle = val;
+  }
+
+  /*!
+    \brief Reseeds the random number generators used for shuffling
+    \param val The seed
+
+    Seeding works the same way as srand48(). Takes effect from the next
+    pass; see rewind().
+  */
+  void setSeed(long val);
+
+  /*!
+    \brief Abandons the current pass and starts a new one
+  */
+  void rewind();
+
+  /*!
+    \brief Returns the next block of the current pass
+    \return The block, or 0 at the end of the pass or on a read error
+
+    The block stays valid until the next call to next(), rewind() or
+    close(). After returning 0 at the end of a pass the reader starts the
+    next pass, so the following call returns its first block; the first
+    block is read while the caller does something else.
+  */
+  const Dataset* next();
+
+  /*!
+    \brief Writes the state of the random number generators at the start
+    of the current pass
+    \param os The output stream; should be opened in binary mode
+
+    The format is that of StateIO.
+  */
+  void writeState(std::ostream& os) const;
+
+  /*!
+    \brief Reads state written by writeState() and starts the pass over
+    \param is The input stream; should be opened in binary mode
+    \retval true Success
+    \retval false The stream failed
+
+    The pass visits the blocks and points in the same order as the pass
+    the state was written in, so training that stops at the end of a pass
+    and is resumed reads the same data as training that goes on.
+  */
+  bool readState(std::istream& is);
+
+  //! Whether a read failed; next() returns 0 until the reader is reopened
+  bool failed() const
+  {
+    return m_failed;
+  }
+
+ private:
+
+  // not implemented; a reader owns a file and a thread
+  NNetDataReaderTemplate(const NNetDataReaderTemplate&);
+  NNetDataReaderTemplate& operator=(const NNetDataReaderTemplate&);
+
+  //! Picks the block order of a new pass and starts reading its first block
+  void startPass();
+
+  //! Has the read thread start reading block m_order[m_nextBlock] into
+  //! m_spare
+  void startRead();
+
+  //! Waits for the read started by startRead(), if any
+  void finishRead();
+
+  //! Body of the read thread; reads each block startRead() hands out
+  //! until stopThread()
+  void runThread();
+
+  //! Stops and joins the read thread
+  void stopThread();
+
+  //! Fills m_spare with block and shuffles it; runs on the read thread
+  void readBlock(int block);
+
+  /*!
+    \brief Reads values from the file and converts them to TScalar
+    \param dest [out] Where to put the values
+    \param numValues Number of values to read
+    \param offset Offset of the first value in the file
+    \retval true Success
+    \retval false Error
+  */
+  template <typename TFileScalar>
+  bool readValues(TScalar* dest, std::size_t numValues,
+                  boost::uint64_t offset, const TFileScalar* dummy);
+
+  //! Reads length bytes at offset, retrying short reads
+  bool readBytes(void* dest, std::size_t length, boost::uint64_t offset);
+
+  //! File being read, or -1 if none
+  int m_fd;
+
+  //! Number of points per block
+  int m_blockSize;
+
+  int m_numPoints;
+  int m_numInputs;
+  int m_numOutputs;
+  NNetDataFile::DataType m_dataType;
+
+  //! Offset in the file of the input matrix
+  boost::uint64_t m_inputOffset;
+
+  //! Offset in the file of the output matrix
+  boost::uint64_t m_outputOffset;
+
+  //! Whether to shuffle the blocks and the points in them
+  bool m_shuffle;
+
+  //! Random number generator state for the block order
+  unsigned short m_orderRandState[3];
+
+  //! Random number generator state for the points of each block; only
+  //! used by the read thread
+  unsigned short m_pointRandState[3];
+
+  //! m_orderRandState at the start of the current pass
+  unsigned short m_passOrderRandState[3];
+
+  //! m_pointRandState at the start of the current pass
+  unsigned short m_passPointRandState[3];
+
+  //! Blocks in the order of the current pass
+  std::vector<int> m_order;
+
+  //! Index into m_order of the block being read into m_spare
+  int m_nextBlock;
+
+  //! Block last returned by next()
+  Dataset m_current;
+
+  //! Block being read by the read thread
+  Dataset m_spare;
+
+  //! Values of a block in the file's type when it doesn't match TScalar
+  std::vector<char> m_buffer;
+
+  //! The read thread, or 0 if it hasn't been started
+  boost::scoped_ptr<boost::thread> m_thread;
+
+  //! Guards m_readBlock and m_stopThread
+  boost::mutex m_readMutex;
+
+  //! Signaled, with m_readMutex, when a read is started or finished or
+  //! the thread is asked to stop
+  boost::condition m_readCondition;
+
+  //! Block being read by the read thread, or -1 if none
+  int m_readBlock;
+
+  //! Whether the read thread should exit
+  bool m_stopThread;
+
+  //! Set by the read thread when a read fails
+  bool m_readFailed;
+
+  //! Whether a read failed
+  bool m_failed;
+};
+
+//! Reader for the default dataset type
+typedef NNetDataReaderTemplate<double> NNetDataReader;
+
+//! Reader for the single precision dataset type
+typedef NNetDataReaderTemplate<float> FloatNNetDataReader;
+
+} // namespace alch
+
+#endif
@@ -26,6 +26,26 @@ namespace alch {
         }
       }
 
+      void writeValues(std::ostream& os,
+                       const double* input,
+                       int numInputs,
+                       const double* output,
+                       int numOutputs)
+      {
+        for (int i = 0; i < numInputs; ++i)
+        {
+          os << input[i] << " ";
+        }
+
+        os << "|";
+
+        for (int i = 0; i < numOutputs; ++i)
+        {
+          os << " " << output[i];
+        }
+        os << "\n";
+      }
+
     } // anonymous namespace
 
 
@@ -72,21 +92,11 @@ namespace alch {
                         const NNetDatapoint& dataPoint,
                         Context& ctx)
     {
-      std::vector<double>::const_iterator end = dataPoint.input.end();
-      std::vector<double>::const_iterator iter;
-      for (iter = dataPoint.input.begin(); iter != end; ++iter)
-      {
-        os << *iter << " ";
-      }
-
-      os << "|";
-
-      end = dataPoint.output.end();
-      for (iter = dataPoint.output.begin(); iter != end; ++iter)
-      {
-        os << " " << *iter;
-      }
-      os << "\n";
+      writeValues(os,
+                  dataPoint.input.empty() ? 0 : &dataPoint.input[0],
+                  int(dataPoint.input.size()),
+                  dataPoint.output.empty() ? 0 : &dataPoint.output[0],
+                  int(dataPoint.output.size()));
 
       return os;
     }
@@ -157,14 +167,12 @@ namespace alch {
                       const NNetDataset& dataset,
                       Context& ctx)
     {
-      NNetDataset::const_iterator end = dataset.end();
-      NNetDataset::const_iterator iter;
-      for (iter = dataset.begin(); iter != end; ++iter)
+      int numPoints = int(dataset.size());
+      for (int i = 0; i < numPoints && os; ++i)
       {
-        if (!writeDatapoint(os, *iter, ctx))
-        {
-          return false;
-        }
+        writeValues(os,
+                    dataset.getInput(i), dataset.getNumInputs(),
+                    dataset.getOutput(i), dataset.getNumOutputs());
       }
 
       return os;
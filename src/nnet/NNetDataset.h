@@ -4,6 +4,9 @@
 #define INCLUDED_nnet_NNetDataset_h
 
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
 #include <cassert>
 
 #ifndef NDEBUG
@@ -13,24 +16,165 @@
 
 namespace alch {
 
+/*!
+  \brief View of the values of one row of a dataset matrix
+
+  Behaves like a fixed size std::vector that refers to values owned by an
+  NNetDatasetTemplate; it is only valid until the dataset is resized or
+  reshaped. TValue is const for views into a const dataset.
+*/
+template <typename TValue>
+class NNetRowTemplate
+{
+ public:
+  typedef TValue value_type;
+  typedef TValue* iterator;
+  typedef TValue* const_iterator;
+  typedef std::size_t size_type;
+
+  NNetRowTemplate(TValue* begin, int size)
+    : m_begin(begin)
+    , m_size(size)
+  {
+    assert(size >= 0);
+  }
+
+  //! Number of values in the row
+  size_type size() const
+  {
+    return m_size;
+  }
+
+  //! Whether the row has no values
+  bool empty() const
+  {
+    return !m_size;
+  }
+
+  TValue& operator[](int i) const
+  {
+    assert(i >= 0);
+    assert(i < m_size);
+    return m_begin[i];
+  }
+
+  iterator begin() const
+  {
+    return m_begin;
+  }
+
+  iterator end() const
+  {
+    return m_begin + m_size;
+  }
+
+  /*!
+    \brief Overwrites the values of the row
+    \param first Start of the new values
+    \param last End of the new values; there must be size() of them
+  */
+  template <typename TIterator>
+  void assign(TIterator first, TIterator last) const
+  {
+    assert(std::distance(first, last) == m_size);
+    std::copy(first, last, m_begin);
+  }
+
+ private:
+  TValue* m_begin;
+  int m_size;
+};
+
+
+/*!
+  \brief View of the inputs and outputs of one data point of a dataset
+
+  Returned by NNetDatasetTemplate::operator[] in place of a reference to
+  a data point; input and output can be used like the vectors of
+  NNetDatapointTemplate except that they can't change size.
+*/
+template <typename TValue>
+struct NNetDatapointRefTemplate
+{
+ public:
+  NNetDatapointRefTemplate(TValue* inputBegin,
+                           int numInputs,
+                           TValue* outputBegin,
+                           int numOutputs)
+    : input(inputBegin, numInputs)
+    , output(outputBegin, numOutputs)
+  {
+    ;
+  }
+
+  //! Inputs
+  NNetRowTemplate<TValue> input;
+
+  //! Outputs
+  NNetRowTemplate<TValue> output;
+
+#ifndef NDEBUG
+  void dump(std::ostream& os) const
+  {
+    os << "I( ";
+    for (int i = 0; i < int(input.size()); ++i)
+    {
+      os << input[i] << " ";
+    }
+
+    os << ")  O( ";
+    for (int i = 0; i < int(output.size()); ++i)
+    {
+      os << output[i] << " ";
+    }
+
+    os << ")\n";
+  }
+#endif
+};
+
+
 /*!
   \brief Data point for neural network
+
+  TScalar is the type of the values; it must match the scalar type of the
+  network the point is used with.
 */
-struct NNetDatapoint
+template <typename TScalar>
+struct NNetDatapointTemplate
 {
  public:
-  NNetDatapoint()
+  NNetDatapointTemplate()
     : input()
     , output()
   {
     ;
   }
 
+  //! Creates a copy of a data point with a different scalar type
+  template <typename TOtherScalar>
+  explicit NNetDatapointTemplate(
+    const NNetDatapointTemplate<TOtherScalar>& other)
+    : input(other.input.begin(), other.input.end())
+    , output(other.output.begin(), other.output.end())
+  {
+    ;
+  }
+
+  //! Creates a copy of a data point held in a dataset
+  template <typename TValue>
+  NNetDatapointTemplate(const NNetDatapointRefTemplate<TValue>& other)
+    : input(other.input.begin(), other.input.end())
+    , output(other.output.begin(), other.output.end())
+  {
+    ;
+  }
+
   //! Inputs
-  std::vector<double> input;
+  std::vector<TScalar> input;
 
   //! Outputs
-  std::vector<double> output;
+  std::vector<TScalar> output;
 
   //! Removes all inputs and outputs
   void clear()
@@ -45,8 +189,8 @@ struct NNetDatapoint
     os << "I( ";
 
     {
-      std::vector<double>::const_iterator end = input.end();
-      std::vector<double>::const_iterator iter;
+      typename std::vector<TScalar>::const_iterator end = input.end();
+      typename std::vector<TScalar>::const_iterator iter;
       for (iter = input.begin(); iter != end; ++iter)
       {
         os << *iter << " ";
@@ -56,8 +200,8 @@ struct NNetDatapoint
     os << ")  O( ";
 
     {
-      std::vector<double>::const_iterator end = output.end();
-      std::vector<double>::const_iterator iter;
+      typename std::vector<TScalar>::const_iterator end = output.end();
+      typename std::vector<TScalar>::const_iterator iter;
       for (iter = output.begin(); iter != end; ++iter)
       {
         os << *iter << " ";
@@ -70,26 +214,422 @@ struct NNetDatapoint
 };
 
 
-//! Set of datapoints for neural network
-struct NNetDataset : public std::vector<NNetDatapoint>
+/*!
+  \brief Set of datapoints for neural network
+
+  Every point has the same number of inputs and outputs. The inputs of all
+  points are held in one dense row-major matrix and the outputs in a
+  second one, so walking the points is unit stride and a dataset costs
+  two allocations however many points it holds. operator[] returns a
+  view of one point whose input and output behave like fixed size
+  vectors.
+
+  The first point added to an empty dataset sets the number of inputs and
+  outputs; setNumInputs() and setNumOutputs() change them for all points.
+*/
+template <typename TScalar>
+class NNetDatasetTemplate
 {
+ public:
+
+  //! Data point that can be added to the dataset
+  typedef NNetDatapointTemplate<TScalar> Datapoint;
+
+  //! View of a point in the dataset
+  typedef NNetDatapointRefTemplate<TScalar> Reference;
+
+  //! View of a point in a const dataset
+  typedef NNetDatapointRefTemplate<const TScalar> ConstReference;
+
+  typedef std::size_t size_type;
+
+  NNetDatasetTemplate()
+    : m_numPoints(0)
+    , m_numInputs(0)
+    , m_numOutputs(0)
+    , m_input()
+    , m_output()
+  {
+    ;
+  }
+
+  //! Creates a dataset of numPoints points whose values are all zero
+  NNetDatasetTemplate(int numPoints, int numInputs, int numOutputs)
+    : m_numPoints(numPoints)
+    , m_numInputs(numInputs)
+    , m_numOutputs(numOutputs)
+    , m_input(std::size_t(numPoints) * numInputs, TScalar(0))
+    , m_output(std::size_t(numPoints) * numOutputs, TScalar(0))
+  {
+    assert(numPoints >= 0);
+    assert(numInputs >= 0);
+    assert(numOutputs >= 0);
+  }
+
+  //! Creates a copy of a dataset with a different scalar type
+  template <typename TOtherScalar>
+  explicit NNetDatasetTemplate(const NNetDatasetTemplate<TOtherScalar>& other)
+    : m_numPoints(int(other.size()))
+    , m_numInputs(other.getNumInputs())
+    , m_numOutputs(other.getNumOutputs())
+    , m_input(other.getInputs(),
+              other.getInputs() + std::size_t(m_numPoints) * m_numInputs)
+    , m_output(other.getOutputs(),
+               other.getOutputs() + std::size_t(m_numPoints) * m_numOutputs)
+  {
+    ;
+  }
+
+  //! Number of points
+  size_type size() const
+  {
+    return m_numPoints;
+  }
+
+  //! Whether there are no points
+  bool empty() const
+  {
+    return !m_numPoints;
+  }
+
+  //! Number of inputs of every point
+  int getNumInputs() const
+  {
+    return m_numInputs;
+  }
+
+  //! Number of outputs of every point
+  int getNumOutputs() const
+  {
+    return m_numOutputs;
+  }
+
+  /*!
+    \brief Returns the input matrix
+    \return size() rows of getNumInputs() values, or 0 if there are none
+  */
+  const TScalar* getInputs() const
+  {
+    return (m_input.empty() ? 0 : &m_input[0]);
+  }
+
+  //! Returns the input matrix
+  TScalar* getInputs()
+  {
+    return (m_input.empty() ? 0 : &m_input[0]);
+  }
+
+  /*!
+    \brief Returns the output matrix
+    \return size() rows of getNumOutputs() values, or 0 if there are none
+  */
+  const TScalar* getOutputs() const
+  {
+    return (m_output.empty() ? 0 : &m_output[0]);
+  }
+
+  //! Returns the output matrix
+  TScalar* getOutputs()
+  {
+    return (m_output.empty() ? 0 : &m_output[0]);
+  }
+
+  //! Returns the inputs of point i
+  const TScalar* getInput(int i) const
+  {
+    assert(i >= 0);
+    assert(i < m_numPoints);
+    return getInputs() + std::size_t(i) * m_numInputs;
+  }
+
+  //! Returns the outputs of point i
+  const TScalar* getOutput(int i) const
+  {
+    assert(i >= 0);
+    assert(i < m_numPoints);
+    return getOutputs() + std::size_t(i) * m_numOutputs;
+  }
+
+  Reference operator[](int i)
+  {
+    assert(i >= 0);
+    assert(i < m_numPoints);
+    return Reference(getInputs() + std::size_t(i) * m_numInputs,
+                     m_numInputs,
+                     getOutputs() + std::size_t(i) * m_numOutputs,
+                     m_numOutputs);
+  }
+
+  ConstReference operator[](int i) const
+  {
+    assert(i >= 0);
+    assert(i < m_numPoints);
+    return ConstReference(getInput(i), m_numInputs,
+                          getOutput(i), m_numOutputs);
+  }
+
+  /*!
+    \brief Adds a point to the end of the dataset
+    \param point The point; must have getNumInputs() inputs and
+    getNumOutputs() outputs unless the dataset is empty
+  */
+  void push_back(const Datapoint& point)
+  {
+    append(point.input.begin(), int(point.input.size()),
+           point.output.begin(), int(point.output.size()));
+  }
+
+  //! Adds a copy of a point of another dataset to the end of the dataset
+  template <typename TValue>
+  void push_back(const NNetDatapointRefTemplate<TValue>& point)
+  {
+    append(point.input.begin(), int(point.input.size()),
+           point.output.begin(), int(point.output.size()));
+  }
+
+  /*!
+    \brief Adds all points of another dataset to the end of this one
+    \param other The points to add; must have the same number of inputs
+    and outputs as this dataset unless this one is empty. May be this
+    dataset.
+  */
+  void append(const NNetDatasetTemplate& other)
+  {
+    if (other.empty())
+    {
+      return;
+    }
+
+    if (empty())
+    {
+      *this = other;
+      return;
+    }
+
+    assert(other.getNumInputs() == m_numInputs);
+    assert(other.getNumOutputs() == m_numOutputs);
+
+    // other may be this dataset, so its values are copied only once the
+    // matrices have been resized
+    std::size_t numInputValues = other.m_input.size();
+    std::size_t numOutputValues = other.m_output.size();
+    int numPoints = other.m_numPoints;
+
+    m_input.resize(m_input.size() + numInputValues);
+    std::copy(other.m_input.begin(), other.m_input.begin() + numInputValues,
+              m_input.end() - numInputValues);
+    m_output.resize(m_output.size() + numOutputValues);
+    std::copy(other.m_output.begin(),
+              other.m_output.begin() + numOutputValues,
+              m_output.end() - numOutputValues);
+    m_numPoints += numPoints;
+  }
+
+  //! Removes points [first, last)
+  void erase(int first, int last)
+  {
+    assert(first >= 0);
+    assert(first <= last);
+    assert(last <= m_numPoints);
+
+    m_input.erase(m_input.begin() + std::size_t(first) * m_numInputs,
+                  m_input.begin() + std::size_t(last) * m_numInputs);
+    m_output.erase(m_output.begin() + std::size_t(first) * m_numOutputs,
+                   m_output.begin() + std::size_t(last) * m_numOutputs);
+    m_numPoints -= (last - first);
+  }
+
+  //! Changes the number of points; new points have values of zero
+  void resize(int numPoints)
+  {
+    assert(numPoints >= 0);
+
+    m_input.resize(std::size_t(numPoints) * m_numInputs, TScalar(0));
+    m_output.resize(std::size_t(numPoints) * m_numOutputs, TScalar(0));
+    m_numPoints = numPoints;
+  }
+
+  //! Reserves memory for numPoints points of the current shape
+  void reserve(int numPoints)
+  {
+    m_input.reserve(std::size_t(numPoints) * m_numInputs);
+    m_output.reserve(std::size_t(numPoints) * m_numOutputs);
+  }
+
+  //! Removes all points
+  void clear()
+  {
+    m_input.clear();
+    m_output.clear();
+    m_numPoints = 0;
+  }
+
+  //! Exchanges all points of this dataset with those of other
+  void swap(NNetDatasetTemplate& other)
+  {
+    std::swap(m_numPoints, other.m_numPoints);
+    std::swap(m_numInputs, other.m_numInputs);
+    std::swap(m_numOutputs, other.m_numOutputs);
+    m_input.swap(other.m_input);
+    m_output.swap(other.m_output);
+  }
+
+  //! Exchanges the values of points a and b
+  void swapPoints(int a, int b)
+  {
+    assert(a >= 0);
+    assert(a < m_numPoints);
+    assert(b >= 0);
+    assert(b < m_numPoints);
+
+    std::swap_ranges(m_input.begin() + std::size_t(a) * m_numInputs,
+                     m_input.begin() + std::size_t(a + 1) * m_numInputs,
+                     m_input.begin() + std::size_t(b) * m_numInputs);
+    std::swap_ranges(m_output.begin() + std::size_t(a) * m_numOutputs,
+                     m_output.begin() + std::size_t(a + 1) * m_numOutputs,
+                     m_output.begin() + std::size_t(b) * m_numOutputs);
+  }
+
+  /*!
+    \brief Changes the number of inputs of every point
+    \param numInputs The new number of inputs
+
+    Points keep their first numInputs inputs; added inputs are zero.
+  */
+  void setNumInputs(int numInputs)
+  {
+    reshape(m_input, m_numInputs, numInputs);
+    m_numInputs = numInputs;
+  }
+
+  /*!
+    \brief Changes the number of outputs of every point
+    \param numOutputs The new number of outputs
+
+    Points keep their first numOutputs outputs; added outputs are zero.
+  */
+  void setNumOutputs(int numOutputs)
+  {
+    reshape(m_output, m_numOutputs, numOutputs);
+    m_numOutputs = numOutputs;
+  }
+
 #ifndef NDEBUG
   void dump(std::ostream& os) const
   {
     os << "[NNetDataset of " << size() << " points]\n";
-    const_iterator final = end();
-    const_iterator iter;
-    int i = 0;
-    for (iter = begin(); iter != final; ++iter, ++i)
+    for (int i = 0; i < m_numPoints; ++i)
     {
       os << "(" << i << ")  ";
-      iter->dump(os);
+      (*this)[i].dump(os);
     }
     os << "[End NNetDataset]\n";
   }
 #endif
+
+ private:
+
+  // appends one point given its values, which may be those of a point of
+  // this dataset
+  template <typename TIterator>
+  void append(TIterator input, int numInputs,
+              TIterator output, int numOutputs)
+  {
+    if (empty())
+    {
+      m_numInputs = numInputs;
+      m_numOutputs = numOutputs;
+      m_input.clear();
+      m_output.clear();
+    }
+
+    assert(numInputs == m_numInputs);
+    assert(numOutputs == m_numOutputs);
+
+    appendRow(m_input, input, numInputs);
+    appendRow(m_output, output, numOutputs);
+    ++m_numPoints;
+  }
+
+  // appends values to matrix; values may point into matrix itself
+  template <typename TIterator>
+  static void appendRow(std::vector<TScalar>& matrix,
+                        TIterator values,
+                        int numValues)
+  {
+    std::size_t size = matrix.size() + numValues;
+    if (size > matrix.capacity())
+    {
+      // the old storage, and so the values, stay valid while copying
+      std::vector<TScalar> grown;
+      grown.reserve(std::max(size, 2 * matrix.capacity()));
+      grown.insert(grown.end(), matrix.begin(), matrix.end());
+      grown.insert(grown.end(), values, values + numValues);
+      matrix.swap(grown);
+      return;
+    }
+
+    // no reallocation, so the values stay valid
+    for (int i = 0; i < numValues; ++i)
+    {
+      matrix.push_back(static_cast<TScalar>(values[i]));
+    }
+  }
+
+  // changes the row length of matrix from oldLength to newLength
+  void reshape(std::vector<TScalar>& matrix, int oldLength, int newLength)
+  {
+    assert(newLength >= 0);
+    if (newLength == oldLength)
+    {
+      return;
+    }
+
+    std::vector<TScalar> reshaped(std::size_t(m_numPoints) * newLength,
+                                  TScalar(0));
+    int keep = std::min(oldLength, newLength);
+    for (int i = 0; i < m_numPoints; ++i)
+    {
+      std::copy(matrix.begin() + std::size_t(i) * oldLength,
+                matrix.begin() + std::size_t(i) * oldLength + keep,
+                reshaped.begin() + std::size_t(i) * newLength);
+    }
+
+    matrix.swap(reshaped);
+  }
+
+  int m_numPoints;
+  int m_numInputs;
+  int m_numOutputs;
+
+  //! Inputs of every point, row-major
+  std::vector<TScalar> m_input;
+
+  //! Outputs of every point, row-major
+  std::vector<TScalar> m_output;
 };
 
+//! Data point for the default (double precision) neural networks
+typedef NNetDatapointTemplate<double> NNetDatapoint;
+
+//! Dataset for the default (double precision) neural networks
+typedef NNetDatasetTemplate<double> NNetDataset;
+
+//! Data point for single precision neural networks
+typedef NNetDatapointTemplate<float> FloatNNetDatapoint;
+
+//! Dataset for single precision neural networks
+typedef NNetDatasetTemplate<float> FloatNNetDataset;
+
+/*!
+  \brief Data points that each hold their own inputs and outputs
+
+  Unlike NNetDataset the points may have different numbers of values, so
+  a dataset can be built up one input at a time before it is packed into
+  an NNetDataset.
+*/
+typedef std::vector<NNetDatapoint> NNetDatapointList;
+
 } // namespace alch
 
 #endif
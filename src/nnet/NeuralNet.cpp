@@ -6,6 +6,9 @@ namespace alch {
   namespace {
     TanhNeuralNet dummy1;
     LinearNeuralNet dummy2;
+    FloatTanhNeuralNet dummy3;
+    FloatLinearNeuralNet dummy4;
+    FastTanhNeuralNet dummy5;
   }
 
 } // namespace alch
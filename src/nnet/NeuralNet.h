@@ -31,6 +31,31 @@ typedef TanhNeuralNet NeuralNet;
 //! Shared pointer to neural network
 typedef boost::shared_ptr<NeuralNet> NeuralNetPtr;
 
+//! Single precision network using tanh hidden and output activation
+typedef
+  NeuralNetTemplate<NeuralNetFunctors::Tanh, NeuralNetFunctors::Tanh, float>
+  FloatTanhNeuralNet;
+
+//! Single precision network using tanh hidden and linear output activation
+typedef
+  NeuralNetTemplate<NeuralNetFunctors::Tanh, NeuralNetFunctors::Linear, float>
+  FloatLinearNeuralNet;
+
+//! Single precision version of the default neural network type
+typedef FloatTanhNeuralNet FloatNeuralNet;
+
+//! Shared pointer to single precision neural network
+typedef boost::shared_ptr<FloatNeuralNet> FloatNeuralNetPtr;
+
+//! Network using the tanh approximation for hidden and output activation;
+//! a faster but approximate copy of NeuralNet for bulk scoring
+typedef
+  NeuralNetTemplate<NeuralNetFunctors::FastTanh, NeuralNetFunctors::FastTanh>
+  FastTanhNeuralNet;
+
+//! Shared pointer to neural network
+typedef boost::shared_ptr<FastTanhNeuralNet> FastTanhNeuralNetPtr;
+
 } // namespace alch
 
 #endif
@@ -3,6 +3,7 @@
 
 #include "nnet/Statistics.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace alch {
@@ -15,7 +16,8 @@ namespace NeuralNetAlg
     // srand48(time(0));
   }
 
-  void randomizeWeights(NeuralNet& net, double min, double max)
+  template <class TNeuralNet>
+  void randomizeWeights(TNeuralNet& net, double min, double max)
   {
     assert(max >= min);
 
@@ -38,32 +40,59 @@ namespace NeuralNetAlg
     }
   }
 
-  double calculateError(NeuralNet& net, const NNetDataset& dataset)
+  template <class TNeuralNet>
+  double calculateError(
+    const TNeuralNet& net,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset)
   {
+    typename TNeuralNet::Workspace workspace(net);
+    return calculateError(net, dataset, workspace);
+  }
+
+
+  template <class TNeuralNet>
+  double calculateError(
+    const TNeuralNet& net,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset,
+    typename TNeuralNet::Workspace& workspace)
+  {
+    typedef typename TNeuralNet::Scalar Scalar;
+
+    const int batchRows = 64;
+
     double error = 0.00;
     int totalPoints = 0;
 
-    // calculate squared error for each point in dataset
-    NNetDataset::const_iterator end = dataset.end();
-    NNetDataset::const_iterator iter;
-    for (iter = dataset.begin(); iter != end; ++iter)
-    {
-      net.propagateInput(iter->input);
-      const std::vector<double>& output = net.getOutput();
-      const std::vector<double>& target = iter->output;
+    int datasetSize = int(dataset.size());
+    int numInput = dataset.getNumInputs();
+    int numOutput = net.getNumOutputUnits();
+
+    assert(!datasetSize || (numInput == net.getNumInputUnits()));
+    assert(!datasetSize || (numOutput == dataset.getNumOutputs() + 1));
 
-      assert(output.size() == target.size() + 1);
-      int numOutput = output.size();
+    // calculate squared error for each point in dataset, propagating
+    // batchRows points at a time straight from the input matrix
+    for (int first = 0; first < datasetSize; first += batchRows)
+    {
+      int numRows = std::min(batchRows, datasetSize - first);
+      net.propagateBatch(dataset.getInput(first), numRows, numInput,
+                         workspace);
 
-      for (int i = 1; i < numOutput; ++i)
+      for (int row = 0; row < numRows; ++row)
       {
-        double diff = output[i] - target[i - 1];
+        const Scalar* output = workspace.getBatchOutput(row);
+        const Scalar* target = dataset.getOutput(first + row);
 
-        // sum the squared error
-        error += (diff * diff);
+        for (int i = 1; i < numOutput; ++i)
+        {
+          double diff = output[i] - target[i - 1];
 
-        // keep track of how many datapoints we're summing over
-        ++totalPoints;
+          // sum the squared error
+          error += (diff * diff);
+
+          // keep track of how many datapoints we're summing over
+          ++totalPoints;
+        }
       }
     }
 
@@ -166,30 +195,76 @@ namespace NeuralNetAlg
   }
 
 
-  void calculateOutputs(NeuralNet& net, NNetDataset& dataset)
+  template <class TNeuralNet>
+  void calculateOutputs(
+    const TNeuralNet& net,
+    NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset)
+  {
+    typename TNeuralNet::Workspace workspace(net);
+    calculateOutputs(net, dataset, workspace);
+  }
+
+
+  template <class TNeuralNet>
+  void calculateOutputs(
+    const TNeuralNet& net,
+    NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset,
+    typename TNeuralNet::Workspace& workspace)
   {
+    typedef typename TNeuralNet::Scalar Scalar;
+
+    const int batchRows = 64;
+
     int datasetSize = int(dataset.size());
-    for (int idx = 0; idx < datasetSize; ++idx)
+    int numInput = dataset.getNumInputs();
+    int numOutput = net.getNumOutputUnits();
+    assert(numOutput > 1);
+    assert(!datasetSize || (numInput == net.getNumInputUnits()));
+
+    dataset.setNumOutputs(numOutput - 1);
+
+    for (int first = 0; first < datasetSize; first += batchRows)
     {
-       net.propagateInput(dataset[idx].input);
-       const std::vector<double>& outputs(net.getOutput());
-       int outputsSize = int(outputs.size());
-       assert(outputsSize > 1);
-
-       dataset[idx].output.clear();
-       dataset[idx].output.reserve(outputsSize);
-
-       std::vector<double>::const_iterator end = outputs.end();
-       std::vector<double>::const_iterator iter;
-       for (iter = outputs.begin() + 1; iter != end; ++iter)
-       {
-         dataset[idx].output.push_back(*iter);
-       }
+      int numRows = std::min(batchRows, datasetSize - first);
+      net.propagateBatch(dataset.getInput(first), numRows, numInput,
+                         workspace);
+
+      // skip the constant unit
+      for (int row = 0; row < numRows; ++row)
+      {
+        const Scalar* output = workspace.getBatchOutput(row);
+        dataset[first + row].output.assign(output + 1, output + numOutput);
+      }
     }
   }
 
-} // namespace NeuralNetAlg
 
-} // namespace alch
+  // the network types we support
+#define NEURALNETALG_INSTANTIATE(TNeuralNet)                            \
+  template void randomizeWeights(TNeuralNet&, double, double);          \
+  template double calculateError(                                       \
+    const TNeuralNet&,                                                  \
+    const NNetDatasetTemplate<TNeuralNet::Scalar>&);                    \
+  template double calculateError(                                       \
+    const TNeuralNet&,                                                  \
+    const NNetDatasetTemplate<TNeuralNet::Scalar>&,                     \
+    TNeuralNet::Workspace&);                                            \
+  template void calculateOutputs(                                       \
+    const TNeuralNet&,                                                  \
+    NNetDatasetTemplate<TNeuralNet::Scalar>&);                          \
+  template void calculateOutputs(                                       \
+    const TNeuralNet&,                                                  \
+    NNetDatasetTemplate<TNeuralNet::Scalar>&,                           \
+    TNeuralNet::Workspace&);
+
+  NEURALNETALG_INSTANTIATE(TanhNeuralNet)
+  NEURALNETALG_INSTANTIATE(LinearNeuralNet)
+  NEURALNETALG_INSTANTIATE(FloatTanhNeuralNet)
+  NEURALNETALG_INSTANTIATE(FloatLinearNeuralNet)
+  NEURALNETALG_INSTANTIATE(FastTanhNeuralNet)
+
+#undef NEURALNETALG_INSTANTIATE
 
+} // namespace NeuralNetAlg
 
+} // namespace alch
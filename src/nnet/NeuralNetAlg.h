@@ -26,6 +26,13 @@ namespace NeuralNetAlg
   */
   void init();
 
+  /*
+    The functions that take a network are templates on the network type;
+    the dataset must use the network's scalar type. They are instantiated
+    for the double and float TanhNeuralNet and LinearNeuralNet types and
+    for FastTanhNeuralNet.
+  */
+
   /*!
     \brief Randomizes the weights of the specified neural network
     \param net The network for which we are randomizing the weights
@@ -35,7 +42,8 @@ namespace NeuralNetAlg
     Assumes net is fully initialized. Each existing weight in net will
     be set to a value between min and max.
   */
-  void randomizeWeights(NeuralNet& net, double min, double max);
+  template <class TNeuralNet>
+  void randomizeWeights(TNeuralNet& net, double min, double max);
 
 
   /*!
@@ -47,7 +55,26 @@ namespace NeuralNetAlg
     dataset. The network output is compared to the datapoint output
     and the difference is used to calculate the squared error.
   */
-  double calculateError(NeuralNet& net, const NNetDataset& dataset);
+  template <class TNeuralNet>
+  double calculateError(
+    const TNeuralNet& net,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset);
+
+
+  /*!
+    \brief Calculates the squared error for the network on a dataset
+    \param net The neural network
+    \param dataset The dataset to calculate
+    \param workspace Workspace to propagate the inputs in
+
+    Same as above, but reuses the caller's workspace instead of allocating
+    one on each call.
+  */
+  template <class TNeuralNet>
+  double calculateError(
+    const TNeuralNet& net,
+    const NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset,
+    typename TNeuralNet::Workspace& workspace);
  
 
   /*!
@@ -122,10 +149,30 @@ namespace NeuralNetAlg
     \param dataset [in/out] The dataset to use for input propagation and
     output storage
 
-    Clears outputs before writing to it.
+    Sets the number of outputs of each point to the number of network
+    outputs before writing them.
+  */
+  template <class TNeuralNet>
+  void calculateOutputs(
+    const TNeuralNet& net,
+    NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset);
+
+
+  /*!
+    \brief Calculates output value for each point in dataset
+    \param net The neural network to use for calculation
+    \param dataset [in/out] The dataset to use for input propagation and
+    output storage
+    \param workspace Workspace to propagate the inputs in
+
+    Same as above, but reuses the caller's workspace instead of allocating
+    one on each call.
   */
-  void calculateOutputs(NeuralNet& net,
-                        NNetDataset& dataset);
+  template <class TNeuralNet>
+  void calculateOutputs(
+    const TNeuralNet& net,
+    NNetDatasetTemplate<typename TNeuralNet::Scalar>& dataset,
+    typename TNeuralNet::Workspace& workspace);
 }
 
 } // namespace alch
@@ -3,28 +3,136 @@
 #ifndef INCLUDED_nnet_NeuralNetFunctors_h
 #define INCLUDED_nnet_NeuralNetFunctors_h
 
+#include "nnet/NeuralNetKernels.h"
+
 #include <cmath>
 
 namespace alch {
 
 namespace NeuralNetFunctors {
 
+  /*
+    Each functor applies its function to a single value or, through the
+    array overloads, to n double or float values at once. The array
+    overloads are what the network uses; they let the function be
+    computed with SIMD kernels.
+
+    derivative() returns the derivative of the function in terms of its
+    output rather than its input, so training can use the outputs the
+    forward pass already computed.
+  */
+
   //! Linear activation function
   struct Linear
   {
-    double operator()(double val)
+    double operator()(double val) const
     {
       return val;
     }
+
+    template <typename TScalar>
+    void operator()(const TScalar* in, TScalar* out, int n) const
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        out[i] = in[i];
+      }
+    }
+
+    static double derivative(double /* output */)
+    {
+      return 1.00;
+    }
   };
 
   //! Hyperbolic tangent activation function
   struct Tanh
   {
-    double operator()(double val)
+    double operator()(double val) const
     {
       return ::tanh(val);
     }
+
+    void operator()(const double* in, double* out, int n) const
+    {
+      NeuralNetKernels::tanh(in, out, n);
+    }
+
+    void operator()(const float* in, float* out, int n) const
+    {
+      NeuralNetKernels::tanh(in, out, n);
+    }
+
+    static double derivative(double output)
+    {
+      return (1.00 - (output * output));
+    }
+  };
+
+  /*!
+    \brief Rational approximation of the hyperbolic tangent
+
+    Computes tanh(x) as x P(x^2) / Q(x^2) with x clamped to [-9, 9]. The
+    absolute error against ::tanh() is below 2.6e-8 in double and below
+    3e-7 in float, and there are no branches, so every kernel level
+    vectorizes it. Use it in place of Tanh to score a trained network
+    faster when that error is acceptable; derivative() is that of Tanh.
+  */
+  struct FastTanh
+  {
+    double operator()(double val) const
+    {
+      double out;
+      NeuralNetKernels::fastTanh(&val, &out, 1);
+      return out;
+    }
+
+    void operator()(const double* in, double* out, int n) const
+    {
+      NeuralNetKernels::fastTanh(in, out, n);
+    }
+
+    void operator()(const float* in, float* out, int n) const
+    {
+      NeuralNetKernels::fastTanh(in, out, n);
+    }
+
+    static double derivative(double output)
+    {
+      return (1.00 - (output * output));
+    }
+  };
+
+
+  /*!
+    \brief Whether weights trained for activation TFrom may be used with
+    activation TTo
+
+    Only the same function, or Tanh and its FastTanh approximation, give
+    the same network from the same weights; value is true for those.
+  */
+  template <typename TFrom, typename TTo>
+  struct IsConvertible
+  {
+    enum { value = false };
+  };
+
+  template <typename T>
+  struct IsConvertible<T, T>
+  {
+    enum { value = true };
+  };
+
+  template <>
+  struct IsConvertible<Tanh, FastTanh>
+  {
+    enum { value = true };
+  };
+
+  template <>
+  struct IsConvertible<FastTanh, Tanh>
+  {
+    enum { value = true };
   };
 
 } // namespace NeuralNetFunctors
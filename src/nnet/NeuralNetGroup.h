@@ -0,0 +1,401 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_NeuralNetGroup_h
+#define INCLUDED_nnet_NeuralNetGroup_h
+
+#include "nnet/NeuralNetTemplate.h"
+#include "nnet/NeuralNetKernels.h"
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace alch {
+
+
+/*!
+  \brief Set of networks that are all propagated over the same inputs
+
+  Every network in a group has the same number of inputs. propagate()
+  copies each row of inputs into the padded input layer once and then
+  runs every network on it, writing the first output of each network to
+  its column of a caller-supplied result matrix.
+
+  Networks with the same layer sizes are kept together in a stack. The
+  first layer weights of a stack are stored as one matrix with the units
+  of each network following those of the one before it, so the first layer
+  of all networks in the stack is computed with a single
+  NeuralNetKernels::matMul(). The later layers, which are usually much
+  smaller, are computed one network at a time.
+
+  The results are bit-identical to those of propagating each network on
+  its own with NeuralNetTemplate::propagateBatch(). Like a network, a
+  group is not modified by propagation; threads sharing a group must each
+  use their own Workspace.
+*/
+template <class TNeuralNet>
+class NeuralNetGroup
+{
+ public:
+
+  //! Type of the weights and unit values
+  typedef typename TNeuralNet::Scalar Scalar;
+
+  //! The unit values of a batch of rows
+  typedef typename TNeuralNet::LayerValue LayerValue;
+
+  //! The weights of a stacked layer
+  typedef typename TNeuralNet::LayerWeight LayerWeight;
+
+
+  /*!
+    \brief Unit values produced by propagating inputs through a group
+
+    Sizes itself on first use and keeps its buffers between calls.
+  */
+  class Workspace
+  {
+   public:
+    //! Creates an empty workspace; it is sized on first use
+    Workspace()
+      : m_input()
+      , m_stack()
+      , m_value()
+      , m_nextValue()
+    {
+    }
+
+   private:
+    friend class NeuralNetGroup;
+
+    //! Padded input layer of each row in the batch
+    LayerValue m_input;
+
+    //! First layer outputs of each row for all networks in a stack;
+    //! m_stack[row * stackStride + member * stride + unit]
+    LayerValue m_stack;
+
+    //! Outputs of the layer being computed for a single row, and of the
+    //! layer before it
+    LayerValue m_value;
+    LayerValue m_nextValue;
+  };
+
+
+  /*!
+    \brief Constructor: Creates an empty group
+    \param numInputs Number of input units of every network in the group
+  */
+  explicit NeuralNetGroup(int numInputs = 1)
+    : m_numInputs(numInputs)
+    , m_inputStride(TNeuralNet::padUnits(numInputs + 1))
+    , m_numNetworks(0)
+    , m_stacks()
+    , m_activation()
+    , m_outputActivation()
+  {
+    assert(numInputs >= 1);
+  }
+
+
+  //! Number of input units of every network in the group
+  int getNumInputUnits() const
+  {
+    return m_numInputs;
+  }
+
+
+  //! Number of networks in the group
+  int size() const
+  {
+    return m_numNetworks;
+  }
+
+
+  //! Number of distinct network layouts in the group
+  int getNumStacks() const
+  {
+    return m_stacks.size();
+  }
+
+
+  /*!
+    \brief Adds a copy of a network to the group
+    \param net The network; must have getNumInputUnits() inputs
+    \param column Column of the result matrix that receives the network's
+    first output
+  */
+  void add(const TNeuralNet& net, int column)
+  {
+    assert(net.getNumInputUnits() == m_numInputs);
+    assert(net.getStride(0) == m_inputStride);
+    assert(column >= 0);
+
+    int numLayers = net.getNumLayers();
+
+    // look for networks with the same layer sizes
+    int stackIdx = 0;
+    for ( ; stackIdx < int(m_stacks.size()); ++stackIdx)
+    {
+      const TNeuralNet& other = m_stacks[stackIdx].nets.front();
+      bool match = (other.getNumLayers() == numLayers);
+      for (int layer = 1; match && (layer < numLayers); ++layer)
+      {
+        match = (other.getNumUnits(layer) == net.getNumUnits(layer));
+      }
+
+      if (match)
+      {
+        break;
+      }
+    }
+
+    if (stackIdx == int(m_stacks.size()))
+    {
+      m_stacks.push_back(Stack());
+    }
+
+    // append the network's first layer to the stacked weights. Each
+    // network takes getStride(1) rows, like the layer values it produces:
+    // the row of the constant unit and the padding rows stay zero, so the
+    // matching values come out as zero and the values of each network can
+    // be passed straight to its next layer.
+    Stack& stack = m_stacks[stackIdx];
+    int stride = net.getStride(1);
+    int member = stack.nets.size();
+    stack.weight.resize((member + 1) * stride * m_inputStride, 0.00);
+
+    const LayerWeight& weight = net.getLayerWeight(1);
+    std::copy(weight.begin() + m_inputStride,
+              weight.begin() + net.getNumUnits(1) * m_inputStride,
+              stack.weight.begin() + (member * stride + 1) * m_inputStride);
+
+    stack.nets.push_back(net);
+    stack.columns.push_back(column);
+    ++m_numNetworks;
+  }
+
+
+  /*!
+    \brief Propagates rows of inputs through every network in the group
+    \param input The first row of inputs; each row holds getNumInputUnits()
+    values
+    \param numRows Number of rows
+    \param inputStride Distance between the starts of consecutive rows
+    \param workspace Workspace to propagate the inputs in
+    \param result [out] The first output of each network for row r is
+    written to result[r * resultStride + column], using the column the
+    network was added with
+    \param resultStride Distance between result rows
+
+    The inputs and results may be of another type than Scalar; they are
+    converted the same way as when a dataset is converted to Scalar.
+  */
+  template <typename TInput, typename TResult>
+  void propagate(const TInput* input,
+                 int numRows,
+                 int inputStride,
+                 Workspace& workspace,
+                 TResult* result,
+                 int resultStride) const
+  {
+    assert(!numRows || input);
+    assert(inputStride >= m_numInputs);
+
+    const int maxBatchRows = 64;
+
+    for (int first = 0; first < numRows; first += maxBatchRows)
+    {
+      int batchRows = std::min(maxBatchRows, numRows - first);
+      setInputs(input + std::size_t(first) * inputStride, batchRows,
+                inputStride, workspace);
+
+      for (int i = 0; i < int(m_stacks.size()); ++i)
+      {
+        computeStack(m_stacks[i], batchRows, workspace,
+                     result + std::size_t(first) * resultStride,
+                     resultStride);
+      }
+    }
+  }
+
+
+ private:
+
+  //! Networks with the same layer sizes
+  struct Stack
+  {
+    Stack()
+      : nets()
+      , columns()
+      , weight()
+    {
+      ;
+    }
+
+    //! The networks; the first layer weights are also in weight
+    std::vector<TNeuralNet> nets;
+
+    //! Result column of each network in nets
+    std::vector<int> columns;
+
+    //! getStride(1) rows for each network in nets of getStride(0) values
+    LayerWeight weight;
+  };
+
+  int m_numInputs;
+
+  //! Padded length of the input layer
+  int m_inputStride;
+
+  int m_numNetworks;
+
+  std::vector<Stack> m_stacks;
+
+  //! Hidden layer activation of every network
+  typename TNeuralNet::Activation m_activation;
+
+  //! Output layer activation of every network
+  typename TNeuralNet::OutputActivation m_outputActivation;
+
+
+  //! Copies rows of inputs into the padded input layer of the workspace
+  template <typename TInput>
+  void setInputs(const TInput* input,
+                 int numRows,
+                 int inputStride,
+                 Workspace& workspace) const
+  {
+    // new space is zeroed, which keeps the row padding at zero
+    if (int(workspace.m_input.size()) < numRows * m_inputStride)
+    {
+      workspace.m_input.resize(numRows * m_inputStride, 0.00);
+    }
+
+    for (int row = 0; row < numRows; ++row)
+    {
+      const TInput* src = input + std::size_t(row) * inputStride;
+      Scalar* dest = &workspace.m_input[row * m_inputStride];
+      dest[0] = 1.00;
+      for (int i = 0; i < m_numInputs; ++i)
+      {
+        dest[i + 1] = static_cast<Scalar>(src[i]);
+      }
+    }
+  }
+
+
+  //! Propagates the rows in the workspace's input layer through the
+  //! networks of a stack
+  template <typename TResult>
+  void computeStack(const Stack& stack,
+                    int numRows,
+                    Workspace& workspace,
+                    TResult* result,
+                    int resultStride) const
+  {
+    const TNeuralNet& first = stack.nets.front();
+    int numLayers = first.getNumLayers();
+    int numMembers = stack.nets.size();
+    int stride = first.getStride(1);
+    int numUnits = first.getNumUnits(1) - 1;
+    int stackStride = numMembers * stride;
+
+    if (int(workspace.m_stack.size()) < numRows * stackStride)
+    {
+      workspace.m_stack.resize(numRows * stackStride);
+    }
+
+    // first layer of every network in the stack
+    NeuralNetKernels::matMul(&workspace.m_input[0],
+                             numRows,
+                             &stack.weight[0],
+                             stackStride,
+                             m_inputStride,
+                             &workspace.m_stack[0],
+                             stackStride);
+
+    for (int row = 0; row < numRows; ++row)
+    {
+      for (int member = 0; member < numMembers; ++member)
+      {
+        Scalar* value = &workspace.m_stack[row * stackStride
+                                           + member * stride];
+        if (numLayers == 2)
+        {
+          m_outputActivation(value + 1, value + 1, numUnits);
+          result[std::size_t(row) * resultStride + stack.columns[member]] =
+            static_cast<TResult>(value[1]);
+        }
+        else
+        {
+          m_activation(value + 1, value + 1, numUnits);
+        }
+        value[0] = 1.00;
+      }
+    }
+
+    if (numLayers == 2)
+    {
+      return;
+    }
+
+    // the later layers, one row of one network at a time
+    int maxStride = 0;
+    for (int layer = 2; layer < numLayers; ++layer)
+    {
+      maxStride = std::max(maxStride, first.getStride(layer));
+    }
+    if (int(workspace.m_value.size()) < maxStride)
+    {
+      workspace.m_value.resize(maxStride, 0.00);
+      workspace.m_nextValue.resize(maxStride, 0.00);
+    }
+
+    for (int member = 0; member < numMembers; ++member)
+    {
+      const TNeuralNet& net = stack.nets[member];
+      for (int row = 0; row < numRows; ++row)
+      {
+        const Scalar* prev = &workspace.m_stack[row * stackStride
+                                                + member * stride];
+        Scalar* value = 0;
+        for (int layer = 2; layer < numLayers; ++layer)
+        {
+          // the workspace buffers are used in turn
+          value = &((layer % 2) ? workspace.m_nextValue
+                    : workspace.m_value)[0];
+
+          int prevStride = net.getStride(layer - 1);
+          int units = net.getNumUnits(layer) - 1;
+          NeuralNetKernels::matVec(&net.getLayerWeight(layer)[prevStride],
+                                   units,
+                                   prevStride,
+                                   prev,
+                                   value + 1);
+          if (layer == numLayers - 1)
+          {
+            m_outputActivation(value + 1, value + 1, units);
+          }
+          else
+          {
+            m_activation(value + 1, value + 1, units);
+
+            // the buffer may hold a wider layer from an earlier network
+            std::fill(value + units + 1, value + net.getStride(layer),
+                      Scalar(0.00));
+          }
+          value[0] = 1.00;
+          prev = value;
+        }
+
+        result[std::size_t(row) * resultStride + stack.columns[member]] =
+          static_cast<TResult>(value[1]);
+      }
+    }
+  }
+};
+
+} // namespace alch
+
+#endif
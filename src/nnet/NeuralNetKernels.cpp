@@ -0,0 +1,1382 @@
+
+#include "nnet/NeuralNetKernels.h"
+
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NEURALNETKERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace alch {
+
+namespace NeuralNetKernels
+{
+
+  namespace {
+
+    /*
+      fastTanh() computes x P(x^2) / Q(x^2) with the argument clamped to
+      [-9, 9]; P has degree 6 and Q degree 3 in x^2. Evaluated in double
+      the absolute error against ::tanh() is below 2.6e-8 everywhere,
+      including the clamped range where tanh() is within 3e-8 of +/-1.
+      The same coefficients are used at every level and for both scalar
+      types, so levels only differ by rounding.
+    */
+    const double c_fastTanhClamp = 9.0;
+
+    const double c_fastTanhP[7] =
+    {
+      4.89352455891786e-03,
+      6.37261928875436e-04,
+      1.48572235717979e-05,
+      5.12229709037114e-08,
+      -8.60467152213735e-11,
+      2.00018790482477e-13,
+      -2.76076847742355e-16
+    };
+
+    const double c_fastTanhQ[4] =
+    {
+      4.89352518554385e-03,
+      2.26843463243900e-03,
+      1.18534705686654e-04,
+      1.19825839466702e-06
+    };
+
+    //////////////////////////////////////////////////////////////////////
+    // scalar versions
+
+    double dotScalar(const double* a, const double* b, int n)
+    {
+      double sum = 0.00;
+      for (int i = 0; i < n; ++i)
+      {
+        sum += (a[i] * b[i]);
+      }
+      return sum;
+    }
+
+    void matVecScalar(const double* weight,
+                      int rows,
+                      int stride,
+                      const double* x,
+                      double* y)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        y[r] = dotScalar(weight + r * stride, x, stride);
+      }
+    }
+
+    void matMulScalar(const double* x,
+                      int rows,
+                      const double* weight,
+                      int units,
+                      int stride,
+                      double* y,
+                      int yStride)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        matVecScalar(weight, units, stride, x + r * stride, y + r * yStride);
+      }
+    }
+
+    void tanhScalar(const double* in, double* out, int n)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        out[i] = ::tanh(in[i]);
+      }
+    }
+
+    float dotScalarFloat(const float* a, const float* b, int n)
+    {
+      float sum = 0.00f;
+      for (int i = 0; i < n; ++i)
+      {
+        sum += (a[i] * b[i]);
+      }
+      return sum;
+    }
+
+    void matVecScalarFloat(const float* weight,
+                           int rows,
+                           int stride,
+                           const float* x,
+                           float* y)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        y[r] = dotScalarFloat(weight + r * stride, x, stride);
+      }
+    }
+
+    void matMulScalarFloat(const float* x,
+                           int rows,
+                           const float* weight,
+                           int units,
+                           int stride,
+                           float* y,
+                           int yStride)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        matVecScalarFloat(weight, units, stride, x + r * stride,
+                          y + r * yStride);
+      }
+    }
+
+    void tanhScalarFloat(const float* in, float* out, int n)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        out[i] = ::tanhf(in[i]);
+      }
+    }
+
+    // branch-free, so the compiler may vectorize it on its own
+    template <typename TScalar>
+    void fastTanhScalarT(const TScalar* in, TScalar* out, int n)
+    {
+      const TScalar clamp = TScalar(c_fastTanhClamp);
+
+      for (int i = 0; i < n; ++i)
+      {
+        TScalar x = in[i];
+        x = (x < -clamp) ? -clamp : ((x > clamp) ? clamp : x);
+        TScalar x2 = x * x;
+
+        TScalar p = TScalar(c_fastTanhP[6]);
+        for (int k = 5; k >= 0; --k)
+        {
+          p = p * x2 + TScalar(c_fastTanhP[k]);
+        }
+
+        TScalar q = TScalar(c_fastTanhQ[3]);
+        for (int k = 2; k >= 0; --k)
+        {
+          q = q * x2 + TScalar(c_fastTanhQ[k]);
+        }
+
+        out[i] = x * p / q;
+      }
+    }
+
+    void fastTanhScalar(const double* in, double* out, int n)
+    {
+      fastTanhScalarT(in, out, n);
+    }
+
+    void fastTanhScalarFloat(const float* in, float* out, int n)
+    {
+      fastTanhScalarT(in, out, n);
+    }
+
+
+#ifdef NEURALNETKERNELS_X86
+
+    //////////////////////////////////////////////////////////////////////
+    // SSE2 versions
+
+    __attribute__((target("sse2")))
+    double dotSse2(const double* a, const double* b, int n)
+    {
+      __m128d acc0 = _mm_setzero_pd();
+      __m128d acc1 = _mm_setzero_pd();
+
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i),
+                                           _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2),
+                                           _mm_loadu_pd(b + i + 2)));
+      }
+
+      acc0 = _mm_add_pd(acc0, acc1);
+      double sum = (_mm_cvtsd_f64(acc0)
+                    + _mm_cvtsd_f64(_mm_unpackhi_pd(acc0, acc0)));
+
+      for (; i < n; ++i)
+      {
+        sum += (a[i] * b[i]);
+      }
+      return sum;
+    }
+
+    __attribute__((target("sse2")))
+    void matVecSse2(const double* weight,
+                    int rows,
+                    int stride,
+                    const double* x,
+                    double* y)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        y[r] = dotSse2(weight + r * stride, x, stride);
+      }
+    }
+
+
+    __attribute__((target("sse2")))
+    void matMulSse2(const double* x,
+                    int rows,
+                    const double* weight,
+                    int units,
+                    int stride,
+                    double* y,
+                    int yStride)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        matVecSse2(weight, units, stride, x + r * stride, y + r * yStride);
+      }
+    }
+
+
+    __attribute__((target("sse2")))
+    float dotSse2Float(const float* a, const float* b, int n)
+    {
+      __m128 acc0 = _mm_setzero_ps();
+      __m128 acc1 = _mm_setzero_ps();
+
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                           _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                           _mm_loadu_ps(b + i + 4)));
+      }
+
+      acc0 = _mm_add_ps(acc0, acc1);
+      acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+      acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+      float sum = _mm_cvtss_f32(acc0);
+
+      for (; i < n; ++i)
+      {
+        sum += (a[i] * b[i]);
+      }
+      return sum;
+    }
+
+    __attribute__((target("sse2")))
+    void matVecSse2Float(const float* weight,
+                         int rows,
+                         int stride,
+                         const float* x,
+                         float* y)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        y[r] = dotSse2Float(weight + r * stride, x, stride);
+      }
+    }
+
+
+    __attribute__((target("sse2")))
+    void matMulSse2Float(const float* x,
+                         int rows,
+                         const float* weight,
+                         int units,
+                         int stride,
+                         float* y,
+                         int yStride)
+    {
+      for (int r = 0; r < rows; ++r)
+      {
+        matVecSse2Float(weight, units, stride, x + r * stride,
+                        y + r * yStride);
+      }
+    }
+
+
+    __attribute__((target("sse2")))
+    inline __m128d fastTanhSse2(__m128d x)
+    {
+      const __m128d clamp = _mm_set1_pd(c_fastTanhClamp);
+      x = _mm_max_pd(_mm_min_pd(x, clamp), _mm_sub_pd(_mm_setzero_pd(),
+                                                      clamp));
+      __m128d x2 = _mm_mul_pd(x, x);
+
+      __m128d p = _mm_set1_pd(c_fastTanhP[6]);
+      for (int k = 5; k >= 0; --k)
+      {
+        p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(c_fastTanhP[k]));
+      }
+
+      __m128d q = _mm_set1_pd(c_fastTanhQ[3]);
+      for (int k = 2; k >= 0; --k)
+      {
+        q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(c_fastTanhQ[k]));
+      }
+
+      return _mm_div_pd(_mm_mul_pd(x, p), q);
+    }
+
+    __attribute__((target("sse2")))
+    void fastTanhSse2(const double* in, double* out, int n)
+    {
+      int i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+        _mm_storeu_pd(out + i, fastTanhSse2(_mm_loadu_pd(in + i)));
+      }
+
+      // the odd value goes through the same arithmetic
+      if (i < n)
+      {
+        _mm_store_sd(out + i, fastTanhSse2(_mm_load_sd(in + i)));
+      }
+    }
+
+    __attribute__((target("sse2")))
+    inline __m128 fastTanhSse2(__m128 x)
+    {
+      const __m128 clamp = _mm_set1_ps(float(c_fastTanhClamp));
+      x = _mm_max_ps(_mm_min_ps(x, clamp), _mm_sub_ps(_mm_setzero_ps(),
+                                                      clamp));
+      __m128 x2 = _mm_mul_ps(x, x);
+
+      __m128 p = _mm_set1_ps(float(c_fastTanhP[6]));
+      for (int k = 5; k >= 0; --k)
+      {
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(float(c_fastTanhP[k])));
+      }
+
+      __m128 q = _mm_set1_ps(float(c_fastTanhQ[3]));
+      for (int k = 2; k >= 0; --k)
+      {
+        q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(float(c_fastTanhQ[k])));
+      }
+
+      return _mm_div_ps(_mm_mul_ps(x, p), q);
+    }
+
+    __attribute__((target("sse2")))
+    void fastTanhSse2Float(const float* in, float* out, int n)
+    {
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        _mm_storeu_ps(out + i, fastTanhSse2(_mm_loadu_ps(in + i)));
+      }
+
+      for (; i < n; ++i)
+      {
+        _mm_store_ss(out + i, fastTanhSse2(_mm_load_ss(in + i)));
+      }
+    }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // AVX2 versions
+
+    __attribute__((target("avx2,fma")))
+    inline double hsumAvx2(__m256d v)
+    {
+      __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v),
+                              _mm256_extractf128_pd(v, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+
+    // Returns a * b + c rounded once. The scalar tails of the kernels use
+    // this rather than a plain multiply and add, which the compiler may or
+    // may not contract into a fused multiply-add depending on the kernel
+    // and the optimization level; that would break the bit-identical
+    // results matVec and matMul promise.
+    __attribute__((target("avx2,fma")))
+    inline double fmaddAvx2(double a, double b, double c)
+    {
+      return _mm_cvtsd_f64(_mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b),
+                                        _mm_set_sd(c)));
+    }
+
+    // Dot product with a single accumulator. matVec and matMul use this
+    // summation order for every result so that both agree bit for bit.
+    __attribute__((target("avx2,fma")))
+    inline double rowDotAvx2(const double* a, const double* b, int n)
+    {
+      __m256d acc = _mm256_setzero_pd();
+
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                              _mm256_loadu_pd(b + i), acc);
+      }
+
+      double sum = hsumAvx2(acc);
+
+      for (; i < n; ++i)
+      {
+        sum = fmaddAvx2(a[i], b[i], sum);
+      }
+      return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    double dotAvx2(const double* a, const double* b, int n)
+    {
+      __m256d acc0 = _mm256_setzero_pd();
+      __m256d acc1 = _mm256_setzero_pd();
+
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                               _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4),
+                               _mm256_loadu_pd(b + i + 4), acc1);
+      }
+      for (; i + 4 <= n; i += 4)
+      {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                               _mm256_loadu_pd(b + i), acc0);
+      }
+
+      double sum = hsumAvx2(_mm256_add_pd(acc0, acc1));
+
+      for (; i < n; ++i)
+      {
+        sum = fmaddAvx2(a[i], b[i], sum);
+      }
+      return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    void matVecAvx2(const double* weight,
+                    int rows,
+                    int stride,
+                    const double* x,
+                    double* y)
+    {
+      int r = 0;
+
+      // four rows at a time share each load of x
+      for (; r + 4 <= rows; r += 4)
+      {
+        const double* w0 = weight + r * stride;
+        const double* w1 = w0 + stride;
+        const double* w2 = w1 + stride;
+        const double* w3 = w2 + stride;
+
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        __m256d acc3 = _mm256_setzero_pd();
+
+        int c = 0;
+        for (; c + 4 <= stride; c += 4)
+        {
+          __m256d xv = _mm256_loadu_pd(x + c);
+          acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w0 + c), xv, acc0);
+          acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(w1 + c), xv, acc1);
+          acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(w2 + c), xv, acc2);
+          acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(w3 + c), xv, acc3);
+        }
+
+        double sum0 = hsumAvx2(acc0);
+        double sum1 = hsumAvx2(acc1);
+        double sum2 = hsumAvx2(acc2);
+        double sum3 = hsumAvx2(acc3);
+
+        for (; c < stride; ++c)
+        {
+          sum0 = fmaddAvx2(w0[c], x[c], sum0);
+          sum1 = fmaddAvx2(w1[c], x[c], sum1);
+          sum2 = fmaddAvx2(w2[c], x[c], sum2);
+          sum3 = fmaddAvx2(w3[c], x[c], sum3);
+        }
+
+        y[r] = sum0;
+        y[r + 1] = sum1;
+        y[r + 2] = sum2;
+        y[r + 3] = sum3;
+      }
+
+      for (; r < rows; ++r)
+      {
+        y[r] = rowDotAvx2(weight + r * stride, x, stride);
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void matMulAvx2(const double* x,
+                    int rows,
+                    const double* weight,
+                    int units,
+                    int stride,
+                    double* y,
+                    int yStride)
+    {
+      int r = 0;
+
+      // 4 input rows x 2 weight rows per block: eight accumulators, with
+      // each input load used twice and each weight load used four times
+      for (; r + 4 <= rows; r += 4)
+      {
+        const double* x0 = x + r * stride;
+        const double* x1 = x0 + stride;
+        const double* x2 = x1 + stride;
+        const double* x3 = x2 + stride;
+
+        double* y0 = y + r * yStride;
+        double* y1 = y0 + yStride;
+        double* y2 = y1 + yStride;
+        double* y3 = y2 + yStride;
+
+        int u = 0;
+        for (; u + 2 <= units; u += 2)
+        {
+          const double* wa = weight + u * stride;
+          const double* wb = wa + stride;
+
+          __m256d acc0a = _mm256_setzero_pd();
+          __m256d acc1a = _mm256_setzero_pd();
+          __m256d acc2a = _mm256_setzero_pd();
+          __m256d acc3a = _mm256_setzero_pd();
+          __m256d acc0b = _mm256_setzero_pd();
+          __m256d acc1b = _mm256_setzero_pd();
+          __m256d acc2b = _mm256_setzero_pd();
+          __m256d acc3b = _mm256_setzero_pd();
+
+          int c = 0;
+          for (; c + 4 <= stride; c += 4)
+          {
+            __m256d wav = _mm256_loadu_pd(wa + c);
+            __m256d wbv = _mm256_loadu_pd(wb + c);
+
+            __m256d xv = _mm256_loadu_pd(x0 + c);
+            acc0a = _mm256_fmadd_pd(wav, xv, acc0a);
+            acc0b = _mm256_fmadd_pd(wbv, xv, acc0b);
+
+            xv = _mm256_loadu_pd(x1 + c);
+            acc1a = _mm256_fmadd_pd(wav, xv, acc1a);
+            acc1b = _mm256_fmadd_pd(wbv, xv, acc1b);
+
+            xv = _mm256_loadu_pd(x2 + c);
+            acc2a = _mm256_fmadd_pd(wav, xv, acc2a);
+            acc2b = _mm256_fmadd_pd(wbv, xv, acc2b);
+
+            xv = _mm256_loadu_pd(x3 + c);
+            acc3a = _mm256_fmadd_pd(wav, xv, acc3a);
+            acc3b = _mm256_fmadd_pd(wbv, xv, acc3b);
+          }
+
+          double sum0a = hsumAvx2(acc0a);
+          double sum1a = hsumAvx2(acc1a);
+          double sum2a = hsumAvx2(acc2a);
+          double sum3a = hsumAvx2(acc3a);
+          double sum0b = hsumAvx2(acc0b);
+          double sum1b = hsumAvx2(acc1b);
+          double sum2b = hsumAvx2(acc2b);
+          double sum3b = hsumAvx2(acc3b);
+
+          for (; c < stride; ++c)
+          {
+            sum0a = fmaddAvx2(wa[c], x0[c], sum0a);
+            sum1a = fmaddAvx2(wa[c], x1[c], sum1a);
+            sum2a = fmaddAvx2(wa[c], x2[c], sum2a);
+            sum3a = fmaddAvx2(wa[c], x3[c], sum3a);
+            sum0b = fmaddAvx2(wb[c], x0[c], sum0b);
+            sum1b = fmaddAvx2(wb[c], x1[c], sum1b);
+            sum2b = fmaddAvx2(wb[c], x2[c], sum2b);
+            sum3b = fmaddAvx2(wb[c], x3[c], sum3b);
+          }
+
+          y0[u] = sum0a;
+          y1[u] = sum1a;
+          y2[u] = sum2a;
+          y3[u] = sum3a;
+          y0[u + 1] = sum0b;
+          y1[u + 1] = sum1b;
+          y2[u + 1] = sum2b;
+          y3[u + 1] = sum3b;
+        }
+
+        for (; u < units; ++u)
+        {
+          const double* w = weight + u * stride;
+          y0[u] = rowDotAvx2(w, x0, stride);
+          y1[u] = rowDotAvx2(w, x1, stride);
+          y2[u] = rowDotAvx2(w, x2, stride);
+          y3[u] = rowDotAvx2(w, x3, stride);
+        }
+      }
+
+      for (; r < rows; ++r)
+      {
+        matVecAvx2(weight, units, stride, x + r * stride, y + r * yStride);
+      }
+    }
+
+
+    /*
+      Vectorized tanh following the Cephes library: a rational
+      approximation for |x| < 0.625 and 1 - 2 / (exp(2|x|) + 1) above it,
+      with exp() computed by range reduction to [-ln2/2, ln2/2] and a Pade
+      approximant. Arguments are clamped where tanh() rounds to +/-1.
+    */
+    __attribute__((target("avx2,fma")))
+    inline __m256d expAvx2(__m256d x)
+    {
+      const __m256d log2e = _mm256_set1_pd(1.4426950408889634073599);
+      const __m256d c1 = _mm256_set1_pd(6.93145751953125E-1);
+      const __m256d c2 = _mm256_set1_pd(1.42860682030941723212E-6);
+
+      // n = round(x / ln2); r = x - n * ln2 in two steps for accuracy
+      __m256d n = _mm256_floor_pd(_mm256_fmadd_pd(x, log2e,
+                                                  _mm256_set1_pd(0.5)));
+      __m256d r = _mm256_fnmadd_pd(n, c1, x);
+      r = _mm256_fnmadd_pd(n, c2, r);
+
+      __m256d rr = _mm256_mul_pd(r, r);
+
+      __m256d p = _mm256_set1_pd(1.26177193074810590878E-4);
+      p = _mm256_fmadd_pd(p, rr, _mm256_set1_pd(3.02994407707441961300E-2));
+      p = _mm256_fmadd_pd(p, rr, _mm256_set1_pd(9.99999999999999999910E-1));
+      p = _mm256_mul_pd(p, r);
+
+      __m256d q = _mm256_set1_pd(3.00198505138664455042E-6);
+      q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(2.52448340349684104192E-3));
+      q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(2.27265548208155028766E-1));
+      q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(2.00000000000000000009E0));
+
+      // e^r = 1 + 2p / (q - p)
+      __m256d e = _mm256_div_pd(p, _mm256_sub_pd(q, p));
+      e = _mm256_fmadd_pd(e, _mm256_set1_pd(2.0), _mm256_set1_pd(1.0));
+
+      // scale by 2^n: adding 1.5 * 2^52 leaves n in the low mantissa bits
+      __m256i bits = _mm256_castpd_si256(
+        _mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0)));
+      bits = _mm256_slli_epi64(
+        _mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+
+      return _mm256_mul_pd(e, _mm256_castsi256_pd(bits));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256d tanhAvx2(__m256d x)
+    {
+      const __m256d signMask = _mm256_set1_pd(-0.0);
+      const __m256d one = _mm256_set1_pd(1.0);
+
+      __m256d ax = _mm256_andnot_pd(signMask, x);
+
+      // |x| >= 0.625
+      __m256d z = expAvx2(_mm256_add_pd(
+                            _mm256_min_pd(ax, _mm256_set1_pd(22.0)),
+                            _mm256_min_pd(ax, _mm256_set1_pd(22.0))));
+      __m256d big = _mm256_sub_pd(
+        one, _mm256_div_pd(_mm256_set1_pd(2.0), _mm256_add_pd(z, one)));
+      big = _mm256_or_pd(big, _mm256_and_pd(signMask, x));
+
+      // |x| < 0.625
+      __m256d s = _mm256_mul_pd(x, x);
+
+      __m256d p = _mm256_set1_pd(-9.64399179425052238628E-1);
+      p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(-9.92877231001918586564E1));
+      p = _mm256_fmadd_pd(p, s, _mm256_set1_pd(-1.61468768441708447952E3));
+
+      __m256d q = _mm256_add_pd(s, _mm256_set1_pd(1.12811678491632931402E2));
+      q = _mm256_fmadd_pd(q, s, _mm256_set1_pd(2.23548839060100448583E3));
+      q = _mm256_fmadd_pd(q, s, _mm256_set1_pd(4.84406305325125486048E3));
+
+      __m256d small = _mm256_fmadd_pd(
+        _mm256_mul_pd(x, s), _mm256_div_pd(p, q), x);
+
+      __m256d useBig = _mm256_cmp_pd(ax, _mm256_set1_pd(0.625), _CMP_GE_OQ);
+      return _mm256_blendv_pd(small, big, useBig);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void tanhAvx2(const double* in, double* out, int n)
+    {
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        _mm256_storeu_pd(out + i, tanhAvx2(_mm256_loadu_pd(in + i)));
+      }
+
+      // finish the tail through a padded register so that every value
+      // goes through the same approximation
+      if (i < n)
+      {
+        double buf[4] = { 0.00, 0.00, 0.00, 0.00 };
+        for (int j = i; j < n; ++j)
+        {
+          buf[j - i] = in[j];
+        }
+
+        _mm256_storeu_pd(buf, tanhAvx2(_mm256_loadu_pd(buf)));
+
+        for (int j = i; j < n; ++j)
+        {
+          out[j] = buf[j - i];
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // AVX2 float versions; the same structure as the double ones with 8
+    // values per register
+
+    // float version of fmaddAvx2(); see there
+    __attribute__((target("avx2,fma")))
+    inline float fmaddAvx2(float a, float b, float c)
+    {
+      return _mm_cvtss_f32(_mm_fmadd_ss(_mm_set_ss(a), _mm_set_ss(b),
+                                        _mm_set_ss(c)));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float hsumAvx2(__m256 v)
+    {
+      __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v),
+                             _mm256_extractf128_ps(v, 1));
+      lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+      return _mm_cvtss_f32(_mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1)));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline float rowDotAvx2(const float* a, const float* b, int n)
+    {
+      __m256 acc = _mm256_setzero_ps();
+
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                              _mm256_loadu_ps(b + i), acc);
+      }
+
+      float sum = hsumAvx2(acc);
+
+      for (; i < n; ++i)
+      {
+        sum = fmaddAvx2(a[i], b[i], sum);
+      }
+      return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    float dotAvx2Float(const float* a, const float* b, int n)
+    {
+      __m256 acc0 = _mm256_setzero_ps();
+      __m256 acc1 = _mm256_setzero_ps();
+
+      int i = 0;
+      for (; i + 16 <= n; i += 16)
+      {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                               _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                               _mm256_loadu_ps(b + i + 8), acc1);
+      }
+      for (; i + 8 <= n; i += 8)
+      {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                               _mm256_loadu_ps(b + i), acc0);
+      }
+
+      float sum = hsumAvx2(_mm256_add_ps(acc0, acc1));
+
+      for (; i < n; ++i)
+      {
+        sum = fmaddAvx2(a[i], b[i], sum);
+      }
+      return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    void matVecAvx2Float(const float* weight,
+                         int rows,
+                         int stride,
+                         const float* x,
+                         float* y)
+    {
+      int r = 0;
+
+      // four rows at a time share each load of x
+      for (; r + 4 <= rows; r += 4)
+      {
+        const float* w0 = weight + r * stride;
+        const float* w1 = w0 + stride;
+        const float* w2 = w1 + stride;
+        const float* w3 = w2 + stride;
+
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+
+        int c = 0;
+        for (; c + 8 <= stride; c += 8)
+        {
+          __m256 xv = _mm256_loadu_ps(x + c);
+          acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w0 + c), xv, acc0);
+          acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w1 + c), xv, acc1);
+          acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(w2 + c), xv, acc2);
+          acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(w3 + c), xv, acc3);
+        }
+
+        float sum0 = hsumAvx2(acc0);
+        float sum1 = hsumAvx2(acc1);
+        float sum2 = hsumAvx2(acc2);
+        float sum3 = hsumAvx2(acc3);
+
+        for (; c < stride; ++c)
+        {
+          sum0 = fmaddAvx2(w0[c], x[c], sum0);
+          sum1 = fmaddAvx2(w1[c], x[c], sum1);
+          sum2 = fmaddAvx2(w2[c], x[c], sum2);
+          sum3 = fmaddAvx2(w3[c], x[c], sum3);
+        }
+
+        y[r] = sum0;
+        y[r + 1] = sum1;
+        y[r + 2] = sum2;
+        y[r + 3] = sum3;
+      }
+
+      for (; r < rows; ++r)
+      {
+        y[r] = rowDotAvx2(weight + r * stride, x, stride);
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void matMulAvx2Float(const float* x,
+                         int rows,
+                         const float* weight,
+                         int units,
+                         int stride,
+                         float* y,
+                         int yStride)
+    {
+      int r = 0;
+
+      // 4 input rows x 2 weight rows per block, as for double
+      for (; r + 4 <= rows; r += 4)
+      {
+        const float* x0 = x + r * stride;
+        const float* x1 = x0 + stride;
+        const float* x2 = x1 + stride;
+        const float* x3 = x2 + stride;
+
+        float* y0 = y + r * yStride;
+        float* y1 = y0 + yStride;
+        float* y2 = y1 + yStride;
+        float* y3 = y2 + yStride;
+
+        int u = 0;
+        for (; u + 2 <= units; u += 2)
+        {
+          const float* wa = weight + u * stride;
+          const float* wb = wa + stride;
+
+          __m256 acc0a = _mm256_setzero_ps();
+          __m256 acc1a = _mm256_setzero_ps();
+          __m256 acc2a = _mm256_setzero_ps();
+          __m256 acc3a = _mm256_setzero_ps();
+          __m256 acc0b = _mm256_setzero_ps();
+          __m256 acc1b = _mm256_setzero_ps();
+          __m256 acc2b = _mm256_setzero_ps();
+          __m256 acc3b = _mm256_setzero_ps();
+
+          int c = 0;
+          for (; c + 8 <= stride; c += 8)
+          {
+            __m256 wav = _mm256_loadu_ps(wa + c);
+            __m256 wbv = _mm256_loadu_ps(wb + c);
+
+            __m256 xv = _mm256_loadu_ps(x0 + c);
+            acc0a = _mm256_fmadd_ps(wav, xv, acc0a);
+            acc0b = _mm256_fmadd_ps(wbv, xv, acc0b);
+
+            xv = _mm256_loadu_ps(x1 + c);
+            acc1a = _mm256_fmadd_ps(wav, xv, acc1a);
+            acc1b = _mm256_fmadd_ps(wbv, xv, acc1b);
+
+            xv = _mm256_loadu_ps(x2 + c);
+            acc2a = _mm256_fmadd_ps(wav, xv, acc2a);
+            acc2b = _mm256_fmadd_ps(wbv, xv, acc2b);
+
+            xv = _mm256_loadu_ps(x3 + c);
+            acc3a = _mm256_fmadd_ps(wav, xv, acc3a);
+            acc3b = _mm256_fmadd_ps(wbv, xv, acc3b);
+          }
+
+          float sum0a = hsumAvx2(acc0a);
+          float sum1a = hsumAvx2(acc1a);
+          float sum2a = hsumAvx2(acc2a);
+          float sum3a = hsumAvx2(acc3a);
+          float sum0b = hsumAvx2(acc0b);
+          float sum1b = hsumAvx2(acc1b);
+          float sum2b = hsumAvx2(acc2b);
+          float sum3b = hsumAvx2(acc3b);
+
+          for (; c < stride; ++c)
+          {
+            sum0a = fmaddAvx2(wa[c], x0[c], sum0a);
+            sum1a = fmaddAvx2(wa[c], x1[c], sum1a);
+            sum2a = fmaddAvx2(wa[c], x2[c], sum2a);
+            sum3a = fmaddAvx2(wa[c], x3[c], sum3a);
+            sum0b = fmaddAvx2(wb[c], x0[c], sum0b);
+            sum1b = fmaddAvx2(wb[c], x1[c], sum1b);
+            sum2b = fmaddAvx2(wb[c], x2[c], sum2b);
+            sum3b = fmaddAvx2(wb[c], x3[c], sum3b);
+          }
+
+          y0[u] = sum0a;
+          y1[u] = sum1a;
+          y2[u] = sum2a;
+          y3[u] = sum3a;
+          y0[u + 1] = sum0b;
+          y1[u + 1] = sum1b;
+          y2[u + 1] = sum2b;
+          y3[u + 1] = sum3b;
+        }
+
+        for (; u < units; ++u)
+        {
+          const float* w = weight + u * stride;
+          y0[u] = rowDotAvx2(w, x0, stride);
+          y1[u] = rowDotAvx2(w, x1, stride);
+          y2[u] = rowDotAvx2(w, x2, stride);
+          y3[u] = rowDotAvx2(w, x3, stride);
+        }
+      }
+
+      for (; r < rows; ++r)
+      {
+        matVecAvx2Float(weight, units, stride, x + r * stride,
+                        y + r * yStride);
+      }
+    }
+
+
+    /*
+      Single precision tanh following the Cephes tanhf(): a polynomial for
+      |x| < 0.625 and 1 - 2 / (exp(2|x|) + 1) above it, with exp() from
+      the Cephes expf() polynomial.
+    */
+    __attribute__((target("avx2,fma")))
+    inline __m256 expAvx2(__m256 x)
+    {
+      const __m256 log2e = _mm256_set1_ps(1.44269504088896341f);
+      const __m256 c1 = _mm256_set1_ps(0.693359375f);
+      const __m256 c2 = _mm256_set1_ps(-2.12194440e-4f);
+
+      // n = round(x / ln2); r = x - n * ln2 in two steps for accuracy
+      __m256 n = _mm256_floor_ps(_mm256_fmadd_ps(x, log2e,
+                                                 _mm256_set1_ps(0.5f)));
+      __m256 r = _mm256_fnmadd_ps(n, c1, x);
+      r = _mm256_fnmadd_ps(n, c2, r);
+
+      __m256 p = _mm256_set1_ps(1.9875691500E-4f);
+      p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507E-3f));
+      p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073E-3f));
+      p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894E-2f));
+      p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459E-1f));
+      p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201E-1f));
+
+      // e^r = 1 + r + r^2 p
+      __m256 e = _mm256_fmadd_ps(_mm256_mul_ps(p, r), r,
+                                 _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+      // scale by 2^n
+      __m256i bits = _mm256_cvtps_epi32(n);
+      bits = _mm256_slli_epi32(
+        _mm256_add_epi32(bits, _mm256_set1_epi32(127)), 23);
+
+      return _mm256_mul_ps(e, _mm256_castsi256_ps(bits));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256 tanhAvx2(__m256 x)
+    {
+      const __m256 signMask = _mm256_set1_ps(-0.0f);
+      const __m256 one = _mm256_set1_ps(1.0f);
+
+      __m256 ax = _mm256_andnot_ps(signMask, x);
+
+      // |x| >= 0.625; tanhf() rounds to +/-1 well before |x| = 9
+      __m256 cx = _mm256_min_ps(ax, _mm256_set1_ps(9.0f));
+      __m256 z = expAvx2(_mm256_add_ps(cx, cx));
+      __m256 big = _mm256_sub_ps(
+        one, _mm256_div_ps(_mm256_set1_ps(2.0f), _mm256_add_ps(z, one)));
+      big = _mm256_or_ps(big, _mm256_and_ps(signMask, x));
+
+      // |x| < 0.625
+      __m256 s = _mm256_mul_ps(x, x);
+
+      __m256 p = _mm256_set1_ps(-5.70498872745E-3f);
+      p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(2.06390887954E-2f));
+      p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-5.37397155531E-2f));
+      p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(1.33314422036E-1f));
+      p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-3.33332819422E-1f));
+
+      __m256 small = _mm256_fmadd_ps(_mm256_mul_ps(p, s), x, x);
+
+      __m256 useBig = _mm256_cmp_ps(ax, _mm256_set1_ps(0.625f), _CMP_GE_OQ);
+      return _mm256_blendv_ps(small, big, useBig);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void tanhAvx2Float(const float* in, float* out, int n)
+    {
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        _mm256_storeu_ps(out + i, tanhAvx2(_mm256_loadu_ps(in + i)));
+      }
+
+      // finish the tail through a padded register so that every value
+      // goes through the same approximation
+      if (i < n)
+      {
+        float buf[8] = { 0.00f, 0.00f, 0.00f, 0.00f,
+                         0.00f, 0.00f, 0.00f, 0.00f };
+        for (int j = i; j < n; ++j)
+        {
+          buf[j - i] = in[j];
+        }
+
+        _mm256_storeu_ps(buf, tanhAvx2(_mm256_loadu_ps(buf)));
+
+        for (int j = i; j < n; ++j)
+        {
+          out[j] = buf[j - i];
+        }
+      }
+    }
+
+
+    __attribute__((target("avx2,fma")))
+    inline __m256d fastTanhAvx2(__m256d x)
+    {
+      const __m256d clamp = _mm256_set1_pd(c_fastTanhClamp);
+      x = _mm256_max_pd(_mm256_min_pd(x, clamp),
+                        _mm256_sub_pd(_mm256_setzero_pd(), clamp));
+      __m256d x2 = _mm256_mul_pd(x, x);
+
+      __m256d p = _mm256_set1_pd(c_fastTanhP[6]);
+      for (int k = 5; k >= 0; --k)
+      {
+        p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(c_fastTanhP[k]));
+      }
+
+      __m256d q = _mm256_set1_pd(c_fastTanhQ[3]);
+      for (int k = 2; k >= 0; --k)
+      {
+        q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(c_fastTanhQ[k]));
+      }
+
+      return _mm256_div_pd(_mm256_mul_pd(x, p), q);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void fastTanhAvx2(const double* in, double* out, int n)
+    {
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        _mm256_storeu_pd(out + i, fastTanhAvx2(_mm256_loadu_pd(in + i)));
+      }
+
+      // finish the tail through a padded register so that every value
+      // goes through the same arithmetic
+      if (i < n)
+      {
+        double buf[4] = { 0.00, 0.00, 0.00, 0.00 };
+        for (int j = i; j < n; ++j)
+        {
+          buf[j - i] = in[j];
+        }
+
+        _mm256_storeu_pd(buf, fastTanhAvx2(_mm256_loadu_pd(buf)));
+
+        for (int j = i; j < n; ++j)
+        {
+          out[j] = buf[j - i];
+        }
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256 fastTanhAvx2(__m256 x)
+    {
+      const __m256 clamp = _mm256_set1_ps(float(c_fastTanhClamp));
+      x = _mm256_max_ps(_mm256_min_ps(x, clamp),
+                        _mm256_sub_ps(_mm256_setzero_ps(), clamp));
+      __m256 x2 = _mm256_mul_ps(x, x);
+
+      __m256 p = _mm256_set1_ps(float(c_fastTanhP[6]));
+      for (int k = 5; k >= 0; --k)
+      {
+        p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(float(c_fastTanhP[k])));
+      }
+
+      __m256 q = _mm256_set1_ps(float(c_fastTanhQ[3]));
+      for (int k = 2; k >= 0; --k)
+      {
+        q = _mm256_fmadd_ps(q, x2, _mm256_set1_ps(float(c_fastTanhQ[k])));
+      }
+
+      return _mm256_div_ps(_mm256_mul_ps(x, p), q);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void fastTanhAvx2Float(const float* in, float* out, int n)
+    {
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        _mm256_storeu_ps(out + i, fastTanhAvx2(_mm256_loadu_ps(in + i)));
+      }
+
+      if (i < n)
+      {
+        float buf[8] = { 0.00f, 0.00f, 0.00f, 0.00f,
+                         0.00f, 0.00f, 0.00f, 0.00f };
+        for (int j = i; j < n; ++j)
+        {
+          buf[j - i] = in[j];
+        }
+
+        _mm256_storeu_ps(buf, fastTanhAvx2(_mm256_loadu_ps(buf)));
+
+        for (int j = i; j < n; ++j)
+        {
+          out[j] = buf[j - i];
+        }
+      }
+    }
+
+#endif // NEURALNETKERNELS_X86
+
+
+    //////////////////////////////////////////////////////////////////////
+    // dispatch
+
+    typedef double (*DotFunc)(const double*, const double*, int);
+    typedef void (*MatVecFunc)(const double*, int, int, const double*,
+                               double*);
+    typedef void (*MatMulFunc)(const double*, int, const double*, int, int,
+                               double*, int);
+    typedef void (*TanhFunc)(const double*, double*, int);
+
+    typedef float (*DotFloatFunc)(const float*, const float*, int);
+    typedef void (*MatVecFloatFunc)(const float*, int, int, const float*,
+                                    float*);
+    typedef void (*MatMulFloatFunc)(const float*, int, const float*, int,
+                                    int, float*, int);
+    typedef void (*TanhFloatFunc)(const float*, float*, int);
+
+    struct KernelTable
+    {
+      Level level;
+      DotFunc dot;
+      MatVecFunc matVec;
+      MatMulFunc matMul;
+      TanhFunc tanh;
+      TanhFunc fastTanh;
+      DotFloatFunc dotFloat;
+      MatVecFloatFunc matVecFloat;
+      MatMulFloatFunc matMulFloat;
+      TanhFloatFunc tanhFloat;
+      TanhFloatFunc fastTanhFloat;
+    };
+
+    KernelTable makeTable(Level level)
+    {
+      KernelTable table;
+      table.level = LEVEL_scalar;
+      table.dot = dotScalar;
+      table.matVec = matVecScalar;
+      table.matMul = matMulScalar;
+      table.tanh = tanhScalar;
+      table.fastTanh = fastTanhScalar;
+      table.dotFloat = dotScalarFloat;
+      table.matVecFloat = matVecScalarFloat;
+      table.matMulFloat = matMulScalarFloat;
+      table.tanhFloat = tanhScalarFloat;
+      table.fastTanhFloat = fastTanhScalarFloat;
+
+#ifdef NEURALNETKERNELS_X86
+      if (level >= LEVEL_avx2)
+      {
+        table.level = LEVEL_avx2;
+        table.dot = dotAvx2;
+        table.matVec = matVecAvx2;
+        table.matMul = matMulAvx2;
+        table.tanh = tanhAvx2;
+        table.fastTanh = fastTanhAvx2;
+        table.dotFloat = dotAvx2Float;
+        table.matVecFloat = matVecAvx2Float;
+        table.matMulFloat = matMulAvx2Float;
+        table.tanhFloat = tanhAvx2Float;
+        table.fastTanhFloat = fastTanhAvx2Float;
+      }
+      else if (level >= LEVEL_sse2)
+      {
+        table.level = LEVEL_sse2;
+        table.dot = dotSse2;
+        table.matVec = matVecSse2;
+        table.matMul = matMulSse2;
+        table.fastTanh = fastTanhSse2;
+        table.dotFloat = dotSse2Float;
+        table.matVecFloat = matVecSse2Float;
+        table.matMulFloat = matMulSse2Float;
+        table.fastTanhFloat = fastTanhSse2Float;
+      }
+#endif
+
+      return table;
+    }
+
+    Level detectLevel()
+    {
+#ifdef NEURALNETKERNELS_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      {
+        return LEVEL_avx2;
+      }
+      else if (__builtin_cpu_supports("sse2"))
+      {
+        return LEVEL_sse2;
+      }
+#endif
+      return LEVEL_scalar;
+    }
+
+    const Level s_maxLevel = detectLevel();
+
+    KernelTable s_table = makeTable(s_maxLevel);
+
+  } // anonymous namespace
+
+
+  Level getLevel()
+  {
+    return s_table.level;
+  }
+
+
+  Level getMaxLevel()
+  {
+    return s_maxLevel;
+  }
+
+
+  void setLevel(Level val)
+  {
+    s_table = makeTable((val > s_maxLevel) ? s_maxLevel : val);
+  }
+
+
+  const char* getLevelName(Level val)
+  {
+    switch (val)
+    {
+      case LEVEL_avx2:
+        return "avx2";
+
+      case LEVEL_sse2:
+        return "sse2";
+
+      case LEVEL_scalar:
+      default:
+        return "scalar";
+    }
+  }
+
+
+  double dot(const double* a, const double* b, int n)
+  {
+    return s_table.dot(a, b, n);
+  }
+
+
+  void matVec(const double* weight,
+              int rows,
+              int stride,
+              const double* x,
+              double* y)
+  {
+    s_table.matVec(weight, rows, stride, x, y);
+  }
+
+
+  void matMul(const double* x,
+              int rows,
+              const double* weight,
+              int units,
+              int stride,
+              double* y,
+              int yStride)
+  {
+    s_table.matMul(x, rows, weight, units, stride, y, yStride);
+  }
+
+
+  void tanh(const double* in, double* out, int n)
+  {
+    s_table.tanh(in, out, n);
+  }
+
+
+  void fastTanh(const double* in, double* out, int n)
+  {
+    s_table.fastTanh(in, out, n);
+  }
+
+
+  float dot(const float* a, const float* b, int n)
+  {
+    return s_table.dotFloat(a, b, n);
+  }
+
+
+  void matVec(const float* weight,
+              int rows,
+              int stride,
+              const float* x,
+              float* y)
+  {
+    s_table.matVecFloat(weight, rows, stride, x, y);
+  }
+
+
+  void matMul(const float* x,
+              int rows,
+              const float* weight,
+              int units,
+              int stride,
+              float* y,
+              int yStride)
+  {
+    s_table.matMulFloat(x, rows, weight, units, stride, y, yStride);
+  }
+
+
+  void tanh(const float* in, float* out, int n)
+  {
+    s_table.tanhFloat(in, out, n);
+  }
+
+
+  void fastTanh(const float* in, float* out, int n)
+  {
+    s_table.fastTanhFloat(in, out, n);
+  }
+
+} // namespace NeuralNetKernels
+
+} // namespace alch
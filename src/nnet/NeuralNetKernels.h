@@ -0,0 +1,160 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_NeuralNetKernels_h
+#define INCLUDED_nnet_NeuralNetKernels_h
+
+namespace alch {
+
+/*!
+  \brief Vectorized inner loops used by the neural network
+  \ingroup nnet
+
+  Each kernel has an AVX2, an SSE2 and a plain C++ implementation. The
+  best one the CPU supports is chosen when the library is loaded; it can
+  be lowered with setLevel(), e.g. to compare results against the scalar
+  code. The SIMD versions sum in a different order than the scalar ones,
+  so results may differ in the last few bits between levels.
+
+  Every kernel also has a float overload for single precision networks.
+  These process twice as many values per register and accumulate in
+  float.
+*/
+namespace NeuralNetKernels
+{
+
+  //! Instruction set used by the kernels
+  enum Level
+  {
+    //! Plain C++ loops
+    LEVEL_scalar = 0,
+
+    //! SSE2 (2 doubles per register)
+    LEVEL_sse2 = 1,
+
+    //! AVX2 with FMA (4 doubles per register)
+    LEVEL_avx2 = 2
+  };
+
+  //! Returns the level the kernels are currently using
+  Level getLevel();
+
+  //! Returns the highest level supported by this CPU
+  Level getMaxLevel();
+
+  /*!
+    \brief Sets the level the kernels use
+    \param val Requested level; lowered to getMaxLevel() if not supported
+
+    Not thread-safe; call before any threads are using the kernels.
+  */
+  void setLevel(Level val);
+
+  //! Returns printable name of the specified level
+  const char* getLevelName(Level val);
+
+  /*!
+    \brief Returns the dot product of two arrays
+    \param a First array
+    \param b Second array
+    \param n Number of elements in a and b
+  */
+  double dot(const double* a, const double* b, int n);
+
+  /*!
+    \brief Multiplies a row-major matrix by a vector
+    \param weight The matrix; rows * stride values
+    \param rows Number of rows in the matrix
+    \param stride Number of values in each row and in x
+    \param x The vector to multiply by
+    \param y [out] The rows results
+
+    Computes y[r] = dot(weight + r * stride, x, stride). Several rows are
+    computed together so that x is loaded once for all of them.
+  */
+  void matVec(const double* weight,
+              int rows,
+              int stride,
+              const double* x,
+              double* y);
+
+  /*!
+    \brief Multiplies a matrix of input rows by a transposed weight matrix
+    \param x The input rows; rows * stride values
+    \param rows Number of input rows
+    \param weight The weight rows; units * stride values
+    \param units Number of weight rows
+    \param stride Number of values in each input and weight row
+    \param y [out] The results; row r starts at y + r * yStride
+    \param yStride Distance between result rows
+
+    Computes y[r * yStride + u] = dot(x + r * stride, weight + u * stride,
+    stride). The work is blocked over rows and units so that each load of
+    an input or weight vector is reused several times. Each result is
+    bit-identical to the corresponding matVec() result.
+  */
+  void matMul(const double* x,
+              int rows,
+              const double* weight,
+              int units,
+              int stride,
+              double* y,
+              int yStride);
+
+  /*!
+    \brief Computes the hyperbolic tangent of each value in an array
+    \param in The input values
+    \param out [out] The output values; may be the same as in
+    \param n Number of values
+
+    The AVX2 version is accurate to a few units in the last place of
+    ::tanh(); the other levels call ::tanh() directly.
+  */
+  void tanh(const double* in, double* out, int n);
+
+  /*!
+    \brief Computes an approximate hyperbolic tangent of each value
+    \param in The input values
+    \param out [out] The output values; may be the same as in
+    \param n Number of values
+
+    Uses a rational approximation with an absolute error below 2.6e-8
+    against ::tanh(); see NeuralNetFunctors::FastTanh. Every level
+    vectorizes it, unlike tanh() below AVX2.
+  */
+  void fastTanh(const double* in, double* out, int n);
+
+  //! Single precision dot()
+  float dot(const float* a, const float* b, int n);
+
+  //! Single precision matVec()
+  void matVec(const float* weight,
+              int rows,
+              int stride,
+              const float* x,
+              float* y);
+
+  //! Single precision matMul(); bit-identical to the float matVec()
+  void matMul(const float* x,
+              int rows,
+              const float* weight,
+              int units,
+              int stride,
+              float* y,
+              int yStride);
+
+  /*!
+    \brief Single precision tanh()
+
+    The AVX2 version is accurate to a few units in the last place of
+    ::tanhf(); the other levels call ::tanhf() directly.
+  */
+  void tanh(const float* in, float* out, int n);
+
+  //! Single precision fastTanh(); absolute error below 3e-7
+  void fastTanh(const float* in, float* out, int n);
+
+} // namespace NeuralNetKernels
+
+} // namespace alch
+
+#endif
@@ -3,13 +3,19 @@
 #ifndef INCLUDED_nnet_NeuralNetTemplate_h
 #define INCLUDED_nnet_NeuralNetTemplate_h
 
+#include "nnet/AlignedAllocator.h"
+#include "nnet/NeuralNetFunctors.h"
+#include "nnet/NeuralNetKernels.h"
+
 #include "boost/shared_ptr.hpp"
+#include "boost/static_assert.hpp"
 
 #include <vector>
 #include <cassert>
 
 #ifndef NDEBUG
 #include <iostream>
+#include <iomanip>
 #endif
 
 namespace alch {
@@ -17,15 +23,287 @@ namespace alch {
 
 /*!
   \brief Neural Network data representation class
+
+  The network holds only the layer sizes and weights. The values computed
+  for each unit while propagating inputs are kept in a separate Workspace,
+  so propagation does not modify the network: one network can be shared
+  by several threads as long as each thread uses its own workspace.
+
+  TScalar is the type of the weights and unit values, double or float.
+  A float network fits twice as many values in each SIMD register and
+  moves half as much memory, at the cost of precision.
 */
-template <typename TActivation, typename TOutputActivation>
+template <typename TActivation,
+          typename TOutputActivation,
+          typename TScalar = double>
 class NeuralNetTemplate
 {
  public:
 
-  //! The weights that belong to a single layer. First index is the unit
-  //! in the previous layer. Second index is the unit in the current layer.
-  typedef std::vector<std::vector<double> > LayerWeight;
+  //! Type of the weights and unit values
+  typedef TScalar Scalar;
+
+  //! Activation function of the hidden layers
+  typedef TActivation Activation;
+
+  //! Activation function of the output layer
+  typedef TOutputActivation OutputActivation;
+
+  //! The weights that belong to a single layer, stored row-major as
+  //! [unit][prevUnit]. Each row holds getStride(layer - 1) values; the
+  //! padding at the end of each row is always zero.
+  typedef std::vector<TScalar, AlignedAllocator<TScalar> > LayerWeight;
+
+  //! The input or output values of all units in a single layer, padded
+  //! with zeros to getStride(layer) values.
+  typedef std::vector<TScalar, AlignedAllocator<TScalar> > LayerValue;
+
+
+  /*!
+    \brief Unit values produced by propagating inputs through a network
+
+    Holds the input and output of every unit for propagateInput(), and the
+    outputs of every row for propagateBatch(). A workspace sizes itself for
+    the network it is used with and keeps its buffers between calls, so
+    reusing one workspace per thread avoids any allocation after the first
+    call.
+  */
+  class Workspace
+  {
+   public:
+    //! Creates an empty workspace; it is sized on first use
+    Workspace()
+      : m_input()
+      , m_output()
+      , m_batchOutput()
+      , m_batchRows(0)
+      , m_numUnits()
+      , m_stride()
+    {
+    }
+
+    //! Creates a workspace sized for the specified network
+    explicit Workspace(const NeuralNetTemplate& net)
+      : m_input()
+      , m_output()
+      , m_batchOutput()
+      , m_batchRows(0)
+      , m_numUnits()
+      , m_stride()
+    {
+      resize(net);
+    }
+
+    /*!
+      \brief Sizes the workspace for the specified network
+      \param net The network
+
+      Does nothing if the workspace already matches the layer sizes of net.
+    */
+    void resize(const NeuralNetTemplate& net)
+    {
+      int numLayers = net.getNumLayers();
+
+      bool match = (static_cast<int>(m_numUnits.size()) == numLayers);
+      for (int i = 0; match && (i < numLayers); ++i)
+      {
+        match = (m_numUnits[i] == net.getNumUnits(i));
+      }
+
+      if (match)
+      {
+        return;
+      }
+
+      m_numUnits.resize(numLayers);
+      m_stride.resize(numLayers);
+      for (int i = 0; i < numLayers; ++i)
+      {
+        m_numUnits[i] = net.getNumUnits(i);
+        m_stride[i] = net.getStride(i);
+      }
+
+      // the padding of every layer must start out as zero
+      m_input.clear();
+      m_input.resize(numLayers);
+      m_output.clear();
+      m_output.resize(numLayers);
+      for (int i = 0; i < numLayers; ++i)
+      {
+        m_input[i].resize(m_stride[i], 0.00);
+        m_output[i].resize(m_stride[i], 0.00);
+
+        // set up single-valued outputs
+        m_output[i][0] = 1.00;
+      }
+
+      // batch values are allocated by the next propagateBatch()
+      m_batchOutput.clear();
+      m_batchOutput.resize(numLayers);
+      m_batchRows = 0;
+    }
+
+
+    /*!
+      \brief Returns a reference to the output units
+
+      Element 0 is the constant unit; the network outputs follow it.
+    */
+    const LayerValue& getOutput() const
+    {
+      assert(m_output.size() >= 2);
+      return m_output[m_output.size() - 1];
+    }
+
+
+    /*!
+      \brief Returns unit output for specified layer/unit
+      \param layer The layer in which the unit resides [0, numLayer-1]
+      \param unit The unit index within that layer
+    */
+    TScalar getUnitOutput(int layer, int unit) const
+    {
+      assert(layer >= 0);
+      assert(layer < static_cast<int>(m_output.size()));
+
+      assert(unit >= 0);
+      assert(unit < m_numUnits[layer]);
+
+      return m_output[layer][unit];
+    }
+
+
+    /*!
+      \brief Returns the padded outputs of all units in the specified layer
+      \param layer The layer [0, numLayer-1]
+    */
+    const LayerValue& getLayerOutput(int layer) const
+    {
+      assert(layer >= 0);
+      assert(layer < static_cast<int>(m_output.size()));
+      return m_output[layer];
+    }
+
+
+    /*!
+      \brief Returns unit input for specified layer/unit
+      \param layer The layer in which the unit resides [1, numLayer-1]
+      \param unit The unit index within that layer
+    */
+    TScalar getUnitInput(int layer, int unit) const
+    {
+      assert(layer >= 1);
+      assert(layer < static_cast<int>(m_input.size()));
+
+      assert(unit >= 0);
+      assert(unit < m_numUnits[layer]);
+
+      return m_input[layer][unit];
+    }
+
+
+    /*!
+      \brief Returns the padded inputs of all units in the specified layer
+      \param layer The layer [1, numLayer-1]
+    */
+    const LayerValue& getLayerInput(int layer) const
+    {
+      assert(layer >= 1);
+      assert(layer < static_cast<int>(m_input.size()));
+      return m_input[layer];
+    }
+
+
+    /*!
+      \brief Returns the outputs for one row of the last propagateBatch()
+      \param row The row [0..numRows - 1]
+
+      The returned array holds the network's getNumOutputUnits() values
+      laid out like getOutput(): element 0 is the constant unit.
+    */
+    const TScalar* getBatchOutput(int row) const
+    {
+      assert(row >= 0);
+      assert(row < m_batchRows);
+
+      int outputLayer = m_numUnits.size() - 1;
+      return &m_batchOutput[outputLayer][row * m_stride[outputLayer]];
+    }
+
+
+#ifndef NDEBUG
+    /*!
+      \brief Prints unit inputs and outputs to stream
+      \param os Output stream
+    */
+    void dump(std::ostream& os) const
+    {
+      const int colWidth = 8;
+
+      int numLayers = m_numUnits.size();
+      for (int i = 0; i < numLayers; ++i)
+      {
+        int numUnits = m_numUnits[i];
+
+        os << "--- Layer " << i << " ---\n";
+
+        os << "Input:  ";
+        for (int j = 0; j < numUnits; ++j)
+        {
+          os << std::setw(colWidth) << m_input[i][j] << " ";
+        }
+        os << "\n";
+
+        os << "Output: ";
+        for (int j = 0; j < numUnits; ++j)
+        {
+          os << std::setw(colWidth) << m_output[i][j] << " ";
+        }
+        os << "\n\n";
+      }
+    }
+#endif
+
+   private:
+    friend class NeuralNetTemplate;
+
+    //! The inputs to all units. m_input[layer][unit]
+    std::vector<LayerValue> m_input;
+
+    //! The outputs from all units. m_output[layer][unit]
+    std::vector<LayerValue> m_output;
+
+    //! The outputs from all units for each row of a batch.
+    //! m_batchOutput[layer][row * stride + unit]
+    std::vector<LayerValue> m_batchOutput;
+
+    //! Number of rows m_batchOutput has room for
+    int m_batchRows;
+
+    //! Number of units in each layer of the network we're sized for
+    std::vector<int> m_numUnits;
+
+    //! Padded length of each layer's values. m_stride[layer]
+    std::vector<int> m_stride;
+
+
+    //! Makes sure m_batchOutput has room for at least numRows rows
+    void resizeBatch(int numRows)
+    {
+      if (numRows <= m_batchRows)
+      {
+        return;
+      }
+
+      // new space is zeroed, which keeps the row padding at zero
+      int numLayers = m_numUnits.size();
+      for (int i = 0; i < numLayers; ++i)
+      {
+        m_batchOutput[i].resize(numRows * m_stride[i], 0.00);
+      }
+      m_batchRows = numRows;
+    }
+  };
 
   /*!
     \brief Constructor: Creates neural network of specified size
@@ -46,9 +324,8 @@ class NeuralNetTemplate
             int hiddenLayers = 0,
             int unitsPerLayer = 0)
     : m_weight()
-    , m_input()
-    , m_output()
     , m_numUnits()
+    , m_stride()
     , m_outputActivation()
     , m_activation()
   {
@@ -68,11 +345,64 @@ class NeuralNetTemplate
     // create output layer; add 1 for constant unit
     m_numUnits.push_back(outputUnits + 1);
 
-    // sets up weight, input, output
+    // sets up weights
     reset();
   }
 
 
+  /*!
+    \brief Creates a copy of a network of another type
+    \param other The network to copy
+
+    The copy has the same layers and the same weights, rounded to TScalar,
+    but uses this type's activation functions. This converts between
+    scalar types, or e.g. from a TanhNeuralNet to a FastTanhNeuralNet.
+    The activations must match up to that approximation, as
+    NeuralNetFunctors::IsConvertible tells; copying e.g. a LinearNeuralNet
+    into a TanhNeuralNet doesn't compile, since the copy would compute
+    something else.
+  */
+  template <typename TOtherActivation,
+            typename TOtherOutputActivation,
+            typename TOtherScalar>
+  explicit NeuralNetTemplate(
+    const NeuralNetTemplate<TOtherActivation,
+                            TOtherOutputActivation,
+                            TOtherScalar>& other)
+    : m_weight()
+    , m_numUnits()
+    , m_stride()
+    , m_outputActivation()
+    , m_activation()
+  {
+    BOOST_STATIC_ASSERT((NeuralNetFunctors::IsConvertible<
+                           TOtherActivation, TActivation>::value));
+    BOOST_STATIC_ASSERT((NeuralNetFunctors::IsConvertible<
+                           TOtherOutputActivation,
+                           TOutputActivation>::value));
+
+    int numLayers = other.getNumLayers();
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      m_numUnits.push_back(other.getNumUnits(layer));
+    }
+
+    reset();
+
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      for (int fromUnit = 0; fromUnit < m_numUnits[layer - 1]; ++fromUnit)
+      {
+        for (int toUnit = 1; toUnit < m_numUnits[layer]; ++toUnit)
+        {
+          setWeight(layer, fromUnit, toUnit,
+                    TScalar(other.getWeight(layer, fromUnit, toUnit)));
+        }
+      }
+    }
+  }
+
+
   /*!
     \brief Destructor
   */
@@ -160,21 +490,15 @@ class NeuralNetTemplate
     \param toUnit The unit index number of the unit in the current layer
     (toLayer) at which this connection ends.
   */
-  double& getWeight(int toLayer, int fromUnit, int toUnit)
+  TScalar& getWeight(int toLayer, int fromUnit, int toUnit)
   {
-    assert(toLayer >= 1);
-    assert(toLayer < getNumLayers());
-    assert(toLayer < static_cast<int>(m_weight.size()));
-
-    assert(fromUnit >= 0);
-    assert(fromUnit < static_cast<int>(m_weight[toLayer].size()));
-    assert(fromUnit < m_numUnits[toLayer - 1]);
-
-    assert(toUnit >= 0);
-    assert(toUnit < static_cast<int>(m_weight[toLayer][fromUnit].size()));
-    assert(toUnit < m_numUnits[toLayer]);
+    return m_weight[toLayer][getWeightIndex(toLayer, fromUnit, toUnit)];
+  }
 
-    return m_weight[toLayer][fromUnit][toUnit];
+  //! Returns the weight of the connection; see non-const getWeight()
+  TScalar getWeight(int toLayer, int fromUnit, int toUnit) const
+  {
+    return m_weight[toLayer][getWeightIndex(toLayer, fromUnit, toUnit)];
   }
 
   /*!
@@ -186,115 +510,187 @@ class NeuralNetTemplate
     \param toUnit The unit index number of the unit in the current layer
     (toLayer) at which this connection ends.
   */
-  void setWeight(int toLayer, int fromUnit, int toUnit, double value)
+  void setWeight(int toLayer, int fromUnit, int toUnit, TScalar value)
   {
-    assert(toLayer >= 1);
-    assert(toLayer < getNumLayers());
-    assert(toLayer < static_cast<int>(m_weight.size()));
+    m_weight[toLayer][getWeightIndex(toLayer, fromUnit, toUnit)] = value;
+  }
 
-    assert(fromUnit >= 0);
-    assert(fromUnit < static_cast<int>(m_weight[toLayer].size()));
-    assert(fromUnit < m_numUnits[toLayer - 1]);
+  /*!
+    \brief Returns the padded number of values stored for each layer
+    \param layer The layer [0..getNumLayers() - 1]
 
-    assert(toUnit >= 0);
-    assert(toUnit < static_cast<int>(m_weight[toLayer][fromUnit].size()));
-    assert(toUnit < m_numUnits[toLayer]);
+    This is getNumUnits(layer) rounded up to a whole number of SIMD
+    registers for all but the output layer. It is the length of each
+    weight row feeding layer + 1.
+  */
+  int getStride(int layer) const
+  {
+    assert(layer >= 0);
+    assert(layer < static_cast<int>(m_stride.size()));
+    return m_stride[layer];
+  }
 
-    m_weight[toLayer][fromUnit][toUnit] = value;
+  /*!
+    \brief Returns the contiguous weight block feeding the specified layer
+    \param toLayer The layer [1..getNumLayers() - 1]
+
+    The block holds getNumUnits(toLayer) rows of getStride(toLayer - 1)
+    weights each. Row 0 belongs to the constant unit and is unused.
+  */
+  LayerWeight& getLayerWeight(int toLayer)
+  {
+    assert(toLayer >= 1);
+    assert(toLayer < static_cast<int>(m_weight.size()));
+    return m_weight[toLayer];
+  }
+
+  //! Returns the contiguous weight block feeding the specified layer
+  const LayerWeight& getLayerWeight(int toLayer) const
+  {
+    assert(toLayer >= 1);
+    assert(toLayer < static_cast<int>(m_weight.size()));
+    return m_weight[toLayer];
   }
 
   /*!
-    \brief Sets ths neural network inputs to be the specified values
-    \param val The network inputs
+    \brief Propagates network inputs to the output
+    \param input The network inputs
+    \param workspace [out] Receives the input and output of every unit
 
-    Note that the size of the specified array must be the same as the
+    This will use the specified input and existing network weights to 
+    calculate the new network outputs, which can be retrieved with
+    workspace.getOutput(). The size of input must be the same as the
     number of input units in the network set during construction.
   */
-  void setInput(const std::vector<double>& val)
+  void propagateInput(const std::vector<TScalar>& input,
+                      Workspace& workspace) const
   {
-    assert(m_output.size() >= 2);
-    assert(m_output[0].size() == (val.size() + 1));
+    assert(m_numUnits[0] == static_cast<int>(input.size() + 1));
 
-    m_output[0][0] = 1.00;
-    int valSize = val.size();
-    for (int i = 0; i < valSize; ++i)
-    {
-      m_output[0][i + 1] = val[i];
-    }
+    propagateInput(input.empty() ? 0 : &input[0], workspace);
   }
 
 
   /*!
-    \brief Returns a reference to the output units
+    \brief Propagates network inputs to the output
+    \param input The getNumInputUnits() network inputs
+    \param workspace [out] Receives the input and output of every unit
+
+    Same as above for inputs that are not held in a vector, such as a row
+    of an NNetDataset.
   */
-  const std::vector<double>& getOutput() const
+  void propagateInput(const TScalar* input, Workspace& workspace) const
   {
-    int outputLayer = m_output.size() - 1;
-    assert(m_output.size() >= 2);
-    return m_output[outputLayer];
+    workspace.resize(*this);
+
+    LayerValue& inputLayer = workspace.m_output[0];
+    inputLayer[0] = 1.00;
+    int inputSize = getNumInputUnits();
+    for (int i = 0; i < inputSize; ++i)
+    {
+      inputLayer[i + 1] = input[i];
+    }
+    
+    for (int layer = 1; layer < getNumLayers(); ++layer)
+    {
+      computeInputs(layer, workspace);
+      computeOutputs(layer, workspace);
+    }
   }
 
 
   /*!
-    \brief Returns unit output for specified layer/unit
-    \param layer The layer in which the unit resides [0, numLayer-1]
-    \param unit The unit index within that layer
+    \brief Propagates several sets of network inputs at once
+    \param input The network inputs; row r holds getNumInputUnits() values
+    starting at input + r * inputStride
+    \param numRows Number of input rows
+    \param inputStride Distance between the starts of successive rows
+    \param workspace [out] Receives the outputs of every row
+
+    Each layer is computed for all rows together as one matrix-matrix
+    product, so every weight is loaded once per block of rows instead of
+    once per row. The outputs can be retrieved with
+    workspace.getBatchOutput() and match what propagateInput() would
+    produce for each row. The single-input values of the workspace are not
+    changed.
+
+    Keep numRows moderate (tens to a few hundred) so that the activations
+    of all rows stay in cache; callers with more data should loop.
   */
-  double getUnitOutput(int layer, int unit) const
+  void propagateBatch(const TScalar* input,
+                      int numRows,
+                      int inputStride,
+                      Workspace& workspace) const
   {
-    assert(layer >= 0);
-    assert(layer < getNumLayers());
-    assert(layer < static_cast<int>(m_output.size()));
+    assert(input);
+    assert(numRows >= 0);
+    assert(inputStride >= getNumInputUnits());
+
+    workspace.resize(*this);
+    workspace.resizeBatch(numRows);
 
-    assert(unit >= 0);
-    assert(unit < static_cast<int>(m_output[layer].size()));
-    assert(unit < m_numUnits[layer]);
+    for (int row = 0; row < numRows; ++row)
+    {
+      setBatchInput(row, input + row * inputStride, workspace);
+    }
 
-    return m_output[layer][unit];
+    computeBatch(numRows, workspace);
   }
 
+
   /*!
-    \brief Returns unit input for specified layer/unit
-    \param layer The layer in which the unit resides [1, numLayer-1]
-    \param unit The unit index within that layer
+    \brief Propagates several sets of network inputs at once
+    \param input The network inputs; input[r] points to the
+    getNumInputUnits() values of row r
+    \param numRows Number of input rows
+    \param workspace [out] Receives the outputs of every row
+
+    Same as above for rows that are not evenly spaced in memory.
   */
-  double getUnitInput(int layer, int unit) const
+  void propagateBatch(const TScalar* const* input,
+                      int numRows,
+                      Workspace& workspace) const
   {
-    assert(layer >= 1);
-    assert(layer < getNumLayers());
-    assert(layer < static_cast<int>(m_input.size()));
+    assert(input);
+    assert(numRows >= 0);
 
-    assert(unit >= 0);
-    assert(unit < static_cast<int>(m_input[layer].size()));
-    assert(unit < m_numUnits[layer]);
+    workspace.resize(*this);
+    workspace.resizeBatch(numRows);
 
-    return m_input[layer][unit];
+    for (int row = 0; row < numRows; ++row)
+    {
+      setBatchInput(row, input[row], workspace);
+    }
+
+    computeBatch(numRows, workspace);
   }
 
 
   /*!
-    \brief Sets network inputs and propagates them to the output
-    \param input The network inputs
+    \brief Exchanges the network's weights with another set of weights
+    \param other Weights laid out like the network's; one LayerWeight per
+    layer, with other[toLayer] the same size as getLayerWeight(toLayer)
 
-    This will use the specified input and existing network weights to 
-    calculate the new network outputs. The tree will be modified with
-    new input/output values for the individual units. The outputs can
-    be retrieved with getOutput();
+    Only the buffers are exchanged, so this takes constant time whatever
+    the size of the network. Trainers use it to keep a second copy of the
+    weights that can be switched in and out without copying.
   */
-  void propagateInput(const std::vector<double>& input)
+  void swapWeights(std::vector<LayerWeight>& other)
   {
-    setInput(input);
-    
-    for (int layer = 1; layer < getNumLayers(); ++layer)
+    assert(other.size() == m_weight.size());
+#ifndef NDEBUG
+    for (int i = 1; i < getNumLayers(); ++i)
     {
-      computeInputs(layer);
-      computeOutputs(layer);
+      assert(other[i].size() == m_weight[i].size());
     }
+#endif
+
+    m_weight.swap(other);
   }
 
 
   /*!
-    \brief Resizes and reinitializes the input and output data structures.
+    \brief Resizes and reinitializes the weights.
     
     It is necessary to call this method after the network has been fully
     sized via the addLayer() method.
@@ -304,105 +700,50 @@ class NeuralNetTemplate
     int numLayers = getNumLayers();
 
     //////////////////////////////////////////////////////////////////////
-    // resize input
-    m_input.clear();
-    m_input.resize(numLayers);
-
-    // inputs to the hidden layers
-    for (int i = 0; i < numLayers; ++i)
-    {
-      m_input[i].resize(m_numUnits[i], 0.00);
-    }
-
-    //////////////////////////////////////////////////////////////////////
-    // resize output
-    m_output.clear();
-    m_output.resize(numLayers);
-
-    // outputs from the hidden layers
-    for (int i = 0; i < numLayers; ++i)
-    {
-      m_output[i].resize(m_numUnits[i], 0.00);
-    }
-
-    // set up single-valued outputs
+    // pad every layer but the output layer to a whole number of SIMD
+    // registers; nothing reads the output layer as a weight row operand
+    m_stride.clear();
+    m_stride.resize(numLayers);
     for (int i = 0; i < numLayers; ++i)
     {
-      m_output[i][0] = 1.00;
+      m_stride[i] = ((i == numLayers - 1)
+                     ? m_numUnits[i]
+                     : padUnits(m_numUnits[i]));
     }
 
     //////////////////////////////////////////////////////////////////////
-    // resize weights
+    // resize weights: one row of prev layer stride per unit in this layer
     m_weight.clear();
     m_weight.resize(numLayers);
     for (int i = 1; i < numLayers; ++i)
     {
-      // number of units in prev layer
-      int maxJ = m_numUnits[i - 1];
-
-      m_weight[i].resize(maxJ);
-
-      for (int j = 0; j < maxJ; ++j)
-      {
-        // number of units in this layer
-        int maxK = 0;
-        maxK = m_numUnits[i];
-
-        m_weight[i][j].resize(maxK, 0.00);
-      }
+      m_weight[i].resize(m_numUnits[i] * m_stride[i - 1], 0.00);
     }
   }
 
 
-
-#ifndef NDEBUG
   /*!
-    \brief Prints neural network to stream
-    \param os Output stream
+    \brief Rounds a unit count up to a whole number of SIMD registers
+    \param numUnits Number of units
   */
-  void dump(std::ostream& os)
+  static int padUnits(int numUnits)
   {
-    const int colWidth = 8;
-
-    int numLayers = getNumLayers();
-    for (int i = 0; i < numLayers; ++i)
-    {
-      int numUnits = m_numUnits[i];
-
-      os << "--- Layer " << i << " ---\n";
-
-      os << "Input:  ";
-      for (int j = 0; j < numUnits; ++j)
-      {
-        os << std::setw(colWidth) << m_input[i][j] << " ";
-      }
-      os << "\n";
-
-      os << "Output: ";
-      for (int j = 0; j < numUnits; ++j)
-      {
-        os << std::setw(colWidth) << m_output[i][j] << " ";
-      }
-      os << "\n\n";
-    }
+    const int width = c_nnetAlignment / sizeof(TScalar);
+    return (((numUnits + width - 1) / width) * width);
   }
 
-#endif
 
 private:
-  //! The weights of all layers
+  //! The weights of all layers. m_weight[toLayer][toUnit * stride + fromUnit]
   std::vector<LayerWeight> m_weight;
 
-  //! The inputs to all units. m_input[layer][unit]
-  std::vector<std::vector<double> > m_input;
-
-  //! The outputs from all units. m_output[layer][unit]
-  std::vector<std::vector<double> > m_output;
-
   //! Number of units in each layer. m_numUnits[layer]. Includes constant
   //! unit.
   std::vector<int> m_numUnits;
 
+  //! Padded length of each layer's values. m_stride[layer]
+  std::vector<int> m_stride;
+
   //! Output activation functor
   TOutputActivation m_outputActivation;
 
@@ -410,65 +751,132 @@ private:
   TActivation m_activation;
 
 
+  //! Returns offset of the specified weight within m_weight[toLayer]
+  int getWeightIndex(int toLayer, int fromUnit, int toUnit) const
+  {
+    assert(toLayer >= 1);
+    assert(toLayer < getNumLayers());
+    assert(toLayer < static_cast<int>(m_weight.size()));
+
+    assert(fromUnit >= 0);
+    assert(fromUnit < m_numUnits[toLayer - 1]);
+
+    assert(toUnit >= 0);
+    assert(toUnit < m_numUnits[toLayer]);
+
+    return (toUnit * m_stride[toLayer - 1] + fromUnit);
+  }
+
+
+  //! Copies one row of inputs, after the constant unit, into the input
+  //! layer of the workspace's batch values
+  void setBatchInput(int row,
+                     const TScalar* input,
+                     Workspace& workspace) const
+  {
+    assert(input);
+
+    TScalar* dest = &workspace.m_batchOutput[0][row * m_stride[0]];
+    dest[0] = 1.00;
+
+    int numInputs = getNumInputUnits();
+    for (int i = 0; i < numInputs; ++i)
+    {
+      dest[i + 1] = input[i];
+    }
+  }
+
+
+  //! Propagates the first numRows rows of batch inputs to the output
+  void computeBatch(int numRows, Workspace& workspace) const
+  {
+    std::vector<LayerValue>& batchOutput = workspace.m_batchOutput;
+
+    int outputLayer = getNumLayers() - 1;
+    for (int layer = 1; layer < getNumLayers(); ++layer)
+    {
+      int prevStride = m_stride[layer - 1];
+      int stride = m_stride[layer];
+      int numUnits = m_numUnits[layer] - 1;
+
+      // unit inputs of every row; row 0 of the weights is skipped since it
+      // belongs to the constant unit
+      NeuralNetKernels::matMul(&batchOutput[layer - 1][0],
+                               numRows,
+                               &m_weight[layer][prevStride],
+                               numUnits,
+                               prevStride,
+                               &batchOutput[layer][1],
+                               stride);
+
+      // unit outputs, computed in place
+      for (int row = 0; row < numRows; ++row)
+      {
+        TScalar* value = &batchOutput[layer][row * stride];
+        if (layer == outputLayer)
+        {
+          m_outputActivation(value + 1, value + 1, numUnits);
+        }
+        else
+        {
+          m_activation(value + 1, value + 1, numUnits);
+        }
+        value[0] = 1.00;
+      }
+    }
+  }
+
+
   //! Computes the outputs for the specified layer [0..N-1]
-  void computeOutputs(int layer)
+  void computeOutputs(int layer, Workspace& workspace) const
   {
     assert(layer >= 0);
     assert(layer < getNumLayers());
-    assert(static_cast<int>(m_input.size()) == getNumLayers());
-    assert(static_cast<int>(m_input[layer].size()) == m_numUnits[layer]);
-    assert(static_cast<int>(m_output.size()) == getNumLayers());
-    assert(static_cast<int>(m_output[layer].size()) == m_numUnits[layer]);
 
-    // set constant output by def
-    m_output[layer][0] = 1.00;
+    LayerValue& input = workspace.m_input[layer];
+    LayerValue& output = workspace.m_output[layer];
 
-    // is this the output layer?
+    assert(static_cast<int>(input.size()) == m_stride[layer]);
+    assert(static_cast<int>(output.size()) == m_stride[layer]);
+
+    // apply the activation function to all units but the constant one
     int outputLayer = getNumLayers() - 1;
     if (layer == outputLayer)
     {
-      for (int unit = 1; unit < m_numUnits[layer]; ++unit)
-      {
-        // output activation function
-        m_output[layer][unit] = m_outputActivation(m_input[layer][unit]);
-      }
+      // output activation function
+      m_outputActivation(&input[1], &output[1], m_numUnits[layer] - 1);
     }
     else
     {
-      for (int unit = 1; unit < m_numUnits[layer]; ++unit)
-      {
-        // hidden unit activation function
-        m_output[layer][unit] = m_activation(m_input[layer][unit]);
-      }
+      // hidden unit activation function
+      m_activation(&input[1], &output[1], m_numUnits[layer] - 1);
     }
+
+    // set constant output by def
+    output[0] = 1.00;
   }
 
 
 
   //! Computes the inputs for the specified layer [1..N-1]
-  void computeInputs(int layer)
+  void computeInputs(int layer, Workspace& workspace) const
   {
     assert(layer >= 1);
     assert(layer < getNumLayers());
-    assert(static_cast<int>(m_input.size()) == getNumLayers());
-    assert(static_cast<int>(m_input[layer].size()) == m_numUnits[layer]);
-    assert(static_cast<int>(m_output.size()) == getNumLayers());
-    assert(static_cast<int>(m_output[layer].size()) == m_numUnits[layer]);
+    assert(static_cast<int>(workspace.m_input[layer].size())
+           == m_stride[layer]);
 
     int prevLayer = layer - 1;
-
-    for (int unit = 1; unit < m_numUnits[layer]; ++unit)
-    {
-      double weightSum = 0.00;
-
-      for (int prevUnit = 0; prevUnit < m_numUnits[prevLayer]; ++prevUnit)
-      {
-        weightSum += (m_weight[layer][prevUnit][unit]
-                      * m_output[prevLayer][prevUnit]);
-      }
-
-      m_input[layer][unit] = weightSum;
-    }
+    int prevStride = m_stride[prevLayer];
+
+    // each unit's weights are one contiguous row; the zero padding lets us
+    // run every dot product over the full stride. Row 0 belongs to the
+    // constant unit and is skipped.
+    NeuralNetKernels::matVec(&m_weight[layer][prevStride],
+                             m_numUnits[layer] - 1,
+                             prevStride,
+                             &workspace.m_output[prevLayer][0],
+                             &workspace.m_input[layer][1]);
   }
 
 }; // class NeuralNetTemplate
@@ -0,0 +1,97 @@
+
+#include "nnet/RMSPropGradDescent.h"
+#include "nnet/StateIO.h"
+
+#include <cmath>
+
+namespace alch {
+
+template <class TNeuralNet>
+RMSPropGradDescentTemplate<TNeuralNet>::RMSPropGradDescentTemplate(
+  NetworkPtr network,
+  double eta,
+  int batchSize,
+  long seed,
+  double rho,
+  double epsilon)
+  : MiniBatchGradDescentTemplate<TNeuralNet>(network, eta, batchSize, seed)
+  , m_rho(rho)
+  , m_epsilon(epsilon)
+  , m_meanSquare()
+{
+  assert((m_rho >= 0.00) && (m_rho < 1.00));
+  assert(m_epsilon > 0.00);
+
+  // averages start at zero, matching the network's weight blocks
+  int numLayers = network->getNumLayers();
+  m_meanSquare.resize(numLayers);
+  for (int layer = 1; layer < numLayers; ++layer)
+  {
+    m_meanSquare[layer].resize(network->getLayerWeight(layer).size(), 0.00);
+  }
+}
+
+
+template <class TNeuralNet>
+void RMSPropGradDescentTemplate<TNeuralNet>::writeState(
+  std::ostream& os) const
+{
+  MiniBatchGradDescentTemplate<TNeuralNet>::writeState(os);
+
+  StateIO::write(os, m_meanSquare);
+}
+
+
+template <class TNeuralNet>
+bool RMSPropGradDescentTemplate<TNeuralNet>::readState(std::istream& is)
+{
+  std::vector<LayerWeight> meanSquare;
+  if (!MiniBatchGradDescentTemplate<TNeuralNet>::readState(is)
+      || !StateIO::read(is, meanSquare)
+      || !StateIO::sameShape(meanSquare, m_meanSquare))
+  {
+    return false;
+  }
+
+  m_meanSquare.swap(meanSquare);
+  return true;
+}
+
+
+template <class TNeuralNet>
+double RMSPropGradDescentTemplate<TNeuralNet>::updateWeights(double eta)
+{
+  // The constant unit rows and the row padding of the weight deltas are
+  // always zero, so the averages there stay zero and so do the updates.
+  double change = 0.00;
+  TNeuralNet& net = *this->getNetwork();
+  int numLayers = net.getNumLayers();
+  for (int layer = 1; layer < numLayers; ++layer)
+  {
+    Scalar* weight = &net.getLayerWeight(layer)[0];
+    const Scalar* weightDelta = &this->getWeightDelta(layer)[0];
+    Scalar* meanSquare = &m_meanSquare[layer][0];
+    int numWeights = int(m_meanSquare[layer].size());
+
+    assert(static_cast<int>(net.getLayerWeight(layer).size()) == numWeights);
+
+    for (int i = 0; i < numWeights; ++i)
+    {
+      double d = weightDelta[i];
+      meanSquare[i] = m_rho * meanSquare[i] + (1.00 - m_rho) * d * d;
+      double diff = eta * d / (::sqrt(meanSquare[i]) + m_epsilon);
+      weight[i] -= diff;
+      change -= d * diff;
+    }
+  }
+
+  return change;
+}
+
+// the network types we train
+template class RMSPropGradDescentTemplate<TanhNeuralNet>;
+template class RMSPropGradDescentTemplate<LinearNeuralNet>;
+template class RMSPropGradDescentTemplate<FloatTanhNeuralNet>;
+template class RMSPropGradDescentTemplate<FloatLinearNeuralNet>;
+
+} // namespace alch
@@ -0,0 +1,106 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_RMSPropGradDescent_h
+#define INCLUDED_nnet_RMSPropGradDescent_h
+
+#include <vector>
+#include <cassert>
+#include "nnet/NNetDataset.h"
+#include "nnet/NeuralNet.h"
+#include "nnet/MiniBatchGradDescent.h"
+
+namespace alch {
+
+/*!
+  \brief Class that trains a neural network with the RMSProp optimizer.
+
+  Keeps a running average v of each weight's squared delta and moves each
+  weight by
+
+    eta * delta / (sqrt(v) + epsilon)
+
+  so that weights with consistently large deltas take smaller steps. The
+  weights are updated once per mini-batch; use a batch size of at least the
+  dataset size for full-batch updates.
+*/
+template <class TNeuralNet>
+class RMSPropGradDescentTemplate
+  : public MiniBatchGradDescentTemplate<TNeuralNet>
+{
+ public:
+
+  //! Shared pointer to the neural network being trained
+  typedef typename GradDescentTemplate<TNeuralNet>::NetworkPtr NetworkPtr;
+
+  //! Type of the weights and unit values
+  typedef typename GradDescentTemplate<TNeuralNet>::Scalar Scalar;
+
+  //! Type of dataset the network is trained on
+  typedef typename GradDescentTemplate<TNeuralNet>::Dataset Dataset;
+
+  //! The weights of a single layer
+  typedef typename GradDescentTemplate<TNeuralNet>::LayerWeight LayerWeight;
+
+  /*!
+    \brief Constructor
+    \param network The neural network on which we're performing gradient
+    descent.
+    \param eta The learning rate parameter
+    \param batchSize Number of data points per weight update
+    \param seed Seed for the random number generator used for shuffling
+    \param rho Decay rate of the squared delta average
+    \param epsilon Added to the denominator to avoid dividing by zero
+  */
+  RMSPropGradDescentTemplate(NetworkPtr network,
+                             double eta = 0.001,
+                             int batchSize = 32,
+                             long seed = 0,
+                             double rho = 0.9,
+                             double epsilon = 1e-8);
+
+
+  /*!
+    \brief Destructor
+  */
+  ~RMSPropGradDescentTemplate()
+  {
+  }
+
+
+  //! Also writes the squared delta averages; see
+  //! GradDescentTemplate::writeState()
+  virtual void writeState(std::ostream& os) const;
+
+
+  //! Reads state written by writeState()
+  virtual bool readState(std::istream& is);
+
+
+ protected:
+
+  //! Updates all weights using the RMSProp rule
+  virtual double updateWeights(double eta);
+
+
+ private:
+
+  //! Decay rate of the squared delta average
+  double m_rho;
+
+  //! Added to the denominator to avoid dividing by zero
+  double m_epsilon;
+
+  //! Running average of the squared weight deltas. Same layout as
+  //! NeuralNet::getLayerWeight().
+  std::vector<LayerWeight> m_meanSquare;
+};
+
+//! RMSPropGradDescent for the default neural network type
+typedef RMSPropGradDescentTemplate<NeuralNet> RMSPropGradDescent;
+
+//! RMSPropGradDescent for the single precision neural network type
+typedef RMSPropGradDescentTemplate<FloatNeuralNet> FloatRMSPropGradDescent;
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,86 @@
+
+#include "nnet/RunningStatistics.h"
+
+#include <cmath>
+#include <istream>
+#include <ostream>
+
+namespace alch {
+
+  RunningStatistics::RunningStatistics()
+    : m_count(0)
+    , m_sumSquares(0.0)
+    , m_meanValue(0.0)
+    , m_meanTarget(0.0)
+    , m_m2Value(0.0)
+    , m_m2Target(0.0)
+    , m_coMoment(0.0)
+  {
+    ;
+  }
+
+
+  void RunningStatistics::add(double value, double target)
+  {
+    double diff = value - target;
+    m_sumSquares += (diff * diff);
+
+    ++m_count;
+    double deltaValue = value - m_meanValue;
+    double deltaTarget = target - m_meanTarget;
+    m_meanValue += deltaValue / m_count;
+    m_meanTarget += deltaTarget / m_count;
+    m_m2Value += deltaValue * (value - m_meanValue);
+    m_m2Target += deltaTarget * (target - m_meanTarget);
+    m_coMoment += deltaValue * (target - m_meanTarget);
+  }
+
+
+  double RunningStatistics::getSquaredError() const
+  {
+    // NeuralNetAlg::squaredError() halves NeuralNetAlg::sumOfSquares(),
+    // which is itself half the sum
+    return 0.5 * (0.5 * m_sumSquares) / (double) m_count;
+  }
+
+
+  double RunningStatistics::getCorrelation() const
+  {
+    if (m_count <= 0)
+    {
+      return 0.0;
+    }
+
+    return (m_coMoment / (::sqrt(m_m2Value) * ::sqrt(m_m2Target)));
+  }
+
+
+  void RunningStatistics::write(std::ostream& os) const
+  {
+    std::streamsize precision = os.precision(17);
+    os << m_count << ' ' << m_sumSquares
+       << ' ' << m_meanValue << ' ' << m_meanTarget
+       << ' ' << m_m2Value << ' ' << m_m2Target
+       << ' ' << m_coMoment;
+    os.precision(precision);
+  }
+
+
+  bool RunningStatistics::read(std::istream& is)
+  {
+    RunningStatistics stats;
+    is >> stats.m_count >> stats.m_sumSquares
+       >> stats.m_meanValue >> stats.m_meanTarget
+       >> stats.m_m2Value >> stats.m_m2Target
+       >> stats.m_coMoment;
+
+    if (!is || (stats.m_count < 0))
+    {
+      return false;
+    }
+
+    *this = stats;
+    return true;
+  }
+
+} // namespace alch
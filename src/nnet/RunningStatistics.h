@@ -0,0 +1,85 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_RunningStatistics_h
+#define INCLUDED_nnet_RunningStatistics_h
+
+#include <iosfwd>
+
+namespace alch {
+
+/*!
+  \brief Error and correlation of paired values, accumulated one pair at a
+  time
+  \ingroup nnet
+
+  Keeps the sufficient statistics of NeuralNetAlg::squaredError() and
+  Statistics::correlation() so that pairs can be added as they arrive,
+  e.g. one trading day at a time, instead of recomputing over every pair.
+  The means and co-moments are updated with Welford's method, so the
+  correlation doesn't lose precision when the values are large compared
+  to their spread. The squared error adds up the same terms in the same
+  order as NeuralNetAlg::squaredError() and so matches it exactly.
+*/
+class RunningStatistics
+{
+ public:
+
+  //! Creates statistics of no pairs
+  RunningStatistics();
+
+  /*!
+    \brief Adds a pair
+    \param value The value that was produced
+    \param target The target value
+  */
+  void add(double value, double target);
+
+  //! Number of pairs added
+  int size() const
+  {
+    return m_count;
+  }
+
+  //! The error of the pairs as computed by NeuralNetAlg::squaredError()
+  double getSquaredError() const;
+
+  //! Correlation of the values with the targets; 0 if there are no pairs
+  double getCorrelation() const;
+
+  /*!
+    \brief Writes the statistics as text
+    \param os The output stream
+
+    Values are written with enough digits to be read back exactly.
+  */
+  void write(std::ostream& os) const;
+
+  /*!
+    \brief Reads statistics written by write()
+    \param is The input stream
+    \retval true Success
+    \retval false Error; the statistics are unchanged
+  */
+  bool read(std::istream& is);
+
+ private:
+
+  int m_count;
+
+  //! Sum of the squared differences of values and targets
+  double m_sumSquares;
+
+  double m_meanValue;
+  double m_meanTarget;
+
+  //! Sums of squared deviations from the means
+  double m_m2Value;
+  double m_m2Target;
+
+  //! Sum of the products of the deviations of values and targets
+  double m_coMoment;
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,175 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_StateIO_h
+#define INCLUDED_nnet_StateIO_h
+
+#include "boost/cstdint.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace alch {
+
+/*!
+  \brief Namespace for binary input and output of training state
+  \ingroup nnet
+
+  Values are written as their raw bytes in the byte order of the machine,
+  and vectors as their length followed by their elements, so the state of
+  a trainer is written with a few block copies. The state is meant to be
+  read back by the same build on the same machine, e.g. to resume
+  training; it is not a portable file format.
+
+  The read functions return false once the stream fails, so a sequence of
+  reads can be checked once at the end.
+*/
+namespace StateIO
+{
+
+  //! Writes a value of a built-in type
+  template <typename T>
+  void write(std::ostream& os, const T& value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+
+  //! Reads a value written by write()
+  template <typename T>
+  bool read(std::istream& is, T& value)
+  {
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return bool(is);
+  }
+
+
+  //! Writes a vector of values of a built-in type
+  template <typename T, class TAlloc>
+  void write(std::ostream& os, const std::vector<T, TAlloc>& values)
+  {
+    write(os, boost::uint64_t(values.size()));
+    if (!values.empty())
+    {
+      os.write(reinterpret_cast<const char*>(&values[0]),
+               values.size() * sizeof(T));
+    }
+  }
+
+
+  //! Reads a vector written by write(); values is resized to fit
+  template <typename T, class TAlloc>
+  bool read(std::istream& is, std::vector<T, TAlloc>& values)
+  {
+    boost::uint64_t size = 0;
+    if (!read(is, size))
+    {
+      return false;
+    }
+
+    // don't let a corrupt length allocate everything; grow as data arrives
+    const boost::uint64_t chunkSize = 1 << 20;
+    values.clear();
+    while (is && (values.size() < size))
+    {
+      std::size_t first = values.size();
+      std::size_t count = std::size_t(std::min(size - first, chunkSize));
+      values.resize(first + count);
+      is.read(reinterpret_cast<char*>(&values[first]), count * sizeof(T));
+    }
+
+    return bool(is);
+  }
+
+
+  //! Writes a vector of vectors, e.g. weights laid out one per layer
+  template <typename T, class TAlloc, class TOuterAlloc>
+  void write(std::ostream& os,
+             const std::vector<std::vector<T, TAlloc>, TOuterAlloc>& values)
+  {
+    write(os, boost::uint64_t(values.size()));
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      write(os, values[i]);
+    }
+  }
+
+
+  //! Reads a vector of vectors written by write()
+  template <typename T, class TAlloc, class TOuterAlloc>
+  bool read(std::istream& is,
+            std::vector<std::vector<T, TAlloc>, TOuterAlloc>& values)
+  {
+    boost::uint64_t size = 0;
+    if (!read(is, size))
+    {
+      return false;
+    }
+
+    values.clear();
+    while (is && (values.size() < size))
+    {
+      values.resize(values.size() + 1);
+      read(is, values.back());
+    }
+
+    return bool(is);
+  }
+
+
+  //! Writes a string
+  inline void write(std::ostream& os, const std::string& value)
+  {
+    write(os, boost::uint64_t(value.size()));
+    os.write(value.data(), value.size());
+  }
+
+
+  //! Reads a string written by write()
+  inline bool read(std::istream& is, std::string& value)
+  {
+    std::vector<char> buffer;
+    if (!read(is, buffer))
+    {
+      return false;
+    }
+
+    value.assign(buffer.begin(), buffer.end());
+    return true;
+  }
+
+
+  /*!
+    \brief Whether two sets of buffers have the same sizes
+    \param a Buffers, e.g. weights laid out one per layer
+    \param b Buffers to compare with
+
+    Used to check that state read back fits the network it is for.
+  */
+  template <class TBuffer, class TOuterAlloc>
+  bool sameShape(const std::vector<TBuffer, TOuterAlloc>& a,
+                 const std::vector<TBuffer, TOuterAlloc>& b)
+  {
+    if (a.size() != b.size())
+    {
+      return false;
+    }
+
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+      if (a[i].size() != b[i].size())
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+} // namespace StateIO
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,118 @@
+
+#include "TestAdamGradDescent.h"
+
+#include "nnet/NeuralNetAlg.h"
+
+#include <cmath>
+#include <sstream>
+#include <stdlib.h>
+
+namespace alch
+{
+
+void TestAdamGradDescent::setUp() 
+{
+  m_dataset.clear();
+  for (int i = 0; i < 40; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(0.5 * x - 0.3 * y);
+    m_dataset.push_back(point);
+  }
+}
+
+void TestAdamGradDescent::tearDown()
+{
+  ;
+}
+
+void TestAdamGradDescent::test1()
+{
+  const double eta = 0.01;
+  const double delta = 0.000001;
+
+  NeuralNet start(2, 1, 1, 4);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  // with bias correction the first step moves every weight by eta
+  NeuralNetPtr net(new NeuralNet(start));
+  AdamGradDescent grad(net, eta, int(m_dataset.size()));
+  grad.run(m_dataset);
+
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    for (int prevUnit = 0; prevUnit < start.getNumUnits(layer - 1);
+         ++prevUnit)
+    {
+      CPPUNIT_ASSERT_EQUAL(0.00, net->getWeight(layer, prevUnit, 0));
+
+      for (int unit = 1; unit < start.getNumUnits(layer); ++unit)
+      {
+        double change = (net->getWeight(layer, prevUnit, unit)
+                         - start.getWeight(layer, prevUnit, unit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(eta, ::fabs(change), delta);
+      }
+    }
+  }
+}
+
+void TestAdamGradDescent::test2()
+{
+  NeuralNetPtr net(new NeuralNet(2, 1, 1, 5));
+  NeuralNetAlg::randomizeWeights(*net, -0.5, 0.5);
+  double startError = NeuralNetAlg::calculateError(*net, m_dataset);
+
+  AdamGradDescent grad(net, 0.01, 10, 3);
+  for (int step = 0; step < 20; ++step)
+  {
+    grad.run(m_dataset);
+  }
+
+  double endError = NeuralNetAlg::calculateError(*net, m_dataset);
+  CPPUNIT_ASSERT(endError < startError);
+}
+
+void TestAdamGradDescent::test3()
+{
+  NeuralNetPtr net(new NeuralNet(2, 1, 1, 5));
+  NeuralNetAlg::randomizeWeights(*net, -0.5, 0.5);
+  AdamGradDescent grad(net, 0.01, 7, 3);
+  for (int step = 0; step < 5; ++step)
+  {
+    grad.run(m_dataset);
+  }
+
+  // the resumed trainer gets a different seed; its shuffles and moments
+  // must come from the saved state
+  std::stringstream state;
+  grad.writeState(state);
+  NeuralNetPtr resumedNet(new NeuralNet(*net));
+  AdamGradDescent resumed(resumedNet, 0.01, 7, 4);
+  CPPUNIT_ASSERT(resumed.readState(state));
+
+  for (int step = 0; step < 5; ++step)
+  {
+    CPPUNIT_ASSERT_EQUAL(grad.run(m_dataset), resumed.run(m_dataset));
+  }
+
+  for (int layer = 1; layer < net->getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = net->getLayerWeight(layer);
+    for (int i = 0; i < int(weight.size()); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(weight[i], resumedNet->getLayerWeight(layer)[i]);
+    }
+  }
+
+  // truncated state is refused
+  std::stringstream full;
+  grad.writeState(full);
+  std::stringstream truncated(full.str().substr(0, full.str().size() / 2));
+  CPPUNIT_ASSERT(!resumed.readState(truncated));
+}
+
+} // namespace alch
@@ -0,0 +1,49 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestAdamGradDescent_h
+#define INCLUDED_nnet_TestAdamGradDescent_h
+
+#include "nnet/AdamGradDescent.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestAdamGradDescent : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestAdamGradDescent);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests the size of the first update
+  void test1();
+
+  //! Tests that training reduces the error
+  void test2();
+
+  //! Tests that a trainer resumed from saved state continues unchanged
+  void test3();
+
+private:
+  NNetDataset m_dataset;
+
+};
+
+} // namespace alch
+
+#endif
@@ -3,9 +3,19 @@
 #include <cassert>
 
 #include "TestNNetDataset.h"
+#include "TestNNetDataFile.h"
+#include "TestNNetDataReader.h"
 #include "TestNNetDataStream.h"
+#include "TestRunningStatistics.h"
 #include "TestStatistics.h"
 #include "TestNeuralNetAlg.h"
+#include "TestNeuralNet.h"
+#include "TestNeuralNetGroup.h"
+#include "TestNeuralNetKernels.h"
+#include "TestMiniBatchGradDescent.h"
+#include "TestMomentumGradDescent.h"
+#include "TestAdamGradDescent.h"
+#include "TestRMSPropGradDescent.h"
 
 int main(int argc, char** argv)
 {
@@ -15,8 +25,18 @@ int main(int argc, char** argv)
 
   runner.addTest(TestNNetDataset::suite());
   runner.addTest(TestNNetDataStream::suite());
+  runner.addTest(TestNNetDataFile::suite());
+  runner.addTest(TestNNetDataReader::suite());
+  runner.addTest(TestRunningStatistics::suite());
   runner.addTest(TestStatistics::suite());
   runner.addTest(TestNeuralNetAlg::suite());
+  runner.addTest(TestNeuralNet::suite());
+  runner.addTest(TestNeuralNetGroup::suite());
+  runner.addTest(TestNeuralNetKernels::suite());
+  runner.addTest(TestMiniBatchGradDescent::suite());
+  runner.addTest(TestMomentumGradDescent::suite());
+  runner.addTest(TestAdamGradDescent::suite());
+  runner.addTest(TestRMSPropGradDescent::suite());
 
   return !runner.run();
 }
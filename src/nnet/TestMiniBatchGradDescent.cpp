@@ -0,0 +1,137 @@
+
+#include "TestMiniBatchGradDescent.h"
+
+#include "nnet/NeuralNetAlg.h"
+#include "nnet/NNetDataFile.h"
+#include "autil/TempFile.h"
+
+#include <fstream>
+
+#include <stdlib.h>
+
+namespace alch
+{
+
+void TestMiniBatchGradDescent::setUp() 
+{
+  m_dataset.clear();
+  for (int i = 0; i < 50; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(0.5 * x - 0.3 * y);
+    m_dataset.push_back(point);
+  }
+}
+
+void TestMiniBatchGradDescent::tearDown()
+{
+  ;
+}
+
+void TestMiniBatchGradDescent::test1()
+{
+  NeuralNet start(2, 1, 1, 5);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+  double startError = NeuralNetAlg::calculateError(start, m_dataset);
+
+  // train copies of the same network with seeds 7, 7 and 8
+  const int numRuns = 3;
+  const long seed[numRuns] = { 7, 7, 8 };
+  NeuralNetPtr net[numRuns];
+  for (int run = 0; run < numRuns; ++run)
+  {
+    net[run] = NeuralNetPtr(new NeuralNet(start));
+
+    MiniBatchGradDescent grad(net[run], 0.05, 8, seed[run]);
+    CPPUNIT_ASSERT_EQUAL(8, grad.getBatchSize());
+
+    for (int step = 0; step < 20; ++step)
+    {
+      grad.run(m_dataset);
+    }
+  }
+
+  double endError = NeuralNetAlg::calculateError(*net[0], m_dataset);
+  CPPUNIT_ASSERT(endError < startError);
+
+  bool sameAsOtherSeed = true;
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = net[0]->getLayerWeight(layer);
+    for (int i = 0; i < int(weight.size()); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(weight[i], net[1]->getLayerWeight(layer)[i]);
+      sameAsOtherSeed = (sameAsOtherSeed
+                         && (weight[i] == net[2]->getLayerWeight(layer)[i]));
+    }
+  }
+  CPPUNIT_ASSERT(!sameAsOtherSeed);
+}
+
+void TestMiniBatchGradDescent::test2()
+{
+  const double delta = 0.0000000001;
+
+  NeuralNet start(2, 1, 1, 5);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  NeuralNetPtr full(new NeuralNet(start));
+  GradDescent fullGrad(full, 0.05);
+  fullGrad.run(m_dataset);
+
+  // the shuffled order only changes rounding
+  NeuralNetPtr batch(new NeuralNet(start));
+  MiniBatchGradDescent batchGrad(batch, 0.05, int(m_dataset.size()), 1);
+  batchGrad.run(m_dataset);
+
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = full->getLayerWeight(layer);
+    for (int i = 0; i < int(weight.size()); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(weight[i], batch->getLayerWeight(layer)[i],
+                                   delta);
+    }
+  }
+}
+
+void TestMiniBatchGradDescent::test3()
+{
+  Context ctx;
+  TempFile tempFile("TestMiniBatchGradDescent");
+  {
+    std::ofstream ofs(tempFile.getName().c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+    CPPUNIT_ASSERT(NNetDataFile::write(ofs, m_dataset, ctx));
+  }
+
+  NeuralNet start(2, 1, 1, 5);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  NeuralNetPtr whole(new NeuralNet(start));
+  MiniBatchGradDescent wholeGrad(whole, 0.05, 8, 3);
+  double wholeError = wholeGrad.run(m_dataset);
+
+  NeuralNetPtr streamed(new NeuralNet(start));
+  MiniBatchGradDescent streamedGrad(streamed, 0.05, 8, 3);
+  NNetDataReader reader(int(m_dataset.size()));
+  CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+  double streamedError = streamedGrad.run(reader);
+  CPPUNIT_ASSERT(!reader.failed());
+
+  CPPUNIT_ASSERT_EQUAL(wholeError, streamedError);
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = whole->getLayerWeight(layer);
+    for (int i = 0; i < int(weight.size()); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(weight[i], streamed->getLayerWeight(layer)[i]);
+    }
+  }
+}
+
+} // namespace alch
@@ -0,0 +1,49 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestMiniBatchGradDescent_h
+#define INCLUDED_nnet_TestMiniBatchGradDescent_h
+
+#include "nnet/MiniBatchGradDescent.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestMiniBatchGradDescent : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestMiniBatchGradDescent);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests that training reduces error and is repeatable for a seed
+  void test1();
+
+  //! Tests that one batch covering the dataset matches GradDescent
+  void test2();
+
+  //! Tests that streaming one block matches training on the dataset
+  void test3();
+
+private:
+  NNetDataset m_dataset;
+
+};
+
+} // namespace alch
+
+#endif
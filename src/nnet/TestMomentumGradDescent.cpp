@@ -0,0 +1,197 @@
+
+#include "TestMomentumGradDescent.h"
+
+#include "nnet/NeuralNetAlg.h"
+
+#include <sstream>
+#include <stdlib.h>
+
+namespace alch
+{
+
+void TestMomentumGradDescent::setUp() 
+{
+  ;
+}
+
+void TestMomentumGradDescent::tearDown()
+{
+  ;
+}
+
+void TestMomentumGradDescent::test1()
+{
+  const double eta = 0.2;
+  const double alpha = 1.5;
+  const double beta = 0.5;
+
+  NNetDataset dataset;
+  for (int i = 0; i < 30; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(x * y * 4.0);
+    dataset.push_back(point);
+  }
+
+  NeuralNet start(2, 1, 1, 4);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  NeuralNetPtr net(new NeuralNet(start));
+  MomentumGradDescent grad(net, eta, alpha, beta);
+
+  // reference: save a full copy of the network before every step and
+  // check the new weights straight away
+  NeuralNetPtr refNet(new NeuralNet(start));
+  GradDescent refGrad(refNet, eta);
+  double refEta = eta;
+  double refLastError = 99999.9;
+  NeuralNet saved(start);
+
+  int numRejected = 0;
+  for (int step = 0; step < 30; ++step)
+  {
+    // the trainer decides on a step one call later, so after each call it
+    // holds the reference's next step before the reference checks it
+    double error = grad.run(dataset);
+    if (step > 0)
+    {
+      CPPUNIT_ASSERT_EQUAL(NeuralNetAlg::calculateError(*refNet, dataset),
+                           error);
+
+      if (error < refLastError)
+      {
+        refEta *= alpha;
+        refLastError = error;
+      }
+      else
+      {
+        refEta *= beta;
+        *refNet = saved;
+        ++numRejected;
+      }
+    }
+
+    saved = *refNet;
+    refGrad.run(dataset, refEta);
+
+    CPPUNIT_ASSERT_EQUAL(refEta, grad.getEta());
+    for (int layer = 1; layer < start.getNumLayers(); ++layer)
+    {
+      const NeuralNet::LayerWeight& weight = net->getLayerWeight(layer);
+      for (int i = 0; i < int(weight.size()); ++i)
+      {
+        CPPUNIT_ASSERT_EQUAL(refNet->getLayerWeight(layer)[i], weight[i]);
+      }
+    }
+  }
+
+  // make sure both paths were exercised
+  CPPUNIT_ASSERT(numRejected > 0);
+  CPPUNIT_ASSERT(numRejected < 30);
+}
+
+void TestMomentumGradDescent::test2()
+{
+  NNetDataset dataset;
+  for (int i = 0; i < 30; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(x * y * 4.0);
+    dataset.push_back(point);
+  }
+
+  NeuralNetPtr net(new NeuralNet(2, 1, 1, 4));
+  NeuralNetAlg::randomizeWeights(*net, -0.5, 0.5);
+  MomentumGradDescent grad(net, 0.2, 1.5, 0.5);
+  for (int step = 0; step < 10; ++step)
+  {
+    grad.run(dataset);
+  }
+
+  // save in the middle of training, with a step awaiting its check
+  std::stringstream state;
+  grad.writeState(state);
+  NeuralNetPtr resumedNet(new NeuralNet(*net));
+  MomentumGradDescent resumed(resumedNet, 0.01, 1.5, 0.5);
+  CPPUNIT_ASSERT(resumed.readState(state));
+  CPPUNIT_ASSERT_EQUAL(grad.getEta(), resumed.getEta());
+
+  for (int step = 0; step < 10; ++step)
+  {
+    CPPUNIT_ASSERT_EQUAL(grad.run(dataset), resumed.run(dataset));
+  }
+
+  for (int layer = 1; layer < net->getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = net->getLayerWeight(layer);
+    for (int i = 0; i < int(weight.size()); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(weight[i], resumedNet->getLayerWeight(layer)[i]);
+    }
+  }
+
+  // state for a network of another shape is refused
+  std::stringstream other;
+  grad.writeState(other);
+  NeuralNetPtr otherNet(new NeuralNet(2, 1, 1, 5));
+  MomentumGradDescent otherGrad(otherNet);
+  CPPUNIT_ASSERT(!otherGrad.readState(other));
+}
+
+void TestMomentumGradDescent::test3()
+{
+  NNetDataset dataset;
+  for (int i = 0; i < 30; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(x * y * 4.0);
+    dataset.push_back(point);
+  }
+
+  NeuralNet start(2, 1, 1, 4);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  NeuralNetPtr net(new NeuralNet(start));
+  MomentumGradDescent grad(net, 0.2, 1.5, 0.5);
+
+  // settled after every step
+  NeuralNetPtr finishedNet(new NeuralNet(start));
+  MomentumGradDescent finished(finishedNet, 0.2, 1.5, 0.5);
+
+  for (int step = 0; step < 30; ++step)
+  {
+    grad.run(dataset);
+    finished.run(dataset);
+
+    CPPUNIT_ASSERT_EQUAL(grad.getEta(), finished.getEta());
+    for (int layer = 1; layer < start.getNumLayers(); ++layer)
+    {
+      const NeuralNet::LayerWeight& weight = net->getLayerWeight(layer);
+      for (int i = 0; i < int(weight.size()); ++i)
+      {
+        CPPUNIT_ASSERT_EQUAL(weight[i],
+                             finishedNet->getLayerWeight(layer)[i]);
+      }
+    }
+
+    // the network then holds weights no worse than the last accepted ones
+    finished.finish(dataset);
+    finished.finish(dataset);
+    CPPUNIT_ASSERT_EQUAL(NeuralNetAlg::calculateError(*finishedNet, dataset),
+                         finished.getEstimatedError());
+  }
+}
+
+} // namespace alch
@@ -0,0 +1,47 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestMomentumGradDescent_h
+#define INCLUDED_nnet_TestMomentumGradDescent_h
+
+#include "nnet/MomentumGradDescent.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestMomentumGradDescent : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestMomentumGradDescent);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Compares accepted and rejected steps against copying the network
+  void test1();
+
+  //! Tests that a trainer resumed from saved state continues unchanged
+  void test2();
+
+  //! Tests that finish() settles the last step without changing the
+  //! steps that follow
+  void test3();
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,194 @@
+
+#include "TestNNetDataFile.h"
+#include "autil/TempFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <string.h>
+
+namespace alch
+{
+
+namespace
+{
+
+  // three points with two inputs and one output each
+  NNetDataset makeDataset()
+  {
+    NNetDataset dataset;
+    for (int i = 0; i < 3; ++i)
+    {
+      NNetDatapoint point;
+      point.input.push_back(i + 0.25);
+      point.input.push_back(-i - 0.5);
+      point.output.push_back(i * 0.125);
+      dataset.push_back(point);
+    }
+
+    return dataset;
+  }
+
+  template <typename TScalar>
+  bool isEqual(const NNetDatasetTemplate<TScalar>& a,
+               const NNetDatasetTemplate<TScalar>& b)
+  {
+    return ((a.size() == b.size())
+            && (a.getNumInputs() == b.getNumInputs())
+            && (a.getNumOutputs() == b.getNumOutputs())
+            && std::equal(a.getInputs(),
+                          a.getInputs() + a.size() * a.getNumInputs(),
+                          b.getInputs())
+            && std::equal(a.getOutputs(),
+                          a.getOutputs() + a.size() * a.getNumOutputs(),
+                          b.getOutputs()));
+  }
+
+  template <typename TScalar>
+  void writeFile(const std::string& filename,
+                 const NNetDatasetTemplate<TScalar>& dataset,
+                 Context& ctx)
+  {
+    std::ofstream ofs(filename.c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+    CPPUNIT_ASSERT(NNetDataFile::write(ofs, dataset, ctx));
+  }
+
+} // anonymous namespace
+
+void TestNNetDataFile::setUp() 
+{
+  ;
+}
+
+void TestNNetDataFile::tearDown()
+{
+  ;
+}
+
+void TestNNetDataFile::test1()
+{
+  Context ctx;
+  TempFile tempFile("TestNNetDataFile");
+  NNetDataset dataset(makeDataset());
+  writeFile(tempFile.getName(), dataset, ctx);
+
+  CPPUNIT_ASSERT(NNetDataFile::isDataFile(tempFile.getName()));
+
+  NNetDataFile file;
+  CPPUNIT_ASSERT(!file.isOpen());
+  CPPUNIT_ASSERT(file.open(tempFile.getName(), ctx));
+  CPPUNIT_ASSERT(file.isOpen());
+  CPPUNIT_ASSERT_EQUAL(3, file.size());
+  CPPUNIT_ASSERT_EQUAL(2, file.getNumInputs());
+  CPPUNIT_ASSERT_EQUAL(1, file.getNumOutputs());
+  CPPUNIT_ASSERT_EQUAL(NNetDataFile::DATATYPE_double, file.getDataType());
+
+  // the matrices are dense and row-major
+  const double* inputs = file.getInputs<double>();
+  const double* outputs = file.getOutputs<double>();
+  for (int i = 0; i < 3; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(dataset[i].input[0], inputs[2 * i]);
+    CPPUNIT_ASSERT_EQUAL(dataset[i].input[1], inputs[2 * i + 1]);
+    CPPUNIT_ASSERT_EQUAL(dataset[i].output[0], outputs[i]);
+  }
+
+  NNetDataset copy;
+  copy.push_back(NNetDatapoint());
+  file.copyTo(copy);
+  CPPUNIT_ASSERT(isEqual(dataset, copy));
+
+  file.close();
+  CPPUNIT_ASSERT(!file.isOpen());
+  CPPUNIT_ASSERT_EQUAL(0, file.size());
+}
+
+void TestNNetDataFile::test2()
+{
+  // single precision files convert to double and back exactly
+  Context ctx;
+  TempFile tempFile("TestNNetDataFile");
+  NNetDataset dataset(makeDataset());
+  FloatNNetDataset floatDataset(dataset);
+  writeFile(tempFile.getName(), floatDataset, ctx);
+
+  NNetDataFile file;
+  CPPUNIT_ASSERT(file.open(tempFile.getName(), ctx));
+  CPPUNIT_ASSERT_EQUAL(NNetDataFile::DATATYPE_float, file.getDataType());
+  CPPUNIT_ASSERT_EQUAL(3, file.size());
+  CPPUNIT_ASSERT_EQUAL(float(-1.5), file.getInputs<float>()[3]);
+
+  NNetDataset copy;
+  file.copyTo(copy);
+  FloatNNetDataset floatCopy;
+  file.copyTo(floatCopy);
+  CPPUNIT_ASSERT(isEqual(dataset, copy));
+  CPPUNIT_ASSERT(isEqual(floatDataset, floatCopy));
+}
+
+void TestNNetDataFile::test3()
+{
+  Context ctx;
+  ctx.setPriorityFilter(Context::PRIORITY_none);
+  NNetDataFile file;
+
+  // text datasets aren't binary dataset files
+  {
+    TempFile tempFile("TestNNetDataFile");
+    std::ofstream ofs(tempFile.getName().c_str());
+    ofs << "0.01 0.02 0.03 | 0.04 0.05 0.06\n";
+    ofs.close();
+
+    CPPUNIT_ASSERT(!NNetDataFile::isDataFile(tempFile.getName()));
+    CPPUNIT_ASSERT(!file.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT(!file.isOpen());
+  }
+
+  // truncated file
+  {
+    TempFile tempFile("TestNNetDataFile");
+    std::ostringstream oss;
+    CPPUNIT_ASSERT(NNetDataFile::write(oss, makeDataset(), ctx));
+    std::string data(oss.str());
+
+    std::ofstream ofs(tempFile.getName().c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+    ofs.write(data.data(), data.length() - sizeof(double));
+    ofs.close();
+
+    CPPUNIT_ASSERT(NNetDataFile::isDataFile(tempFile.getName()));
+    CPPUNIT_ASSERT(!file.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT(!file.isOpen());
+  }
+
+  // a header whose sizes multiply out to the file size only because the
+  // product overflows
+  {
+    TempFile tempFile("TestNNetDataFile");
+    std::ostringstream oss;
+    CPPUNIT_ASSERT(NNetDataFile::write(oss, makeDataset(), ctx));
+    std::string data(oss.str().substr(0, 32));
+
+    boost::uint32_t numInputs = 0x7fffffff;
+    boost::uint32_t numOutputs = 1;
+    boost::uint64_t numPoints = boost::uint64_t(1) << 30;
+    memcpy(&data[12], &numInputs, sizeof(numInputs));
+    memcpy(&data[16], &numOutputs, sizeof(numOutputs));
+    memcpy(&data[24], &numPoints, sizeof(numPoints));
+
+    std::ofstream ofs(tempFile.getName().c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+    ofs.write(data.data(), data.length());
+    ofs.close();
+
+    CPPUNIT_ASSERT(NNetDataFile::isDataFile(tempFile.getName()));
+    CPPUNIT_ASSERT(!file.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT(!file.isOpen());
+  }
+
+  CPPUNIT_ASSERT(!NNetDataFile::isDataFile("/nonexistent/dataset"));
+  CPPUNIT_ASSERT(!file.open("/nonexistent/dataset", ctx));
+}
+
+} // namespace alch
@@ -0,0 +1,45 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestNNetDataFile_h
+#define INCLUDED_nnet_TestNNetDataFile_h
+
+#include "nnet/NNetDataFile.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestNNetDataFile : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestNNetDataFile);
+
+  CPPUNIT_TEST(test1);
+
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST(test3);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  void test1();
+
+  void test2();
+
+  void test3();
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,237 @@
+
+#include "TestNNetDataReader.h"
+#include "autil/TempFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+namespace alch
+{
+
+namespace
+{
+
+  // point i has inputs i and -i and output 0.5 * i
+  NNetDataset makeDataset(int numPoints)
+  {
+    NNetDataset dataset(numPoints, 2, 1);
+    for (int i = 0; i < numPoints; ++i)
+    {
+      dataset[i].input[0] = i;
+      dataset[i].input[1] = -i;
+      dataset[i].output[0] = 0.5 * i;
+    }
+
+    return dataset;
+  }
+
+  template <typename TScalar>
+  void writeFile(const std::string& filename,
+                 const NNetDatasetTemplate<TScalar>& dataset,
+                 Context& ctx)
+  {
+    std::ofstream ofs(filename.c_str(),
+                      std::ios::out | std::ios::trunc | std::ios::binary);
+    CPPUNIT_ASSERT(NNetDataFile::write(ofs, dataset, ctx));
+  }
+
+  // reads one pass, checking each point is intact; returns the points in
+  // the order read
+  template <typename TScalar>
+  std::vector<int> readPass(NNetDataReaderTemplate<TScalar>& reader)
+  {
+    std::vector<int> order;
+    typedef typename NNetDataReaderTemplate<TScalar>::Dataset Dataset;
+    for (const Dataset* block = reader.next(); block; block = reader.next())
+    {
+      CPPUNIT_ASSERT(int(block->size()) <= reader.getBlockSize());
+      for (int i = 0; i < int(block->size()); ++i)
+      {
+        TScalar value = (*block)[i].input[0];
+        CPPUNIT_ASSERT_EQUAL(-value, (*block)[i].input[1]);
+        CPPUNIT_ASSERT_EQUAL(TScalar(0.5) * value, (*block)[i].output[0]);
+        order.push_back(int(value));
+      }
+    }
+
+    return order;
+  }
+
+} // anonymous namespace
+
+void TestNNetDataReader::setUp()
+{
+  ;
+}
+
+void TestNNetDataReader::tearDown()
+{
+  ;
+}
+
+void TestNNetDataReader::test1()
+{
+  Context ctx;
+  TempFile tempFile("TestNNetDataReader");
+  writeFile(tempFile.getName(), makeDataset(10), ctx);
+
+  NNetDataReader reader(4);
+  CPPUNIT_ASSERT(!reader.isOpen());
+  CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+  CPPUNIT_ASSERT(reader.isOpen());
+  CPPUNIT_ASSERT_EQUAL(10, reader.size());
+  CPPUNIT_ASSERT_EQUAL(2, reader.getNumInputs());
+  CPPUNIT_ASSERT_EQUAL(1, reader.getNumOutputs());
+  CPPUNIT_ASSERT_EQUAL(3, reader.getNumBlocks());
+
+  // blocks of 4, 4 and 2 points in file order
+  const NNetDataset* block = reader.next();
+  CPPUNIT_ASSERT(block);
+  CPPUNIT_ASSERT_EQUAL(4, int(block->size()));
+  CPPUNIT_ASSERT_EQUAL(0.0, (*block)[0].input[0]);
+  block = reader.next();
+  CPPUNIT_ASSERT(block);
+  CPPUNIT_ASSERT_EQUAL(4.0, (*block)[0].input[0]);
+  block = reader.next();
+  CPPUNIT_ASSERT(block);
+  CPPUNIT_ASSERT_EQUAL(2, int(block->size()));
+  CPPUNIT_ASSERT_EQUAL(9.0, (*block)[1].input[0]);
+  CPPUNIT_ASSERT_EQUAL(-9.0, (*block)[1].input[1]);
+  CPPUNIT_ASSERT_EQUAL(4.5, (*block)[1].output[0]);
+  CPPUNIT_ASSERT(!reader.next());
+
+  // the next pass starts over
+  std::vector<int> order(readPass(reader));
+  CPPUNIT_ASSERT_EQUAL(10, int(order.size()));
+  for (int i = 0; i < 10; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(i, order[i]);
+  }
+
+  // rewinding abandons the rest of a pass
+  CPPUNIT_ASSERT(reader.next());
+  reader.rewind();
+  CPPUNIT_ASSERT_EQUAL(10, int(readPass(reader).size()));
+  CPPUNIT_ASSERT(!reader.failed());
+
+  reader.close();
+  CPPUNIT_ASSERT(!reader.isOpen());
+  CPPUNIT_ASSERT(!reader.next());
+}
+
+void TestNNetDataReader::test2()
+{
+  Context ctx;
+  TempFile tempFile("TestNNetDataReader");
+  writeFile(tempFile.getName(), makeDataset(50), ctx);
+
+  const long seed[3] = { 7, 7, 8 };
+  std::vector<int> pass[3][2];
+  for (int run = 0; run < 3; ++run)
+  {
+    NNetDataReader reader(8, seed[run]);
+    reader.setShuffle(true);
+    CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT(reader.getShuffle());
+
+    for (int i = 0; i < 2; ++i)
+    {
+      pass[run][i] = readPass(reader);
+
+      std::vector<int> sorted(pass[run][i]);
+      std::sort(sorted.begin(), sorted.end());
+      CPPUNIT_ASSERT_EQUAL(50, int(sorted.size()));
+      for (int j = 0; j < 50; ++j)
+      {
+        CPPUNIT_ASSERT_EQUAL(j, sorted[j]);
+      }
+    }
+  }
+
+  // each pass is shuffled anew; the same seed gives the same passes
+  CPPUNIT_ASSERT(pass[0][0] != pass[0][1]);
+  CPPUNIT_ASSERT(pass[0][0] == pass[1][0]);
+  CPPUNIT_ASSERT(pass[0][1] == pass[1][1]);
+  CPPUNIT_ASSERT(pass[0][0] != pass[2][0]);
+}
+
+void TestNNetDataReader::test3()
+{
+  Context ctx;
+
+  // double files are read as floats and float files as doubles
+  {
+    TempFile tempFile("TestNNetDataReader");
+    writeFile(tempFile.getName(), makeDataset(5), ctx);
+
+    FloatNNetDataReader reader(2);
+    CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT_EQUAL(5, int(readPass(reader).size()));
+  }
+
+  {
+    TempFile tempFile("TestNNetDataReader");
+    writeFile(tempFile.getName(), FloatNNetDataset(makeDataset(5)), ctx);
+
+    NNetDataReader reader(2);
+    CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT_EQUAL(5, int(readPass(reader).size()));
+  }
+
+  ctx.setPriorityFilter(Context::PRIORITY_none);
+  NNetDataReader reader;
+
+  // text datasets can't be streamed
+  {
+    TempFile tempFile("TestNNetDataReader");
+    std::ofstream ofs(tempFile.getName().c_str());
+    ofs << "0.01 0.02 0.03 | 0.04 0.05 0.06\n";
+    ofs.close();
+
+    CPPUNIT_ASSERT(!reader.open(tempFile.getName(), ctx));
+    CPPUNIT_ASSERT(!reader.isOpen());
+    CPPUNIT_ASSERT(!reader.next());
+  }
+
+  CPPUNIT_ASSERT(!reader.open("/nonexistent/dataset", ctx));
+}
+
+void TestNNetDataReader::test4()
+{
+  Context ctx;
+  TempFile tempFile("TestNNetDataReader");
+  writeFile(tempFile.getName(), makeDataset(50), ctx);
+
+  NNetDataReader reader(8, 7);
+  reader.setShuffle(true);
+  CPPUNIT_ASSERT(reader.open(tempFile.getName(), ctx));
+  readPass(reader);
+
+  // saved between passes, the state gives the passes that follow
+  std::stringstream state;
+  reader.writeState(state);
+  std::vector<int> pass1(readPass(reader));
+  std::vector<int> pass2(readPass(reader));
+
+  NNetDataReader resumed(8, 8);
+  resumed.setShuffle(true);
+  CPPUNIT_ASSERT(resumed.open(tempFile.getName(), ctx));
+  CPPUNIT_ASSERT(resumed.readState(state));
+  CPPUNIT_ASSERT(pass1 == readPass(resumed));
+  CPPUNIT_ASSERT(pass2 == readPass(resumed));
+
+  // saved in the middle of a pass, the pass starts over
+  std::stringstream midState;
+  CPPUNIT_ASSERT(reader.next());
+  reader.writeState(midState);
+  std::vector<int> pass3(readPass(reader));
+  CPPUNIT_ASSERT(resumed.readState(midState));
+  std::vector<int> resumedPass3(readPass(resumed));
+  CPPUNIT_ASSERT_EQUAL(50, int(resumedPass3.size()));
+  CPPUNIT_ASSERT(std::equal(pass3.begin(), pass3.end(),
+                            resumedPass3.end() - pass3.size()));
+}
+
+} // namespace alch
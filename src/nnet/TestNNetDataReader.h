@@ -0,0 +1,52 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestNNetDataReader_h
+#define INCLUDED_nnet_TestNNetDataReader_h
+
+#include "nnet/NNetDataReader.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestNNetDataReader : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestNNetDataReader);
+
+  CPPUNIT_TEST(test1);
+
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST(test3);
+  CPPUNIT_TEST(test4);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests reading in order, including a partial last block
+  void test1();
+
+  //! Tests that shuffled passes cover every point once and repeat by seed
+  void test2();
+
+  //! Tests conversion and invalid files
+  void test3();
+
+  //! Tests resuming a shuffled pass from saved state
+  void test4();
+
+};
+
+} // namespace alch
+
+#endif
@@ -39,5 +39,129 @@ void TestNNetDataset::test1()
   CPPUNIT_ASSERT_EQUAL(dp.input.size(), ds[1].input.size());
 }
 
+void TestNNetDataset::test2()
+{
+  // the points are held in two dense row-major matrices
+  NNetDataset ds;
+  for (int i = 0; i < 4; ++i)
+  {
+    NNetDatapoint dp;
+    dp.input.push_back(10 * i);
+    dp.input.push_back(10 * i + 1);
+    dp.input.push_back(10 * i + 2);
+    dp.output.push_back(-i);
+    ds.push_back(dp);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(4, int(ds.size()));
+  CPPUNIT_ASSERT_EQUAL(3, ds.getNumInputs());
+  CPPUNIT_ASSERT_EQUAL(1, ds.getNumOutputs());
+  for (int i = 0; i < 12; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(double(10 * (i / 3) + i % 3), ds.getInputs()[i]);
+  }
+  CPPUNIT_ASSERT_EQUAL(-2.0, ds.getOutputs()[2]);
+  CPPUNIT_ASSERT(ds.getInput(2) == ds.getInputs() + 6);
+  CPPUNIT_ASSERT(ds.getOutput(3) == ds.getOutputs() + 3);
+
+  // points are views into the matrices
+  ds[1].input[2] = 5.0;
+  CPPUNIT_ASSERT_EQUAL(5.0, ds.getInputs()[5]);
+  ds[1].output.assign(ds[3].output.begin(), ds[3].output.end());
+  CPPUNIT_ASSERT_EQUAL(-3.0, ds[1].output[0]);
+
+  NNetDatapoint copy(ds[2]);
+  CPPUNIT_ASSERT_EQUAL(3, int(copy.input.size()));
+  CPPUNIT_ASSERT_EQUAL(21.0, copy.input[1]);
+  CPPUNIT_ASSERT_EQUAL(-2.0, copy.output[0]);
+
+  ds.swapPoints(0, 2);
+  CPPUNIT_ASSERT_EQUAL(20.0, ds[0].input[0]);
+  CPPUNIT_ASSERT_EQUAL(-2.0, ds[0].output[0]);
+  CPPUNIT_ASSERT_EQUAL(0.0, ds[2].input[0]);
+  CPPUNIT_ASSERT_EQUAL(0.0, ds[2].output[0]);
+
+  ds.erase(0, 2);
+  CPPUNIT_ASSERT_EQUAL(2, int(ds.size()));
+  CPPUNIT_ASSERT_EQUAL(2.0, ds[0].input[2]);
+  CPPUNIT_ASSERT_EQUAL(30.0, ds[1].input[0]);
+
+  NNetDataset other;
+  other.append(ds);
+  other.append(ds);
+  other.push_back(ds[1]);
+  CPPUNIT_ASSERT_EQUAL(5, int(other.size()));
+  CPPUNIT_ASSERT_EQUAL(30.0, other[4].input[0]);
+  CPPUNIT_ASSERT_EQUAL(2.0, other[2].input[2]);
+
+  FloatNNetDataset floatDs(other);
+  CPPUNIT_ASSERT_EQUAL(5, int(floatDs.size()));
+  CPPUNIT_ASSERT_EQUAL(3, floatDs.getNumInputs());
+  CPPUNIT_ASSERT_EQUAL(31.0f, floatDs[4].input[1]);
+
+  other.clear();
+  CPPUNIT_ASSERT(other.empty());
+}
+
+void TestNNetDataset::test3()
+{
+  // changing the shape keeps the leading values of every point
+  NNetDataset ds(3, 2, 0);
+  CPPUNIT_ASSERT_EQUAL(3, int(ds.size()));
+  CPPUNIT_ASSERT_EQUAL(0, int(ds[2].output.size()));
+  for (int i = 0; i < 3; ++i)
+  {
+    ds[i].input[0] = i;
+    ds[i].input[1] = i + 0.5;
+  }
+
+  ds.setNumOutputs(1);
+  ds.setNumInputs(3);
+  CPPUNIT_ASSERT_EQUAL(3, ds.getNumInputs());
+  CPPUNIT_ASSERT_EQUAL(1, ds.getNumOutputs());
+  for (int i = 0; i < 3; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(double(i), ds[i].input[0]);
+    CPPUNIT_ASSERT_EQUAL(i + 0.5, ds[i].input[1]);
+    CPPUNIT_ASSERT_EQUAL(0.0, ds[i].input[2]);
+    CPPUNIT_ASSERT_EQUAL(0.0, ds[i].output[0]);
+  }
+
+  ds.setNumInputs(1);
+  CPPUNIT_ASSERT_EQUAL(2.0, ds.getInputs()[2]);
+
+  ds.resize(5);
+  CPPUNIT_ASSERT_EQUAL(5, int(ds.size()));
+  CPPUNIT_ASSERT_EQUAL(0.0, ds[4].input[0]);
+  CPPUNIT_ASSERT_EQUAL(1, int(ds[4].output.size()));
+}
+
+void TestNNetDataset::test4()
+{
+  // adding points of the dataset to itself, with the matrices full so
+  // that they have to grow while the points are read
+  NNetDataset ds(3, 2, 1);
+  for (int i = 0; i < 3; ++i)
+  {
+    ds[i].input[0] = i;
+    ds[i].input[1] = i + 0.25;
+    ds[i].output[0] = -i;
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    ds.push_back(ds[i]);
+  }
+
+  ds.append(ds);
+  CPPUNIT_ASSERT_EQUAL(12, int(ds.size()));
+  for (int i = 0; i < 12; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(double(i % 3), ds[i].input[0]);
+    CPPUNIT_ASSERT_EQUAL(i % 3 + 0.25, ds[i].input[1]);
+    CPPUNIT_ASSERT_EQUAL(-double(i % 3), ds[i].output[0]);
+  }
+}
+
 } // namespace alch
 
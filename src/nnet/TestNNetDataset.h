@@ -20,6 +20,12 @@ class TestNNetDataset : public CppUnit::TestFixture
 
   CPPUNIT_TEST(test1);
 
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST(test3);
+
+  CPPUNIT_TEST(test4);
+
   CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -30,6 +36,12 @@ class TestNNetDataset : public CppUnit::TestFixture
 
   void test1();
 
+  void test2();
+
+  void test3();
+
+  void test4();
+
 
 }; // class TestNNetDataset
 
@@ -0,0 +1,447 @@
+
+#include "TestNeuralNet.h"
+
+#include "nnet/GradDescent.h"
+#include "nnet/NeuralNetAlg.h"
+
+#include <cmath>
+
+namespace alch
+{
+
+namespace
+{
+  // trains a network with small steps and compares the errors reported by
+  // the trainer with the actual ones
+  template <class TNeuralNet>
+  void checkReportedError()
+  {
+    const double delta = 0.0000000001;
+
+    NNetDataset dataset;
+    for (int i = 0; i < 25; ++i)
+    {
+      NNetDatapoint point;
+      double x = drand48() - 0.5;
+      double y = drand48() - 0.5;
+      point.input.push_back(x);
+      point.input.push_back(y);
+      point.output.push_back(x * y * 4.0);
+      point.output.push_back(x - y);
+      dataset.push_back(point);
+    }
+
+    // same layout for every network type
+    NeuralNet start(2, 2, 1, 4);
+    NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+    boost::shared_ptr<TNeuralNet> net(new TNeuralNet(2, 2, 1, 4));
+    for (int layer = 1; layer < start.getNumLayers(); ++layer)
+    {
+      net->getLayerWeight(layer) = start.getLayerWeight(layer);
+    }
+
+    GradDescentTemplate<TNeuralNet> grad(net, 0.0001);
+    grad.setNumThreads(3);
+
+    typename TNeuralNet::Workspace workspace;
+    for (int step = 0; step < 5; ++step)
+    {
+      // the error is that of the weights before the update
+      double before = NeuralNetAlg::calculateError(*net, dataset, workspace);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(before, grad.run(dataset), delta);
+
+      // a small step lowers the error by about as much as estimated, as
+      // long as the weight deltas are the true gradient
+      double after = NeuralNetAlg::calculateError(*net, dataset, workspace);
+      CPPUNIT_ASSERT(after < before);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(before - after,
+                                   before - grad.getEstimatedError(),
+                                   0.01 * (before - after));
+    }
+  }
+} // anonymous namespace
+
+void TestNeuralNet::setUp() 
+{
+  ;
+}
+
+void TestNeuralNet::tearDown()
+{
+  m_ctx.dump(std::cerr);
+}
+
+void TestNeuralNet::test1()
+{
+  const double delta = 0.000001;
+
+  // 2 inputs, 1 output, 1 hidden layer of 3 units
+  NeuralNet net(2, 1, 1, 3);
+  CPPUNIT_ASSERT_EQUAL(3, net.getNumLayers());
+  CPPUNIT_ASSERT_EQUAL(3, net.getNumUnits(0));
+  CPPUNIT_ASSERT_EQUAL(4, net.getNumUnits(1));
+  CPPUNIT_ASSERT_EQUAL(2, net.getNumUnits(2));
+
+  // every layer but the output layer is padded to whole SIMD registers
+  for (int layer = 0; layer < net.getNumLayers() - 1; ++layer)
+  {
+    CPPUNIT_ASSERT(net.getStride(layer) >= net.getNumUnits(layer));
+    CPPUNIT_ASSERT_EQUAL(0, int(net.getStride(layer) * sizeof(double))
+                         % c_nnetAlignment);
+  }
+  CPPUNIT_ASSERT_EQUAL(net.getNumUnits(2), net.getStride(2));
+
+  // weight blocks are aligned and sized as rows of the previous stride
+  for (int layer = 1; layer < net.getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& weight = net.getLayerWeight(layer);
+    CPPUNIT_ASSERT_EQUAL(net.getNumUnits(layer) * net.getStride(layer - 1),
+                         int(weight.size()));
+    CPPUNIT_ASSERT_EQUAL(0, int(reinterpret_cast<size_t>(&weight[0])
+                                % c_nnetAlignment));
+  }
+
+  // give every weight a distinct value and read them back
+  for (int layer = 1; layer < net.getNumLayers(); ++layer)
+  {
+    for (int prevUnit = 0; prevUnit < net.getNumUnits(layer - 1); ++prevUnit)
+    {
+      for (int unit = 1; unit < net.getNumUnits(layer); ++unit)
+      {
+        net.setWeight(layer, prevUnit, unit,
+                      0.1 * layer - 0.05 * prevUnit + 0.02 * unit);
+      }
+    }
+  }
+
+  for (int layer = 1; layer < net.getNumLayers(); ++layer)
+  {
+    for (int prevUnit = 0; prevUnit < net.getNumUnits(layer - 1); ++prevUnit)
+    {
+      for (int unit = 1; unit < net.getNumUnits(layer); ++unit)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+          0.1 * layer - 0.05 * prevUnit + 0.02 * unit,
+          net.getWeight(layer, prevUnit, unit),
+          delta);
+      }
+    }
+  }
+
+  std::vector<double> input;
+  input.push_back(0.5);
+  input.push_back(-0.25);
+  NeuralNet::Workspace workspace;
+  net.propagateInput(input, workspace);
+
+  // compute the expected output by hand
+  double layer0[] = { 1.00, 0.5, -0.25 };
+  double layer1[] = { 1.00, 0.00, 0.00, 0.00 };
+  for (int unit = 1; unit < 4; ++unit)
+  {
+    double sum = 0.00;
+    for (int prevUnit = 0; prevUnit < 3; ++prevUnit)
+    {
+      sum += (0.1 - 0.05 * prevUnit + 0.02 * unit) * layer0[prevUnit];
+    }
+    layer1[unit] = ::tanh(sum);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(layer1[unit], workspace.getUnitOutput(1, unit),
+                                 delta);
+  }
+
+  double sum = 0.00;
+  for (int prevUnit = 0; prevUnit < 4; ++prevUnit)
+  {
+    sum += (0.2 - 0.05 * prevUnit + 0.02) * layer1[prevUnit];
+  }
+
+  CPPUNIT_ASSERT_EQUAL(2, int(workspace.getOutput().size()));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(::tanh(sum), workspace.getOutput()[1], delta);
+}
+
+void TestNeuralNet::test2()
+{
+  NeuralNetPtr net(new NeuralNet(2, 1, 1, 5));
+  NeuralNetAlg::randomizeWeights(*net, -0.5, 0.5);
+
+  NNetDataset dataset;
+  for (int i = 0; i < 20; ++i)
+  {
+    NNetDatapoint point;
+    double x = (i % 5) * 0.2 - 0.4;
+    double y = (i / 5) * 0.2 - 0.3;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(0.5 * x - 0.3 * y);
+    dataset.push_back(point);
+  }
+
+  double startError = NeuralNetAlg::calculateError(*net, dataset);
+
+  GradDescent grad(net, 0.05);
+  for (int step = 0; step < 50; ++step)
+  {
+    grad.run(dataset);
+  }
+
+  double endError = NeuralNetAlg::calculateError(*net, dataset);
+  CPPUNIT_ASSERT(endError < startError);
+}
+
+void TestNeuralNet::test3()
+{
+  const int numRows = 9;
+  const int numInputs = 6;
+
+  NeuralNet net(numInputs, 3, 2, 7);
+  NeuralNetAlg::randomizeWeights(net, -0.5, 0.5);
+
+  // leave a gap after each row to check that inputStride is honored
+  const int inputStride = numInputs + 2;
+  std::vector<double> input(numRows * inputStride, 99.0);
+  for (int row = 0; row < numRows; ++row)
+  {
+    for (int i = 0; i < numInputs; ++i)
+    {
+      input[row * inputStride + i] = drand48() * 2.0 - 1.0;
+    }
+  }
+
+  // run twice so that the second batch reuses the buffers
+  NeuralNet::Workspace batchWorkspace;
+  NeuralNet::Workspace workspace;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    int passRows = numRows - pass * 4;
+    net.propagateBatch(&input[0], passRows, inputStride, batchWorkspace);
+
+    for (int row = 0; row < passRows; ++row)
+    {
+      std::vector<double> single(input.begin() + row * inputStride,
+                                 input.begin() + row * inputStride
+                                 + numInputs);
+      net.propagateInput(single, workspace);
+
+      const double* batch = batchWorkspace.getBatchOutput(row);
+      for (int unit = 0; unit < net.getNumOutputUnits(); ++unit)
+      {
+        CPPUNIT_ASSERT_EQUAL(workspace.getOutput()[unit], batch[unit]);
+      }
+    }
+  }
+
+  // calculateOutputs() fills in the outputs of every datapoint
+  NNetDataset dataset;
+  for (int row = 0; row < numRows; ++row)
+  {
+    NNetDatapoint point;
+    point.input.assign(input.begin() + row * inputStride,
+                       input.begin() + row * inputStride + numInputs);
+    point.output.push_back(1.0);
+    dataset.push_back(point);
+  }
+
+  NeuralNetAlg::calculateOutputs(net, dataset);
+  for (int row = 0; row < numRows; ++row)
+  {
+    net.propagateInput(dataset.getInput(row), workspace);
+    CPPUNIT_ASSERT_EQUAL(net.getNumOutputUnits() - 1,
+                         int(dataset[row].output.size()));
+    for (int unit = 1; unit < net.getNumOutputUnits(); ++unit)
+    {
+      CPPUNIT_ASSERT_EQUAL(workspace.getOutput()[unit],
+                           dataset[row].output[unit - 1]);
+    }
+  }
+}
+
+void TestNeuralNet::test4()
+{
+  const double delta = 0.0000000001;
+
+  NeuralNet start(3, 2, 1, 6);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  NNetDataset dataset;
+  for (int i = 0; i < 37; ++i)
+  {
+    NNetDatapoint point;
+    for (int j = 0; j < 3; ++j)
+    {
+      point.input.push_back(drand48() - 0.5);
+    }
+    point.output.push_back(point.input[0] * point.input[1]);
+    point.output.push_back(0.5 * point.input[2]);
+    dataset.push_back(point);
+  }
+
+  // train copies of the same network with 1, 3, 3 and 8 threads
+  const int numRuns = 4;
+  const int numThreads[numRuns] = { 1, 3, 3, 8 };
+  NeuralNetPtr net[numRuns];
+  for (int run = 0; run < numRuns; ++run)
+  {
+    net[run] = NeuralNetPtr(new NeuralNet(start));
+
+    GradDescent grad(net[run], 0.05);
+    grad.setNumThreads(numThreads[run]);
+    CPPUNIT_ASSERT_EQUAL(numThreads[run], grad.getNumThreads());
+
+    for (int step = 0; step < 10; ++step)
+    {
+      grad.run(dataset);
+    }
+  }
+
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    const NeuralNet::LayerWeight& serial = net[0]->getLayerWeight(layer);
+    for (int i = 0; i < int(serial.size()); ++i)
+    {
+      // the same thread count always gives the same answer
+      CPPUNIT_ASSERT_EQUAL(net[1]->getLayerWeight(layer)[i],
+                           net[2]->getLayerWeight(layer)[i]);
+
+      // other thread counts only differ by rounding
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(serial[i], net[1]->getLayerWeight(layer)[i],
+                                   delta);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(serial[i], net[3]->getLayerWeight(layer)[i],
+                                   delta);
+    }
+  }
+}
+
+void TestNeuralNet::test5()
+{
+  NeuralNet net(2, 1, 1, 3);
+  NeuralNetAlg::randomizeWeights(net, -0.5, 0.5);
+  const NeuralNet& shared = net;
+
+  std::vector<double> input1(2, 0.25);
+  std::vector<double> input2(2, -0.75);
+
+  // two workspaces on the same network keep their own values
+  NeuralNet::Workspace workspace1(shared);
+  NeuralNet::Workspace workspace2;
+  shared.propagateInput(input1, workspace1);
+  double output1 = workspace1.getOutput()[1];
+  shared.propagateInput(input2, workspace2);
+
+  CPPUNIT_ASSERT_EQUAL(output1, workspace1.getOutput()[1]);
+  CPPUNIT_ASSERT(workspace2.getOutput()[1] != output1);
+
+  // a workspace resizes itself when used with a network of another shape
+  NeuralNet larger(2, 3, 2, 5);
+  NeuralNetAlg::randomizeWeights(larger, -0.5, 0.5);
+  larger.propagateInput(input1, workspace1);
+  CPPUNIT_ASSERT_EQUAL(larger.getNumOutputUnits(),
+                       int(workspace1.getOutput().size()));
+
+  shared.propagateInput(input1, workspace1);
+  CPPUNIT_ASSERT_EQUAL(output1, workspace1.getOutput()[1]);
+}
+
+void TestNeuralNet::test6()
+{
+  checkReportedError<TanhNeuralNet>();
+  checkReportedError<LinearNeuralNet>();
+}
+
+void TestNeuralNet::test7()
+{
+  NNetDataset dataset;
+  for (int i = 0; i < 40; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(x * y * 4.0);
+    dataset.push_back(point);
+  }
+  FloatNNetDataset floatDataset(dataset);
+  CPPUNIT_ASSERT_EQUAL(dataset.size(), floatDataset.size());
+
+  NeuralNet net(2, 1, 1, 9);
+  NeuralNetAlg::randomizeWeights(net, -0.5, 0.5);
+
+  // a float copy propagates to within float rounding of the original
+  FloatNeuralNetPtr floatNet(new FloatNeuralNet(net));
+  CPPUNIT_ASSERT_EQUAL(net.getNumLayers(), floatNet->getNumLayers());
+  CPPUNIT_ASSERT_EQUAL(float(net.getWeight(1, 2, 3)),
+                       floatNet->getWeight(1, 2, 3));
+
+  NeuralNet::Workspace workspace;
+  FloatNeuralNet::Workspace floatWorkspace;
+  for (int i = 0; i < int(dataset.size()); ++i)
+  {
+    net.propagateInput(dataset.getInput(i), workspace);
+    floatNet->propagateInput(floatDataset.getInput(i), floatWorkspace);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(workspace.getOutput()[1],
+                                 floatWorkspace.getOutput()[1], 1e-5);
+  }
+
+  double error = NeuralNetAlg::calculateError(net, dataset);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(
+    error, NeuralNetAlg::calculateError(*floatNet, floatDataset), 1e-5);
+
+  // training in float lowers the error of the double network as well
+  FloatGradDescent grad(floatNet, 0.05);
+  for (int i = 0; i < 200; ++i)
+  {
+    grad.run(floatDataset);
+  }
+
+  NeuralNet trained(*floatNet);
+  CPPUNIT_ASSERT(NeuralNetAlg::calculateError(trained, dataset) < error);
+}
+
+void TestNeuralNet::test8()
+{
+  NNetDataset dataset;
+  for (int i = 0; i < 50; ++i)
+  {
+    NNetDatapoint point;
+    for (int j = 0; j < 5; ++j)
+    {
+      point.input.push_back(4.0 * (drand48() - 0.5));
+    }
+    dataset.push_back(point);
+  }
+
+  NeuralNet net(5, 3, 2, 11);
+  NeuralNetAlg::randomizeWeights(net, -1.0, 1.0);
+
+  // same weights, approximate activation
+  FastTanhNeuralNet fastNet(net);
+  CPPUNIT_ASSERT_EQUAL(net.getNumLayers(), fastNet.getNumLayers());
+  CPPUNIT_ASSERT_EQUAL(net.getWeight(2, 4, 7), fastNet.getWeight(2, 4, 7));
+
+  NeuralNetFunctors::Tanh tanh;
+  NeuralNetFunctors::FastTanh fastTanh;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(tanh(0.3), fastTanh(0.3), 2.6e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(tanh(-12.0), fastTanh(-12.0), 2.6e-8);
+
+  // the error of each unit is small and only grows a little per layer
+  NNetDataset exact(dataset);
+  NNetDataset fast(dataset);
+  NeuralNetAlg::calculateOutputs(net, exact);
+  NeuralNetAlg::calculateOutputs(fastNet, fast);
+  for (int i = 0; i < int(dataset.size()); ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(size_t(3), fast[i].output.size());
+    for (int j = 0; j < 3; ++j)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(exact[i].output[j], fast[i].output[j],
+                                   1e-6);
+    }
+  }
+
+  // and converting back gives the original weights
+  NeuralNet copy(fastNet);
+  CPPUNIT_ASSERT(copy.getLayerWeight(2) == net.getLayerWeight(2));
+}
+
+} // namespace alch
@@ -0,0 +1,70 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestNeuralNet_h
+#define INCLUDED_nnet_TestNeuralNet_h
+
+#include "nnet/NeuralNet.h"
+#include "autil/Context.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestNeuralNet : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestNeuralNet);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+  CPPUNIT_TEST(test4);
+  CPPUNIT_TEST(test5);
+  CPPUNIT_TEST(test6);
+  CPPUNIT_TEST(test7);
+  CPPUNIT_TEST(test8);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests weight layout and forward propagation
+  void test1();
+
+  //! Tests that gradient descent reduces the training error
+  void test2();
+
+  //! Tests that batch propagation matches propagating one input at a time
+  void test3();
+
+  //! Tests multithreaded gradient descent against the serial version
+  void test4();
+
+  //! Tests that workspaces are independent of each other and the network
+  void test5();
+
+  //! Tests the errors reported by gradient descent for each network type
+  void test6();
+
+  //! Tests single precision networks against double precision ones
+  void test7();
+
+  //! Tests the approximate tanh network against the exact one
+  void test8();
+
+private:
+  Context m_ctx;
+
+};
+
+} // namespace alch
+
+#endif
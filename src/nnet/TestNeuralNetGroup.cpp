@@ -0,0 +1,147 @@
+#include "TestNeuralNetGroup.h"
+
+#include "nnet/NeuralNet.h"
+#include "nnet/NeuralNetAlg.h"
+#include "nnet/NNetDataset.h"
+
+#include <cstdlib>
+
+namespace alch
+{
+
+  namespace
+  {
+    const int numInputs = 5;
+
+    // rows are further apart than the inputs to check the input stride
+    const int inputStride = 7;
+
+    // more than one batch of rows
+    const int numRows = 150;
+
+    // creates networks of three layouts, two of them more than once
+    void makeNetworks(std::vector<NeuralNet>& nets)
+    {
+      nets.push_back(NeuralNet(numInputs, 1, 1, 8));
+      nets.push_back(NeuralNet(numInputs, 1, 0, 0));
+      nets.push_back(NeuralNet(numInputs, 1, 1, 8));
+
+      NeuralNet deep(numInputs, 1, 1, 11);
+      deep.addLayer(3);
+      deep.reset();
+      nets.push_back(deep);
+      nets.push_back(NeuralNet(numInputs, 1, 1, 8));
+      nets.push_back(deep);
+
+      for (int i = 0; i < int(nets.size()); ++i)
+      {
+        NeuralNetAlg::randomizeWeights(nets[i], -1.0, 1.0);
+      }
+    }
+
+    void makeInputs(std::vector<double>& input)
+    {
+      input.resize(numRows * inputStride);
+      for (int i = 0; i < int(input.size()); ++i)
+      {
+        input[i] = 2.0 * drand48() - 1.0;
+      }
+    }
+
+    // compares the group's results with those of each network on its own
+    template <class TNeuralNet>
+    void checkGroup(const std::vector<TNeuralNet>& nets,
+                    const std::vector<double>& input)
+    {
+      typedef typename TNeuralNet::Scalar Scalar;
+
+      // the networks are added in reverse to check the result columns
+      int numNets = nets.size();
+      NeuralNetGroup<TNeuralNet> group(numInputs);
+      for (int i = numNets - 1; i >= 0; --i)
+      {
+        group.add(nets[i], i);
+      }
+      CPPUNIT_ASSERT_EQUAL(numNets, group.size());
+      CPPUNIT_ASSERT_EQUAL(3, group.getNumStacks());
+
+      NNetDatasetTemplate<Scalar> dataset(numRows, numInputs, 1);
+      for (int row = 0; row < numRows; ++row)
+      {
+        for (int i = 0; i < numInputs; ++i)
+        {
+          dataset.getInputs()[row * numInputs + i] =
+            static_cast<Scalar>(input[row * inputStride + i]);
+        }
+      }
+
+      // the workspace is used twice to check that it's reused correctly
+      typename NeuralNetGroup<TNeuralNet>::Workspace workspace;
+      std::vector<double> result(numRows * numNets, -5.0);
+      for (int pass = 0; pass < 2; ++pass)
+      {
+        group.propagate(&input[0], numRows, inputStride, workspace,
+                        &result[0], numNets);
+
+        for (int i = 0; i < numNets; ++i)
+        {
+          NeuralNetAlg::calculateOutputs(nets[i], dataset);
+          for (int row = 0; row < numRows; ++row)
+          {
+            CPPUNIT_ASSERT_EQUAL(double(dataset[row].output[0]),
+                                 result[row * numNets + i]);
+          }
+        }
+      }
+    }
+  }
+
+
+void TestNeuralNetGroup::setUp() 
+{
+  m_level = NeuralNetKernels::getLevel();
+}
+
+void TestNeuralNetGroup::tearDown()
+{
+  NeuralNetKernels::setLevel(m_level);
+}
+
+void TestNeuralNetGroup::test1()
+{
+  std::vector<NeuralNet> nets;
+  makeNetworks(nets);
+
+  std::vector<double> input;
+  makeInputs(input);
+
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+    checkGroup(nets, input);
+  }
+}
+
+void TestNeuralNetGroup::test2()
+{
+  std::vector<NeuralNet> nets;
+  makeNetworks(nets);
+
+  std::vector<double> input;
+  makeInputs(input);
+
+  std::vector<FloatNeuralNet> floatNets;
+  std::vector<FastTanhNeuralNet> fastNets;
+  for (int i = 0; i < int(nets.size()); ++i)
+  {
+    floatNets.push_back(FloatNeuralNet(nets[i]));
+    fastNets.push_back(FastTanhNeuralNet(nets[i]));
+  }
+
+  checkGroup(floatNets, input);
+  checkGroup(fastNets, input);
+}
+
+} // namespace alch
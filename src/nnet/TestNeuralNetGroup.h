@@ -0,0 +1,45 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestNeuralNetGroup_h
+#define INCLUDED_nnet_TestNeuralNetGroup_h
+
+#include "nnet/NeuralNetGroup.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestNeuralNetGroup : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestNeuralNetGroup);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Checks that a group matches each network on its own at every level
+  void test1();
+
+  //! Checks the single precision and fast tanh networks
+  void test2();
+
+private:
+  NeuralNetKernels::Level m_level;
+
+};
+
+} // namespace alch
+
+#endif
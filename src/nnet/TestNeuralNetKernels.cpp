@@ -0,0 +1,270 @@
+
+#include "TestNeuralNetKernels.h"
+
+#include <vector>
+#include <cmath>
+#include <stdlib.h>
+
+namespace alch
+{
+
+void TestNeuralNetKernels::setUp() 
+{
+  m_level = NeuralNetKernels::getLevel();
+}
+
+void TestNeuralNetKernels::tearDown()
+{
+  NeuralNetKernels::setLevel(m_level);
+}
+
+void TestNeuralNetKernels::test1()
+{
+  const double delta = 0.0000000001;
+  const int rows = 7;
+  const int stride = 13;
+
+  std::vector<double> weight(rows * stride);
+  std::vector<double> x(stride);
+  for (int i = 0; i < int(weight.size()); ++i)
+  {
+    weight[i] = drand48() - 0.5;
+  }
+  for (int i = 0; i < stride; ++i)
+  {
+    x[i] = drand48() - 0.5;
+  }
+
+  // reference values computed without SIMD
+  std::vector<double> expected(rows);
+  for (int r = 0; r < rows; ++r)
+  {
+    expected[r] = 0.00;
+    for (int c = 0; c < stride; ++c)
+    {
+      expected[r] += weight[r * stride + c] * x[c];
+    }
+  }
+
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+    CPPUNIT_ASSERT_EQUAL(level, int(NeuralNetKernels::getLevel()));
+
+    // odd lengths exercise the tail handling
+    for (int n = 0; n <= stride; ++n)
+    {
+      double sum = 0.00;
+      for (int c = 0; c < n; ++c)
+      {
+        sum += weight[c] * x[c];
+      }
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(
+        sum, NeuralNetKernels::dot(&weight[0], &x[0], n), delta);
+    }
+
+    std::vector<double> y(rows, 0.00);
+    NeuralNetKernels::matVec(&weight[0], rows, stride, &x[0], &y[0]);
+    for (int r = 0; r < rows; ++r)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[r], y[r], delta);
+    }
+  }
+}
+
+void TestNeuralNetKernels::test2()
+{
+  const int n = 1001;
+  std::vector<double> in(n);
+  std::vector<double> out(n);
+  for (int i = 0; i < n; ++i)
+  {
+    in[i] = -25.0 + 50.0 * i / (n - 1);
+  }
+
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+    NeuralNetKernels::tanh(&in[0], &out[0], n);
+
+    for (int i = 0; i < n; ++i)
+    {
+      double expected = ::tanh(in[i]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, out[i],
+                                   4e-16 * (1.0 + ::fabs(expected)));
+    }
+  }
+}
+
+void TestNeuralNetKernels::test3()
+{
+  // odd sizes exercise the row, unit and column remainders
+  const int rows = 11;
+  const int units = 5;
+  const int stride = 10;
+  const int yStride = 7;
+
+  std::vector<double> x(rows * stride);
+  std::vector<double> weight(units * stride);
+  for (int i = 0; i < int(x.size()); ++i)
+  {
+    x[i] = drand48() - 0.5;
+  }
+  for (int i = 0; i < int(weight.size()); ++i)
+  {
+    weight[i] = drand48() - 0.5;
+  }
+
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+
+    std::vector<double> y(rows * yStride, 0.00);
+    NeuralNetKernels::matMul(&x[0], rows, &weight[0], units, stride,
+                             &y[0], yStride);
+
+    for (int r = 0; r < rows; ++r)
+    {
+      std::vector<double> expected(units);
+      NeuralNetKernels::matVec(&weight[0], units, stride, &x[r * stride],
+                               &expected[0]);
+      for (int u = 0; u < units; ++u)
+      {
+        CPPUNIT_ASSERT_EQUAL(expected[u], y[r * yStride + u]);
+      }
+
+      // the gap between rows is left alone
+      for (int u = units; u < yStride; ++u)
+      {
+        CPPUNIT_ASSERT_EQUAL(0.00, y[r * yStride + u]);
+      }
+    }
+  }
+}
+
+void TestNeuralNetKernels::test4()
+{
+  const int rows = 11;
+  const int units = 5;
+  const int stride = 21;
+  const int yStride = 7;
+
+  std::vector<float> x(rows * stride);
+  std::vector<float> weight(units * stride);
+  for (int i = 0; i < int(x.size()); ++i)
+  {
+    x[i] = float(drand48() - 0.5);
+  }
+  for (int i = 0; i < int(weight.size()); ++i)
+  {
+    weight[i] = float(drand48() - 0.5);
+  }
+
+  const int n = 1001;
+  std::vector<float> in(n);
+  std::vector<float> out(n);
+  for (int i = 0; i < n; ++i)
+  {
+    in[i] = float(-25.0 + 50.0 * i / (n - 1));
+  }
+
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+
+    // dot() against sums in double precision
+    for (int u = 0; u < units; ++u)
+    {
+      double expected = 0.00;
+      for (int c = 0; c < stride; ++c)
+      {
+        expected += double(weight[u * stride + c]) * x[c];
+      }
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(
+        expected, NeuralNetKernels::dot(&weight[u * stride], &x[0], stride),
+        1e-5);
+    }
+
+    // matMul() matches matVec() exactly
+    std::vector<float> y(rows * yStride, 0.00f);
+    NeuralNetKernels::matMul(&x[0], rows, &weight[0], units, stride,
+                             &y[0], yStride);
+    for (int r = 0; r < rows; ++r)
+    {
+      std::vector<float> expected(units);
+      NeuralNetKernels::matVec(&weight[0], units, stride, &x[r * stride],
+                               &expected[0]);
+      for (int u = 0; u < units; ++u)
+      {
+        CPPUNIT_ASSERT_EQUAL(expected[u], y[r * yStride + u]);
+      }
+      for (int u = units; u < yStride; ++u)
+      {
+        CPPUNIT_ASSERT_EQUAL(0.00f, y[r * yStride + u]);
+      }
+    }
+
+    // tanh() within a few units in the last place of float
+    NeuralNetKernels::tanh(&in[0], &out[0], n);
+    for (int i = 0; i < n; ++i)
+    {
+      double expected = ::tanh(double(in[i]));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, out[i],
+                                   5e-7 * (1.0 + ::fabs(expected)));
+    }
+  }
+}
+
+void TestNeuralNetKernels::test5()
+{
+  const int n = 4001;
+  std::vector<double> in(n);
+  std::vector<double> out(n);
+  std::vector<float> floatIn(n);
+  std::vector<float> floatOut(n);
+  for (int i = 0; i < n; ++i)
+  {
+    in[i] = -20.0 + 40.0 * i / (n - 1);
+    floatIn[i] = float(in[i]);
+  }
+
+  // the documented bounds, which hold at every level and for any tail
+  for (int level = NeuralNetKernels::LEVEL_scalar;
+       level <= NeuralNetKernels::getMaxLevel();
+       ++level)
+  {
+    NeuralNetKernels::setLevel(NeuralNetKernels::Level(level));
+
+    for (int len = n - 3; len <= n; ++len)
+    {
+      NeuralNetKernels::fastTanh(&in[0], &out[0], len);
+      NeuralNetKernels::fastTanh(&floatIn[0], &floatOut[0], len);
+
+      for (int i = 0; i < len; ++i)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(::tanh(in[i]), out[i], 2.6e-8);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(::tanh(double(floatIn[i])),
+                                     floatOut[i], 3e-7);
+      }
+    }
+
+    // odd in x, and exact at zero
+    double x[2] = { 0.75, -0.75 };
+    NeuralNetKernels::fastTanh(x, x, 2);
+    CPPUNIT_ASSERT_EQUAL(x[0], -x[1]);
+
+    double zero = 0.00;
+    NeuralNetKernels::fastTanh(&zero, &zero, 1);
+    CPPUNIT_ASSERT_EQUAL(0.00, zero);
+  }
+}
+
+} // namespace alch
@@ -0,0 +1,57 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestNeuralNetKernels_h
+#define INCLUDED_nnet_TestNeuralNetKernels_h
+
+#include "nnet/NeuralNetKernels.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestNeuralNetKernels : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestNeuralNetKernels);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+  CPPUNIT_TEST(test4);
+  CPPUNIT_TEST(test5);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Compares dot() and matVec() at every level against scalar results
+  void test1();
+
+  //! Compares tanh() at every level against ::tanh()
+  void test2();
+
+  //! Checks that matMul() matches matVec() exactly at every level
+  void test3();
+
+  //! Checks the single precision kernels at every level
+  void test4();
+
+  //! Checks fastTanh() at every level against ::tanh()
+  void test5();
+
+private:
+  NeuralNetKernels::Level m_level;
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,80 @@
+
+#include "TestRMSPropGradDescent.h"
+
+#include "nnet/NeuralNetAlg.h"
+
+#include <cmath>
+#include <stdlib.h>
+
+namespace alch
+{
+
+void TestRMSPropGradDescent::setUp() 
+{
+  m_dataset.clear();
+  for (int i = 0; i < 40; ++i)
+  {
+    NNetDatapoint point;
+    double x = drand48() - 0.5;
+    double y = drand48() - 0.5;
+    point.input.push_back(x);
+    point.input.push_back(y);
+    point.output.push_back(0.5 * x - 0.3 * y);
+    m_dataset.push_back(point);
+  }
+}
+
+void TestRMSPropGradDescent::tearDown()
+{
+  ;
+}
+
+void TestRMSPropGradDescent::test1()
+{
+  const double eta = 0.01;
+  const double delta = 0.000001;
+
+  NeuralNet start(2, 1, 1, 4);
+  NeuralNetAlg::randomizeWeights(start, -0.5, 0.5);
+
+  // the first average is 1 - rho of the squared delta, so the first step
+  // moves every weight by eta / sqrt(1 - rho)
+  NeuralNetPtr net(new NeuralNet(start));
+  RMSPropGradDescent grad(net, eta, int(m_dataset.size()));
+  grad.run(m_dataset);
+
+  for (int layer = 1; layer < start.getNumLayers(); ++layer)
+  {
+    for (int prevUnit = 0; prevUnit < start.getNumUnits(layer - 1);
+         ++prevUnit)
+    {
+      CPPUNIT_ASSERT_EQUAL(0.00, net->getWeight(layer, prevUnit, 0));
+
+      for (int unit = 1; unit < start.getNumUnits(layer); ++unit)
+      {
+        double change = (net->getWeight(layer, prevUnit, unit)
+                         - start.getWeight(layer, prevUnit, unit));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(eta / ::sqrt(0.1), ::fabs(change),
+                                     delta);
+      }
+    }
+  }
+}
+
+void TestRMSPropGradDescent::test2()
+{
+  NeuralNetPtr net(new NeuralNet(2, 1, 1, 5));
+  NeuralNetAlg::randomizeWeights(*net, -0.5, 0.5);
+  double startError = NeuralNetAlg::calculateError(*net, m_dataset);
+
+  RMSPropGradDescent grad(net, 0.01, 10, 3);
+  for (int step = 0; step < 20; ++step)
+  {
+    grad.run(m_dataset);
+  }
+
+  double endError = NeuralNetAlg::calculateError(*net, m_dataset);
+  CPPUNIT_ASSERT(endError < startError);
+}
+
+} // namespace alch
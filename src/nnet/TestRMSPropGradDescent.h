@@ -0,0 +1,45 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestRMSPropGradDescent_h
+#define INCLUDED_nnet_TestRMSPropGradDescent_h
+
+#include "nnet/RMSPropGradDescent.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestRMSPropGradDescent : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestRMSPropGradDescent);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests the size of the first update
+  void test1();
+
+  //! Tests that training reduces the error
+  void test2();
+
+private:
+  NNetDataset m_dataset;
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,92 @@
+
+#include "TestRunningStatistics.h"
+
+#include "nnet/NeuralNetAlg.h"
+#include "nnet/Statistics.h"
+
+#include <sstream>
+
+namespace alch
+{
+
+  namespace
+  {
+    // prices that move little compared to their level
+    const double values[] = {
+      1000.25, 1001.5, 999.75, 1002.0, 1003.25, 1001.0, 1004.5, 1005.0
+    };
+    const double targets[] = {
+      1000.5, 1001.0, 1000.25, 1002.75, 1002.5, 1001.75, 1004.0, 1006.25
+    };
+    const int numPairs = (sizeof(values) / sizeof(double));
+  }
+
+
+void TestRunningStatistics::setUp() 
+{
+  ;
+}
+
+void TestRunningStatistics::tearDown()
+{
+  ;
+}
+
+void TestRunningStatistics::test1()
+{
+  RunningStatistics stats;
+  CPPUNIT_ASSERT_EQUAL(0, stats.size());
+  CPPUNIT_ASSERT_EQUAL(0.0, stats.getCorrelation());
+
+  for (int i = 0; i < numPairs; ++i)
+  {
+    stats.add(values[i], targets[i]);
+    CPPUNIT_ASSERT_EQUAL(i + 1, stats.size());
+
+    // the squared error adds the same terms in the same order
+    CPPUNIT_ASSERT_EQUAL(NeuralNetAlg::squaredError(values, targets, i + 1),
+                         stats.getSquaredError());
+    if (i > 0)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(
+        Statistics::correlation(values, targets, i + 1),
+        stats.getCorrelation(), 1e-12);
+    }
+  }
+}
+
+void TestRunningStatistics::test2()
+{
+  RunningStatistics stats;
+  for (int i = 0; i < numPairs / 2; ++i)
+  {
+    stats.add(values[i], targets[i]);
+  }
+
+  std::stringstream ss;
+  stats.write(ss);
+  ss << " 42";
+
+  // picks up where the original left off
+  RunningStatistics stats2;
+  CPPUNIT_ASSERT(stats2.read(ss));
+  int next = 0;
+  ss >> next;
+  CPPUNIT_ASSERT_EQUAL(42, next);
+
+  for (int i = numPairs / 2; i < numPairs; ++i)
+  {
+    stats.add(values[i], targets[i]);
+    stats2.add(values[i], targets[i]);
+  }
+  CPPUNIT_ASSERT_EQUAL(stats.size(), stats2.size());
+  CPPUNIT_ASSERT_EQUAL(stats.getSquaredError(), stats2.getSquaredError());
+  CPPUNIT_ASSERT_EQUAL(stats.getCorrelation(), stats2.getCorrelation());
+
+  // a failed read leaves the statistics alone
+  std::istringstream bad("3 1.5 x");
+  CPPUNIT_ASSERT(!stats2.read(bad));
+  CPPUNIT_ASSERT_EQUAL(numPairs, stats2.size());
+}
+
+} // namespace alch
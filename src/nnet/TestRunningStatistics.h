@@ -0,0 +1,42 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_nnet_TestRunningStatistics_h
+#define INCLUDED_nnet_TestRunningStatistics_h
+
+#include "nnet/RunningStatistics.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestRunningStatistics : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestRunningStatistics);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests against the functions that compute over all pairs at once
+  void test1();
+
+  //! Tests writing and reading back the statistics
+  void test2();
+
+};
+
+} // namespace alch
+
+#endif
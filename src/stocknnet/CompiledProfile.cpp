@@ -0,0 +1,162 @@
+#include "stocknnet/CompiledProfile.h"
+
+#include <map>
+#include <cassert>
+
+namespace alch {
+
+namespace CompiledProfile
+{
+
+  namespace { // anonymous
+
+    typedef std::multimap<boost::uint64_t, Evaluator> EvaluatorMap;
+
+    // constructed on first use, since evaluators register themselves
+    // during static initialization
+    EvaluatorMap& getEvaluators()
+    {
+      static EvaluatorMap evaluators;
+      return evaluators;
+    }
+
+    // 64-bit FNV-1a
+    const boost::uint64_t c_fnvOffset = 14695981039346656037ULL;
+    const boost::uint64_t c_fnvPrime = 1099511628211ULL;
+
+    boost::uint64_t hash(boost::uint64_t h, const void* data, int size)
+    {
+      const unsigned char* p = static_cast<const unsigned char*>(data);
+      for (int i = 0; i < size; ++i)
+      {
+        h = (h ^ p[i]) * c_fnvPrime;
+      }
+      return h;
+    }
+
+    // whether the weights compiled into an evaluator are those of net,
+    // converted to the evaluator's scalar type
+    template <typename TScalar>
+    bool sameWeights(const TScalar* const* weights, const NeuralNet& net)
+    {
+      for (int layer = 1; layer < net.getNumLayers(); ++layer)
+      {
+        const TScalar* weight = weights[layer];
+        for (int unit = 1; unit < net.getNumUnits(layer); ++unit)
+        {
+          for (int prevUnit = 0; prevUnit < net.getNumUnits(layer - 1);
+               ++prevUnit)
+          {
+            if (*weight++ != TScalar(net.getWeight(layer, prevUnit, unit)))
+            {
+              return false;
+            }
+          }
+        }
+      }
+
+      return true;
+    }
+
+    // whether evaluator was compiled from profile
+    bool matches(const Evaluator& evaluator,
+                 const PredictionProfile& profile)
+    {
+      const NeuralNet& net = profile.getNeuralNet();
+      if (evaluator.numLayers != net.getNumLayers())
+      {
+        return false;
+      }
+
+      // getNumUnits() counts the constant unit
+      for (int layer = 0; layer < net.getNumLayers(); ++layer)
+      {
+        if (evaluator.layerUnits[layer] != net.getNumUnits(layer) - 1)
+        {
+          return false;
+        }
+      }
+
+      if (profile.getPrecision() == PredictionProfile::PRECISION_float)
+      {
+        return (evaluator.floatWeights
+                && sameWeights(evaluator.floatWeights, net));
+      }
+
+      return (evaluator.weights && sameWeights(evaluator.weights, net));
+    }
+
+  } // anonymous namespace
+
+
+  boost::uint64_t digest(const PredictionProfile& profile)
+  {
+    assert(profile.getNeuralNetPtr().get());
+    const NeuralNet& net = profile.getNeuralNet();
+
+    boost::uint64_t h = c_fnvOffset;
+
+    int precision = int(profile.getPrecision());
+    h = hash(h, &precision, sizeof(precision));
+
+    int numLayers = net.getNumLayers();
+    h = hash(h, &numLayers, sizeof(numLayers));
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      int numUnits = net.getNumUnits(layer);
+      h = hash(h, &numUnits, sizeof(numUnits));
+    }
+
+    // skip the padding, which holds no weights
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      for (int unit = 1; unit < net.getNumUnits(layer); ++unit)
+      {
+        for (int prevUnit = 0; prevUnit < net.getNumUnits(layer - 1);
+             ++prevUnit)
+        {
+          double weight = net.getWeight(layer, prevUnit, unit);
+          h = hash(h, &weight, sizeof(weight));
+        }
+      }
+    }
+
+    return h;
+  }
+
+
+  void add(const Evaluator& evaluator)
+  {
+    assert(evaluator.predict);
+    assert(evaluator.layerUnits);
+    assert(evaluator.weights || evaluator.floatWeights);
+    getEvaluators().insert(std::make_pair(evaluator.digest, evaluator));
+  }
+
+
+  const Evaluator* find(const PredictionProfile& profile)
+  {
+    EvaluatorMap& evaluators = getEvaluators();
+    if (evaluators.empty())
+    {
+      return 0;
+    }
+
+    std::pair<EvaluatorMap::const_iterator, EvaluatorMap::const_iterator>
+      range = evaluators.equal_range(digest(profile));
+    for (EvaluatorMap::const_iterator iter = range.first;
+         iter != range.second;
+         ++iter)
+    {
+      if (matches(iter->second, profile))
+      {
+        return &iter->second;
+      }
+    }
+
+    return 0;
+  }
+
+} // namespace CompiledProfile
+
+} // namespace alch
@@ -0,0 +1,108 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_CompiledProfile_h
+#define INCLUDED_stocknnet_CompiledProfile_h
+
+#include "stocknnet/PredictionProfile.h"
+
+#include "boost/cstdint.hpp"
+
+namespace alch {
+
+/*!
+  \brief Registry of prediction profiles compiled into the application
+  \ingroup stocknnet
+
+  alchemycompileprofile turns a trained profile into a header with the
+  network's weights as static arrays and a predict() function with fixed
+  loop bounds. Including that header in one translation unit of an
+  application registers the evaluator here, and find() hands it out for
+  any loaded profile whose network it was compiled from.
+
+  Profiles are looked up by a 64-bit digest of their precision, layer
+  sizes and weights, and a match is confirmed by comparing the layer sizes
+  and every weight with those compiled in. An evaluator is therefore never
+  used for a profile that has been retrained since it was compiled, even
+  if the digests collide.
+*/
+namespace CompiledProfile
+{
+
+  /*!
+    \brief Signature of a compiled evaluator
+    \param input The network inputs, without the constant unit
+    \param output [out] The network outputs, without the constant unit
+  */
+  typedef void (*PredictFunction)(const double* input, double* output);
+
+  //! A compiled evaluator and the profile it was compiled from
+  struct Evaluator
+  {
+    //! digest() of the profile the evaluator was compiled from
+    boost::uint64_t digest;
+
+    //! Number of inputs, without the constant unit
+    int numInputUnits;
+
+    //! Number of outputs, without the constant unit
+    int numOutputUnits;
+
+    //! Computes the outputs for one set of inputs
+    PredictFunction predict;
+
+    //! Number of layers, including the input layer
+    int numLayers;
+
+    //! Units on each layer, without the constant unit
+    const int* layerUnits;
+
+    //! Weights into each layer [1..numLayers - 1] of a double profile,
+    //! or 0. Layer l has layerUnits[l] rows of the bias and the weights
+    //! from each unit of layer l - 1.
+    const double* const* weights;
+
+    //! Weights of a float profile in the same layout, or 0
+    const float* const* floatWeights;
+  };
+
+  /*!
+    \brief Calculates the digest identifying a profile's network
+    \param profile The profile; must have a neural network
+    \return 64-bit FNV-1a hash of the precision, layer sizes and weights
+  */
+  boost::uint64_t digest(const PredictionProfile& profile);
+
+  /*!
+    \brief Registers an evaluator
+
+    Evaluators with the same digest are all kept; find() tells them apart
+    by their weights.
+  */
+  void add(const Evaluator& evaluator);
+
+  /*!
+    \brief Finds the evaluator compiled from the specified profile
+    \param profile The profile; must have a neural network
+    \return The evaluator, or 0 if none was compiled from this profile
+  */
+  const Evaluator* find(const PredictionProfile& profile);
+
+  /*!
+    \brief Registers an evaluator during static initialization
+
+    Generated headers define one of these for their evaluator.
+  */
+  class Registrar
+  {
+   public:
+    explicit Registrar(const Evaluator& evaluator)
+    {
+      add(evaluator);
+    }
+  };
+
+} // namespace CompiledProfile
+
+} // namespace alch
+
+#endif
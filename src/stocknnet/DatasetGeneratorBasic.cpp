@@ -41,13 +41,13 @@ namespace alch {
 
 
     // now append the dataset we created to the one that was passed in
-    dataset.insert(dataset.end(), tmpDataset.begin(), tmpDataset.end());
+    dataset.append(tmpDataset);
 
     return true;
   }
 
   namespace {
-    inline int getInputsIndex(const NNetDataset& dataset)
+    inline int getInputsIndex(const NNetDatapointList& dataset)
     {
       if (dataset.size() > 0)
       {
@@ -69,6 +69,10 @@ namespace alch {
 
     The startPointIdx / endPointIdx / getInputsIndex() stuff is only used
     for debugging.
+
+    The populators add inputs to each point separately, so the points are
+    built in an NNetDatapointList and only packed into dataset once they
+    are complete.
   */
 
   bool DatasetGeneratorBasic::generateInputs(const RangeDataPtr& rangeDataPtr,
@@ -79,7 +83,7 @@ namespace alch {
 
     const int historySize = 3;
 
-    NNetDataset tmpDataset;
+    NNetDatapointList tmpDataset;
 
     // resize dataset to hold at least one point for each input data point
     tmpDataset.resize(rangeDataPtr->size());
@@ -298,8 +302,12 @@ namespace alch {
     }
 #endif
 
-    // now append the dataset we created to the one that was passed in
-    dataset.insert(dataset.end(), tmpDataset.begin(), tmpDataset.end());
+    // now append the points we created to the dataset that was passed in
+    dataset.reserve(int(dataset.size() + tmpDataset.size()));
+    for (int i = 0; i < int(tmpDataset.size()); ++i)
+    {
+      dataset.push_back(tmpDataset[i]);
+    }
 
     return true;
   }
@@ -329,8 +337,7 @@ namespace alch {
 
     // start off by chopping off last numDays datapoints since they will 
     // not have an output
-    dataset.erase(dataset.begin() + dataset.size() - getNumberDays(),
-                  dataset.end());
+    dataset.erase(int(dataset.size()) - getNumberDays(), int(dataset.size()));
 
     getContext() << Context::PRIORITY_debug2
                  << "generateOutputs: Target dataset size: "
@@ -342,6 +349,10 @@ namespace alch {
                  << rangeDataPtr->size() 
                  << Context::endl;
 
+    // add an output to every point
+    int outputIdx = dataset.getNumOutputs();
+    dataset.setNumOutputs(outputIdx + 1);
+
     // now work backward through rangeData and dataset, assigning
     // outputs
     int i = dataset.size() - 1;
@@ -356,7 +367,7 @@ namespace alch {
       double currClose = rangeDataPtr->get(j - getNumberDays()).close;
       double futureClose = rangeDataPtr->get(j).close;
       double relativeClose = (futureClose - currClose) / currClose;
-      dataset[i].output.push_back(relativeClose);
+      dataset[i].output[outputIdx] = relativeClose;
 
       --i;
       --j;
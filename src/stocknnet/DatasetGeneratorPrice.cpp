@@ -9,8 +9,7 @@ namespace alch {
   {
     int numberDays = getNumberDays();
     int rangeDataSize = rangeDataPtr->size() - numberDays;
-    dataset.clear();
-    dataset.resize(rangeDataSize);
+    dataset = NNetDataset(rangeDataSize, 1, 1);
 
     for (int i = 0; i < rangeDataSize; ++i)
     {
@@ -18,8 +17,8 @@ namespace alch {
         ((rangeDataPtr->get(i).close - 50.0 ) / 50.0);
       double mappedCloseFuture =
         ((rangeDataPtr->get(i + numberDays).close - 50.0) / 50.0);
-      dataset[i].input.push_back(mappedCloseCurr);
-      dataset[i].output.push_back(mappedCloseFuture);
+      dataset[i].input[0] = mappedCloseCurr;
+      dataset[i].output[0] = mappedCloseFuture;
     }
 
     return true;
@@ -29,13 +28,12 @@ namespace alch {
                                              NNetDataset& dataset)
   {
     int rangeDataSize = rangeDataPtr->size();
-    dataset.clear();
-    dataset.resize(rangeDataSize);
+    dataset = NNetDataset(rangeDataSize, 1, 0);
 
     for (int i = 0; i < rangeDataSize; ++i)
     {
       double mappedClose = ((rangeDataPtr->get(i).close - 50.0 ) / 50.0);
-      dataset[i].input.push_back(mappedClose);
+      dataset[i].input[0] = mappedClose;
     }
 
     return true;
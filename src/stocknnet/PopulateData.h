@@ -55,7 +55,7 @@ class PopulateData
     inputs should be added to each element starting at the numModified index.
   */
   virtual bool populate(const RangeDataPtr& rangeDataPtr,
-                        NNetDataset& dataset,
+                        NNetDatapointList& dataset,
                         int& numModified) = 0;
 
 
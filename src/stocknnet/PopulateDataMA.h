@@ -38,7 +38,7 @@ class PopulateDataMA : public PopulateData
   }
 
   virtual bool populate(const RangeDataPtr& rangeDataPtr,
-                        NNetDataset& dataset,
+                        NNetDatapointList& dataset,
                         int& numModified);
 
 
@@ -7,7 +7,7 @@ namespace alch {
 
 
   bool PopulateDataPSAR::populate(const RangeDataPtr& rangeDataPtr,
-                                  NNetDataset& dataset,
+                                  NNetDatapointList& dataset,
                                   int& numModified)
   {
     assert(m_numberDays >= 0);
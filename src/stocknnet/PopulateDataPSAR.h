@@ -39,7 +39,7 @@ class PopulateDataPSAR : public PopulateData
   }
 
   virtual bool populate(const RangeDataPtr& rangeDataPtr,
-                        NNetDataset& dataset,
+                        NNetDatapointList& dataset,
                         int& numModified);
 
 
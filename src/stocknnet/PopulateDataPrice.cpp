@@ -5,7 +5,7 @@ namespace alch {
 
 
   bool PopulateDataPrice::populate(const RangeDataPtr& rangeDataPtr,
-                                   NNetDataset& dataset,
+                                   NNetDatapointList& dataset,
                                    int& numModified)
   {
     assert(m_numberDays > 0);
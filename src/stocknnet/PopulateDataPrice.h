@@ -38,7 +38,7 @@ class PopulateDataPrice : public PopulateData
   }
 
   virtual bool populate(const RangeDataPtr& rangeDataPtr,
-                        NNetDataset& dataset,
+                        NNetDatapointList& dataset,
                         int& numModified);
 
 
@@ -37,7 +37,7 @@ class PopulateDataRSI : public PopulateData
   }
 
   virtual bool populate(const RangeDataPtr& rangeDataPtr,
-                        NNetDataset& dataset,
+                        NNetDatapointList& dataset,
                         int& numModified);
 
 
@@ -0,0 +1,115 @@
+#include "stocknnet/PredictionCache.h"
+
+#include <cassert>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace alch {
+
+  // first line of the file; the number is the format version
+  const char* const PredictionCache::c_header = "alchemy-prediction-cache 1";
+
+  PredictionCache::PredictionCache()
+    : m_entries()
+  {
+    ;
+  }
+
+
+  bool PredictionCache::find(const std::string& key, Entry& entry) const
+  {
+    EntryMap::const_iterator iter = m_entries.find(key);
+    if (iter == m_entries.end())
+    {
+      return false;
+    }
+
+    entry = iter->second;
+    return true;
+  }
+
+
+  void PredictionCache::set(const std::string& key, const Entry& entry)
+  {
+    assert(!key.empty());
+    assert(key.find_first_of(" \t\r\n") == std::string::npos);
+    m_entries[key] = entry;
+  }
+
+
+  bool PredictionCache::read(std::istream& is, Context& ctx)
+  {
+    m_entries.clear();
+
+    std::string line;
+    if (!std::getline(is, line) || (line != c_header))
+    {
+      ctx << Context::PRIORITY_error
+          << "Not a prediction cache, or one of another version"
+          << Context::endl;
+      return false;
+    }
+
+    int lineNumber = 1;
+    while (std::getline(is, line))
+    {
+      ++lineNumber;
+
+      std::istringstream iss(line);
+      std::string key;
+      std::string lastTime;
+      Entry entry;
+      iss >> key >> lastTime >> entry.lastClose;
+      bool ok = (iss && entry.stats.read(iss));
+
+      if (ok)
+      {
+        try
+        {
+          entry.lastTime = boost::posix_time::from_iso_string(lastTime);
+        }
+        catch (std::exception&)
+        {
+          ok = false;
+        }
+      }
+
+      if (!ok)
+      {
+        ctx << Context::PRIORITY_error
+            << "Invalid prediction cache entry on line " << lineNumber
+            << Context::endl;
+        m_entries.clear();
+        return false;
+      }
+
+      m_entries[key] = entry;
+    }
+
+    return true;
+  }
+
+
+  bool PredictionCache::write(std::ostream& os) const
+  {
+    os << c_header << '\n';
+
+    std::streamsize precision = os.precision(17);
+    EntryMap::const_iterator end = m_entries.end();
+    EntryMap::const_iterator iter;
+    for (iter = m_entries.begin(); iter != end; ++iter)
+    {
+      const Entry& entry = iter->second;
+      os << iter->first
+         << ' ' << boost::posix_time::to_iso_string(entry.lastTime)
+         << ' ' << entry.lastClose << ' ';
+      entry.stats.write(os);
+      os << '\n';
+    }
+    os.precision(precision);
+
+    return bool(os);
+  }
+
+} // namespace alch
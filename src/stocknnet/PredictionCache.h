@@ -0,0 +1,117 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_PredictionCache_h
+#define INCLUDED_stocknnet_PredictionCache_h
+
+#include "autil/Context.h"
+#include "nnet/RunningStatistics.h"
+#include "stockdata/StockTime.h"
+
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace alch {
+
+/*!
+  \brief Statistics of the predictions a profile has made for a symbol,
+  kept between runs
+  \ingroup stocknnet
+
+  Scoring a profile compares its prediction for every past day with the
+  close that followed. Storing the statistics of those comparisons along
+  with the last day they cover lets the next run add only the days that
+  are new since then.
+
+  Entries are looked up by a key that names the symbol and identifies the
+  profile; it must not contain whitespace. The cache is stored as text,
+  one entry per line.
+*/
+class PredictionCache
+{
+ public:
+
+  //! Statistics of one symbol and profile
+  struct Entry
+  {
+    Entry()
+      : lastTime(boost::posix_time::not_a_date_time)
+      , lastClose(0.0)
+      , stats()
+    {
+      ;
+    }
+
+    //! Trade time of the last close compared with a prediction
+    StockTime lastTime;
+
+    //! The close at lastTime; a different close on a later run means the
+    //! history was adjusted and the statistics no longer apply
+    double lastClose;
+
+    //! Statistics of the predicted and actual closes up to lastTime
+    RunningStatistics stats;
+  };
+
+  /*!
+    \brief Constructor; the cache starts out empty
+  */
+  PredictionCache();
+
+  /*!
+    \brief Looks up an entry
+    \param key The key the entry was stored under
+    \param entry [out] Receives the entry if there is one
+    \retval true Found
+    \retval false There is no entry for key
+  */
+  bool find(const std::string& key, Entry& entry) const;
+
+  /*!
+    \brief Stores an entry, replacing any stored under the same key
+    \param key The key; must not contain whitespace
+    \param entry The entry
+  */
+  void set(const std::string& key, const Entry& entry);
+
+  //! Number of entries
+  int size() const
+  {
+    return int(m_entries.size());
+  }
+
+  //! Removes all entries
+  void clear()
+  {
+    m_entries.clear();
+  }
+
+  /*!
+    \brief Reads entries written by write(), replacing the current ones
+    \param is The input stream
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error; the cache is empty
+  */
+  bool read(std::istream& is, Context& ctx);
+
+  /*!
+    \brief Writes all entries
+    \param os The output stream
+    \retval true Success
+    \retval false Error writing to the stream
+  */
+  bool write(std::ostream& os) const;
+
+ private:
+
+  typedef std::map<std::string, Entry> EntryMap;
+
+  static const char* const c_header;
+
+  EntryMap m_entries;
+};
+
+} // namespace alch
+
+#endif
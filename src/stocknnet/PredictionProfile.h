@@ -19,6 +19,13 @@ class PredictionProfile
 {
  public:
 
+  //! Scalar type the network is trained and scored in
+  enum Precision
+  {
+    PRECISION_double,
+    PRECISION_float
+  };
+
   /*!
     \brief Constructor
   */
@@ -26,6 +33,7 @@ class PredictionProfile
     : m_neuralNet()
     , m_name("Generic prediction profile")
     , m_numberDays(1)
+    , m_precision(PRECISION_double)
   {
     ;
   }
@@ -77,6 +85,24 @@ class PredictionProfile
     m_name = val;
   }
 
+  /*!
+    \brief Returns the precision the network was trained in
+
+    The network is always stored in double precision; a profile trained in
+    float should be scored with a FloatNeuralNet copy of it so that the
+    results match those seen during training.
+  */
+  Precision getPrecision() const
+  {
+    return m_precision;
+  }
+
+  //! sets the precision the network was trained in
+  void setPrecision(Precision val)
+  {
+    m_precision = val;
+  }
+
  private:
 
   NeuralNetPtr m_neuralNet;
@@ -84,6 +110,8 @@ class PredictionProfile
   std::string m_name;
 
   int m_numberDays;
+
+  Precision m_precision;
   
 };
 
@@ -0,0 +1,264 @@
+
+#include "stocknnet/ProfileCompiler.h"
+
+#include "stocknnet/CompiledProfile.h"
+
+#include <ostream>
+#include <iomanip>
+#include <cctype>
+
+namespace alch {
+
+namespace ProfileCompiler
+{
+
+  namespace { // anonymous
+
+    // number of weights written on each line, keeping lines of the
+    // generated header under 80 columns
+    const int c_doublesPerLine = 2;
+    const int c_floatsPerLine = 4;
+
+    // writes the weights into one layer; row u holds the bias and then
+    // the weights from each unit of the previous layer
+    void writeWeights(std::ostream& os,
+                      const NeuralNet& net,
+                      int layer,
+                      bool isFloat)
+    {
+      int numUnits = net.getNumUnits(layer) - 1;
+      int numPrevUnits = net.getNumUnits(layer - 1);
+      int valuesPerLine = (isFloat ? c_floatsPerLine : c_doublesPerLine);
+
+      os << "  //! Weights into layer " << layer
+         << "; column 0 is the bias\n"
+         << "  const Scalar c_weight" << layer << "[" << numUnits << "]["
+         << numPrevUnits << "] =\n"
+         << "  {\n";
+
+      for (int unit = 1; unit <= numUnits; ++unit)
+      {
+        os << "    {";
+        for (int prevUnit = 0; prevUnit < numPrevUnits; ++prevUnit)
+        {
+          if (prevUnit && !(prevUnit % valuesPerLine))
+          {
+            os << "\n     ";
+          }
+
+          double weight = net.getWeight(layer, prevUnit, unit);
+          if (isFloat)
+          {
+            os << " " << std::setprecision(8) << float(weight) << "f";
+          }
+          else
+          {
+            os << " " << std::setprecision(16) << weight;
+          }
+
+          if (prevUnit + 1 < numPrevUnits)
+          {
+            os << ",";
+          }
+        }
+        os << " }" << ((unit < numUnits) ? "," : "") << "\n";
+      }
+
+      os << "  };\n\n";
+    }
+
+
+    // writes the computation of one layer from the previous one
+    void writeLayer(std::ostream& os, int layer, bool isOutput)
+    {
+      os << "\n";
+      if (!isOutput)
+      {
+        os << "    Scalar value" << layer << "[c_numUnits" << layer
+           << "];\n";
+      }
+
+      os << "    for (int unit = 0; unit < c_numUnits" << layer
+         << "; ++unit)\n"
+         << "    {\n"
+         << "      Scalar sum = c_weight" << layer << "[unit][0];\n"
+         << "      for (int prev = 0; prev < c_numUnits" << (layer - 1)
+         << "; ++prev)\n"
+         << "      {\n"
+         << "        sum += c_weight" << layer << "[unit][prev + 1] * value"
+         << (layer - 1) << "[prev];\n"
+         << "      }\n";
+
+      if (isOutput)
+      {
+        os << "      output[unit] = double(std::tanh(sum));\n";
+      }
+      else
+      {
+        os << "      value" << layer << "[unit] = std::tanh(sum);\n";
+      }
+
+      os << "    }\n";
+    }
+
+  } // anonymous namespace
+
+
+  std::string getIdentifier(const std::string& baseName)
+  {
+    std::string::size_type slashPos = baseName.rfind('/');
+    std::string name = ((slashPos == std::string::npos)
+                        ? baseName : baseName.substr(slashPos + 1));
+
+    std::string identifier("profile_");
+    for (std::string::size_type i = 0; i < name.length(); ++i)
+    {
+      unsigned char c = name[i];
+      identifier += (::isalnum(c) ? char(c) : '_');
+    }
+
+    return identifier;
+  }
+
+
+  bool write(std::ostream& os,
+             const PredictionProfile& profile,
+             const std::string& identifier,
+             Context& ctx)
+  {
+    if (!profile.getNeuralNetPtr().get())
+    {
+      ctx << Context::PRIORITY_error
+          << "Prediction profile '" << profile.getName()
+          << "' has no neural network to compile"
+          << Context::endl;
+      return false;
+    }
+
+    const NeuralNet& net = profile.getNeuralNet();
+    int numLayers = net.getNumLayers();
+    bool isFloat = (profile.getPrecision()
+                    == PredictionProfile::PRECISION_float);
+
+    std::ios::fmtflags flags = os.flags();
+    os.setf(std::ios::scientific, std::ios::floatfield);
+
+    os << "// -*- C++ -*-\n"
+       << "\n"
+       << "// Generated by alchemycompileprofile from prediction profile\n"
+       << "// '" << profile.getName() << "'. Do not edit.\n"
+       << "\n"
+       << "#ifndef INCLUDED_compiledprofile_" << identifier << "_h\n"
+       << "#define INCLUDED_compiledprofile_" << identifier << "_h\n"
+       << "\n"
+       << "#include \"stocknnet/CompiledProfile.h\"\n"
+       << "\n"
+       << "#include <cmath>\n"
+       << "\n"
+       << "namespace alch {\n"
+       << "\n"
+       << "namespace CompiledProfiles {\n"
+       << "\n"
+       << "namespace " << identifier << " {\n"
+       << "\n"
+       << "  typedef " << (isFloat ? "float" : "double") << " Scalar;\n"
+       << "\n"
+       << "  //! Units on each layer, not including the constant unit\n"
+       << "  enum\n"
+       << "  {\n";
+
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      os << "    c_numUnits" << layer << " = "
+         << (net.getNumUnits(layer) - 1)
+         << ((layer + 1 < numLayers) ? "," : "") << "\n";
+    }
+
+    os << "  };\n"
+       << "\n"
+       << "  //! digest() of the profile this was compiled from\n"
+       << "  const boost::uint64_t c_digest = "
+       << CompiledProfile::digest(profile) << "ULL;\n"
+       << "\n";
+
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      writeWeights(os, net, layer, isFloat);
+    }
+
+    // the layer sizes and weights again, for CompiledProfile::find() to
+    // compare with those of a profile
+    os << "  //! Units on each layer, not including the constant unit\n"
+       << "  const int c_layerUnits[" << numLayers << "] =\n"
+       << "  {\n";
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+      os << "    c_numUnits" << layer
+         << ((layer + 1 < numLayers) ? "," : "") << "\n";
+    }
+
+    os << "  };\n"
+       << "\n"
+       << "  //! First weight into each layer\n"
+       << "  const Scalar* const c_layerWeights[" << numLayers << "] =\n"
+       << "  {\n"
+       << "    0,\n";
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      os << "    &c_weight" << layer << "[0][0]"
+         << ((layer + 1 < numLayers) ? "," : "") << "\n";
+    }
+
+    os << "  };\n"
+       << "\n";
+
+    os << "  //! Computes the network outputs for one set of inputs\n"
+       << "  inline void predict(const double* input, double* output)\n"
+       << "  {\n"
+       << "    Scalar value0[c_numUnits0];\n"
+       << "    for (int i = 0; i < c_numUnits0; ++i)\n"
+       << "    {\n"
+       << "      value0[i] = Scalar(input[i]);\n"
+       << "    }\n";
+
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      writeLayer(os, layer, (layer + 1 == numLayers));
+    }
+
+    os << "  }\n"
+       << "\n"
+       << "  namespace { // anonymous\n"
+       << "\n"
+       << "    const CompiledProfile::Evaluator c_evaluator =\n"
+       << "    {\n"
+       << "      c_digest,\n"
+       << "      c_numUnits0,\n"
+       << "      c_numUnits" << (numLayers - 1) << ",\n"
+       << "      &predict,\n"
+       << "      " << numLayers << ",\n"
+       << "      c_layerUnits,\n"
+       << "      " << (isFloat ? "0" : "c_layerWeights") << ",\n"
+       << "      " << (isFloat ? "c_layerWeights" : "0") << "\n"
+       << "    };\n"
+       << "\n"
+       << "    CompiledProfile::Registrar s_registrar(c_evaluator);\n"
+       << "\n"
+       << "  } // anonymous namespace\n"
+       << "\n"
+       << "} // namespace " << identifier << "\n"
+       << "\n"
+       << "} // namespace CompiledProfiles\n"
+       << "\n"
+       << "} // namespace alch\n"
+       << "\n"
+       << "#endif\n";
+
+    os.flags(flags);
+
+    return os;
+  }
+
+} // namespace ProfileCompiler
+
+} // namespace alch
@@ -0,0 +1,60 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_ProfileCompiler_h
+#define INCLUDED_stocknnet_ProfileCompiler_h
+
+#include "stocknnet/PredictionProfile.h"
+
+#include "autil/Context.h"
+
+#include <iosfwd>
+#include <string>
+
+namespace alch {
+
+/*!
+  \brief Namespace with methods for compiling prediction profiles to C++
+  \ingroup stocknnet
+
+  The generated header holds the network's layer sizes as enum constants,
+  its weights as static arrays and an allocation-free predict() whose loop
+  bounds are all compile-time constants, so the compiler can unroll and
+  vectorize the whole evaluation. Including the header registers the
+  evaluator with CompiledProfile.
+*/
+namespace ProfileCompiler
+{
+
+  /*!
+    \brief Makes a C++ identifier from a profile base name
+    \param baseName The base name of the prediction profile
+    \return The identifier
+
+    Drops any directory, replaces characters that can't appear in an
+    identifier with underscores, and prefixes "profile_" so the result
+    never starts with a digit.
+  */
+  std::string getIdentifier(const std::string& baseName);
+
+  /*!
+    \brief Writes the C++ header for a prediction profile
+    \param os The output stream
+    \param profile The profile to compile; must have a neural network
+    \param identifier Name of the namespace the evaluator is put in
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error
+
+    The weights are written in the profile's precision, with enough digits
+    to read them back exactly.
+  */
+  bool write(std::ostream& os,
+             const PredictionProfile& profile,
+             const std::string& identifier,
+             Context& ctx);
+
+} // namespace ProfileCompiler
+
+} // namespace alch
+
+#endif
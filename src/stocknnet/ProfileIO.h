@@ -25,7 +25,9 @@ namespace ProfileIO
     \retval false Error
 
     The prediction profile consists of multiple files, all of which share
-    the same base filename.
+    the same base filename. The network is stored in double precision
+    whatever precision the profile records; see
+    PredictionProfile::getPrecision().
   */
   bool read(const char* baseName,
             PredictionProfile& profile,
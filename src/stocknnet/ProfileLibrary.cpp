@@ -0,0 +1,536 @@
+#include "stocknnet/ProfileLibrary.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace alch {
+
+  namespace
+  {
+    //! Orders profile indexes by the name they are packed under
+    class NameLess
+    {
+     public:
+      explicit NameLess(const std::vector<std::string>& names)
+        : m_names(names)
+      {
+        ;
+      }
+
+      bool operator()(int a, int b) const
+      {
+        return (m_names[a] < m_names[b]);
+      }
+
+     private:
+      const std::vector<std::string>& m_names;
+    };
+
+
+    //! Writes zero bytes until the stream is at offset
+    void pad(std::ostream& os, boost::uint64_t& pos, boost::uint64_t offset)
+    {
+      static const char zeros[c_nnetAlignment] = { 0 };
+      while (pos < offset)
+      {
+        std::size_t count = std::size_t(std::min<boost::uint64_t>(
+                                          offset - pos, sizeof(zeros)));
+        os.write(zeros, count);
+        pos += count;
+      }
+    }
+
+
+    //! Rounds an offset up to the next c_nnetAlignment boundary
+    boost::uint64_t align(boost::uint64_t offset)
+    {
+      const boost::uint64_t alignment = c_nnetAlignment;
+      return (((offset + alignment - 1) / alignment) * alignment);
+    }
+  }
+
+
+  // "ANPL" when read in little endian byte order
+  const boost::uint32_t ProfileLibrary::c_magic = 0x4c504e41;
+  const boost::uint32_t ProfileLibrary::c_version = 1;
+
+  ProfileLibrary::ProfileLibrary()
+    : m_map(0)
+    , m_mapLength(0)
+    , m_entries(0)
+    , m_numProfiles(0)
+  {
+    ;
+  }
+
+
+  ProfileLibrary::~ProfileLibrary()
+  {
+    close();
+  }
+
+
+  bool ProfileLibrary::open(const std::string& filename, Context& ctx)
+  {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to open '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to stat '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      ::close(fd);
+      return false;
+    }
+
+    std::size_t length = std::size_t(st.st_size);
+    if (length < sizeof(Header))
+    {
+      ctx << Context::PRIORITY_error
+          << "File '" << filename << "' is too short to be a profile library"
+          << Context::endl;
+      ::close(fd);
+      return false;
+    }
+
+    void* map = ::mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to map '" << filename << "': " << strerror(errno)
+          << Context::endl;
+      return false;
+    }
+
+    m_map = map;
+    m_mapLength = length;
+
+    Header header;
+    memcpy(&header, map, sizeof(header));
+
+    if (header.magic != c_magic)
+    {
+      ctx << Context::PRIORITY_error
+          << "File '" << filename << "' is not a profile library"
+          << Context::endl;
+      close();
+      return false;
+    }
+
+    if (header.version != c_version)
+    {
+      ctx << Context::PRIORITY_error
+          << "Profile library '" << filename << "' has unsupported version "
+          << header.version
+          << Context::endl;
+      close();
+      return false;
+    }
+
+    if (sizeof(Header) + boost::uint64_t(header.numProfiles) * sizeof(Entry)
+        > length)
+    {
+      ctx << Context::PRIORITY_error
+          << "Profile library '" << filename << "' has " << length
+          << " bytes, which is too short for its index"
+          << Context::endl;
+      close();
+      return false;
+    }
+
+    m_entries = reinterpret_cast<const Entry*>(
+      static_cast<const char*>(map) + sizeof(Header));
+    m_numProfiles = int(header.numProfiles);
+
+    // only the index is checked here; the weights aren't touched until a
+    // profile is read, so opening a large library costs little
+    for (int i = 0; i < m_numProfiles; ++i)
+    {
+      if (!checkEntry(m_entries[i], filename, ctx))
+      {
+        close();
+        return false;
+      }
+
+      // find() relies on the order
+      if ((i > 0) && !(getName(i - 1) < getName(i)))
+      {
+        ctx << Context::PRIORITY_error
+            << "Profile library '" << filename
+            << "' is not sorted by profile name at '" << getName(i) << "'"
+            << Context::endl;
+        close();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  void ProfileLibrary::close()
+  {
+    if (m_map)
+    {
+      ::munmap(m_map, m_mapLength);
+    }
+
+    m_map = 0;
+    m_mapLength = 0;
+    m_entries = 0;
+    m_numProfiles = 0;
+  }
+
+
+  std::string ProfileLibrary::getName(int index) const
+  {
+    const Entry& entry = getEntry(index);
+    return std::string(static_cast<const char*>(m_map) + entry.nameOffset,
+                       entry.nameLength);
+  }
+
+
+  int ProfileLibrary::find(const std::string& name) const
+  {
+    int lo = 0;
+    int hi = m_numProfiles;
+    while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      const Entry& entry = getEntry(mid);
+      int cmp = name.compare(0, std::string::npos,
+                             static_cast<const char*>(m_map)
+                             + entry.nameOffset,
+                             entry.nameLength);
+      if (cmp == 0)
+      {
+        return mid;
+      }
+      else if (cmp < 0)
+      {
+        hi = mid;
+      }
+      else
+      {
+        lo = mid + 1;
+      }
+    }
+
+    return -1;
+  }
+
+
+  void ProfileLibrary::read(int index, PredictionProfile& profile) const
+  {
+    const Entry& entry = getEntry(index);
+    const boost::uint32_t* units = getLayers(entry);
+    const boost::uint32_t* strides = units + entry.numLayers;
+    int numLayers = int(entry.numLayers);
+
+    // the unit counts include the constant unit of each layer
+    NeuralNetPtr net(new NeuralNet(int(units[0]) - 1,
+                                   int(units[numLayers - 1]) - 1));
+    for (int layer = 1; layer < numLayers - 1; ++layer)
+    {
+      net->addLayer(int(units[layer]) - 1);
+    }
+    net->reset();
+
+    const char* block = static_cast<const char*>(m_map)
+      + entry.weightsOffset;
+    for (int layer = 1; layer < numLayers; ++layer)
+    {
+      NeuralNet::LayerWeight& weight = net->getLayerWeight(layer);
+      const double* fileWeight = reinterpret_cast<const double*>(block);
+      int fileStride = int(strides[layer - 1]);
+      int stride = net->getStride(layer - 1);
+
+      if (fileStride == stride)
+      {
+        memcpy(&weight[0], fileWeight, weight.size() * sizeof(double));
+      }
+      else
+      {
+        // written by a build with another SIMD width; copy the rows
+        // without their padding
+        for (int row = 0; row < int(units[layer]); ++row)
+        {
+          memcpy(&weight[row * stride], &fileWeight[row * fileStride],
+                 units[layer - 1] * sizeof(double));
+        }
+      }
+
+      block += getWeightBlockSize(units[layer], strides[layer - 1]);
+    }
+
+    profile.setNeuralNet(net);
+    readMetaData(index, profile);
+  }
+
+
+  void ProfileLibrary::readMetaData(int index,
+                                    PredictionProfile& profile) const
+  {
+    const Entry& entry = getEntry(index);
+    profile.setName(std::string(static_cast<const char*>(m_map)
+                                + entry.titleOffset,
+                                entry.titleLength));
+    profile.setNumberDays(int(entry.numberDays));
+    profile.setPrecision(PredictionProfile::Precision(entry.precision));
+  }
+
+
+  void ProfileLibrary::getLayerSizes(int index,
+                                     std::vector<int>& layerSizes) const
+  {
+    const Entry& entry = getEntry(index);
+    const boost::uint32_t* units = getLayers(entry);
+
+    // the unit counts include the constant unit of each layer
+    layerSizes.resize(entry.numLayers);
+    for (int layer = 0; layer < int(entry.numLayers); ++layer)
+    {
+      layerSizes[layer] = int(units[layer]) - 1;
+    }
+  }
+
+
+  bool ProfileLibrary::isLibraryFile(const std::string& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+
+    boost::uint32_t magic = 0;
+    ifs.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+
+    return (ifs && (magic == c_magic));
+  }
+
+
+  bool ProfileLibrary::write(std::ostream& os,
+                             const std::vector<std::string>& names,
+                             const std::vector<PredictionProfile>& profiles,
+                             Context& ctx)
+  {
+    assert(names.size() == profiles.size());
+    int numProfiles = int(profiles.size());
+
+    // the index is sorted by name so that find() can search it
+    std::vector<int> order(numProfiles);
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), NameLess(names));
+
+    for (int i = 1; i < numProfiles; ++i)
+    {
+      if (names[order[i - 1]] == names[order[i]])
+      {
+        ctx << Context::PRIORITY_error
+            << "Duplicate profile name '" << names[order[i]] << "'"
+            << Context::endl;
+        return false;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // lay out the file: index, names and titles, layers, weight blocks
+    std::vector<Entry> entries(numProfiles);
+    boost::uint64_t offset = sizeof(Header) + numProfiles * sizeof(Entry);
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const PredictionProfile& profile = profiles[order[i]];
+      Entry& entry = entries[i];
+      memset(&entry, 0, sizeof(entry));
+
+      entry.nameOffset = offset;
+      entry.nameLength = names[order[i]].size();
+      offset += entry.nameLength;
+
+      entry.titleOffset = offset;
+      entry.titleLength = profile.getName().size();
+      offset += entry.titleLength;
+
+      entry.numberDays = profile.getNumberDays();
+      entry.precision = profile.getPrecision();
+      entry.numLayers = profile.getNeuralNet().getNumLayers();
+    }
+
+    offset = ((offset + sizeof(boost::uint32_t) - 1)
+              / sizeof(boost::uint32_t)) * sizeof(boost::uint32_t);
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      entries[i].layersOffset = offset;
+      offset += 2 * entries[i].numLayers * sizeof(boost::uint32_t);
+    }
+
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const NeuralNet& net = profiles[order[i]].getNeuralNet();
+      offset = align(offset);
+      entries[i].weightsOffset = offset;
+      for (int layer = 1; layer < net.getNumLayers(); ++layer)
+      {
+        offset += getWeightBlockSize(net.getNumUnits(layer),
+                                     net.getStride(layer - 1));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // write it out in the same order
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = c_magic;
+    header.version = c_version;
+    header.numProfiles = numProfiles;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (numProfiles)
+    {
+      os.write(reinterpret_cast<const char*>(&entries[0]),
+               numProfiles * sizeof(Entry));
+    }
+
+    boost::uint64_t pos = sizeof(Header) + numProfiles * sizeof(Entry);
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const std::string& name = names[order[i]];
+      const std::string& title = profiles[order[i]].getName();
+      os.write(name.data(), name.size());
+      os.write(title.data(), title.size());
+      pos += name.size() + title.size();
+    }
+
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const NeuralNet& net = profiles[order[i]].getNeuralNet();
+      int numLayers = net.getNumLayers();
+      std::vector<boost::uint32_t> layers(2 * numLayers);
+      for (int layer = 0; layer < numLayers; ++layer)
+      {
+        layers[layer] = net.getNumUnits(layer);
+        layers[numLayers + layer] = net.getStride(layer);
+      }
+
+      pad(os, pos, entries[i].layersOffset);
+      os.write(reinterpret_cast<const char*>(&layers[0]),
+               layers.size() * sizeof(boost::uint32_t));
+      pos += layers.size() * sizeof(boost::uint32_t);
+    }
+
+    for (int i = 0; i < numProfiles; ++i)
+    {
+      const NeuralNet& net = profiles[order[i]].getNeuralNet();
+      pad(os, pos, entries[i].weightsOffset);
+      for (int layer = 1; layer < net.getNumLayers(); ++layer)
+      {
+        const NeuralNet::LayerWeight& weight = net.getLayerWeight(layer);
+        os.write(reinterpret_cast<const char*>(&weight[0]),
+                 weight.size() * sizeof(double));
+        pos += weight.size() * sizeof(double);
+        pad(os, pos, align(pos));
+      }
+    }
+
+    if (!os)
+    {
+      ctx << Context::PRIORITY_error
+          << "Failed to write profile library of " << numProfiles
+          << " profiles"
+          << Context::endl;
+    }
+
+    return bool(os);
+  }
+
+
+  const ProfileLibrary::Entry& ProfileLibrary::getEntry(int index) const
+  {
+    assert(index >= 0);
+    assert(index < m_numProfiles);
+    return m_entries[index];
+  }
+
+
+  const boost::uint32_t* ProfileLibrary::getLayers(const Entry& entry) const
+  {
+    return reinterpret_cast<const boost::uint32_t*>(
+      static_cast<const char*>(m_map) + entry.layersOffset);
+  }
+
+
+  boost::uint64_t ProfileLibrary::getWeightBlockSize(boost::uint32_t numRows,
+                                                     boost::uint32_t stride)
+  {
+    return align(boost::uint64_t(numRows) * stride * sizeof(double));
+  }
+
+
+  bool ProfileLibrary::checkEntry(const Entry& entry,
+                                  const std::string& filename,
+                                  Context& ctx) const
+  {
+    const boost::uint64_t length = m_mapLength;
+    bool valid = ((entry.nameOffset <= length)
+                  && (entry.nameLength <= length - entry.nameOffset)
+                  && (entry.titleOffset <= length)
+                  && (entry.titleLength <= length - entry.titleOffset)
+                  && (entry.layersOffset <= length)
+                  && (entry.layersOffset % sizeof(boost::uint32_t) == 0)
+                  && (entry.numLayers >= 2)
+                  && (2 * sizeof(boost::uint32_t) * boost::uint64_t(
+                        entry.numLayers) <= length - entry.layersOffset)
+                  && (entry.precision <= PredictionProfile::PRECISION_float)
+                  && (entry.weightsOffset % c_nnetAlignment == 0));
+
+    if (valid)
+    {
+      // every layer needs a unit besides the constant one, and the weight
+      // rows must hold the units of the layer they come from
+      const boost::uint32_t* units = getLayers(entry);
+      const boost::uint32_t* strides = units + entry.numLayers;
+      boost::uint64_t offset = entry.weightsOffset;
+      for (boost::uint32_t layer = 0; valid && (layer < entry.numLayers);
+           ++layer)
+      {
+        valid = ((units[layer] >= 2) && (strides[layer] >= units[layer]));
+        if (valid && (layer > 0))
+        {
+          // compare row counts first so that the block size can't overflow
+          boost::uint64_t rowSize = strides[layer - 1] * sizeof(double);
+          valid = (units[layer] <= (length - offset) / rowSize);
+          offset += getWeightBlockSize(units[layer], strides[layer - 1]);
+          valid = valid && (offset <= length);
+        }
+      }
+    }
+
+    if (!valid)
+    {
+      ctx << Context::PRIORITY_error
+          << "Profile library '" << filename
+          << "' has an invalid index entry"
+          << Context::endl;
+    }
+
+    return valid;
+  }
+
+} // namespace alch
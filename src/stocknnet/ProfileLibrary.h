@@ -0,0 +1,223 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_ProfileLibrary_h
+#define INCLUDED_stocknnet_ProfileLibrary_h
+
+#include "autil/Context.h"
+#include "stocknnet/PredictionProfile.h"
+
+#include "boost/cstdint.hpp"
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+namespace alch {
+
+/*!
+  \brief Binary file holding many prediction profiles, read through a
+  memory map
+  \ingroup stocknnet
+
+  The file is a fixed header, an index with one fixed size entry per
+  profile sorted by profile name, a string table, the layer sizes of each
+  network and then the weight blocks. Each block is stored in the padded
+  row-major layout of NeuralNet::getLayerWeight() and starts on a
+  c_nnetAlignment boundary, so loading a profile copies each block with a
+  single memcpy and parses nothing. Values are stored in the byte order of
+  the machine that wrote them; a file from a machine of the other byte
+  order fails the magic number check.
+
+  The names in the index identify the profiles in the library, like the
+  base names given to ProfileIO; they are separate from
+  PredictionProfile::getName().
+*/
+class ProfileLibrary
+{
+ public:
+
+  /*!
+    \brief Constructor; the file is not opened until open() is called
+  */
+  ProfileLibrary();
+
+  /*!
+    \brief Destructor; unmaps the file
+  */
+  ~ProfileLibrary();
+
+  /*!
+    \brief Maps the named file and checks its index
+    \param filename Name of the file to map
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error; the file is not a valid profile library
+  */
+  bool open(const std::string& filename, Context& ctx);
+
+  //! Unmaps the file, if any
+  void close();
+
+  //! Whether a file is mapped
+  bool isOpen() const
+  {
+    return (m_map != 0);
+  }
+
+  //! Number of profiles in the library
+  int size() const
+  {
+    return m_numProfiles;
+  }
+
+  /*!
+    \brief Returns the name of a profile in the library
+    \param index The profile [0..size() - 1]; profiles are sorted by name
+  */
+  std::string getName(int index) const;
+
+  /*!
+    \brief Looks up a profile by name
+    \param name The name the profile was packed under
+    \return Index of the profile, or -1 if there is none
+  */
+  int find(const std::string& name) const;
+
+  /*!
+    \brief Loads a profile
+    \param index The profile [0..size() - 1]
+    \param profile [out] Receives the metadata and a new network
+  */
+  void read(int index, PredictionProfile& profile) const;
+
+  /*!
+    \brief Loads the metadata of a profile without its network
+    \param index The profile [0..size() - 1]
+    \param profile [out] Receives the metadata; its network is unchanged
+  */
+  void readMetaData(int index, PredictionProfile& profile) const;
+
+  /*!
+    \brief Returns the layer sizes of a profile's network
+    \param index The profile [0..size() - 1]
+    \param layerSizes [out] Units of each layer from the input layer to the
+    output layer, not including the constant unit
+  */
+  void getLayerSizes(int index, std::vector<int>& layerSizes) const;
+
+  /*!
+    \brief Checks whether the named file starts with the magic number
+    \param filename Name of the file to check
+    \retval true The file looks like a profile library
+    \retval false The file can't be read or is in another format
+  */
+  static bool isLibraryFile(const std::string& filename);
+
+  /*!
+    \brief Writes profiles in library format
+    \param os The output stream; should be opened in binary mode
+    \param names Name of each profile; must be unique
+    \param profiles The profiles, in the same order as names
+    \param ctx Context for this operation
+    \retval true Success
+    \retval false Error writing to the stream, or duplicate names
+  */
+  static bool write(std::ostream& os,
+                    const std::vector<std::string>& names,
+                    const std::vector<PredictionProfile>& profiles,
+                    Context& ctx);
+
+ private:
+
+  //! Fixed size header at the start of the file
+  struct Header
+  {
+    //! Identifies the file type and byte order; c_magic
+    boost::uint32_t magic;
+
+    //! Format version; c_version
+    boost::uint32_t version;
+
+    //! Number of profiles, and of entries in the index
+    boost::uint32_t numProfiles;
+
+    //! Unused; zero
+    boost::uint32_t reserved;
+  };
+
+  //! Index entry of one profile; offsets are from the start of the file
+  struct Entry
+  {
+    //! Offset of the name the profile was packed under; not terminated
+    boost::uint64_t nameOffset;
+
+    //! Offset of PredictionProfile::getName(); not terminated
+    boost::uint64_t titleOffset;
+
+    //! Offset of the units of each layer followed by the stride of each
+    //! layer, as numLayers 32 bit values each
+    boost::uint64_t layersOffset;
+
+    //! Offset of the weight block feeding layer 1; the blocks of the
+    //! following layers come next, each aligned to c_nnetAlignment
+    boost::uint64_t weightsOffset;
+
+    boost::uint32_t nameLength;
+    boost::uint32_t titleLength;
+    boost::uint32_t numberDays;
+
+    //! PredictionProfile::Precision
+    boost::uint32_t precision;
+
+    //! Number of layers including the input and output layers
+    boost::uint32_t numLayers;
+
+    //! Unused; zero
+    boost::uint32_t reserved;
+  };
+
+  static const boost::uint32_t c_magic;
+  static const boost::uint32_t c_version;
+
+  // not implemented; a mapping can't be shared
+  ProfileLibrary(const ProfileLibrary&);
+  ProfileLibrary& operator=(const ProfileLibrary&);
+
+  //! Returns the index entry of a profile
+  const Entry& getEntry(int index) const;
+
+  //! Returns the layer sizes of a profile, followed by the strides
+  const boost::uint32_t* getLayers(const Entry& entry) const;
+
+  //! Returns the size in bytes of a weight block, including the padding
+  //! up to the next block
+  static boost::uint64_t getWeightBlockSize(boost::uint32_t numRows,
+                                            boost::uint32_t stride);
+
+  /*!
+    \brief Checks that an index entry lies within the file
+    \param entry The entry
+    \param filename Name of the file (for messages)
+    \param ctx Context for this operation
+    \retval true The entry is valid
+    \retval false Error
+  */
+  bool checkEntry(const Entry& entry,
+                  const std::string& filename,
+                  Context& ctx) const;
+
+  //! Start of the mapping, or 0 if no file is mapped
+  void* m_map;
+
+  //! Length of the mapping in bytes
+  std::size_t m_mapLength;
+
+  //! Start of the index in the mapping
+  const Entry* m_entries;
+
+  int m_numProfiles;
+};
+
+} // namespace alch
+
+#endif
@@ -15,6 +15,12 @@ namespace alch {
 
       const char* c_daysTag = "Days";
 
+      const char* c_precisionTag = "Precision";
+
+      const char* c_doubleValue = "double";
+
+      const char* c_floatValue = "float";
+
       // adds invalid line message
       void invalidLine(const std::string& str, Context& ctx)
       {
@@ -88,6 +94,25 @@ namespace alch {
         return false;
       }
 
+      // profiles written before the precision was recorded are double
+      mapType::const_iterator precision = tagMap.find(c_precisionTag);
+      if ((precision == tagMapEnd) || (precision->second == c_doubleValue))
+      {
+        data.setPrecision(PredictionProfile::PRECISION_double);
+      }
+      else if (precision->second == c_floatValue)
+      {
+        data.setPrecision(PredictionProfile::PRECISION_float);
+      }
+      else
+      {
+        ctx << Context::PRIORITY_error
+            << "Invalid setting for parameter '" << c_precisionTag << "' ("
+            << precision->second << ") in profile metadata"
+            << Context::endl;
+        return false;
+      }
+
       return true;
     }
 
@@ -99,6 +124,11 @@ namespace alch {
 
       os << c_daysTag << " " << data.getNumberDays() << "\n";
 
+      os << c_precisionTag << " "
+         << ((data.getPrecision() == PredictionProfile::PRECISION_float)
+             ? c_floatValue : c_doubleValue)
+         << "\n";
+
       return os;
     }
 
@@ -8,7 +8,10 @@
 #include "TestPopulateDataMA.h"
 #include "TestPopulateDataPSAR.h"
 #include "TestPopulateDataRSI.h"
+#include "TestPredictionCache.h"
+#include "TestProfileCompiler.h"
 #include "TestProfileIO.h"
+#include "TestProfileLibrary.h"
 #include "TestProfileMetaDataStream.h"
 
 int main(int argc, char** argv)
@@ -23,7 +26,10 @@ int main(int argc, char** argv)
   runner.addTest(TestPopulateDataMA::suite());
   runner.addTest(TestPopulateDataPSAR::suite());
   runner.addTest(TestPopulateDataRSI::suite());
+  runner.addTest(TestPredictionCache::suite());
+  runner.addTest(TestProfileCompiler::suite());
   runner.addTest(TestProfileIO::suite());
+  runner.addTest(TestProfileLibrary::suite());
   runner.addTest(TestProfileMetaDataStream::suite());
 
   return !runner.run();
@@ -36,7 +36,7 @@ void TestPopulateDataMA::test1()
   }
 
 
-  NNetDataset dataset;
+  NNetDatapointList dataset;
   int numModified = 0;
 
   dataset.resize(15);
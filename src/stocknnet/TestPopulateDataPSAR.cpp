@@ -45,7 +45,7 @@ void TestPopulateDataPSAR::test1()
   }
 
 
-  NNetDataset dataset;
+  NNetDatapointList dataset;
   int numModified = 0;
 
   dataset.resize(35);
@@ -33,7 +33,7 @@ void TestPopulateDataPrice::test1()
   }
 
 
-  NNetDataset dataset;
+  NNetDatapointList dataset;
   int numModified = 0;
 
   dataset.resize(15);
@@ -38,7 +38,7 @@ void TestPopulateDataRSI::test1()
   }
 
 
-  NNetDataset dataset;
+  NNetDatapointList dataset;
   int numModified = 0;
 
   dataset.resize(25);
@@ -0,0 +1,100 @@
+#include "TestPredictionCache.h"
+
+#include <sstream>
+
+namespace alch
+{
+
+void TestPredictionCache::setUp() 
+{
+  ;
+}
+
+void TestPredictionCache::tearDown()
+{
+  ;
+}
+
+void TestPredictionCache::test1()
+{
+  PredictionCache cache;
+  PredictionCache::Entry entry;
+  CPPUNIT_ASSERT(!cache.find("MSFT:1", entry));
+
+  PredictionCache::Entry msft;
+  msft.lastTime = boost::posix_time::from_iso_string("20050131T160000");
+  msft.lastClose = 26.18;
+  msft.stats.add(26.0, 26.25);
+  msft.stats.add(26.3, 26.125);
+  msft.stats.add(1.0 / 3.0, 26.18);
+  cache.set("MSFT:1", msft);
+
+  PredictionCache::Entry ibm;
+  ibm.lastTime = boost::posix_time::from_iso_string("20050128T160000");
+  ibm.lastClose = 92.89;
+  cache.set("IBM:2", ibm);
+  CPPUNIT_ASSERT_EQUAL(2, cache.size());
+
+  std::stringstream ss;
+  CPPUNIT_ASSERT(cache.write(ss));
+
+  PredictionCache cache2;
+  CPPUNIT_ASSERT(cache2.read(ss, m_ctx));
+  CPPUNIT_ASSERT_EQUAL(2, cache2.size());
+
+  // values come back exactly
+  CPPUNIT_ASSERT(cache2.find("MSFT:1", entry));
+  CPPUNIT_ASSERT(entry.lastTime == msft.lastTime);
+  CPPUNIT_ASSERT_EQUAL(msft.lastClose, entry.lastClose);
+  CPPUNIT_ASSERT_EQUAL(3, entry.stats.size());
+  CPPUNIT_ASSERT_EQUAL(msft.stats.getSquaredError(),
+                       entry.stats.getSquaredError());
+  CPPUNIT_ASSERT_EQUAL(msft.stats.getCorrelation(),
+                       entry.stats.getCorrelation());
+
+  CPPUNIT_ASSERT(cache2.find("IBM:2", entry));
+  CPPUNIT_ASSERT(entry.lastTime == ibm.lastTime);
+  CPPUNIT_ASSERT_EQUAL(0, entry.stats.size());
+  CPPUNIT_ASSERT(!cache2.find("IBM:1", entry));
+
+  // replaces the old entry
+  cache2.set("IBM:2", msft);
+  CPPUNIT_ASSERT_EQUAL(2, cache2.size());
+  CPPUNIT_ASSERT(cache2.find("IBM:2", entry));
+  CPPUNIT_ASSERT_EQUAL(3, entry.stats.size());
+}
+
+void TestPredictionCache::test2()
+{
+  Context ctx;
+  ctx.setPriorityFilter(Context::PRIORITY_none);
+
+  PredictionCache cache;
+  PredictionCache::Entry entry;
+  cache.set("A:1", entry);
+
+  std::istringstream empty("");
+  CPPUNIT_ASSERT(!cache.read(empty, ctx));
+  CPPUNIT_ASSERT_EQUAL(0, cache.size());
+
+  std::istringstream version("alchemy-prediction-cache 2\n");
+  CPPUNIT_ASSERT(!cache.read(version, ctx));
+
+  std::istringstream badTime(
+    "alchemy-prediction-cache 1\n"
+    "A:1 20050131T160000 1 0 0 0 0 0 0 0\n"
+    "B:1 yesterday 1 0 0 0 0 0 0 0\n");
+  CPPUNIT_ASSERT(!cache.read(badTime, ctx));
+  CPPUNIT_ASSERT_EQUAL(0, cache.size());
+
+  std::istringstream truncated(
+    "alchemy-prediction-cache 1\n"
+    "A:1 20050131T160000 1 0 0 0\n");
+  CPPUNIT_ASSERT(!cache.read(truncated, ctx));
+
+  std::istringstream header("alchemy-prediction-cache 1\n");
+  CPPUNIT_ASSERT(cache.read(header, ctx));
+  CPPUNIT_ASSERT_EQUAL(0, cache.size());
+}
+
+} // namespace alch
@@ -0,0 +1,46 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_TestPredictionCache_h
+#define INCLUDED_stocknnet_TestPredictionCache_h
+
+#include "stocknnet/PredictionCache.h"
+#include "autil/Context.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestPredictionCache : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestPredictionCache);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests storing entries and reading them back
+  void test1();
+
+  //! Tests invalid input
+  void test2();
+
+private:
+  Context m_ctx;
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,170 @@
+#include "TestProfileCompiler.h"
+
+// generated by ProfileCompiler::write() from the profile made by
+// createProfile() below
+#include "TestProfileCompilerData.h"
+
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+namespace alch
+{
+
+namespace
+{
+  // a small profile whose weights are exactly representable in text
+  void createProfile(PredictionProfile& profile)
+  {
+    NeuralNetPtr net(new NeuralNet(3, 2, 1, 4));
+    for (int layer = 1; layer < net->getNumLayers(); ++layer)
+    {
+      for (int prevUnit = 0; prevUnit < net->getNumUnits(layer - 1);
+           ++prevUnit)
+      {
+        for (int unit = 1; unit < net->getNumUnits(layer); ++unit)
+        {
+          int i = (layer * 7 + prevUnit * 3 + unit * 5) % 17;
+          net->setWeight(layer, prevUnit, unit, (i - 8) / 16.0);
+        }
+      }
+    }
+
+    profile.setName("compiler test");
+    profile.setNumberDays(2);
+    profile.setNeuralNet(net);
+  }
+} // anonymous namespace
+
+void TestProfileCompiler::setUp() 
+{
+  ;
+}
+
+void TestProfileCompiler::tearDown()
+{
+  m_ctx.dump(std::cerr);
+}
+
+void TestProfileCompiler::test1()
+{
+  CPPUNIT_ASSERT_EQUAL(std::string("profile_test"),
+                       ProfileCompiler::getIdentifier("test"));
+
+  CPPUNIT_ASSERT_EQUAL(std::string("profile_5day_v2"),
+                       ProfileCompiler::getIdentifier("/tmp/x.y/5day-v2"));
+
+  CPPUNIT_ASSERT_EQUAL(std::string("profile_"),
+                       ProfileCompiler::getIdentifier(""));
+}
+
+void TestProfileCompiler::test2()
+{
+  PredictionProfile profile;
+  createProfile(profile);
+
+  std::ostringstream os;
+  CPPUNIT_ASSERT(ProfileCompiler::write(os, profile, "profile_test", m_ctx));
+  std::string header = os.str();
+
+  std::ostringstream digest;
+  digest << "c_digest = " << CompiledProfile::digest(profile) << "ULL;";
+
+  CPPUNIT_ASSERT(header.find("namespace profile_test {")
+                 != std::string::npos);
+  CPPUNIT_ASSERT(header.find("typedef double Scalar;") != std::string::npos);
+  CPPUNIT_ASSERT(header.find("c_numUnits0 = 3,") != std::string::npos);
+  CPPUNIT_ASSERT(header.find("c_numUnits1 = 4,") != std::string::npos);
+  CPPUNIT_ASSERT(header.find("c_numUnits2 = 2\n") != std::string::npos);
+  CPPUNIT_ASSERT(header.find("c_weight2[2][5]") != std::string::npos);
+  CPPUNIT_ASSERT(header.find(digest.str()) != std::string::npos);
+  CPPUNIT_ASSERT(header.find("c_layerWeights,\n      0\n")
+                 != std::string::npos);
+
+  // float profiles are compiled in float and digest differently
+  profile.setPrecision(PredictionProfile::PRECISION_float);
+  std::ostringstream floatOs;
+  CPPUNIT_ASSERT(ProfileCompiler::write(floatOs, profile, "profile_test",
+                                        m_ctx));
+  CPPUNIT_ASSERT(floatOs.str().find("typedef float Scalar;")
+                 != std::string::npos);
+  CPPUNIT_ASSERT(floatOs.str().find(digest.str()) == std::string::npos);
+  CPPUNIT_ASSERT(floatOs.str().find("0,\n      c_layerWeights\n")
+                 != std::string::npos);
+
+  // no network to compile
+  PredictionProfile empty;
+  std::ostringstream emptyOs;
+  CPPUNIT_ASSERT(!ProfileCompiler::write(emptyOs, empty, "profile_test",
+                                         m_ctx));
+}
+
+void TestProfileCompiler::test3()
+{
+  const double delta = 0.000000000001;
+
+  PredictionProfile profile;
+  createProfile(profile);
+
+  // the compiled header registered itself and matches this profile
+  const CompiledProfile::Evaluator* evaluator = CompiledProfile::find(profile);
+  CPPUNIT_ASSERT(evaluator);
+  CPPUNIT_ASSERT(CompiledProfiles::profile_test::c_digest
+                 == evaluator->digest);
+  CPPUNIT_ASSERT_EQUAL(3, evaluator->numInputUnits);
+  CPPUNIT_ASSERT_EQUAL(2, evaluator->numOutputUnits);
+
+  NeuralNet::Workspace workspace;
+  for (int i = 0; i < 10; ++i)
+  {
+    std::vector<double> input;
+    input.push_back(0.1 * i - 0.5);
+    input.push_back(0.3 - 0.07 * i);
+    input.push_back((i % 3) * 0.25);
+
+    double output[2];
+    evaluator->predict(&input[0], output);
+
+    profile.getNeuralNet().propagateInput(input, workspace);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(workspace.getOutput()[1], output[0], delta);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(workspace.getOutput()[2], output[1], delta);
+  }
+
+  // not used once the profile changes
+  NeuralNetPtr changed(new NeuralNet(profile.getNeuralNet()));
+  changed->setWeight(2, 1, 1, changed->getWeight(2, 1, 1) + 0.125);
+  PredictionProfile changedProfile(profile);
+  changedProfile.setNeuralNet(changed);
+  CPPUNIT_ASSERT(!CompiledProfile::find(changedProfile));
+
+  // nor if another profile's digest collides with it
+  CompiledProfile::Evaluator collision(*evaluator);
+  collision.digest = CompiledProfile::digest(changedProfile);
+  CompiledProfile::add(collision);
+  CPPUNIT_ASSERT(!CompiledProfile::find(changedProfile));
+  CPPUNIT_ASSERT_EQUAL(evaluator, CompiledProfile::find(profile));
+
+  changedProfile.setNeuralNet(profile.getNeuralNetPtr());
+  changedProfile.setPrecision(PredictionProfile::PRECISION_float);
+  CPPUNIT_ASSERT(!CompiledProfile::find(changedProfile));
+}
+
+void TestProfileCompiler::test4()
+{
+  PredictionProfile profile;
+  createProfile(profile);
+
+  std::ostringstream os;
+  CPPUNIT_ASSERT(ProfileCompiler::write(os, profile, "profile_test", m_ctx));
+
+  // tests run in the package directory
+  std::ifstream ifs("TestProfileCompilerData.h");
+  CPPUNIT_ASSERT(ifs);
+  std::ostringstream data;
+  data << ifs.rdbuf();
+
+  // regenerate the header if the output of write() changed on purpose
+  CPPUNIT_ASSERT_EQUAL(os.str(), data.str());
+}
+
+} // namespace alch
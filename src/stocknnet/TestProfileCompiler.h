@@ -0,0 +1,56 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_TestProfileCompiler_h
+#define INCLUDED_stocknnet_TestProfileCompiler_h
+
+#include "stocknnet/ProfileCompiler.h"
+#include "stocknnet/CompiledProfile.h"
+#include "autil/Context.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestProfileCompiler : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestProfileCompiler);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+  CPPUNIT_TEST(test3);
+  CPPUNIT_TEST(test4);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests identifiers made from profile names
+  void test1();
+
+  //! Tests the generated header
+  void test2();
+
+  //! Tests a compiled evaluator against the network it was compiled from
+  void test3();
+
+  //! Tests that the checked-in generated header is still what
+  //! ProfileCompiler::write() generates
+  void test4();
+
+private:
+  Context m_ctx;
+
+};
+
+} // namespace alch
+
+#endif
@@ -0,0 +1,127 @@
+// -*- C++ -*-
+
+// Generated by alchemycompileprofile from prediction profile
+// 'compiler test'. Do not edit.
+
+#ifndef INCLUDED_compiledprofile_profile_test_h
+#define INCLUDED_compiledprofile_profile_test_h
+
+#include "stocknnet/CompiledProfile.h"
+
+#include <cmath>
+
+namespace alch {
+
+namespace CompiledProfiles {
+
+namespace profile_test {
+
+  typedef double Scalar;
+
+  //! Units on each layer, not including the constant unit
+  enum
+  {
+    c_numUnits0 = 3,
+    c_numUnits1 = 4,
+    c_numUnits2 = 2
+  };
+
+  //! digest() of the profile this was compiled from
+  const boost::uint64_t c_digest = 13317450936183283064ULL;
+
+  //! Weights into layer 1; column 0 is the bias
+  const Scalar c_weight1[4][4] =
+  {
+    { 2.5000000000000000e-01, 4.3750000000000000e-01,
+      -4.3750000000000000e-01, -2.5000000000000000e-01 },
+    { -5.0000000000000000e-01, -3.1250000000000000e-01,
+      -1.2500000000000000e-01, 6.2500000000000000e-02 },
+    { -1.8750000000000000e-01, 0.0000000000000000e+00,
+      1.8750000000000000e-01, 3.7500000000000000e-01 },
+    { 1.2500000000000000e-01, 3.1250000000000000e-01,
+      5.0000000000000000e-01, -3.7500000000000000e-01 }
+  };
+
+  //! Weights into layer 2; column 0 is the bias
+  const Scalar c_weight2[2][5] =
+  {
+    { -3.7500000000000000e-01, -1.8750000000000000e-01,
+      0.0000000000000000e+00, 1.8750000000000000e-01,
+      3.7500000000000000e-01 },
+    { -6.2500000000000000e-02, 1.2500000000000000e-01,
+      3.1250000000000000e-01, 5.0000000000000000e-01,
+      -3.7500000000000000e-01 }
+  };
+
+  //! Units on each layer, not including the constant unit
+  const int c_layerUnits[3] =
+  {
+    c_numUnits0,
+    c_numUnits1,
+    c_numUnits2
+  };
+
+  //! First weight into each layer
+  const Scalar* const c_layerWeights[3] =
+  {
+    0,
+    &c_weight1[0][0],
+    &c_weight2[0][0]
+  };
+
+  //! Computes the network outputs for one set of inputs
+  inline void predict(const double* input, double* output)
+  {
+    Scalar value0[c_numUnits0];
+    for (int i = 0; i < c_numUnits0; ++i)
+    {
+      value0[i] = Scalar(input[i]);
+    }
+
+    Scalar value1[c_numUnits1];
+    for (int unit = 0; unit < c_numUnits1; ++unit)
+    {
+      Scalar sum = c_weight1[unit][0];
+      for (int prev = 0; prev < c_numUnits0; ++prev)
+      {
+        sum += c_weight1[unit][prev + 1] * value0[prev];
+      }
+      value1[unit] = std::tanh(sum);
+    }
+
+    for (int unit = 0; unit < c_numUnits2; ++unit)
+    {
+      Scalar sum = c_weight2[unit][0];
+      for (int prev = 0; prev < c_numUnits1; ++prev)
+      {
+        sum += c_weight2[unit][prev + 1] * value1[prev];
+      }
+      output[unit] = double(std::tanh(sum));
+    }
+  }
+
+  namespace { // anonymous
+
+    const CompiledProfile::Evaluator c_evaluator =
+    {
+      c_digest,
+      c_numUnits0,
+      c_numUnits2,
+      &predict,
+      3,
+      c_layerUnits,
+      c_layerWeights,
+      0
+    };
+
+    CompiledProfile::Registrar s_registrar(c_evaluator);
+
+  } // anonymous namespace
+
+} // namespace profile_test
+
+} // namespace CompiledProfiles
+
+} // namespace alch
+
+#endif
@@ -64,6 +64,7 @@ void TestProfileIO::test1()
   profile.setNumberDays(4);
   profile.setName("my name");
   profile.setNeuralNet(nnet);
+  profile.setPrecision(PredictionProfile::PRECISION_float);
 
   CPPUNIT_ASSERT(ProfileIO::write(baseName, profile, m_ctx));
   CPPUNIT_ASSERT(ProfileIO::exists(baseName));
@@ -72,6 +73,8 @@ void TestProfileIO::test1()
   CPPUNIT_ASSERT(ProfileIO::read(baseName, profile2, m_ctx));
   CPPUNIT_ASSERT_EQUAL(4, profile2.getNumberDays());
   CPPUNIT_ASSERT_EQUAL(std::string("my name"), profile2.getName());
+  CPPUNIT_ASSERT(profile2.getPrecision()
+                 == PredictionProfile::PRECISION_float);
   CPPUNIT_ASSERT_EQUAL(6, profile2.getNeuralNet().getNumInputUnits());
   CPPUNIT_ASSERT_EQUAL(8, profile2.getNeuralNet().getNumOutputUnits());
 
@@ -0,0 +1,199 @@
+#include "TestProfileLibrary.h"
+
+#include "autil/TempFile.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace alch
+{
+
+  namespace
+  {
+    //! Creates a profile whose weights differ from those of other profiles
+    PredictionProfile makeProfile(const std::string& title,
+                                  int inputs,
+                                  int outputs,
+                                  int hiddenUnits,
+                                  double seed)
+    {
+      NeuralNetPtr net(new NeuralNet(inputs, outputs));
+      if (hiddenUnits)
+      {
+        net->addLayer(hiddenUnits);
+        net->addLayer(hiddenUnits + 3);
+        net->reset();
+      }
+
+      for (int layer = 1; layer < net->getNumLayers(); ++layer)
+      {
+        for (int from = 0; from < net->getNumUnits(layer - 1); ++from)
+        {
+          for (int to = 1; to < net->getNumUnits(layer); ++to)
+          {
+            net->setWeight(layer, from, to,
+                           seed + layer * 0.5 + from * 0.01 - to * 0.001);
+          }
+        }
+      }
+
+      PredictionProfile profile;
+      profile.setName(title);
+      profile.setNumberDays(inputs);
+      profile.setNeuralNet(net);
+      return profile;
+    }
+
+
+    //! Writes a library to the named file
+    void writeFile(const std::string& filename,
+                   const std::vector<std::string>& names,
+                   const std::vector<PredictionProfile>& profiles,
+                   Context& ctx)
+    {
+      std::ofstream ofs(filename.c_str(),
+                        std::ios::out | std::ios::binary | std::ios::trunc);
+      CPPUNIT_ASSERT(ProfileLibrary::write(ofs, names, profiles, ctx));
+    }
+  }
+
+
+void TestProfileLibrary::setUp() 
+{
+  ;
+}
+
+void TestProfileLibrary::tearDown()
+{
+  ;
+}
+
+void TestProfileLibrary::test1()
+{
+  std::vector<std::string> names;
+  std::vector<PredictionProfile> profiles;
+
+  names.push_back("zeta");
+  profiles.push_back(makeProfile("last", 3, 1, 0, 1.0));
+
+  names.push_back("alpha");
+  profiles.push_back(makeProfile("first", 17, 2, 5, 2.0));
+  profiles.back().setPrecision(PredictionProfile::PRECISION_float);
+
+  names.push_back("mid");
+  profiles.push_back(makeProfile("", 9, 4, 11, 3.0));
+
+  TempFile tempFile("TestProfileLibrary");
+  writeFile(tempFile.getName(), names, profiles, m_ctx);
+  CPPUNIT_ASSERT(ProfileLibrary::isLibraryFile(tempFile.getName()));
+
+  ProfileLibrary library;
+  CPPUNIT_ASSERT(library.open(tempFile.getName(), m_ctx));
+  CPPUNIT_ASSERT_EQUAL(3, library.size());
+
+  // sorted by name
+  CPPUNIT_ASSERT_EQUAL(std::string("alpha"), library.getName(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("mid"), library.getName(1));
+  CPPUNIT_ASSERT_EQUAL(std::string("zeta"), library.getName(2));
+  CPPUNIT_ASSERT_EQUAL(-1, library.find("beta"));
+  CPPUNIT_ASSERT_EQUAL(-1, library.find("zeta2"));
+  CPPUNIT_ASSERT_EQUAL(-1, library.find(""));
+
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    int index = library.find(names[i]);
+    CPPUNIT_ASSERT(index >= 0);
+    CPPUNIT_ASSERT_EQUAL(names[i], library.getName(index));
+
+    PredictionProfile profile;
+    library.read(index, profile);
+    CPPUNIT_ASSERT_EQUAL(profiles[i].getName(), profile.getName());
+    CPPUNIT_ASSERT_EQUAL(profiles[i].getNumberDays(),
+                         profile.getNumberDays());
+    CPPUNIT_ASSERT(profiles[i].getPrecision() == profile.getPrecision());
+
+    const NeuralNet& expected = profiles[i].getNeuralNet();
+    const NeuralNet& net = profile.getNeuralNet();
+    CPPUNIT_ASSERT_EQUAL(expected.getNumLayers(), net.getNumLayers());
+
+    // the metadata and layer sizes alone, without loading the weights
+    PredictionProfile metaData;
+    library.readMetaData(index, metaData);
+    CPPUNIT_ASSERT_EQUAL(profiles[i].getName(), metaData.getName());
+    CPPUNIT_ASSERT_EQUAL(profiles[i].getNumberDays(),
+                         metaData.getNumberDays());
+    CPPUNIT_ASSERT(profiles[i].getPrecision() == metaData.getPrecision());
+
+    std::vector<int> layerSizes;
+    library.getLayerSizes(index, layerSizes);
+    CPPUNIT_ASSERT_EQUAL(expected.getNumLayers(), int(layerSizes.size()));
+    for (int layer = 0; layer < expected.getNumLayers(); ++layer)
+    {
+      CPPUNIT_ASSERT_EQUAL(expected.getNumUnits(layer) - 1,
+                           layerSizes[layer]);
+    }
+    for (int layer = 1; layer < net.getNumLayers(); ++layer)
+    {
+      CPPUNIT_ASSERT_EQUAL(expected.getNumUnits(layer),
+                           net.getNumUnits(layer));
+      CPPUNIT_ASSERT(expected.getLayerWeight(layer)
+                     == net.getLayerWeight(layer));
+    }
+  }
+
+  library.close();
+  CPPUNIT_ASSERT(!library.isOpen());
+  CPPUNIT_ASSERT_EQUAL(0, library.size());
+
+  // an empty library is valid
+  writeFile(tempFile.getName(), std::vector<std::string>(),
+            std::vector<PredictionProfile>(), m_ctx);
+  CPPUNIT_ASSERT(library.open(tempFile.getName(), m_ctx));
+  CPPUNIT_ASSERT_EQUAL(0, library.size());
+  CPPUNIT_ASSERT_EQUAL(-1, library.find("alpha"));
+}
+
+void TestProfileLibrary::test2()
+{
+  Context ctx;
+  ctx.setPriorityFilter(Context::PRIORITY_none);
+
+  std::vector<std::string> names;
+  std::vector<PredictionProfile> profiles;
+  names.push_back("a");
+  profiles.push_back(makeProfile("one", 3, 1, 2, 1.0));
+  names.push_back("a");
+  profiles.push_back(makeProfile("two", 3, 1, 2, 2.0));
+
+  std::ostringstream oss;
+  CPPUNIT_ASSERT(!ProfileLibrary::write(oss, names, profiles, ctx));
+
+  // text profiles and truncated libraries are rejected
+  names.pop_back();
+  profiles.pop_back();
+  std::ostringstream oss2;
+  CPPUNIT_ASSERT(ProfileLibrary::write(oss2, names, profiles, ctx));
+  std::string data(oss2.str());
+
+  TempFile tempFile("TestProfileLibrary");
+  ProfileLibrary library;
+  {
+    std::ofstream ofs(tempFile.getName().c_str());
+    ofs << "not a library\n";
+  }
+  CPPUNIT_ASSERT(!ProfileLibrary::isLibraryFile(tempFile.getName()));
+  CPPUNIT_ASSERT(!library.open(tempFile.getName(), ctx));
+
+  {
+    std::ofstream ofs(tempFile.getName().c_str(),
+                      std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs.write(data.data(), data.size() - 1);
+  }
+  CPPUNIT_ASSERT(ProfileLibrary::isLibraryFile(tempFile.getName()));
+  CPPUNIT_ASSERT(!library.open(tempFile.getName(), ctx));
+  CPPUNIT_ASSERT(!library.isOpen());
+
+  CPPUNIT_ASSERT(!library.open(tempFile.getName() + ".missing", ctx));
+}
+
+} // namespace alch
@@ -0,0 +1,46 @@
+// -*- C++ -*-
+
+#ifndef INCLUDED_stocknnet_TestProfileLibrary_h
+#define INCLUDED_stocknnet_TestProfileLibrary_h
+
+#include "stocknnet/ProfileLibrary.h"
+#include "autil/Context.h"
+
+#include <cppunit/TestFixture.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace alch
+{
+
+
+class TestProfileLibrary : public CppUnit::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(TestProfileLibrary);
+
+  CPPUNIT_TEST(test1);
+  CPPUNIT_TEST(test2);
+
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+  void setUp();
+
+  void tearDown();
+
+  //! Tests writing and reading back profiles of different shapes
+  void test1();
+
+  //! Tests duplicate names and invalid files
+  void test2();
+
+private:
+  Context m_ctx;
+
+};
+
+} // namespace alch
+
+#endif
@@ -21,6 +21,7 @@ void TestProfileMetaDataStream::test1()
   const char* result = 
     "Name this is a name\n"
     "Days 4\n"
+    "Precision float\n"
     ;
 
   std::ostringstream os;
@@ -28,6 +29,7 @@ void TestProfileMetaDataStream::test1()
   PredictionProfile data;
   data.setName("this is a name");
   data.setNumberDays(4);
+  data.setPrecision(PredictionProfile::PRECISION_float);
 
   CPPUNIT_ASSERT(ProfileMetaDataStream::write(os, data, m_ctx));
 
@@ -38,6 +40,7 @@ void TestProfileMetaDataStream::test1()
   CPPUNIT_ASSERT(ProfileMetaDataStream::read(is, newData, m_ctx));
   CPPUNIT_ASSERT(data.getName() == newData.getName());
   CPPUNIT_ASSERT(data.getNumberDays() == newData.getNumberDays());
+  CPPUNIT_ASSERT(data.getPrecision() == newData.getPrecision());
 }
 
 void TestProfileMetaDataStream::test2()
@@ -51,7 +54,26 @@ void TestProfileMetaDataStream::test2()
 
     std::istringstream is(origData);
     PredictionProfile newData;
+    newData.setPrecision(PredictionProfile::PRECISION_float);
     CPPUNIT_ASSERT(ProfileMetaDataStream::read(is, newData, m_ctx));
+
+    // no precision tag means double
+    CPPUNIT_ASSERT(newData.getPrecision()
+                   == PredictionProfile::PRECISION_double);
+  }
+
+  {
+    const char* origData = 
+      "Name this is a name\n"
+      "Days 4\n"
+      "Precision double\n"
+      ;
+
+    std::istringstream is(origData);
+    PredictionProfile newData;
+    CPPUNIT_ASSERT(ProfileMetaDataStream::read(is, newData, m_ctx));
+    CPPUNIT_ASSERT(newData.getPrecision()
+                   == PredictionProfile::PRECISION_double);
   }
 
 
@@ -141,6 +163,18 @@ void TestProfileMetaDataStream::test2()
     CPPUNIT_ASSERT(!ProfileMetaDataStream::read(is, newData, m_ctx));
   }
 
+  {
+    const char* origData = 
+      "Name this is a name\n"
+      "Days 4\n"
+      "Precision half\n"
+      ;
+
+    std::istringstream is(origData);
+    PredictionProfile newData;
+    CPPUNIT_ASSERT(!ProfileMetaDataStream::read(is, newData, m_ctx));
+  }
+
 }
 
 } // namespace alch
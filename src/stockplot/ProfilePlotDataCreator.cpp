@@ -87,7 +87,7 @@ namespace alch {
     // future beyond what's in rangeData--we have to estimate the dates
     // for these additional points.
     
-    NeuralNet neuralNet = m_profile.getNeuralNet();
+    const NeuralNet& neuralNet = m_profile.getNeuralNet();
     int datasetSize = int(dataset.size());
     int numRangeDataPoints = int(rangeData->size());
     int startIdx = (numRangeDataPoints